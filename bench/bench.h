@@ -0,0 +1,220 @@
+#pragma once
+
+#include "cpu.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Small benchmark harness. A benchmark is a function processing n elements;
+// it is repeated until a sample lasts Options::minTime, and the best of
+// Options::samples samples gives the ns per element, reported with the
+// elements per second (for the intersection batches one element is one ray
+// against one primitive). Bandwidth comes from the bytes read and written per
+// element.
+//
+// Array functions are measured for a few working set sizes, from L1 resident
+// to DRAM sized, first with a naive loop over the single element function
+// (the reference) and then through the library at every cpu level available,
+// so the SIMD speedup is reported next to each result.
+
+namespace bench
+{
+	struct Footprint
+	{
+		const char* name;
+		size_t bytes;		//whole working set of the benchmark, inputs and outputs
+	};
+
+	struct Options
+	{
+		std::string filter;	//substring of "group/name", empty runs everything
+		double minTime;		//seconds per sample
+		uint32_t samples;
+		std::vector<Footprint> footprints;
+	};
+
+	struct Result
+	{
+		std::string group, name, variant, footprint;
+		uint32_t count;
+		double nsPerOp, mopsPerS, gbPerS;
+		double speedup;		//over the naive variant, 0 when there is none
+	};
+
+	struct Suite
+	{
+		Options options;
+		std::vector<Result> results;
+	};
+
+	//---------------------------------------------------------------------
+
+	inline bool selected(const Suite& p_Suite, const char* p_Group, const char* p_Name)
+	{
+		if(p_Suite.options.filter.empty())
+			return true;
+
+		return (std::string(p_Group) + "/" + p_Name).find(p_Suite.options.filter) != std::string::npos;
+	}
+
+	//element count filling p_Footprint with p_BytesPerOp per element, at least 16
+	inline uint32_t countFor(const Footprint& p_Footprint, double p_BytesPerOp)
+	{
+		size_t n = (size_t)(p_Footprint.bytes / p_BytesPerOp);
+		return n < 16 ? 16 : (uint32_t)n;
+	}
+
+	//---------------------------------------------------------------------
+
+	//best ns per element of p_Fn(p_Count)
+	template<typename F>
+	double measure(const Options& p_Options, uint32_t p_Count, F p_Fn)
+	{
+		typedef std::chrono::steady_clock Clock;
+
+		p_Fn(p_Count);
+
+		//double the repetitions until one sample is long enough
+		uint64_t reps = 1;
+		double best = 1e30;
+		uint32_t samples = 0;
+
+		while(samples < p_Options.samples)
+		{
+			Clock::time_point start = Clock::now();
+			for(uint64_t r = 0; r < reps; ++r)
+				p_Fn(p_Count);
+			double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+			if(elapsed < p_Options.minTime && samples == 0)
+			{
+				reps *= 2;
+				continue;
+			}
+
+			double ns = elapsed * 1e9 / ((double)reps * p_Count);
+			best = ns < best ? ns : best;
+			samples += 1;
+		}
+
+		return best;
+	}
+
+	//---------------------------------------------------------------------
+
+	inline void report(Suite& p_Suite, const char* p_Group, const char* p_Name, const char* p_Variant, const Footprint& p_Footprint,
+					   uint32_t p_Count, double p_NsPerOp, double p_BytesPerOp, double p_NaiveNs)
+	{
+		Result r;
+		r.group = p_Group;
+		r.name = p_Name;
+		r.variant = p_Variant;
+		r.footprint = p_Footprint.name;
+		r.count = p_Count;
+		r.nsPerOp = p_NsPerOp;
+		r.mopsPerS = 1000.0 / p_NsPerOp;
+		r.gbPerS = p_BytesPerOp / p_NsPerOp;
+		r.speedup = p_NaiveNs > 0 ? p_NaiveNs / p_NsPerOp : 0;
+
+		p_Suite.results.push_back(r);
+
+		printf("%-12s %-28s %-7s %-5s %10u %10.3f ns/op %9.1f Mop/s %8.2f GB/s", p_Group, p_Name, p_Variant, p_Footprint.name, p_Count, r.nsPerOp, r.mopsPerS, r.gbPerS);
+		if(r.speedup > 0)
+			printf(" %6.2fx", r.speedup);
+		printf("\n");
+		fflush(stdout);
+	}
+
+	//---------------------------------------------------------------------
+
+	//a function with no array version, called in a loop over p_Count elements
+	template<typename F>
+	void single(Suite& p_Suite, const char* p_Group, const char* p_Name, uint32_t p_Count, double p_BytesPerOp, F p_Fn)
+	{
+		if(!selected(p_Suite, p_Group, p_Name))
+			return;
+
+		double ns = measure(p_Suite.options, p_Count, p_Fn);
+		report(p_Suite, p_Group, p_Name, "single", p_Suite.options.footprints[0], p_Count, ns, p_BytesPerOp, 0);
+	}
+
+	//the naive reference, then p_Lib at every cpu level up to the detected one
+	//(only the fixed one in a build where ALFAR_MIN_LEVEL == ALFAR_MAX_LEVEL)
+	template<typename N, typename L>
+	void compare(Suite& p_Suite, const char* p_Group, const char* p_Name, const Footprint& p_Footprint, uint32_t p_Count, double p_BytesPerOp, N p_Naive, L p_Lib)
+	{
+		if(!selected(p_Suite, p_Group, p_Name))
+			return;
+
+		double naive = measure(p_Suite.options, p_Count, p_Naive);
+		report(p_Suite, p_Group, p_Name, "naive", p_Footprint, p_Count, naive, p_BytesPerOp, 0);
+
+		alfar::cpu::Level detected = alfar::cpu::detect();
+		for(int l = alfar::cpu::LEVEL_SCALAR; l <= detected; ++l)
+		{
+			alfar::cpu::setLevel((alfar::cpu::Level)l);
+			if(alfar::cpu::level() != l)
+				continue;
+
+			double ns = measure(p_Suite.options, p_Count, p_Lib);
+			report(p_Suite, p_Group, p_Name, alfar::cpu::levelName((alfar::cpu::Level)l), p_Footprint, p_Count, ns, p_BytesPerOp, naive);
+		}
+
+		alfar::cpu::setLevel(detected);
+	}
+
+	//---------------------------------------------------------------------
+
+	//deterministic values in [p_Min, p_Max]
+	inline float random(uint32_t& p_State, float p_Min = -1.0f, float p_Max = 1.0f)
+	{
+		p_State = p_State * 1664525u + 1013904223u;
+		return p_Min + (p_Max - p_Min) * ((p_State >> 8) * (1.0f / 16777216.0f));
+	}
+
+	//p_Count structs of floats (vectors, quaternions...) filled with random values
+	template<typename T>
+	std::vector<T> randomArray(uint32_t p_Count, uint32_t p_Seed, float p_Min = -1.0f, float p_Max = 1.0f)
+	{
+		std::vector<T> ret(p_Count);
+		float* f = (float*)ret.data();
+
+		for(size_t i = 0; i < (size_t)p_Count * (sizeof(T) / sizeof(float)); ++i)
+			f[i] = random(p_Seed, p_Min, p_Max);
+
+		return ret;
+	}
+
+	//----- registration, one per benchmark file
+
+	void vectorBenchmarks(Suite& p_Suite);
+	void quaternionBenchmarks(Suite& p_Suite);
+	void mat4x4Benchmarks(Suite& p_Suite);
+	void mat3x3Benchmarks(Suite& p_Suite);
+	void affine3x4Benchmarks(Suite& p_Suite);
+	void intersectionBenchmarks(Suite& p_Suite);
+	void boundsBenchmarks(Suite& p_Suite);
+	void frustumBenchmarks(Suite& p_Suite);
+	void bvhBenchmarks(Suite& p_Suite);
+	void fastmathBenchmarks(Suite& p_Suite);
+	void parallelBenchmarks(Suite& p_Suite);
+	void exprBenchmarks(Suite& p_Suite);
+	void rasterBenchmarks(Suite& p_Suite);
+	void spriteBenchmarks(Suite& p_Suite);
+	void arenaBenchmarks(Suite& p_Suite);
+	void quantizeBenchmarks(Suite& p_Suite);
+	void rebaseBenchmarks(Suite& p_Suite);
+}
+
+// Shorthands of the benchmark files, inside a footprint loop declaring fp and
+// n. BENCH_ARRAY compares the naive loop body NAIVE (over i) with the library
+// call LIB (over c elements), BENCH_SINGLE times the loop body BODY.
+#define BENCH_ARRAY(GROUP, NAME, BYTES, NAIVE, LIB) \
+	bench::compare(p_Suite, GROUP, NAME, fp, n, BYTES, \
+		[&](uint32_t c) { for(uint32_t i = 0; i < c; ++i) { NAIVE; } }, \
+		[&](uint32_t c) { LIB; })
+
+#define BENCH_SINGLE(GROUP, NAME, BYTES, BODY) \
+	bench::single(p_Suite, GROUP, NAME, n, BYTES, [&](uint32_t c) { for(uint32_t i = 0; i < c; ++i) { BODY; } })
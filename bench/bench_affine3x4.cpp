@@ -0,0 +1,107 @@
+#include "bench.h"
+#include "affine3x4.h"
+#include "affine3x4_parallel.h"
+#include "mat4x4.h"
+#include "mat4x4_parallel.h"
+
+using namespace alfar;
+
+namespace
+{
+	//well conditioned transforms: a perturbed identity basis and a translation
+	std::vector<Affine3x4> randomAffine(uint32_t p_Count, uint32_t p_Seed)
+	{
+		std::vector<Affine3x4> ret(p_Count);
+
+		for(uint32_t i = 0; i < p_Count; ++i)
+		{
+			float* f = &ret[i].x.x;
+			for(int k = 0; k < 12; ++k)
+				f[k] = (k % 5 == 0 ? 2.0f : 0.0f) + bench::random(p_Seed, -0.5f, 0.5f);
+
+			ret[i].x.w *= 10.0f;
+			ret[i].y.w *= 10.0f;
+			ret[i].z.w *= 10.0f;
+		}
+
+		return ret;
+	}
+
+	//a forest of 4-ary trees of 64 nodes, parents before children
+	std::vector<int32_t> forest(uint32_t p_Count)
+	{
+		std::vector<int32_t> ret(p_Count);
+
+		for(uint32_t i = 0; i < p_Count; ++i)
+		{
+			uint32_t local = i % 64;
+			ret[i] = local == 0 ? -1 : (int32_t)(i - local + (local - 1) / 4);
+		}
+
+		return ret;
+	}
+}
+
+//=============================================================================
+
+void bench::affine3x4Benchmarks(bench::Suite& p_Suite)
+{
+	//----- hierarchies, the same node count as Matrix4x4 and Affine3x4 so the
+	//footprint column is the one of the Matrix4x4 version
+
+	for(size_t f = 0; f < p_Suite.options.footprints.size(); ++f)
+	{
+		const bench::Footprint& fp = p_Suite.options.footprints[f];
+		uint32_t n = bench::countFor(fp, 2 * sizeof(Matrix4x4));
+
+		std::vector<Affine3x4> a = randomAffine(n, 1), o(n);
+		std::vector<Matrix4x4> a4(n), o4(n);
+		std::vector<int32_t> parents = forest(n);
+
+		affine3x4::toMat4x4(a.data(), a4.data(), n);
+
+		BENCH_ARRAY("affine3x4", "propagateMat4x4", 132, o4[i] = parents[i] < 0 ? a4[i] : mat4x4::mul(o4[parents[i]], a4[i]), mat4x4::propagate(a4.data(), parents.data(), o4.data(), c));
+		BENCH_ARRAY("affine3x4", "propagate", 100, o[i] = parents[i] < 0 ? a[i] : affine3x4::mul(o[parents[i]], a[i]), affine3x4::propagate(a.data(), parents.data(), o.data(), c));
+		BENCH_ARRAY("affine3x4", "propagateParallelMat4x4", 132, o4[i] = parents[i] < 0 ? a4[i] : mat4x4::mul(o4[parents[i]], a4[i]), mat4x4::propagate(parallel::policy(), a4.data(), parents.data(), o4.data(), c));
+		BENCH_ARRAY("affine3x4", "propagateParallel", 100, o[i] = parents[i] < 0 ? a[i] : affine3x4::mul(o[parents[i]], a[i]), affine3x4::propagate(parallel::policy(), a.data(), parents.data(), o.data(), c));
+	}
+
+	//----- matrix arrays
+
+	for(size_t f = 0; f < p_Suite.options.footprints.size(); ++f)
+	{
+		const bench::Footprint& fp = p_Suite.options.footprints[f];
+		uint32_t n = bench::countFor(fp, 3 * sizeof(Affine3x4));
+
+		std::vector<Affine3x4> a = randomAffine(n, 1), b = randomAffine(n, 2), o(n);
+
+		BENCH_ARRAY("affine3x4", "mul", 144, o[i] = affine3x4::mul(a[i], b[i]), affine3x4::mul(a.data(), b.data(), o.data(), c));
+		BENCH_ARRAY("affine3x4", "inverse", 96, o[i] = affine3x4::inverse(a[i]), affine3x4::inverse(a.data(), o.data(), c));
+		BENCH_ARRAY("affine3x4", "rigidInverse", 96, o[i] = affine3x4::rigidInverse(a[i]), affine3x4::rigidInverse(a.data(), o.data(), c));
+
+		if(f != 0)
+			continue;
+
+		std::vector<Matrix4x4> m(n);
+		std::vector<Vector3> v = bench::randomArray<Vector3>(n, 3), vo(n);
+		affine3x4::toMat4x4(a.data(), m.data(), n);
+
+		BENCH_SINGLE("affine3x4", "fromMat4x4", 112, o[i] = affine3x4::fromMat4x4(m[i]));
+		BENCH_SINGLE("affine3x4", "toMat4x4", 112, m[i] = affine3x4::toMat4x4(a[i]));
+		BENCH_SINGLE("affine3x4", "transformPoint", 72, vo[i] = affine3x4::transformPoint(a[i], v[i]));
+	}
+
+	//----- vector transforms
+
+	for(size_t f = 0; f < p_Suite.options.footprints.size(); ++f)
+	{
+		const bench::Footprint& fp = p_Suite.options.footprints[f];
+		uint32_t n = bench::countFor(fp, 2 * sizeof(Vector3));
+
+		Affine3x4 m = randomAffine(1, 1)[0];
+		std::vector<Vector3> a = bench::randomArray<Vector3>(n, 2), o(n);
+
+		BENCH_ARRAY("affine3x4", "transformPoints", 24, o[i] = affine3x4::transformPoint(m, a[i]), affine3x4::transformPoints(m, a.data(), o.data(), c));
+		BENCH_ARRAY("affine3x4", "transformDirections", 24, o[i] = affine3x4::transformDirection(m, a[i]), affine3x4::transformDirections(m, a.data(), o.data(), c));
+	}
+}
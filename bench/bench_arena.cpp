@@ -0,0 +1,103 @@
+#include "bench.h"
+#include "arena.h"
+#include "vector3.h"
+#include "vector4.h"
+
+using namespace alfar;
+
+// Allocation: one op is one array of ARRAY Vector3, from aligned::allocate
+// and release (the "naive" reference), an Arena reset every BATCH arrays, or
+// a Pool. Kernels: array functions over arena arrays against the same arrays
+// one float off the cache line (the reference), so most SIMD loads split a
+// line, at the detected level.
+
+namespace
+{
+	const uint32_t ARRAY = 256;
+	const uint32_t BATCH = 64;
+}
+
+//=============================================================================
+
+void bench::arenaBenchmarks(bench::Suite& p_Suite)
+{
+	bench::Footprint allocationFp = { "-", arena::arrayBytes<Vector3>(ARRAY) * BATCH };
+	void* blocks[BATCH];
+
+	if(bench::selected(p_Suite, "arena", "allocate"))
+	{
+		double naive = bench::measure(p_Suite.options, BATCH, [&](uint32_t c)
+		{
+			for(uint32_t i = 0; i < c; ++i)
+				blocks[i] = aligned::allocate(arena::arrayBytes<Vector3>(ARRAY));
+			for(uint32_t i = 0; i < c; ++i)
+				aligned::release(blocks[i]);
+		});
+		bench::report(p_Suite, "arena", "allocate", "naive", allocationFp, BATCH, naive, 0, 0);
+
+		Arena a = arena::create(arena::arrayBytes<Vector3>(ARRAY) * BATCH);
+		double ns = bench::measure(p_Suite.options, BATCH, [&](uint32_t c)
+		{
+			for(uint32_t i = 0; i < c; ++i)
+				blocks[i] = arena::allocateArray<Vector3>(a, ARRAY);
+			arena::reset(a);
+		});
+		bench::report(p_Suite, "arena", "allocate", "arena", allocationFp, BATCH, ns, 0, naive);
+		arena::destroy(a);
+
+		Pool p = pool::createForArrays<Vector3>(ARRAY, BATCH);
+		ns = bench::measure(p_Suite.options, BATCH, [&](uint32_t c)
+		{
+			for(uint32_t i = 0; i < c; ++i)
+				blocks[i] = pool::allocateArray<Vector3>(p, ARRAY);
+			for(uint32_t i = 0; i < c; ++i)
+				pool::release(p, blocks[i]);
+		});
+		bench::report(p_Suite, "arena", "allocate", "pool", allocationFp, BATCH, ns, 0, naive);
+		pool::destroy(p);
+	}
+
+	//----- kernels, aligned and padded against one float off
+
+	for(size_t f = 0; f < p_Suite.options.footprints.size(); ++f)
+	{
+		const bench::Footprint& fp = p_Suite.options.footprints[f];
+		uint32_t n = bench::countFor(fp, 3 * sizeof(Vector4));
+
+		Arena a = arena::create(3 * arena::arrayBytes<Vector4>(n + 1));
+		float* x = (float*)arena::allocateArray<Vector4>(a, n + 1);
+		float* y = (float*)arena::allocateArray<Vector4>(a, n + 1);
+		float* o = (float*)arena::allocateArray<Vector4>(a, n + 1);
+		for(size_t i = 0; i < (size_t)(n + 1) * 4; ++i)
+			x[i] = y[i] = 1.0f;
+
+		struct Case
+		{
+			const char* name;
+			double bytes;
+			void (*run)(float*, float*, float*, uint32_t);
+		};
+
+		const Case cases[] =
+		{
+			{ "vector3::add", 36, [](float* a, float* b, float* o, uint32_t p_Number) { vector3::add((Vector3*)a, (Vector3*)b, (Vector3*)o, p_Number); } },
+			{ "vector3::cross", 36, [](float* a, float* b, float* o, uint32_t p_Number) { vector3::cross((Vector3*)a, (Vector3*)b, (Vector3*)o, p_Number); } },
+			{ "vector4::normalize", 32, [](float* a, float*, float* o, uint32_t p_Number) { vector4::normalize((Vector4*)a, (Vector4*)o, p_Number); } },
+		};
+
+		for(size_t k = 0; k < sizeof(cases) / sizeof(cases[0]); ++k)
+		{
+			if(!bench::selected(p_Suite, "arena", cases[k].name))
+				continue;
+
+			const Case& c = cases[k];
+			double naive = bench::measure(p_Suite.options, n, [&](uint32_t p_Count) { c.run(x + 1, y + 1, o + 1, p_Count); });
+			bench::report(p_Suite, "arena", c.name, "naive", fp, n, naive, c.bytes, 0);
+
+			double ns = bench::measure(p_Suite.options, n, [&](uint32_t p_Count) { c.run(x, y, o, aligned::paddedCount(p_Count)); });
+			bench::report(p_Suite, "arena", c.name, "arena", fp, n, ns, c.bytes, naive);
+		}
+
+		arena::destroy(a);
+	}
+}
@@ -0,0 +1,103 @@
+#include "bench.h"
+#include "aabb.h"
+#include "rect.h"
+#include "oobb.h"
+#include "quaternion.h"
+
+using namespace alfar;
+
+namespace
+{
+	//boxes of half size up to 1 in a 20 units cube, a query of 4 units overlaps about 1 in 50
+	std::vector<AABB> randomBoxes(uint32_t p_Count, uint32_t p_Seed)
+	{
+		std::vector<AABB> ret(p_Count);
+
+		for(uint32_t i = 0; i < p_Count; ++i)
+		{
+			Vector3 c = vector3::create(bench::random(p_Seed, -10, 10), bench::random(p_Seed, -10, 10), bench::random(p_Seed, -10, 10));
+			Vector3 h = vector3::create(bench::random(p_Seed, 0, 1), bench::random(p_Seed, 0, 1), bench::random(p_Seed, 0, 1));
+			ret[i] = aabb::fromCenter(c, h);
+		}
+
+		return ret;
+	}
+
+	std::vector<Rect> randomRects(uint32_t p_Count, uint32_t p_Seed)
+	{
+		std::vector<Rect> ret(p_Count);
+
+		for(uint32_t i = 0; i < p_Count; ++i)
+		{
+			Vector2 c = vector2::create(bench::random(p_Seed, -10, 10), bench::random(p_Seed, -10, 10));
+			Vector2 h = vector2::create(bench::random(p_Seed, 0, 1), bench::random(p_Seed, 0, 1));
+			ret[i] = rect::create(vector2::sub(c, h), vector2::add(c, h));
+		}
+
+		return ret;
+	}
+}
+
+//=============================================================================
+
+void bench::boundsBenchmarks(bench::Suite& p_Suite)
+{
+	for(size_t f = 0; f < p_Suite.options.footprints.size(); ++f)
+	{
+		const bench::Footprint& fp = p_Suite.options.footprints[f];
+
+		//----- aabb
+
+		uint32_t n = bench::countFor(fp, sizeof(AABB));
+
+		std::vector<Vector3> points = bench::randomArray<Vector3>(n, 1);
+		std::vector<AABB> boxes = randomBoxes(n, 2), o(n);
+		std::vector<uint32_t> mask((n + 31) / 32);
+		AABB query = aabb::fromCenter(vector3::create(1, 2, 3), vector3::create(2, 2, 2));
+
+		BENCH_ARRAY("aabb", "fromPoints", 12, o[0] = aabb::merge(i == 0 ? aabb::empty() : o[0], points[i]), o[0] = aabb::fromPoints(points.data(), c));
+		BENCH_ARRAY("aabb", "overlap", 24,
+			if(i % 32 == 0) mask[i / 32] = 0;
+			mask[i / 32] |= (aabb::overlap(query, boxes[i]) ? 1u : 0u) << (i % 32),
+			aabb::overlap(query, boxes.data(), c, mask.data()));
+
+		//----- rect
+
+		n = bench::countFor(fp, sizeof(Rect));
+
+		std::vector<Vector2> points2 = bench::randomArray<Vector2>(n, 3);
+		std::vector<Rect> rects = randomRects(n, 4), r(1);
+		mask.resize((n + 31) / 32);
+		Rect queryRect = rect::create(vector2::create(-1, 0), vector2::create(3, 4));
+
+		BENCH_ARRAY("rect", "fromPoints", 8, r[0] = rect::merge(i == 0 ? rect::empty() : r[0], points2[i]), r[0] = rect::fromPoints(points2.data(), c));
+		BENCH_ARRAY("rect", "overlap", 16,
+			if(i % 32 == 0) mask[i / 32] = 0;
+			mask[i / 32] |= (rect::overlap(queryRect, rects[i]) ? 1u : 0u) << (i % 32),
+			rect::overlap(queryRect, rects.data(), c, mask.data()));
+
+		if(f != 0)
+			continue;
+
+		//----- single element
+
+		n = bench::countFor(fp, 2 * sizeof(AABB));
+		boxes = randomBoxes(n, 5);
+		o.resize(n);
+
+		std::vector<Quaternion> rotations = bench::randomArray<Quaternion>(n, 6);
+		std::vector<OOBB> oriented(n);
+		std::vector<float> d(n);
+		for(uint32_t i = 0; i < n; ++i)
+			oriented[i] = oobb::create(quaternion::toMat4x4(aabb::center(boxes[i]), quaternion::normalized(rotations[i]), vector3::create(1, 1, 1)),
+									   aabb::fromCenter(vector3::create(0, 0, 0), aabb::halfSize(boxes[i])));
+
+		Matrix4x4 m = quaternion::toMat4x4(vector3::create(1, 2, 3), quaternion::normalized(rotations[0]), vector3::create(2, 2, 2));
+
+		BENCH_SINGLE("aabb", "merge", 72, o[i] = aabb::merge(boxes[i], boxes[n - 1 - i]));
+		BENCH_SINGLE("aabb", "transform", 112, o[i] = aabb::transform(m, boxes[i]));
+		BENCH_SINGLE("oobb", "toAABB", 112, o[i] = oobb::toAABB(oriented[i]));
+		BENCH_SINGLE("oobb", "overlapAABB", 116, d[i] = oobb::overlap(oriented[i], query) ? 1.0f : 0.0f);
+		BENCH_SINGLE("oobb", "overlap", 180, d[i] = oobb::overlap(oriented[i], oriented[n - 1 - i]) ? 1.0f : 0.0f);
+	}
+}
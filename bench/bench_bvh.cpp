@@ -0,0 +1,94 @@
+#include "bench.h"
+#include "bvh.h"
+#include "intersection.h"
+#include "vector3_stream.h"
+
+using namespace alfar;
+
+// The ray benchmarks shoot RAYS rays at a scene of spheres filling the
+// footprint; one op is one ray. The naive reference is the brute force
+// intersection::nearestSphere over the whole scene.
+
+namespace
+{
+	const uint32_t RAYS = 256;
+
+	void randomScene(uint32_t p_Count, std::vector<Vector3>& p_Centers, std::vector<float>& p_Radii, std::vector<AABB>& p_Boxes)
+	{
+		//about 1000 spheres per 100^3 units whatever the count, so rays hit something at every size
+		float size = 100.0f * cbrtf(p_Count / 1000.0f);
+		uint32_t seed = 11;
+
+		p_Centers.resize(p_Count);
+		p_Radii.resize(p_Count);
+		p_Boxes.resize(p_Count);
+
+		for(uint32_t i = 0; i < p_Count; ++i)
+		{
+			p_Centers[i] = vector3::create(bench::random(seed, -size, size), bench::random(seed, -size, size), bench::random(seed, -size, size));
+			p_Radii[i] = bench::random(seed, 0.5f, 2.0f);
+			p_Boxes[i] = aabb::fromCenter(p_Centers[i], vector3::create(p_Radii[i], p_Radii[i], p_Radii[i]));
+		}
+	}
+}
+
+//=============================================================================
+
+void bench::bvhBenchmarks(bench::Suite& p_Suite)
+{
+	std::vector<Vector3> centers;
+	std::vector<float> radii;
+	std::vector<AABB> boxes;
+
+	for(size_t f = 0; f < p_Suite.options.footprints.size(); ++f)
+	{
+		const bench::Footprint& fp = p_Suite.options.footprints[f];
+
+		uint32_t n = bench::countFor(fp, 4 * sizeof(float));
+		randomScene(n, centers, radii, boxes);
+
+		Vector3Stream centerStream = vector3stream::create(n);
+		vector3stream::fromArray(centers.data(), n, centerStream);
+		BVH tree = bvh::build(parallel::policy(), boxes.data(), n);
+
+		std::vector<Vector3> origins = bench::randomArray<Vector3>(RAYS, 1, -10.0f, 10.0f);
+		std::vector<Vector3> dirs = bench::randomArray<Vector3>(RAYS, 2);
+		std::vector<RayHit> hits(RAYS);
+
+		bench::compare(p_Suite, "bvh", "raycastSpheres", fp, RAYS, 0,
+			[&](uint32_t c) { for(uint32_t i = 0; i < c; ++i) hits[i] = intersection::nearestSphere(origins[i], dirs[i], centerStream, radii.data()); },
+			[&](uint32_t c)
+			{
+				for(uint32_t i = 0; i < c; ++i)
+				{
+					const Vector3& o = origins[i];
+					const Vector3& d = dirs[i];
+					hits[i] = bvh::raycast(tree, o, d, [&](uint32_t p_Index) { return vector3::raySphereIntersection(centers[p_Index], radii[p_Index], o, d); });
+				}
+			});
+
+		bvh::destroy(tree);
+		vector3stream::destroy(centerStream);
+	}
+
+	//----- build and refit, one op is one primitive
+
+	uint32_t n = bench::countFor(p_Suite.options.footprints.back(), 4 * sizeof(float));
+	randomScene(n, centers, radii, boxes);
+
+	BVH tree = bvh::build(boxes.data(), n);
+	std::vector<uint32_t> found(n);
+
+	bench::single(p_Suite, "bvh", "build", n, sizeof(AABB), [&](uint32_t c) { BVH b = bvh::build(boxes.data(), c); bvh::destroy(b); });
+	bench::single(p_Suite, "bvh", "buildParallel", n, sizeof(AABB), [&](uint32_t c) { BVH b = bvh::build(parallel::policy(), boxes.data(), c); bvh::destroy(b); });
+	bench::single(p_Suite, "bvh", "refit", n, sizeof(AABB) + sizeof(BVHNode), [&](uint32_t) { bvh::refit(tree, boxes.data()); });
+
+	//one op is one query
+	bench::single(p_Suite, "bvh", "overlapSphere", RAYS, 0, [&](uint32_t c)
+	{
+		for(uint32_t i = 0; i < c; ++i)
+			found[0] = bvh::overlap(tree, boxes.data(), centers[i], 5.0f, found.data() + 1, n - 1);
+	});
+
+	bvh::destroy(tree);
+}
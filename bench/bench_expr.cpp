@@ -0,0 +1,44 @@
+#include "bench.h"
+#include "expr.h"
+#include "vector3.h"
+#include "vector4.h"
+
+using namespace alfar;
+
+// Fused expressions against the same computation as a chain of array calls
+// through a temporary array ("...Chained", the library before expr.h). The
+// naive reference is the single element functions in one loop, which is
+// fused too but not vectorized.
+
+//=============================================================================
+
+void bench::exprBenchmarks(bench::Suite& p_Suite)
+{
+	for(size_t f = 0; f < p_Suite.options.footprints.size(); ++f)
+	{
+		const bench::Footprint& fp = p_Suite.options.footprints[f];
+		uint32_t n = bench::countFor(fp, 3 * sizeof(Vector3) + sizeof(float));
+
+		std::vector<Vector3> a = bench::randomArray<Vector3>(n, 1), b = bench::randomArray<Vector3>(n, 2), o(n), t(n);
+		std::vector<float> s = bench::randomArray<float>(n, 3);
+
+		//out = normalize(a + b * s)
+		BENCH_ARRAY("expr", "normalizeMulAddChained", 40, o[i] = vector3::normalize(vector3::add(a[i], vector3::mul(b[i], s[i]))),
+			vector3::mul(b.data(), s.data(), t.data(), c); vector3::add(a.data(), t.data(), t.data(), c); vector3::normalize(t.data(), o.data(), c));
+		BENCH_ARRAY("expr", "normalizeMulAdd", 40, o[i] = vector3::normalize(vector3::add(a[i], vector3::mul(b[i], s[i]))),
+			expr::assign(o.data(), expr::normalize(expr::ref(a.data()) + expr::ref(b.data()) * expr::ref(s.data())), c));
+
+		//explicit Euler step in place, one time step per element: x += v * dt
+		BENCH_ARRAY("expr", "integrateChained", 40, a[i] = vector3::add(a[i], vector3::mul(b[i], s[i])),
+			vector3::mul(b.data(), s.data(), t.data(), c); vector3::add(a.data(), t.data(), a.data(), c));
+		BENCH_ARRAY("expr", "integrate", 40, a[i] = vector3::add(a[i], vector3::mul(b[i], s[i])),
+			expr::assign(a.data(), expr::ref(a.data()) + expr::ref(b.data()) * expr::ref(s.data()), c));
+
+		//float results: d = dot(cross(a, b), a) * s
+		std::vector<float> d(n);
+		BENCH_ARRAY("expr", "dotCrossChained", 32, d[i] = vector3::dot(vector3::cross(a[i], b[i]), a[i]) * s[i],
+			vector3::cross(a.data(), b.data(), t.data(), c); vector3::dot(t.data(), a.data(), d.data(), c); lanes::binary<lanes::OP_SCALE>(d.data(), s.data(), d.data(), c));
+		BENCH_ARRAY("expr", "dotCross", 32, d[i] = vector3::dot(vector3::cross(a[i], b[i]), a[i]) * s[i],
+			expr::assign(d.data(), expr::dot(expr::cross(expr::ref(a.data()), expr::ref(b.data())), expr::ref(a.data())) * expr::ref(s.data()), c));
+	}
+}
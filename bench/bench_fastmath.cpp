@@ -0,0 +1,41 @@
+#include "bench.h"
+#include "fastmath.h"
+#include <math.h>
+
+using namespace alfar;
+
+// The naive references are the libm functions, PRECISION_EXACT.
+
+//=============================================================================
+
+void bench::fastmathBenchmarks(bench::Suite& p_Suite)
+{
+	for(size_t f = 0; f < p_Suite.options.footprints.size(); ++f)
+	{
+		const bench::Footprint& fp = p_Suite.options.footprints[f];
+		uint32_t n = bench::countFor(fp, 3 * sizeof(float));
+
+		std::vector<float> a = bench::randomArray<float>(n, 1, -10.0f, 10.0f), b = bench::randomArray<float>(n, 2, -10.0f, 10.0f);
+		std::vector<float> unit = bench::randomArray<float>(n, 3, -1.0f, 1.0f), positive = bench::randomArray<float>(n, 4, 1e-3f, 1e3f);
+		std::vector<float> s(n), o(n);
+
+		BENCH_ARRAY("fastmath", "sincos", 12, (s[i] = sinf(a[i]), o[i] = cosf(a[i])), fastmath::sincos(a.data(), s.data(), o.data(), c));
+		BENCH_ARRAY("fastmath", "sincosApproximate", 12, (s[i] = sinf(a[i]), o[i] = cosf(a[i])), fastmath::sincos<PRECISION_APPROXIMATE>(a.data(), s.data(), o.data(), c));
+		BENCH_ARRAY("fastmath", "sin", 8, o[i] = sinf(a[i]), fastmath::sin(a.data(), o.data(), c));
+		BENCH_ARRAY("fastmath", "atan2", 12, o[i] = atan2f(a[i], b[i]), fastmath::atan2(a.data(), b.data(), o.data(), c));
+		BENCH_ARRAY("fastmath", "atan2Approximate", 12, o[i] = atan2f(a[i], b[i]), fastmath::atan2<PRECISION_APPROXIMATE>(a.data(), b.data(), o.data(), c));
+		BENCH_ARRAY("fastmath", "acos", 8, o[i] = acosf(unit[i]), fastmath::acos(unit.data(), o.data(), c));
+		BENCH_ARRAY("fastmath", "exp", 8, o[i] = expf(a[i]), fastmath::exp(a.data(), o.data(), c));
+		BENCH_ARRAY("fastmath", "log", 8, o[i] = logf(positive[i]), fastmath::log(positive.data(), o.data(), c));
+		BENCH_ARRAY("fastmath", "logApproximate", 8, o[i] = logf(positive[i]), fastmath::log<PRECISION_APPROXIMATE>(positive.data(), o.data(), c));
+
+		if(f != 0)
+			continue;
+
+		BENCH_SINGLE("fastmath", "sincos", 12, fastmath::sincos(a[i], s[i], o[i]));
+		BENCH_SINGLE("fastmath", "atan2", 12, o[i] = fastmath::atan2(a[i], b[i]));
+		BENCH_SINGLE("fastmath", "acos", 8, o[i] = fastmath::acos(unit[i]));
+		BENCH_SINGLE("fastmath", "exp", 8, o[i] = fastmath::exp(a[i]));
+		BENCH_SINGLE("fastmath", "log", 8, o[i] = fastmath::log(positive[i]));
+	}
+}
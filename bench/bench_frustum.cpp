@@ -0,0 +1,92 @@
+#include "bench.h"
+#include "frustum.h"
+#include "frustum_parallel.h"
+#include "mat4x4.h"
+#include "vector3_stream.h"
+
+using namespace alfar;
+
+// BENCH_ARRAY with a naive loop that counts its visible elements in count
+// and stores that count, as the library cull returns it.
+#define BENCH_CULL(NAME, BYTES, NAIVE, LIB) \
+	bench::compare(p_Suite, "frustum", NAME, fp, n, BYTES, \
+		[&](uint32_t c) { uint32_t count = 0; for(uint32_t i = 0; i < c; ++i) { NAIVE; } visible[0] = count; }, \
+		[&](uint32_t c) { LIB; })
+
+namespace
+{
+	//the usual per box loop: the most inside corner against each plane, early out
+	bool naiveVisible(const Frustum& p_Frustum, const AABB& p_Box)
+	{
+		for(int p = 0; p < 6; ++p)
+		{
+			const Plane& plane = p_Frustum.planes[p];
+			Vector3 corner = vector3::create(plane.normal.x >= 0 ? p_Box.max.x : p_Box.min.x,
+											 plane.normal.y >= 0 ? p_Box.max.y : p_Box.min.y,
+											 plane.normal.z >= 0 ? p_Box.max.z : p_Box.min.z);
+
+			if(frustum::distance(plane, corner) < 0)
+				return false;
+		}
+
+		return true;
+	}
+
+	bool naiveVisible(const Frustum& p_Frustum, const Vector3& p_Center, float p_Radius)
+	{
+		for(int p = 0; p < 6; ++p)
+		{
+			if(frustum::distance(p_Frustum.planes[p], p_Center) < -p_Radius)
+				return false;
+		}
+
+		return true;
+	}
+}
+
+//=============================================================================
+
+void bench::frustumBenchmarks(bench::Suite& p_Suite)
+{
+	//a camera in the middle of the scene looking down +z, about 1 element in 8 kept
+	Matrix4x4 viewProj = mat4x4::mul(mat4x4::persp(1.2f, 16.0f / 9.0f, 0.1f, 100.0f),
+									 mat4x4::lookAt(vector3::create(0, 0, 0), vector3::create(0, 0, 1), vector3::create(0, 1, 0)));
+	Frustum view = frustum::fromMatrix(viewProj);
+
+	for(size_t f = 0; f < p_Suite.options.footprints.size(); ++f)
+	{
+		const bench::Footprint& fp = p_Suite.options.footprints[f];
+
+		//----- boxes
+
+		uint32_t n = bench::countFor(fp, sizeof(AABB) + sizeof(uint32_t));
+
+		std::vector<Vector3> centers = bench::randomArray<Vector3>(n, 1, -100.0f, 100.0f);
+		std::vector<Vector3> halfSizes = bench::randomArray<Vector3>(n, 2, 0.1f, 2.0f);
+		std::vector<AABB> boxes(n);
+		std::vector<uint32_t> visible(n);
+		for(uint32_t i = 0; i < n; ++i)
+			boxes[i] = aabb::fromCenter(centers[i], halfSizes[i]);
+
+		BENCH_CULL("cullBoxes", 28, if(naiveVisible(view, boxes[i])) visible[count++] = i, frustum::cull(view, boxes.data(), c, visible.data()));
+		BENCH_CULL("cullBoxesParallel", 28, if(naiveVisible(view, boxes[i])) visible[count++] = i, frustum::cull(parallel::policy(), view, boxes.data(), c, visible.data()));
+
+		//----- spheres
+
+		n = bench::countFor(fp, 4 * sizeof(float) + sizeof(uint32_t));
+
+		centers = bench::randomArray<Vector3>(n, 3, -100.0f, 100.0f);
+		std::vector<float> radii = bench::randomArray<float>(n, 4, 0.1f, 3.0f);
+		visible.resize(n);
+
+		Vector3Stream centerStream = vector3stream::create(n);
+		vector3stream::fromArray(centers.data(), n, centerStream);
+
+		BENCH_CULL("cullSpheres", 20, if(naiveVisible(view, centers[i], radii[i])) visible[count++] = i,
+			centerStream.count = c; frustum::cull(view, centerStream, radii.data(), visible.data()));
+		BENCH_CULL("cullSpheresParallel", 20, if(naiveVisible(view, centers[i], radii[i])) visible[count++] = i,
+			centerStream.count = c; frustum::cull(parallel::policy(), view, centerStream, radii.data(), visible.data()));
+
+		vector3stream::destroy(centerStream);
+	}
+}
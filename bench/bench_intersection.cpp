@@ -0,0 +1,89 @@
+#include "bench.h"
+#include "intersection.h"
+#include "vector3.h"
+#include "vector3_stream.h"
+
+using namespace alfar;
+
+// One op is one ray against one primitive, so Mop/s is the number of
+// ray * primitive tests per microsecond.
+
+namespace
+{
+	//a scene in front of the rays, about 1 sphere in 10 hit by a ray going down +z
+	void randomSpheres(uint32_t p_Count, std::vector<Vector3>& p_Centers, std::vector<float>& p_Radii)
+	{
+		uint32_t seed = 7;
+		p_Centers.resize(p_Count);
+		p_Radii.resize(p_Count);
+
+		for(uint32_t i = 0; i < p_Count; ++i)
+		{
+			p_Centers[i] = vector3::create(bench::random(seed, -10.0f, 10.0f), bench::random(seed, -10.0f, 10.0f), bench::random(seed, 5.0f, 50.0f));
+			p_Radii[i] = bench::random(seed, 0.5f, 3.0f);
+		}
+	}
+
+	Vector3Stream toStream(const std::vector<Vector3>& p_Array)
+	{
+		Vector3Stream ret = vector3stream::create((uint32_t)p_Array.size());
+		vector3stream::fromArray(p_Array.data(), (uint32_t)p_Array.size(), ret);
+
+		return ret;
+	}
+}
+
+//=============================================================================
+
+void bench::intersectionBenchmarks(bench::Suite& p_Suite)
+{
+	for(size_t f = 0; f < p_Suite.options.footprints.size(); ++f)
+	{
+		const bench::Footprint& fp = p_Suite.options.footprints[f];
+
+		//----- one ray against n spheres
+
+		uint32_t n = bench::countFor(fp, 5 * sizeof(float));
+
+		std::vector<Vector3> centers;
+		std::vector<float> radii, d(n);
+		randomSpheres(n, centers, radii);
+		Vector3Stream centerStream = toStream(centers);
+
+		Vector3 o = vector3::create(0.5f, -0.25f, 0.0f);
+		Vector3 dir = vector3::create(0.05f, 0.02f, 1.0f);
+		RayHit hit = { -1.0f, -1 };
+
+		BENCH_ARRAY("intersection", "raySpheres", 20, d[i] = vector3::raySphereIntersection(centers[i], radii[i], o, dir),
+			centerStream.count = c; intersection::raySpheres(o, dir, centerStream, radii.data(), d.data()));
+
+		BENCH_ARRAY("intersection", "nearestSphere", 16,
+			float t = vector3::raySphereIntersection(centers[i], radii[i], o, dir);
+			if(t >= 0 && (hit.index < 0 || t < hit.distance)) { hit.distance = t; hit.index = (int32_t)i; },
+			centerStream.count = c; hit = intersection::nearestSphere(o, dir, centerStream, radii.data()));
+
+		vector3stream::destroy(centerStream);
+
+		//----- n rays against one primitive
+
+		n = bench::countFor(fp, 7 * sizeof(float));
+
+		std::vector<Vector3> origins = bench::randomArray<Vector3>(n, 1, -5.0f, 5.0f);
+		std::vector<Vector3> dirs = bench::randomArray<Vector3>(n, 2, -0.3f, 0.3f);
+		for(uint32_t i = 0; i < n; ++i)
+			dirs[i].z = 1.0f;
+		d.resize(n);
+
+		Vector3Stream originStream = toStream(origins), dirStream = toStream(dirs);
+		Vector3 center = vector3::create(0.0f, 0.0f, 20.0f);
+		Vector3 planeOrigin = vector3::create(0.0f, 0.0f, 10.0f), planeNormal = vector3::normalize(vector3::create(0.1f, 0.2f, -1.0f));
+
+		BENCH_ARRAY("intersection", "raysSphere", 28, d[i] = vector3::raySphereIntersection(center, 4.0f, origins[i], dirs[i]),
+			originStream.count = dirStream.count = c; intersection::raysSphere(center, 4.0f, originStream, dirStream, d.data()));
+		BENCH_ARRAY("intersection", "raysPlane", 28, d[i] = vector3::linePlaneIntersection(planeOrigin, planeNormal, origins[i], dirs[i]),
+			originStream.count = dirStream.count = c; intersection::raysPlane(planeOrigin, planeNormal, originStream, dirStream, d.data()));
+
+		vector3stream::destroy(originStream);
+		vector3stream::destroy(dirStream);
+	}
+}
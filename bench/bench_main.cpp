@@ -0,0 +1,123 @@
+#include "bench.h"
+#include <stdlib.h>
+#include <string.h>
+
+// usage: alfar_bench [--filter <group/name substring>] [--json <file>] [--quick]
+//                    [--min-time <seconds>] [--samples <n>]
+
+namespace
+{
+	void writeJson(const bench::Suite& p_Suite, FILE* p_File)
+	{
+		fprintf(p_File, "{\n");
+		fprintf(p_File, "  \"cpu_level\": \"%s\",\n", alfar::cpu::levelName(alfar::cpu::level()));
+		fprintf(p_File, "  \"min_time\": %g,\n", p_Suite.options.minTime);
+		fprintf(p_File, "  \"samples\": %u,\n", p_Suite.options.samples);
+		fprintf(p_File, "  \"results\": [\n");
+
+		for(size_t i = 0; i < p_Suite.results.size(); ++i)
+		{
+			const bench::Result& r = p_Suite.results[i];
+
+			fprintf(p_File, "    {\"group\": \"%s\", \"name\": \"%s\", \"variant\": \"%s\", \"footprint\": \"%s\", \"count\": %u, "
+							"\"ns_per_op\": %.4f, \"mops_per_s\": %.4f, \"gb_per_s\": %.4f",
+					r.group.c_str(), r.name.c_str(), r.variant.c_str(), r.footprint.c_str(), r.count, r.nsPerOp, r.mopsPerS, r.gbPerS);
+
+			if(r.speedup > 0)
+				fprintf(p_File, ", \"speedup\": %.3f", r.speedup);
+
+			fprintf(p_File, "}%s\n", i + 1 < p_Suite.results.size() ? "," : "");
+		}
+
+		fprintf(p_File, "  ]\n}\n");
+	}
+}
+
+//=============================================================================
+
+int main(int argc, char** argv)
+{
+	bench::Suite suite;
+	suite.options.minTime = 0.02;
+	suite.options.samples = 5;
+
+	const char* jsonPath = NULL;
+	bool quick = false;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		if(strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+			suite.options.filter = argv[++i];
+		else if(strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+			jsonPath = argv[++i];
+		else if(strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+			suite.options.minTime = atof(argv[++i]);
+		else if(strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+			suite.options.samples = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "--quick") == 0)
+			quick = true;
+		else
+		{
+			fprintf(stderr, "usage: %s [--filter <group/name>] [--json <file>] [--quick] [--min-time <s>] [--samples <n>]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	//working sets from L1 resident to well past the last level cache
+	bench::Footprint l1 = { "L1", 16 * 1024 };
+	bench::Footprint l2 = { "L2", 256 * 1024 };
+	bench::Footprint l3 = { "L3", 4 * 1024 * 1024 };
+	bench::Footprint dram = { "DRAM", 128 * 1024 * 1024 };
+
+	suite.options.footprints.push_back(l1);
+	suite.options.footprints.push_back(l2);
+
+	if(quick)
+	{
+		suite.options.minTime = 0.002;
+		suite.options.samples = 2;
+	}
+	else
+	{
+		suite.options.footprints.push_back(l3);
+		suite.options.footprints.push_back(dram);
+	}
+
+	if(suite.options.samples == 0)
+		suite.options.samples = 1;
+
+	printf("cpu level: %s\n", alfar::cpu::levelName(alfar::cpu::level()));
+
+	bench::vectorBenchmarks(suite);
+	bench::quaternionBenchmarks(suite);
+	bench::mat4x4Benchmarks(suite);
+	bench::mat3x3Benchmarks(suite);
+	bench::affine3x4Benchmarks(suite);
+	bench::intersectionBenchmarks(suite);
+	bench::boundsBenchmarks(suite);
+	bench::frustumBenchmarks(suite);
+	bench::bvhBenchmarks(suite);
+	bench::fastmathBenchmarks(suite);
+	bench::exprBenchmarks(suite);
+	bench::parallelBenchmarks(suite);
+	bench::rasterBenchmarks(suite);
+	bench::spriteBenchmarks(suite);
+	bench::arenaBenchmarks(suite);
+	bench::quantizeBenchmarks(suite);
+	bench::rebaseBenchmarks(suite);
+
+	if(jsonPath != NULL)
+	{
+		FILE* file = fopen(jsonPath, "w");
+		if(file == NULL)
+		{
+			fprintf(stderr, "cannot write %s\n", jsonPath);
+			return 1;
+		}
+
+		writeJson(suite, file);
+		fclose(file);
+	}
+
+	return 0;
+}
@@ -0,0 +1,79 @@
+#include "bench.h"
+#include "mat3x3.h"
+#include "mat4x4.h"
+
+using namespace alfar;
+
+namespace
+{
+	//well conditioned matrices: a perturbed, non uniformly scaled identity basis
+	std::vector<Matrix3x3> randomLinear(uint32_t p_Count, uint32_t p_Seed)
+	{
+		std::vector<Matrix3x3> ret(p_Count);
+
+		for(uint32_t i = 0; i < p_Count; ++i)
+		{
+			float* f = &ret[i].x.x;
+			for(int k = 0; k < 9; ++k)
+				f[k] = (k % 4 == 0 ? 1.0f + k * 0.25f : 0.0f) + bench::random(p_Seed, -0.5f, 0.5f);
+		}
+
+		return ret;
+	}
+}
+
+//=============================================================================
+
+void bench::mat3x3Benchmarks(bench::Suite& p_Suite)
+{
+	//----- vector transforms
+
+	for(size_t f = 0; f < p_Suite.options.footprints.size(); ++f)
+	{
+		const bench::Footprint& fp = p_Suite.options.footprints[f];
+		uint32_t n = bench::countFor(fp, 2 * sizeof(Vector3));
+
+		Matrix3x3 m = randomLinear(1, 1)[0];
+		Matrix3x3 normal = mat3x3::normalMatrix(m);
+		Matrix4x4 m4 = mat3x3::toMat4x4(m);
+		std::vector<Vector3> a = bench::randomArray<Vector3>(n, 2), o(n);
+
+		BENCH_ARRAY("mat3x3", "transform", 24, o[i] = vector3::mul(m, a[i]), mat3x3::transform(m, a.data(), o.data(), c));
+		BENCH_ARRAY("mat3x3", "transformNormals", 24, o[i] = vector3::normalize(vector3::mul(normal, a[i])), mat3x3::transformNormals(normal, a.data(), o.data(), c));
+
+		//the Matrix4x4 path this replaces, same naive loop
+		BENCH_ARRAY("mat3x3", "transformDirections4x4", 24, o[i] = vector3::mul(m, a[i]), mat4x4::transformDirections(m4, a.data(), o.data(), c));
+	}
+
+	//----- matrix arrays
+
+	for(size_t f = 0; f < p_Suite.options.footprints.size(); ++f)
+	{
+		const bench::Footprint& fp = p_Suite.options.footprints[f];
+		uint32_t n = bench::countFor(fp, 3 * sizeof(Matrix3x3));
+
+		std::vector<Matrix3x3> a = randomLinear(n, 1), b = randomLinear(n, 2), o(n);
+
+		BENCH_ARRAY("mat3x3", "mul", 108, o[i] = mat3x3::mul(a[i], b[i]), mat3x3::mul(a.data(), b.data(), o.data(), c));
+		BENCH_ARRAY("mat3x3", "inverse", 72, o[i] = mat3x3::inverse(a[i]), mat3x3::inverse(a.data(), o.data(), c));
+		BENCH_ARRAY("mat3x3", "normalMatrix", 72, o[i] = mat3x3::normalMatrix(a[i]), mat3x3::normalMatrix(a.data(), o.data(), c));
+
+		if(f != 0)
+			continue;
+
+		std::vector<Quaternion> q = bench::randomArray<Quaternion>(n, 3);
+		std::vector<Matrix4x4> a4(n);
+		std::vector<float> d(n);
+		for(uint32_t i = 0; i < n; ++i)
+		{
+			q[i] = quaternion::normalized(q[i]);
+			a4[i] = mat3x3::toMat4x4(a[i]);
+		}
+
+		BENCH_SINGLE("mat3x3", "transpose", 72, o[i] = mat3x3::transpose(a[i]));
+		BENCH_SINGLE("mat3x3", "determinant", 40, d[i] = mat3x3::determinant(a[i]));
+		BENCH_SINGLE("mat3x3", "fromQuaternion", 52, o[i] = mat3x3::fromQuaternion(q[i]));
+		BENCH_SINGLE("mat3x3", "fromMat4x4", 100, o[i] = mat3x3::fromMat4x4(a4[i]));
+		BENCH_SINGLE("mat3x3", "normalMatrix4x4", 100, o[i] = mat3x3::normalMatrix(a4[i]));
+	}
+}
@@ -0,0 +1,101 @@
+#include "bench.h"
+#include "mat4x4.h"
+#include "mat4x4_parallel.h"
+
+using namespace alfar;
+
+namespace
+{
+	//affine, well conditioned matrices: a perturbed identity basis and a translation
+	std::vector<Matrix4x4> randomAffine(uint32_t p_Count, uint32_t p_Seed)
+	{
+		std::vector<Matrix4x4> ret(p_Count);
+
+		for(uint32_t i = 0; i < p_Count; ++i)
+		{
+			float* f = &ret[i].x.x;
+			for(int k = 0; k < 12; ++k)
+				f[k] = (k % 5 == 0 ? 2.0f : 0.0f) + bench::random(p_Seed, -0.5f, 0.5f);
+
+			ret[i].x.w *= 10.0f;
+			ret[i].y.w *= 10.0f;
+			ret[i].z.w *= 10.0f;
+			ret[i].t = vector4::create(0, 0, 0, 1);
+		}
+
+		return ret;
+	}
+
+	//a forest of 4-ary trees of 64 nodes, parents before children
+	std::vector<int32_t> forest(uint32_t p_Count)
+	{
+		std::vector<int32_t> ret(p_Count);
+
+		for(uint32_t i = 0; i < p_Count; ++i)
+		{
+			uint32_t local = i % 64;
+			ret[i] = local == 0 ? -1 : (int32_t)(i - local + (local - 1) / 4);
+		}
+
+		return ret;
+	}
+}
+
+//=============================================================================
+
+void bench::mat4x4Benchmarks(bench::Suite& p_Suite)
+{
+	//----- vector transforms
+
+	for(size_t f = 0; f < p_Suite.options.footprints.size(); ++f)
+	{
+		const bench::Footprint& fp = p_Suite.options.footprints[f];
+		uint32_t n = bench::countFor(fp, 2 * sizeof(Vector4));
+
+		Matrix4x4 m = randomAffine(1, 1)[0];
+		Matrix4x4 proj = mat4x4::persp(1.0f, 1.5f, 0.1f, 100.0f);
+		std::vector<Vector3> a = bench::randomArray<Vector3>(n, 2), o(n);
+		std::vector<Vector4> a4 = bench::randomArray<Vector4>(n, 3), o4(n);
+
+		BENCH_ARRAY("mat4x4", "transformPoints", 24, o[i] = vector4::toVec3(vector4::mul(m, vector4::create(a[i], 1))), mat4x4::transformPoints(m, a.data(), o.data(), c));
+		BENCH_ARRAY("mat4x4", "transformDirections", 24, o[i] = vector4::toVec3(vector4::mul(m, vector4::create(a[i], 0))), mat4x4::transformDirections(m, a.data(), o.data(), c));
+		BENCH_ARRAY("mat4x4", "transformPointsProjective", 24, o[i] = vector3::mul(proj, a[i]), mat4x4::transformPointsProjective(proj, a.data(), o.data(), c));
+		BENCH_ARRAY("mat4x4", "transform", 32, o4[i] = vector4::mul(m, a4[i]), mat4x4::transform(m, a4.data(), o4.data(), c));
+	}
+
+	//----- matrix arrays
+
+	for(size_t f = 0; f < p_Suite.options.footprints.size(); ++f)
+	{
+		const bench::Footprint& fp = p_Suite.options.footprints[f];
+		uint32_t n = bench::countFor(fp, 3 * sizeof(Matrix4x4));
+
+		std::vector<Matrix4x4> a = randomAffine(n, 1), b = randomAffine(n, 2), o(n);
+		std::vector<int32_t> parents = forest(n);
+		std::vector<float> d(n);
+
+		BENCH_ARRAY("mat4x4", "mul", 192, o[i] = mat4x4::mul(a[i], b[i]), mat4x4::mul(a.data(), b.data(), o.data(), c));
+		BENCH_ARRAY("mat4x4", "inverse", 128, o[i] = mat4x4::inverse(a[i]), mat4x4::inverse(a.data(), o.data(), c));
+		BENCH_ARRAY("mat4x4", "affineInverse", 128, o[i] = mat4x4::affineInverse(a[i]), mat4x4::affineInverse(a.data(), o.data(), c));
+		BENCH_ARRAY("mat4x4", "rigidInverse", 128, o[i] = mat4x4::rigidInverse(a[i]), mat4x4::rigidInverse(a.data(), o.data(), c));
+		BENCH_ARRAY("mat4x4", "determinant", 68, d[i] = mat4x4::determinant(a[i]), mat4x4::determinant(a.data(), d.data(), c));
+		BENCH_ARRAY("mat4x4", "propagate", 132, o[i] = parents[i] < 0 ? a[i] : mat4x4::mul(o[parents[i]], a[i]), mat4x4::propagate(a.data(), parents.data(), o.data(), c));
+		BENCH_ARRAY("mat4x4", "propagateParallel", 132, o[i] = parents[i] < 0 ? a[i] : mat4x4::mul(o[parents[i]], a[i]), mat4x4::propagate(parallel::policy(), a.data(), parents.data(), o.data(), c));
+
+		if(f != 0)
+			continue;
+
+		std::vector<Vector3> v = bench::randomArray<Vector3>(n, 3, 1.0f, 2.0f);
+		std::vector<float> s = bench::randomArray<float>(n, 4, 0.5f, 1.5f);
+
+		BENCH_SINGLE("mat4x4", "create", 128, o[i] = mat4x4::create(a[i].x, a[i].y, a[i].z, b[i].t));
+		BENCH_SINGLE("mat4x4", "identity", 64, o[i] = mat4x4::identity());
+		BENCH_SINGLE("mat4x4", "translation", 76, o[i] = mat4x4::translation(v[i]));
+		BENCH_SINGLE("mat4x4", "setBase", 164, o[i] = mat4x4::setBase(a[i], v[i], v[n - 1 - i], v[i]));
+		BENCH_SINGLE("mat4x4", "ortho", 68, o[i] = mat4x4::ortho(s[i], -s[i], s[i], -s[i], 100.0f, 0.1f));
+		BENCH_SINGLE("mat4x4", "persp", 68, o[i] = mat4x4::persp(s[i], 1.5f, 0.1f, 100.0f));
+		BENCH_SINGLE("mat4x4", "perspConst", 68, o[i] = mat4x4::perspConst(s[i], 1.5f, 0.1f, 100.0f));
+		BENCH_SINGLE("mat4x4", "lookAt", 88, o[i] = mat4x4::lookAt(v[i], v[n - 1 - i], vector3::create(0, 1, 0)));
+		BENCH_SINGLE("mat4x4", "isAffine", 64, d[i] = mat4x4::isAffine(a[i]) ? 1.0f : 0.0f);
+	}
+}
@@ -0,0 +1,96 @@
+#include "bench.h"
+#include "vector2_parallel.h"
+#include "vector3_parallel.h"
+#include "vector4_parallel.h"
+#include <thread>
+
+using namespace alfar;
+
+// Scaling of the parallel array functions on COUNT elements (far past the
+// last level cache, so the big ones end up bandwidth bound): the same call on
+// pools of 1, 2, 4... up to the hardware thread count. The variant column is
+// the thread count and the speedup is over the single thread pool.
+
+namespace
+{
+	const uint32_t COUNT = 10 * 1000 * 1000;
+
+	std::vector<uint32_t> threadCounts()
+	{
+		uint32_t hardware = std::thread::hardware_concurrency();
+		hardware = hardware == 0 ? 1 : hardware;
+
+		std::vector<uint32_t> ret;
+		for(uint32_t t = 1; t < hardware; t *= 2)
+			ret.push_back(t);
+		ret.push_back(hardware);
+
+		return ret;
+	}
+
+	template<typename F>
+	void scaling(bench::Suite& p_Suite, const char* p_Name, double p_BytesPerOp, F p_Fn)
+	{
+		if(!bench::selected(p_Suite, "parallel", p_Name))
+			return;
+
+		bench::Footprint fp = { "10M", (size_t)(COUNT * p_BytesPerOp) };
+		std::vector<uint32_t> counts = threadCounts();
+		double single = 0;
+
+		for(size_t t = 0; t < counts.size(); ++t)
+		{
+			parallel::ThreadPool* pool = parallel::create(counts[t]);
+			parallel::Policy policy = parallel::policy(pool);
+
+			double ns = bench::measure(p_Suite.options, COUNT, [&](uint32_t c) { p_Fn(policy, c); });
+			single = t == 0 ? ns : single;
+
+			char variant[16];
+			snprintf(variant, sizeof(variant), "%ut", counts[t]);
+			bench::report(p_Suite, "parallel", p_Name, variant, fp, COUNT, ns, p_BytesPerOp, t == 0 ? 0 : single);
+
+			parallel::destroy(pool);
+		}
+	}
+}
+
+//=============================================================================
+
+void bench::parallelBenchmarks(bench::Suite& p_Suite)
+{
+	//the arrays take more than a GB, skip them when the filter leaves nothing to run
+	const char* names[] = { "vector3::add", "vector3::mul", "vector3::cross", "vector3::dot", "vector3::normalize", "vector2::add", "vector2::dot", "vector4::add", "vector4::dot" };
+	bool any = false;
+	for(size_t k = 0; k < sizeof(names) / sizeof(names[0]); ++k)
+		any = any || bench::selected(p_Suite, "parallel", names[k]);
+
+	if(!any)
+		return;
+
+	std::vector<Vector3> a3 = bench::randomArray<Vector3>(COUNT, 1);
+	std::vector<Vector3> b3 = bench::randomArray<Vector3>(COUNT, 2);
+	std::vector<Vector3> o3(COUNT);
+	std::vector<float> scalars = bench::randomArray<float>(COUNT, 3);
+	std::vector<float> dots(COUNT);
+
+	scaling(p_Suite, "vector3::add", 36, [&](const parallel::Policy& p, uint32_t c) { vector3::add(p, a3.data(), b3.data(), o3.data(), c); });
+	scaling(p_Suite, "vector3::mul", 28, [&](const parallel::Policy& p, uint32_t c) { vector3::mul(p, a3.data(), scalars.data(), o3.data(), c); });
+	scaling(p_Suite, "vector3::cross", 36, [&](const parallel::Policy& p, uint32_t c) { vector3::cross(p, a3.data(), b3.data(), o3.data(), c); });
+	scaling(p_Suite, "vector3::dot", 28, [&](const parallel::Policy& p, uint32_t c) { vector3::dot(p, a3.data(), b3.data(), dots.data(), c); });
+	scaling(p_Suite, "vector3::normalize", 24, [&](const parallel::Policy& p, uint32_t c) { vector3::normalize(p, a3.data(), o3.data(), c); });
+
+	std::vector<Vector2> a2 = bench::randomArray<Vector2>(COUNT, 4);
+	std::vector<Vector2> b2 = bench::randomArray<Vector2>(COUNT, 5);
+	std::vector<Vector2> o2(COUNT);
+
+	scaling(p_Suite, "vector2::add", 24, [&](const parallel::Policy& p, uint32_t c) { vector2::add(p, a2.data(), b2.data(), o2.data(), c); });
+	scaling(p_Suite, "vector2::dot", 20, [&](const parallel::Policy& p, uint32_t c) { vector2::dot(p, a2.data(), b2.data(), dots.data(), c); });
+
+	std::vector<Vector4> a4 = bench::randomArray<Vector4>(COUNT, 6);
+	std::vector<Vector4> b4 = bench::randomArray<Vector4>(COUNT, 7);
+	std::vector<Vector4> o4(COUNT);
+
+	scaling(p_Suite, "vector4::add", 48, [&](const parallel::Policy& p, uint32_t c) { vector4::add(p, a4.data(), b4.data(), o4.data(), c); });
+	scaling(p_Suite, "vector4::dot", 36, [&](const parallel::Policy& p, uint32_t c) { vector4::dot(p, a4.data(), b4.data(), dots.data(), c); });
+}
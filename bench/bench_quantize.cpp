@@ -0,0 +1,106 @@
+#include "bench.h"
+#include "quantize.h"
+#include "vector3.h"
+#include "vector4.h"
+
+using namespace alfar;
+
+// Encode/decode of the quantize.h storage formats, one op is one element
+// (bytes are the float element plus its compressed form). The naive
+// reference is the single element function in a loop.
+
+namespace
+{
+	std::vector<Vector3> randomNormals(uint32_t p_Count, uint32_t p_Seed)
+	{
+		std::vector<Vector3> ret(p_Count);
+		for(uint32_t i = 0; i < p_Count; ++i)
+			ret[i] = vector3::normalize(vector3::create(bench::random(p_Seed, -1, 1), bench::random(p_Seed, -1, 1), bench::random(p_Seed, -1, 1)));
+
+		return ret;
+	}
+
+	std::vector<Quaternion> randomRotations(uint32_t p_Count, uint32_t p_Seed)
+	{
+		std::vector<Quaternion> ret(p_Count);
+		for(uint32_t i = 0; i < p_Count; ++i)
+		{
+			Vector4 v = vector4::normalize(vector4::create(bench::random(p_Seed, -1, 1), bench::random(p_Seed, -1, 1), bench::random(p_Seed, -1, 1), bench::random(p_Seed, -1, 1)));
+			ret[i].x = v.x; ret[i].y = v.y; ret[i].z = v.z; ret[i].w = v.w;
+		}
+
+		return ret;
+	}
+}
+
+//=============================================================================
+
+void bench::quantizeBenchmarks(bench::Suite& p_Suite)
+{
+	AABB bounds = { vector3::create(-100, -100, -100), vector3::create(100, 100, 100) };
+
+	for(size_t f = 0; f < p_Suite.options.footprints.size(); ++f)
+	{
+		const bench::Footprint& fp = p_Suite.options.footprints[f];
+
+		//----- half
+
+		uint32_t n = bench::countFor(fp, sizeof(Vector4) + sizeof(Vector4Half));
+		std::vector<Vector4> colors = bench::randomArray<Vector4>(n, 1);
+		std::vector<Vector4Half> halves(n);
+		std::vector<Vector4> colorsOut(n);
+		quantize::toHalf(colors.data(), halves.data(), n);
+
+		bench::compare(p_Suite, "quantize", "toHalf", fp, n, sizeof(Vector4) + sizeof(Vector4Half),
+			[&](uint32_t c) { for(uint32_t i = 0; i < c; ++i) halves[i] = quantize::toHalf(colors[i]); },
+			[&](uint32_t c) { quantize::toHalf(colors.data(), halves.data(), c); });
+		bench::compare(p_Suite, "quantize", "fromHalf", fp, n, sizeof(Vector4) + sizeof(Vector4Half),
+			[&](uint32_t c) { for(uint32_t i = 0; i < c; ++i) colorsOut[i] = quantize::fromHalf(halves[i]); },
+			[&](uint32_t c) { quantize::fromHalf(halves.data(), colorsOut.data(), c); });
+
+		//----- normals
+
+		n = bench::countFor(fp, sizeof(Vector3) + sizeof(NormalOct));
+		std::vector<Vector3> normals = randomNormals(n, 2);
+		std::vector<NormalOct> octs(n);
+		std::vector<Vector3> normalsOut(n);
+		quantize::encodeNormal(normals.data(), octs.data(), n);
+
+		bench::compare(p_Suite, "quantize", "encodeNormal", fp, n, sizeof(Vector3) + sizeof(NormalOct),
+			[&](uint32_t c) { for(uint32_t i = 0; i < c; ++i) octs[i] = quantize::encodeNormal(normals[i]); },
+			[&](uint32_t c) { quantize::encodeNormal(normals.data(), octs.data(), c); });
+		bench::compare(p_Suite, "quantize", "decodeNormal", fp, n, sizeof(Vector3) + sizeof(NormalOct),
+			[&](uint32_t c) { for(uint32_t i = 0; i < c; ++i) normalsOut[i] = quantize::decodeNormal(octs[i]); },
+			[&](uint32_t c) { quantize::decodeNormal(octs.data(), normalsOut.data(), c); });
+
+		//----- rotations
+
+		n = bench::countFor(fp, sizeof(Quaternion) + sizeof(QuaternionPacked));
+		std::vector<Quaternion> rotations = randomRotations(n, 3);
+		std::vector<QuaternionPacked> packed(n);
+		std::vector<Quaternion> rotationsOut(n);
+		quantize::encodeRotation(rotations.data(), packed.data(), n);
+
+		bench::compare(p_Suite, "quantize", "encodeRotation", fp, n, sizeof(Quaternion) + sizeof(QuaternionPacked),
+			[&](uint32_t c) { for(uint32_t i = 0; i < c; ++i) packed[i] = quantize::encodeRotation(rotations[i]); },
+			[&](uint32_t c) { quantize::encodeRotation(rotations.data(), packed.data(), c); });
+		bench::compare(p_Suite, "quantize", "decodeRotation", fp, n, sizeof(Quaternion) + sizeof(QuaternionPacked),
+			[&](uint32_t c) { for(uint32_t i = 0; i < c; ++i) rotationsOut[i] = quantize::decodeRotation(packed[i]); },
+			[&](uint32_t c) { quantize::decodeRotation(packed.data(), rotationsOut.data(), c); });
+
+		//----- positions
+
+		n = bench::countFor(fp, sizeof(Vector3) + sizeof(Vector3Quantized));
+		std::vector<Vector3> positions = bench::randomArray<Vector3>(n, 4, -100.0f, 100.0f);
+		std::vector<Vector3Quantized> quantized(n);
+		std::vector<Vector3> positionsOut(n);
+		quantize::encodePosition(positions.data(), quantized.data(), n, bounds);
+
+		bench::compare(p_Suite, "quantize", "encodePosition", fp, n, sizeof(Vector3) + sizeof(Vector3Quantized),
+			[&](uint32_t c) { for(uint32_t i = 0; i < c; ++i) quantized[i] = quantize::encodePosition(positions[i], bounds); },
+			[&](uint32_t c) { quantize::encodePosition(positions.data(), quantized.data(), c, bounds); });
+		bench::compare(p_Suite, "quantize", "decodePosition", fp, n, sizeof(Vector3) + sizeof(Vector3Quantized),
+			[&](uint32_t c) { for(uint32_t i = 0; i < c; ++i) positionsOut[i] = quantize::decodePosition(quantized[i], bounds); },
+			[&](uint32_t c) { quantize::decodePosition(quantized.data(), positionsOut.data(), c, bounds); });
+	}
+}
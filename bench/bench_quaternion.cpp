@@ -0,0 +1,91 @@
+#include "bench.h"
+#include "quaternion.h"
+
+using namespace alfar;
+
+namespace
+{
+	std::vector<Quaternion> randomRotations(uint32_t p_Count, uint32_t p_Seed)
+	{
+		std::vector<Quaternion> ret = bench::randomArray<Quaternion>(p_Count, p_Seed);
+
+		for(uint32_t i = 0; i < p_Count; ++i)
+			ret[i] = quaternion::normalized(ret[i]);
+
+		return ret;
+	}
+}
+
+//=============================================================================
+
+void bench::quaternionBenchmarks(bench::Suite& p_Suite)
+{
+	//----- interpolation, the naive reference is the exact acos/sin slerp
+
+	for(size_t f = 0; f < p_Suite.options.footprints.size(); ++f)
+	{
+		const bench::Footprint& fp = p_Suite.options.footprints[f];
+		uint32_t n = bench::countFor(fp, 3 * sizeof(Quaternion));
+
+		std::vector<Quaternion> a = randomRotations(n, 1), b = randomRotations(n, 2), o(n);
+		std::vector<float> t = bench::randomArray<float>(n, 3, 0.0f, 1.0f);
+
+		BENCH_ARRAY("quaternion", "slerp", 52, o[i] = quaternion::slerp(a[i], b[i], t[i]), quaternion::slerp(a.data(), b.data(), t.data(), o.data(), c));
+		BENCH_ARRAY("quaternion", "slerpSharedT", 48, o[i] = quaternion::slerp(a[i], b[i], 0.3f), quaternion::slerp(a.data(), b.data(), 0.3f, o.data(), c));
+		BENCH_ARRAY("quaternion", "nlerp", 52, o[i] = quaternion::nlerp(a[i], b[i], t[i]), quaternion::nlerp(a.data(), b.data(), t.data(), o.data(), c));
+		BENCH_ARRAY("quaternion", "nlerpSharedT", 48, o[i] = quaternion::nlerp(a[i], b[i], 0.3f), quaternion::nlerp(a.data(), b.data(), 0.3f, o.data(), c));
+		BENCH_ARRAY("quaternion", "normalized", 32, o[i] = quaternion::normalized(b[i]), quaternion::normalized(b.data(), o.data(), c));
+		BENCH_ARRAY("quaternion", "fastNormalized", 32, o[i] = quaternion::normalized(b[i]), quaternion::fastNormalized(b.data(), o.data(), c));
+	}
+
+	//----- rotations and matrices
+
+	for(size_t f = 0; f < p_Suite.options.footprints.size(); ++f)
+	{
+		const bench::Footprint& fp = p_Suite.options.footprints[f];
+		uint32_t n = bench::countFor(fp, sizeof(Quaternion) + sizeof(Matrix4x4));
+
+		std::vector<Quaternion> q = randomRotations(n, 1);
+		std::vector<Vector3> v = bench::randomArray<Vector3>(n, 2), t = bench::randomArray<Vector3>(n, 3), s = bench::randomArray<Vector3>(n, 4, 0.5f, 2.0f), o(n);
+		std::vector<Matrix4x4> m(n);
+		std::vector<Quaternion> qo(n);
+		std::vector<float> angles = bench::randomArray<float>(n, 5, -3.0f, 3.0f);
+
+		BENCH_ARRAY("quaternion", "rotate", 40, o[i] = quaternion::rotate(q[i], v[i]), quaternion::rotate(q.data(), v.data(), o.data(), c));
+		BENCH_ARRAY("quaternion", "rotateShared", 24, o[i] = quaternion::rotate(q[0], v[i]), quaternion::rotate(q[0], v.data(), o.data(), c));
+		BENCH_ARRAY("quaternion", "toMat4x4", 80, m[i] = quaternion::toMat4x4(q[i]), quaternion::toMat4x4(q.data(), m.data(), c));
+		BENCH_ARRAY("quaternion", "axisAngle", 32, qo[i] = quaternion::axisAngle(v[i], angles[i]), quaternion::axisAngle(v.data(), angles.data(), qo.data(), c));
+		BENCH_ARRAY("quaternion", "toMat4x4TRS", 104, m[i] = quaternion::toMat4x4(t[i], q[i], s[i]), quaternion::toMat4x4(t.data(), q.data(), s.data(), m.data(), c));
+	}
+
+	//----- single element
+
+	uint32_t n = bench::countFor(p_Suite.options.footprints[0], 3 * sizeof(Quaternion));
+
+	std::vector<Quaternion> a = bench::randomArray<Quaternion>(n, 1), b = bench::randomArray<Quaternion>(n, 2), o(n);
+	std::vector<Vector3> axis = bench::randomArray<Vector3>(n, 3);
+	std::vector<float> s = bench::randomArray<float>(n, 4, -3.0f, 3.0f), d(n);
+	std::vector<Matrix4x4> m(n);
+
+	for(uint32_t i = 0; i < n; ++i)
+	{
+		a[i] = quaternion::normalized(a[i]);
+		b[i] = quaternion::normalized(b[i]);
+		axis[i] = vector3::normalize(axis[i]);
+	}
+
+	BENCH_SINGLE("quaternion", "create", 32, o[i] = quaternion::create(s[i], d[i], s[i], d[i]));
+	BENCH_SINGLE("quaternion", "identity", 16, o[i] = quaternion::identity());
+	BENCH_SINGLE("quaternion", "sqrMagnitude", 20, d[i] = quaternion::sqrMagnitude(a[i]));
+	BENCH_SINGLE("quaternion", "magnitude", 20, d[i] = quaternion::magnitude(a[i]));
+	BENCH_SINGLE("quaternion", "normalized", 32, o[i] = quaternion::normalized(a[i]));
+	BENCH_SINGLE("quaternion", "fastNormalized", 32, o[i] = quaternion::fastNormalized(a[i]));
+	BENCH_SINGLE("quaternion", "fastMagnitude", 20, d[i] = quaternion::fastMagnitude(a[i]));
+	BENCH_SINGLE("quaternion", "mul", 48, o[i] = quaternion::mul(a[i], b[i]));
+	BENCH_SINGLE("quaternion", "axisAngle", 32, o[i] = quaternion::axisAngle(axis[i], s[i]));
+	BENCH_SINGLE("quaternion", "axisAngleConst", 32, o[i] = quaternion::axisAngleConst(axis[i], s[i]));
+	BENCH_SINGLE("quaternion", "dot", 36, d[i] = quaternion::dot(a[i], b[i]));
+	BENCH_SINGLE("quaternion", "slerpFast", 52, o[i] = quaternion::slerpFast(a[i], b[i], (s[i] + 3.0f) * (1.0f / 6.0f)));
+	BENCH_SINGLE("quaternion", "toMat4x4", 80, m[i] = quaternion::toMat4x4(a[i]));
+	BENCH_SINGLE("quaternion", "rotate", 40, axis[i] = quaternion::rotate(a[i], axis[i]));
+}
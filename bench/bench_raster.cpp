@@ -0,0 +1,174 @@
+#include "bench.h"
+#include "raster.h"
+#include "mat4x4.h"
+#include "vector3.h"
+#include "vector4.h"
+#include <algorithm>
+#include <thread>
+
+using namespace alfar;
+
+// Rasterization of a frame of TRIANGLES random triangles (a few pixels to a
+// few thousand each, lots of overdraw) at WIDTH x HEIGHT; one op is one pixel
+// of the frame, so Mop/s is Mpixels/s and frames per second is that over the
+// pixel count. The naive reference walks the bounds of every triangle with
+// vector3::barycentric and vector4::interpolatedFromBarycentric per pixel.
+// The levels run on a single thread pool, then the detected level on pools
+// of 1, 2, 4... up to the hardware thread count (variant "Nt", speedup over
+// 1t).
+
+namespace
+{
+	const uint32_t WIDTH = 1280;
+	const uint32_t HEIGHT = 720;
+	const uint32_t TRIANGLES = 20000;
+
+	struct Scene
+	{
+		Matrix4x4 viewProj;
+		std::vector<Vector3> positions;
+		std::vector<Vector4> colors;
+		std::vector<uint32_t> indices;
+	};
+
+	Scene randomScene()
+	{
+		Scene ret;
+		ret.viewProj = mat4x4::persp(1.0f, (float)WIDTH / HEIGHT, 0.5f, 100.0f);
+
+		uint32_t seed = 21;
+		for(uint32_t t = 0; t < TRIANGLES; ++t)
+		{
+			float z = bench::random(seed, 3.0f, 60.0f);
+			Vector3 center = vector3::create(bench::random(seed, -0.6f, 0.6f) * z, bench::random(seed, -0.4f, 0.4f) * z, z);
+
+			for(int k = 0; k < 3; ++k)
+			{
+				ret.positions.push_back(vector3::add(center, vector3::create(bench::random(seed, -1.5f, 1.5f), bench::random(seed, -1.5f, 1.5f), bench::random(seed, -1.5f, 1.5f))));
+				ret.colors.push_back(vector4::create(bench::random(seed, 0, 1), bench::random(seed, 0, 1), bench::random(seed, 0, 1), 1.0f));
+				ret.indices.push_back(t * 3 + k);
+			}
+		}
+
+		return ret;
+	}
+
+	//the per pixel barycentric rasterizer, no clipping (the scene is in front of the near plane)
+	template<bool COLOR>
+	void naiveDraw(const Scene& p_Scene, RasterTarget& p_Target)
+	{
+		for(uint32_t t = 0; t < TRIANGLES; ++t)
+		{
+			Vector3 screen[3];
+			Vector4 planes[3], colors[3];
+			for(int k = 0; k < 3; ++k)
+			{
+				uint32_t index = p_Scene.indices[t * 3 + k];
+				const Vector3& p = p_Scene.positions[index];
+				Vector4 clip = vector4::mul(p_Scene.viewProj, vector4::create(p.x, p.y, p.z, 1.0f));
+
+				float invW = 1.0f / clip.w;
+				screen[k] = vector3::create((clip.x * invW + 1.0f) * 0.5f * WIDTH, (1.0f - clip.y * invW) * 0.5f * HEIGHT, 0);
+				planes[k] = vector4::create(clip.z * invW * 0.5f + 0.5f, invW, 0, 0);
+				colors[k] = vector4::mul(p_Scene.colors[index], invW);
+			}
+
+			int32_t x0 = std::max((int32_t)std::min(screen[0].x, std::min(screen[1].x, screen[2].x)), 0);
+			int32_t x1 = std::min((int32_t)std::max(screen[0].x, std::max(screen[1].x, screen[2].x)) + 1, (int32_t)WIDTH);
+			int32_t y0 = std::max((int32_t)std::min(screen[0].y, std::min(screen[1].y, screen[2].y)), 0);
+			int32_t y1 = std::min((int32_t)std::max(screen[0].y, std::max(screen[1].y, screen[2].y)) + 1, (int32_t)HEIGHT);
+
+			for(int32_t y = y0; y < y1; ++y)
+			{
+				for(int32_t x = x0; x < x1; ++x)
+				{
+					Vector3 b = vector3::barycentric(screen[0], screen[1], screen[2], vector3::create(x + 0.5f, y + 0.5f, 0));
+					if(b.x < 0 || b.y < 0 || b.z < 0)
+						continue;
+
+					Vector4 plane = vector4::interpolatedFromBarycentric(planes[0], planes[1], planes[2], b);
+					float& depth = p_Target.depth[(size_t)y * p_Target.pitch + x];
+					if(!(plane.x < depth))
+						continue;
+
+					depth = plane.x;
+					if(COLOR)
+					{
+						Vector4 c = vector4::mul(vector4::interpolatedFromBarycentric(colors[0], colors[1], colors[2], b), 1.0f / plane.y);
+						p_Target.color[(size_t)y * p_Target.pitch + x] = raster::simd::packColor(c.x, c.y, c.z, c.w);
+					}
+				}
+			}
+		}
+	}
+}
+
+//=============================================================================
+
+void bench::rasterBenchmarks(bench::Suite& p_Suite)
+{
+	if(!bench::selected(p_Suite, "raster", "drawDepth") && !bench::selected(p_Suite, "raster", "drawColor"))
+		return;
+
+	Scene scene = randomScene();
+	RasterTarget target = raster::create(WIDTH, HEIGHT, true);
+	RasterTarget depthOnly = target;
+	depthOnly.color = NULL;
+
+	const uint32_t pixels = WIDTH * HEIGHT;
+	bench::Footprint fp = { "720p", (size_t)pixels * 8 };
+
+	parallel::ThreadPool* single = parallel::create(1);
+	parallel::Policy singlePolicy = parallel::policy(single);
+
+	bench::compare(p_Suite, "raster", "drawDepth", fp, pixels, 4,
+		[&](uint32_t) { raster::clear(depthOnly); naiveDraw<false>(scene, depthOnly); },
+		[&](uint32_t) { raster::clear(depthOnly); raster::draw(singlePolicy, depthOnly, scene.viewProj, scene.positions.data(), (uint32_t)scene.positions.size(), NULL, scene.indices.data(), TRIANGLES); });
+	bench::compare(p_Suite, "raster", "drawColor", fp, pixels, 8,
+		[&](uint32_t) { raster::clear(target); naiveDraw<true>(scene, target); },
+		[&](uint32_t) { raster::clear(target); raster::draw(singlePolicy, target, scene.viewProj, scene.positions.data(), (uint32_t)scene.positions.size(), scene.colors.data(), scene.indices.data(), TRIANGLES); });
+
+	parallel::destroy(single);
+
+	//----- thread scaling at the detected level
+
+	uint32_t hardware = std::thread::hardware_concurrency();
+	hardware = hardware == 0 ? 1 : hardware;
+
+	std::vector<uint32_t> counts;
+	for(uint32_t t = 1; t < hardware; t *= 2)
+		counts.push_back(t);
+	counts.push_back(hardware);
+
+	const char* names[] = { "drawDepth", "drawColor" };
+	for(int k = 0; k < 2; ++k)
+	{
+		if(!bench::selected(p_Suite, "raster", names[k]))
+			continue;
+
+		RasterTarget& t = k == 0 ? depthOnly : target;
+		const Vector4* colors = k == 0 ? NULL : scene.colors.data();
+		double first = 0;
+
+		for(size_t c = 0; c < counts.size(); ++c)
+		{
+			parallel::ThreadPool* pool = parallel::create(counts[c]);
+			parallel::Policy policy = parallel::policy(pool);
+
+			double ns = bench::measure(p_Suite.options, pixels, [&](uint32_t)
+			{
+				raster::clear(t);
+				raster::draw(policy, t, scene.viewProj, scene.positions.data(), (uint32_t)scene.positions.size(), colors, scene.indices.data(), TRIANGLES);
+			});
+			first = c == 0 ? ns : first;
+
+			char variant[16];
+			snprintf(variant, sizeof(variant), "%ut", counts[c]);
+			bench::report(p_Suite, "raster", names[k], variant, fp, pixels, ns, k == 0 ? 4 : 8, c == 0 ? 0 : first);
+
+			parallel::destroy(pool);
+		}
+	}
+
+	raster::destroy(target);
+}
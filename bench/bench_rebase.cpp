@@ -0,0 +1,58 @@
+#include "bench.h"
+#include "mat4x4d.h"
+
+using namespace alfar;
+
+// Camera relative rebasing of double precision worlds, one op is one position
+// (24 bytes in, 12 out) or one world matrix (128 in, 64 out). The naive
+// reference is the single element function in a loop, the per element
+// conversion pass the batched kernel replaces.
+
+namespace
+{
+	const double WORLD = 1.0e7;
+
+	Vector3d randomPosition(uint32_t& p_Seed)
+	{
+		return vector3d::create(bench::random(p_Seed, -1, 1) * WORLD, bench::random(p_Seed, -1, 1) * WORLD, bench::random(p_Seed, -1, 1) * WORLD);
+	}
+}
+
+//=============================================================================
+
+void bench::rebaseBenchmarks(bench::Suite& p_Suite)
+{
+	uint32_t seed = 1;
+	Vector3d origin = randomPosition(seed);
+
+	for(size_t f = 0; f < p_Suite.options.footprints.size(); ++f)
+	{
+		const bench::Footprint& fp = p_Suite.options.footprints[f];
+
+		{
+			uint32_t n = bench::countFor(fp, sizeof(Vector3d) + sizeof(Vector3));
+
+			std::vector<Vector3d> positions(n);
+			for(uint32_t i = 0; i < n; ++i)
+				positions[i] = randomPosition(seed);
+			std::vector<Vector3> out(n);
+
+			bench::compare(p_Suite, "rebase", "positions", fp, n, 36,
+				[&](uint32_t c) { for(uint32_t i = 0; i < c; ++i) out[i] = vector3d::relative(positions[i], origin); },
+				[&](uint32_t c) { vector3d::relative(positions.data(), origin, out.data(), c); });
+		}
+
+		{
+			uint32_t n = bench::countFor(fp, sizeof(Matrix4x4d) + sizeof(Matrix4x4));
+
+			std::vector<Matrix4x4d> worlds(n);
+			for(uint32_t i = 0; i < n; ++i)
+				worlds[i] = mat4x4d::lookAt(randomPosition(seed), randomPosition(seed), vector3d::create(0, 1, 0));
+			std::vector<Matrix4x4> out(n);
+
+			bench::compare(p_Suite, "rebase", "matrices", fp, n, 192,
+				[&](uint32_t c) { for(uint32_t i = 0; i < c; ++i) out[i] = mat4x4d::relative(worlds[i], origin); },
+				[&](uint32_t c) { mat4x4d::relative(worlds.data(), origin, out.data(), c); });
+		}
+	}
+}
@@ -0,0 +1,60 @@
+#include "bench.h"
+#include "sprite.h"
+#include "sprite_parallel.h"
+
+using namespace alfar;
+
+// Sprite quads to corner vertices, one op is one sprite (32 bytes in, 32
+// out). The naive reference is the single sprite function in a loop. The
+// "frame" variant is FRAME sprites on the default pool, the per frame vertex
+// generation of a 2D layer.
+
+namespace
+{
+	const uint32_t FRAME = 1000 * 1000;
+
+	std::vector<Sprite> randomSprites(uint32_t p_Count, uint32_t p_Seed)
+	{
+		std::vector<Sprite> ret(p_Count);
+
+		for(uint32_t i = 0; i < p_Count; ++i)
+		{
+			Vector2 position = vector2::create(bench::random(p_Seed, 0, 1920), bench::random(p_Seed, 0, 1080));
+			Vector2 size = vector2::create(bench::random(p_Seed, 8, 128), bench::random(p_Seed, 8, 128));
+			ret[i] = sprite::create(position, size, bench::random(p_Seed, -3.14f, 3.14f), vector2::create(bench::random(p_Seed, 0, 1), bench::random(p_Seed, 0, 1)));
+		}
+
+		return ret;
+	}
+}
+
+//=============================================================================
+
+void bench::spriteBenchmarks(bench::Suite& p_Suite)
+{
+	for(size_t f = 0; f < p_Suite.options.footprints.size(); ++f)
+	{
+		const bench::Footprint& fp = p_Suite.options.footprints[f];
+		uint32_t n = bench::countFor(fp, sizeof(Sprite) + 4 * sizeof(Vector2));
+
+		std::vector<Sprite> sprites = randomSprites(n, 1);
+		std::vector<Vector2> corners(4 * (size_t)n);
+
+		bench::compare(p_Suite, "sprite", "corners", fp, n, 64,
+			[&](uint32_t c) { for(uint32_t i = 0; i < c; ++i) sprite::corners(sprites[i], &corners[4 * i]); },
+			[&](uint32_t c) { sprite::corners(sprites.data(), corners.data(), c); });
+	}
+
+	if(!bench::selected(p_Suite, "sprite", "cornersFrame"))
+		return;
+
+	std::vector<Sprite> sprites = randomSprites(FRAME, 2);
+	std::vector<Vector2> corners(4 * (size_t)FRAME);
+	bench::Footprint fp = { "1M", (size_t)FRAME * 64 };
+
+	double ns = bench::measure(p_Suite.options, FRAME, [&](uint32_t c) { sprite::corners(parallel::policy(), sprites.data(), corners.data(), c); });
+
+	char variant[16];
+	snprintf(variant, sizeof(variant), "%ut", parallel::threadCount(parallel::defaultPool()));
+	bench::report(p_Suite, "sprite", "cornersFrame", variant, fp, FRAME, ns, 64, 0);
+}
@@ -0,0 +1,129 @@
+#include "bench.h"
+#include "vector2.h"
+#include "vector3.h"
+#include "vector4.h"
+#include "mat4x4.h"
+
+using namespace alfar;
+
+namespace
+{
+	void vector2Benchmarks(bench::Suite& p_Suite)
+	{
+		for(size_t f = 0; f < p_Suite.options.footprints.size(); ++f)
+		{
+			const bench::Footprint& fp = p_Suite.options.footprints[f];
+			uint32_t n = bench::countFor(fp, 3 * sizeof(Vector2));
+
+			std::vector<Vector2> a = bench::randomArray<Vector2>(n, 1), b = bench::randomArray<Vector2>(n, 2), o(n);
+			std::vector<float> s = bench::randomArray<float>(n, 3), d(n);
+
+			BENCH_ARRAY("vector2", "init", 8, o[i] = vector2::create(0, 0), vector2::init(o.data(), c));
+			BENCH_ARRAY("vector2", "add", 24, o[i] = vector2::add(a[i], b[i]), vector2::add(a.data(), b.data(), o.data(), c));
+			BENCH_ARRAY("vector2", "sub", 24, o[i] = vector2::sub(a[i], b[i]), vector2::sub(a.data(), b.data(), o.data(), c));
+			BENCH_ARRAY("vector2", "mul", 20, o[i] = vector2::mul(a[i], s[i]), vector2::mul(a.data(), s.data(), o.data(), c));
+			BENCH_ARRAY("vector2", "scale", 24, o[i] = vector2::scale(a[i], b[i]), vector2::scale(a.data(), b.data(), o.data(), c));
+			BENCH_ARRAY("vector2", "dot", 20, d[i] = vector2::dot(a[i], b[i]), vector2::dot(a.data(), b.data(), d.data(), c));
+
+			if(f != 0)
+				continue;
+
+			BENCH_SINGLE("vector2", "create", 16, o[i] = vector2::create(s[i], d[i]));
+			BENCH_SINGLE("vector2", "sqrMagnitude", 12, d[i] = vector2::sqrMagnitude(a[i]));
+			BENCH_SINGLE("vector2", "magnitude", 12, d[i] = vector2::magnitude(a[i]));
+		}
+	}
+
+	//-------------------------------------------------------------------------
+
+	void vector3Benchmarks(bench::Suite& p_Suite)
+	{
+		for(size_t f = 0; f < p_Suite.options.footprints.size(); ++f)
+		{
+			const bench::Footprint& fp = p_Suite.options.footprints[f];
+			uint32_t n = bench::countFor(fp, 3 * sizeof(Vector3));
+
+			std::vector<Vector3> a = bench::randomArray<Vector3>(n, 1), b = bench::randomArray<Vector3>(n, 2), o(n);
+			std::vector<float> s = bench::randomArray<float>(n, 3), d(n);
+
+			BENCH_ARRAY("vector3", "init", 12, o[i] = vector3::create(0, 0, 0), vector3::init(o.data(), c));
+			BENCH_ARRAY("vector3", "add", 36, o[i] = vector3::add(a[i], b[i]), vector3::add(a.data(), b.data(), o.data(), c));
+			BENCH_ARRAY("vector3", "sub", 36, o[i] = vector3::sub(a[i], b[i]), vector3::sub(a.data(), b.data(), o.data(), c));
+			BENCH_ARRAY("vector3", "mul", 28, o[i] = vector3::mul(a[i], s[i]), vector3::mul(a.data(), s.data(), o.data(), c));
+			BENCH_ARRAY("vector3", "scale", 36, o[i] = vector3::scale(a[i], b[i]), vector3::scale(a.data(), b.data(), o.data(), c));
+			BENCH_ARRAY("vector3", "cross", 36, o[i] = vector3::cross(a[i], b[i]), vector3::cross(a.data(), b.data(), o.data(), c));
+			BENCH_ARRAY("vector3", "dot", 28, d[i] = vector3::dot(a[i], b[i]), vector3::dot(a.data(), b.data(), d.data(), c));
+			BENCH_ARRAY("vector3", "normalize", 24, o[i] = vector3::normalize(a[i]), vector3::normalize(a.data(), o.data(), c));
+			BENCH_ARRAY("vector3", "fastNormalizeApproximate", 24, o[i] = vector3::normalize(a[i]), vector3::fastNormalize<PRECISION_APPROXIMATE>(a.data(), o.data(), c));
+			BENCH_ARRAY("vector3", "fastNormalizeRefined", 24, o[i] = vector3::normalize(a[i]), vector3::fastNormalize<PRECISION_REFINED>(a.data(), o.data(), c));
+
+			if(f != 0)
+				continue;
+
+			Matrix4x4 m = mat4x4::persp(1.0f, 1.5f, 0.1f, 100.0f);
+			Vector3 planeOrigin = vector3::create(0, 0, 2), planeNormal = vector3::create(0, 0, 1);
+
+			BENCH_SINGLE("vector3", "create", 20, o[i] = vector3::create(s[i], d[i], s[i]));
+			BENCH_SINGLE("vector3", "mulMatrix", 24, o[i] = vector3::mul(m, a[i]));
+			BENCH_SINGLE("vector3", "sqrMagnitude", 16, d[i] = vector3::sqrMagnitude(a[i]));
+			BENCH_SINGLE("vector3", "magnitude", 16, d[i] = vector3::magnitude(a[i]));
+			BENCH_SINGLE("vector3", "normalize", 24, o[i] = vector3::normalize(a[i]));
+			BENCH_SINGLE("vector3", "fastNormalize", 24, o[i] = vector3::fastNormalize(a[i]));
+			BENCH_SINGLE("vector3", "fastMagnitude", 16, d[i] = vector3::fastMagnitude(a[i]));
+			BENCH_SINGLE("vector3", "barycentric", 24, o[i] = vector3::barycentric(a[0], b[0], a[n - 1], a[i]));
+			BENCH_SINGLE("vector3", "linePlaneIntersection", 28, d[i] = vector3::linePlaneIntersection(planeOrigin, planeNormal, a[i], b[i]));
+			BENCH_SINGLE("vector3", "raySphereIntersection", 28, d[i] = vector3::raySphereIntersection(planeOrigin, 0.5f, a[i], b[i]));
+		}
+	}
+
+	//-------------------------------------------------------------------------
+
+	void vector4Benchmarks(bench::Suite& p_Suite)
+	{
+		for(size_t f = 0; f < p_Suite.options.footprints.size(); ++f)
+		{
+			const bench::Footprint& fp = p_Suite.options.footprints[f];
+			uint32_t n = bench::countFor(fp, 3 * sizeof(Vector4));
+
+			std::vector<Vector4> a = bench::randomArray<Vector4>(n, 1), b = bench::randomArray<Vector4>(n, 2), o(n);
+			std::vector<float> s = bench::randomArray<float>(n, 3), d(n);
+
+			BENCH_ARRAY("vector4", "init", 16, o[i] = vector4::create(0, 0, 0, 0), vector4::init(o.data(), c));
+			BENCH_ARRAY("vector4", "add", 48, o[i] = vector4::add(a[i], b[i]), vector4::add(a.data(), b.data(), o.data(), c));
+			BENCH_ARRAY("vector4", "sub", 48, o[i] = vector4::sub(a[i], b[i]), vector4::sub(a.data(), b.data(), o.data(), c));
+			BENCH_ARRAY("vector4", "mul", 36, o[i] = vector4::mul(a[i], s[i]), vector4::mul(a.data(), s.data(), o.data(), c));
+			BENCH_ARRAY("vector4", "scale", 48, o[i] = vector4::scale(a[i], b[i]), vector4::scale(a.data(), b.data(), o.data(), c));
+			BENCH_ARRAY("vector4", "dot", 36, d[i] = vector4::dot(a[i], b[i]), vector4::dot(a.data(), b.data(), d.data(), c));
+			BENCH_ARRAY("vector4", "normalize", 32, o[i] = vector4::normalize(a[i]), vector4::normalize(a.data(), o.data(), c));
+			BENCH_ARRAY("vector4", "fastNormalizeApproximate", 32, o[i] = vector4::normalize(a[i]), vector4::fastNormalize<PRECISION_APPROXIMATE>(a.data(), o.data(), c));
+			BENCH_ARRAY("vector4", "fastNormalizeRefined", 32, o[i] = vector4::normalize(a[i]), vector4::fastNormalize<PRECISION_REFINED>(a.data(), o.data(), c));
+
+			if(f != 0)
+				continue;
+
+			Matrix4x4 m = mat4x4::persp(1.0f, 1.5f, 0.1f, 100.0f);
+			Vector3 bary = vector3::create(0.2f, 0.3f, 0.5f);
+
+			BENCH_SINGLE("vector4", "create", 24, o[i] = vector4::create(s[i], d[i], s[i], d[i]));
+			BENCH_SINGLE("vector4", "createFromVector3", 32, o[i] = vector4::create(vector4::toVec3(a[i]), s[i]));
+			BENCH_SINGLE("vector4", "mulMatrix", 32, o[i] = vector4::mul(m, a[i]));
+			BENCH_SINGLE("vector4", "lengthSqr", 20, d[i] = vector4::lengthSqr(a[i]));
+			BENCH_SINGLE("vector4", "length", 20, d[i] = vector4::length(a[i]));
+			BENCH_SINGLE("vector4", "normalize", 32, o[i] = vector4::normalize(a[i]));
+			BENCH_SINGLE("vector4", "fastNormalize", 32, o[i] = vector4::fastNormalize(a[i]));
+			BENCH_SINGLE("vector4", "fastLength", 20, d[i] = vector4::fastLength(a[i]));
+			BENCH_SINGLE("vector4", "interpolatedFromBarycentric", 32, o[i] = vector4::interpolatedFromBarycentric(a[i], b[i], a[0], bary));
+			BENCH_SINGLE("vector4", "lerp", 48, o[i] = vector4::lerp(a[i], b[i], 0.25f));
+			BENCH_SINGLE("vector4", "clamp", 32, o[i] = vector4::clamp(a[i], -0.5f, 0.5f));
+		}
+	}
+}
+
+//=============================================================================
+
+void bench::vectorBenchmarks(bench::Suite& p_Suite)
+{
+	vector2Benchmarks(p_Suite);
+	vector3Benchmarks(p_Suite);
+	vector4Benchmarks(p_Suite);
+}
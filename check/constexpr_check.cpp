@@ -0,0 +1,71 @@
+#include "vector2.h"
+#include "vector3.h"
+#include "vector4.h"
+#include "vector3d.h"
+#include "mat3x3.h"
+#include "mat4x4.h"
+#include "affine3x4.h"
+#include "quaternion.h"
+#include "aabb.h"
+#include "oobb.h"
+#include "frustum.h"
+
+// Compile time evaluation guards of the constexpr surface. Nothing here runs:
+// the file only has to compile, and a function that stops being constexpr (or
+// gives a different result) breaks the alfar_constexpr_check build instead of
+// the consumers of the headers. Needs C++14, under C++11 ALFAR_CONSTEXPR is
+// inline and the checks compile out.
+
+#if ALFAR_HAS_CONSTEXPR
+
+//----- vector2
+static_assert(alfar::vector2::dot(alfar::vector2::create(1, 2), alfar::vector2::create(3, 4)) == 11, "vector2 must be constexpr");
+static_assert(alfar::vector2::rotate(alfar::vector2::create(1, 2), alfar::vector2::create(0, 1)).x == -2, "vector2 must be constexpr");
+
+//----- mat4x4
+static_assert(alfar::mat4x4::identity().x.x == 1 && alfar::mat4x4::identity().x.y == 0, "mat4x4::identity must be constexpr");
+static_assert(alfar::mat4x4::affineInverse(alfar::mat4x4::translation(alfar::vector3::create(1, 2, 3))).z.w == -3, "mat4x4::affineInverse must be constexpr");
+static_assert(alfar::mat4x4::determinant(alfar::mat4x4::translation(alfar::vector3::create(1, 2, 3))) == 1, "mat4x4::determinant must be constexpr");
+static_assert(alfar::vector3::dot(alfar::vector3::cross(alfar::vector3::create(1, 0, 0), alfar::vector3::create(0, 1, 0)), alfar::vector3::create(0, 0, 1)) == 1, "vector3 must be constexpr");
+static_assert(alfar::vector4::mul(alfar::mat4x4::identity(), alfar::vector4::create(1, 2, 3, 4)).w == 4, "vector4 must be constexpr");
+static_assert(alfar::constSqrt(4.0f) == 2.0f && alfar::constSin(0.0f) == 0.0f && alfar::constCos(0.0f) == 1.0f, "const sqrt/sin/cos must be constexpr");
+
+//----- quaternion
+static_assert(alfar::quaternion::mul(alfar::quaternion::identity(), alfar::quaternion::identity()).w == 1, "quaternion::mul must be constexpr");
+static_assert(alfar::quaternion::toMat4x4(alfar::quaternion::identity()).y.y == 1, "quaternion::toMat4x4 must be constexpr");
+static_assert(alfar::quaternion::toMat4x4(alfar::vector3::create(1, 2, 3), alfar::quaternion::identity(), alfar::vector3::create(2, 2, 2)).y.w == 2, "quaternion::toMat4x4 must be constexpr");
+static_assert(alfar::quaternion::rotate(alfar::quaternion::identity(), alfar::vector3::create(1, 2, 3)).z == 3, "quaternion::rotate must be constexpr");
+
+//----- mat3x3
+static_assert(alfar::mat3x3::determinant(alfar::mat3x3::identity()) == 1, "mat3x3::determinant must be constexpr");
+static_assert(alfar::mat3x3::inverse(alfar::mat3x3::create(alfar::vector3::create(2, 0, 0), alfar::vector3::create(0, 4, 0), alfar::vector3::create(0, 0, 1))).y.y == 0.25f, "mat3x3::inverse must be constexpr");
+static_assert(alfar::vector3::mul(alfar::mat3x3::fromQuaternion(alfar::quaternion::identity()), alfar::vector3::create(1, 2, 3)).z == 3, "mat3x3::fromQuaternion must be constexpr");
+
+//----- affine3x4
+static_assert(alfar::affine3x4::inverse(alfar::affine3x4::translation(alfar::vector3::create(1, 2, 3))).z.w == -3, "affine3x4::inverse must be constexpr");
+static_assert(alfar::affine3x4::transformPoint(alfar::affine3x4::mul(alfar::affine3x4::translation(alfar::vector3::create(1, 0, 0)), alfar::affine3x4::translation(alfar::vector3::create(0, 2, 0))), alfar::vector3::create(0, 0, 3)).y == 2, "affine3x4::mul must be constexpr");
+
+//----- aabb
+static_assert(alfar::aabb::overlap(alfar::aabb::create(alfar::vector3::create(0, 0, 0), alfar::vector3::create(1, 1, 1)),
+								   alfar::aabb::create(alfar::vector3::create(1, 1, 1), alfar::vector3::create(2, 2, 2))), "aabb must be constexpr");
+
+//----- oobb
+static_assert(alfar::oobb::overlap(alfar::oobb::create(alfar::mat4x4::translation(alfar::vector3::create(1.5f, 0, 0)),
+													   alfar::aabb::create(alfar::vector3::create(-1, -1, -1), alfar::vector3::create(1, 1, 1))),
+								   alfar::aabb::create(alfar::vector3::create(0, 0, 0), alfar::vector3::create(1, 1, 1))), "oobb must be constexpr");
+//a 20 x 20 quad at z = 0 under a rotated cube spanning z 0.28 to 3.72: only the normal of the quad separates them
+static_assert(!alfar::oobb::overlap(alfar::oobb::create(alfar::mat4x4::identity(), alfar::aabb::create(alfar::vector3::create(-10, -10, 0), alfar::vector3::create(10, 10, 0))),
+									alfar::oobb::create(alfar::quaternion::toMat4x4(alfar::vector3::create(0, 0, 2), alfar::quaternion::create(0.2f, 0.4f, 0.4f, 0.8f), alfar::vector3::create(1, 1, 1)),
+														alfar::aabb::create(alfar::vector3::create(-1, -1, -1), alfar::vector3::create(1, 1, 1)))), "oobb::overlap must test the normal of a flat box");
+static_assert(alfar::oobb::overlap(alfar::oobb::create(alfar::mat4x4::identity(), alfar::aabb::create(alfar::vector3::create(-10, -10, 0), alfar::vector3::create(10, 10, 0))),
+								   alfar::oobb::create(alfar::quaternion::toMat4x4(alfar::vector3::create(0, 0, 1), alfar::quaternion::create(0.2f, 0.4f, 0.4f, 0.8f), alfar::vector3::create(1, 1, 1)),
+													   alfar::aabb::create(alfar::vector3::create(-1, -1, -1), alfar::vector3::create(1, 1, 1)))), "oobb::overlap must accept a flat box crossing a cube");
+
+//----- frustum
+static_assert(alfar::frustum::distance(alfar::Plane{ alfar::vector3::create(0, 1, 0), -1 }, alfar::vector3::create(3, 2, 1)) == 1, "frustum must be constexpr");
+
+//----- vector3d
+static_assert(alfar::vector3d::dot(alfar::vector3d::cross(alfar::vector3d::create(1, 0, 0), alfar::vector3d::create(0, 1, 0)), alfar::vector3d::create(0, 0, 1)) == 1, "vector3d must be constexpr");
+static_assert(alfar::vector3d::relative(alfar::vector3d::create(1e9 + 0.5, 0, 0), alfar::vector3d::create(1e9, 0, 0)).x == 0.5f, "vector3d::relative must be constexpr");
+
+#endif
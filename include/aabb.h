@@ -0,0 +1,180 @@
+#pragma once
+
+#include "math_types.h"
+#include "functions.h"
+#include "vector3.h"
+#include "bounds_simd.h"
+#include <stdint.h>
+#include <limits>
+
+// Axis aligned boxes. Bounds are inclusive: boxes touching on a face overlap
+// and a point on a face is contained. empty() (min = +inf, max = -inf) is the
+// identity of merge, overlaps nothing and contains nothing.
+
+namespace alfar
+{
+	namespace aabb
+	{
+		static_assert(sizeof(AABB) == 6 * sizeof(float), "AABB must be 6 packed floats");
+
+		ALFAR_CONSTEXPR AABB create(const Vector3& p_Min, const Vector3& p_Max)
+		{
+			AABB ret = {};
+			ret.min = p_Min;
+			ret.max = p_Max;
+
+			return ret;
+		}
+
+		ALFAR_CONSTEXPR AABB empty()
+		{
+			return create(vector3::create(std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity()),
+						  vector3::create(-std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()));
+		}
+
+		//p_Center +/- p_HalfSize
+		ALFAR_CONSTEXPR AABB fromCenter(const Vector3& p_Center, const Vector3& p_HalfSize)
+		{
+			return create(vector3::sub(p_Center, p_HalfSize), vector3::add(p_Center, p_HalfSize));
+		}
+
+		ALFAR_CONSTEXPR bool isEmpty(const AABB& p_Box)
+		{
+			return p_Box.min.x > p_Box.max.x || p_Box.min.y > p_Box.max.y || p_Box.min.z > p_Box.max.z;
+		}
+
+		//---------------------------------------------------------------------
+
+		ALFAR_CONSTEXPR Vector3 center(const AABB& p_Box)
+		{
+			return vector3::mul(vector3::add(p_Box.min, p_Box.max), 0.5f);
+		}
+
+		ALFAR_CONSTEXPR Vector3 halfSize(const AABB& p_Box)
+		{
+			return vector3::mul(vector3::sub(p_Box.max, p_Box.min), 0.5f);
+		}
+
+		ALFAR_CONSTEXPR Vector3 size(const AABB& p_Box)
+		{
+			return vector3::sub(p_Box.max, p_Box.min);
+		}
+
+		//---------------------------------------------------------------------
+
+		ALFAR_CONSTEXPR AABB merge(const AABB& a, const AABB& b)
+		{
+			return create(vector3::min(a.min, b.min), vector3::max(a.max, b.max));
+		}
+
+		ALFAR_CONSTEXPR AABB merge(const AABB& p_Box, const Vector3& p_Point)
+		{
+			return create(vector3::min(p_Box.min, p_Point), vector3::max(p_Box.max, p_Point));
+		}
+
+		//---------------------------------------------------------------------
+
+		ALFAR_CONSTEXPR bool contains(const AABB& p_Box, const Vector3& p_Point)
+		{
+			return p_Point.x >= p_Box.min.x && p_Point.x <= p_Box.max.x
+				&& p_Point.y >= p_Box.min.y && p_Point.y <= p_Box.max.y
+				&& p_Point.z >= p_Box.min.z && p_Point.z <= p_Box.max.z;
+		}
+
+		//p_Inner entirely inside p_Box
+		ALFAR_CONSTEXPR bool contains(const AABB& p_Box, const AABB& p_Inner)
+		{
+			return !isEmpty(p_Inner) && contains(p_Box, p_Inner.min) && contains(p_Box, p_Inner.max);
+		}
+
+		ALFAR_CONSTEXPR bool overlap(const AABB& a, const AABB& b)
+		{
+			return a.min.x <= b.max.x && b.min.x <= a.max.x
+				&& a.min.y <= b.max.y && b.min.y <= a.max.y
+				&& a.min.z <= b.max.z && b.min.z <= a.max.z;
+		}
+
+		//sphere p_Center, p_Radius touching the box
+		ALFAR_CONSTEXPR bool overlap(const AABB& p_Box, const Vector3& p_Center, float p_Radius)
+		{
+			float dx = p_Center.x < p_Box.min.x ? p_Box.min.x - p_Center.x : (p_Center.x > p_Box.max.x ? p_Center.x - p_Box.max.x : 0);
+			float dy = p_Center.y < p_Box.min.y ? p_Box.min.y - p_Center.y : (p_Center.y > p_Box.max.y ? p_Center.y - p_Box.max.y : 0);
+			float dz = p_Center.z < p_Box.min.z ? p_Box.min.z - p_Center.z : (p_Center.z > p_Box.max.z ? p_Center.z - p_Box.max.z : 0);
+
+			return !isEmpty(p_Box) && dx * dx + dy * dy + dz * dz <= p_Radius * p_Radius;
+		}
+
+		//distance along the ray to the entry in the box (slab test), 0 when the
+		//origin is inside, -1 when the ray misses the box or enters it after
+		//p_MaxDistance. p_RayInvDir is 1 / direction per component, a null
+		//component giving an infinity.
+		ALFAR_CONSTEXPR float rayIntersection(const AABB& p_Box, const Vector3& p_RayOrigin, const Vector3& p_RayInvDir, float p_MaxDistance)
+		{
+			float x0 = (p_Box.min.x - p_RayOrigin.x) * p_RayInvDir.x, x1 = (p_Box.max.x - p_RayOrigin.x) * p_RayInvDir.x;
+			float y0 = (p_Box.min.y - p_RayOrigin.y) * p_RayInvDir.y, y1 = (p_Box.max.y - p_RayOrigin.y) * p_RayInvDir.y;
+			float z0 = (p_Box.min.z - p_RayOrigin.z) * p_RayInvDir.z, z1 = (p_Box.max.z - p_RayOrigin.z) * p_RayInvDir.z;
+
+			float tmin = x0 < x1 ? x0 : x1, tmax = x0 < x1 ? x1 : x0;
+			float ymin = y0 < y1 ? y0 : y1, ymax = y0 < y1 ? y1 : y0;
+			float zmin = z0 < z1 ? z0 : z1, zmax = z0 < z1 ? z1 : z0;
+
+			tmin = ymin > tmin ? ymin : tmin;
+			tmin = zmin > tmin ? zmin : tmin;
+			tmax = ymax < tmax ? ymax : tmax;
+			tmax = zmax < tmax ? zmax : tmax;
+
+			if(!(tmin <= tmax) || tmax < 0 || tmin > p_MaxDistance)
+				return -1.0f;
+
+			return tmin > 0 ? tmin : 0;
+		}
+
+		//---------------------------------------------------------------------
+
+		//bounds of the affine transform of p_Box (Arvo): the center is transformed
+		//as a point, each half size is the sum of the half sizes weighted by the
+		//absolute values of the matrix row. The result is the smallest box around
+		//the 8 transformed corners.
+		ALFAR_CONSTEXPR AABB transform(const Matrix4x4& m, const AABB& p_Box)
+		{
+			if(isEmpty(p_Box))
+				return p_Box;
+
+			Vector3 c = center(p_Box);
+			Vector3 h = halfSize(p_Box);
+
+			Vector3 tc = vector3::create(m.x.x * c.x + m.x.y * c.y + m.x.z * c.z + m.x.w,
+										 m.y.x * c.x + m.y.y * c.y + m.y.z * c.z + m.y.w,
+										 m.z.x * c.x + m.z.y * c.y + m.z.z * c.z + m.z.w);
+
+			Vector3 th = vector3::create((m.x.x < 0 ? -m.x.x : m.x.x) * h.x + (m.x.y < 0 ? -m.x.y : m.x.y) * h.y + (m.x.z < 0 ? -m.x.z : m.x.z) * h.z,
+										 (m.y.x < 0 ? -m.y.x : m.y.x) * h.x + (m.y.y < 0 ? -m.y.y : m.y.y) * h.y + (m.y.z < 0 ? -m.y.z : m.y.z) * h.z,
+										 (m.z.x < 0 ? -m.z.x : m.z.x) * h.x + (m.z.y < 0 ? -m.z.y : m.z.y) * h.y + (m.z.z < 0 ? -m.z.z : m.z.z) * h.z);
+
+			return fromCenter(tc, th);
+		}
+
+		//----- array version
+
+		//bounds of p_Number points, empty() for none
+		inline AABB fromPoints(const Vector3* p_Points, uint32_t p_Number)
+		{
+			AABB ret;
+			bounds::simd::bounds<3>(&p_Points->x, &ret.min.x, &ret.max.x, p_Number);
+
+			return ret;
+		}
+
+		//bit i % 32 of p_Out[i / 32] = overlap(p_Box, p_Boxes[i]). p_Out holds (p_Number + 31) / 32 words.
+		inline void overlap(const AABB& p_Box, const AABB* p_Boxes, uint32_t p_Number, uint32_t* p_Out)
+		{
+			bounds::simd::overlap<3>(&p_Box.min.x, &p_Boxes->min.x, p_Out, p_Number);
+		}
+
+		inline void transform(const Matrix4x4& m, const AABB* p_In, AABB* p_Out, uint32_t p_Number)
+		{
+			for(uint32_t i = 0; i < p_Number; ++i)
+				p_Out[i] = transform(m, p_In[i]);
+		}
+	}
+}
@@ -0,0 +1,230 @@
+#pragma once
+
+#include "math_types.h"
+#include "vector3.h"
+#include "vector4.h"
+#include "quaternion.h"
+#include "mat4x4.h"
+#include "vector3_simd.h"
+#include "affine3x4_simd.h"
+#include <stdint.h>
+#include <string.h>
+
+// Affine transforms stored as the 3 top rows of a Matrix4x4, the bottom row
+// being (0,0,0,1): 48 bytes instead of 64 for object transforms and
+// hierarchies. Same conventions as Matrix4x4, rows x, y, z with the
+// translation in w and column vectors, so every function gives the result of
+// its mat4x4 counterpart on toMat4x4(m).
+
+namespace alfar
+{
+	namespace affine3x4
+	{
+		ALFAR_CONSTEXPR Affine3x4 create(const Vector4& x, const Vector4& y, const Vector4& z)
+		{
+			Affine3x4 mat = {};
+			mat.x = x;
+			mat.y = y;
+			mat.z = z;
+
+			return mat;
+		}
+
+		ALFAR_CONSTEXPR Affine3x4 identity()
+		{
+			return create(vector4::create(1, 0, 0, 0), vector4::create(0, 1, 0, 0), vector4::create(0, 0, 1, 0));
+		}
+
+		ALFAR_CONSTEXPR Affine3x4 translation(const Vector3& p_Translate)
+		{
+			return create(vector4::create(1, 0, 0, p_Translate.x), vector4::create(0, 1, 0, p_Translate.y), vector4::create(0, 0, 1, p_Translate.z));
+		}
+
+		//---------------------------------------------------------------------------
+
+		//the bottom row of m is dropped, it should be (0,0,0,1)
+		ALFAR_CONSTEXPR Affine3x4 fromMat4x4(const Matrix4x4& m)
+		{
+			return create(m.x, m.y, m.z);
+		}
+
+		ALFAR_CONSTEXPR Matrix4x4 toMat4x4(const Affine3x4& m)
+		{
+			return mat4x4::create(m.x, m.y, m.z, vector4::create(0, 0, 0, 1));
+		}
+
+		//translation * rotation * scale, q must be a unit quaternion
+		ALFAR_CONSTEXPR Affine3x4 fromTRS(const Vector3& p_Translation, const Quaternion& p_Rotation, const Vector3& p_Scale)
+		{
+			return fromMat4x4(quaternion::toMat4x4(p_Translation, p_Rotation, p_Scale));
+		}
+
+		//===========================================================================
+
+		//a * b, as mat4x4::mul with the bottom rows dropped
+		ALFAR_CONSTEXPR Affine3x4 mul(const Affine3x4& a, const Affine3x4& b)
+		{
+			Affine3x4 out = {};
+
+			out.x.x = a.x.x * b.x.x + a.x.y * b.y.x + a.x.z * b.z.x;
+			out.x.y = a.x.x * b.x.y + a.x.y * b.y.y + a.x.z * b.z.y;
+			out.x.z = a.x.x * b.x.z + a.x.y * b.y.z + a.x.z * b.z.z;
+			out.x.w = a.x.x * b.x.w + a.x.y * b.y.w + a.x.z * b.z.w + a.x.w;
+
+			out.y.x = a.y.x * b.x.x + a.y.y * b.y.x + a.y.z * b.z.x;
+			out.y.y = a.y.x * b.x.y + a.y.y * b.y.y + a.y.z * b.z.y;
+			out.y.z = a.y.x * b.x.z + a.y.y * b.y.z + a.y.z * b.z.z;
+			out.y.w = a.y.x * b.x.w + a.y.y * b.y.w + a.y.z * b.z.w + a.y.w;
+
+			out.z.x = a.z.x * b.x.x + a.z.y * b.y.x + a.z.z * b.z.x;
+			out.z.y = a.z.x * b.x.y + a.z.y * b.y.y + a.z.z * b.z.y;
+			out.z.z = a.z.x * b.x.z + a.z.y * b.y.z + a.z.z * b.z.z;
+			out.z.w = a.z.x * b.x.w + a.z.y * b.y.w + a.z.z * b.z.w + a.z.w;
+
+			return out;
+		}
+
+		//---------------------------------------------------------------------------
+
+		//mat4x4::affineInverse, any invertible linear part. a singular one gives inf/nan.
+		ALFAR_CONSTEXPR Affine3x4 inverse(const Affine3x4& m)
+		{
+			return fromMat4x4(mat4x4::affineInverse(toMat4x4(m)));
+		}
+
+		//mat4x4::rigidInverse, when the linear part is a rotation
+		ALFAR_CONSTEXPR Affine3x4 rigidInverse(const Affine3x4& m)
+		{
+			return fromMat4x4(mat4x4::rigidInverse(toMat4x4(m)));
+		}
+
+		//---------------------------------------------------------------------------
+
+		//w = 1
+		ALFAR_CONSTEXPR Vector3 transformPoint(const Affine3x4& m, const Vector3& p)
+		{
+			return vector3::create(m.x.x * p.x + m.x.y * p.y + m.x.z * p.z + m.x.w,
+								   m.y.x * p.x + m.y.y * p.y + m.y.z * p.z + m.y.w,
+								   m.z.x * p.x + m.z.y * p.y + m.z.z * p.z + m.z.w);
+		}
+
+		//w = 0, the translation does not apply
+		ALFAR_CONSTEXPR Vector3 transformDirection(const Affine3x4& m, const Vector3& d)
+		{
+			return vector3::create(m.x.x * d.x + m.x.y * d.y + m.x.z * d.z,
+								   m.y.x * d.x + m.y.y * d.y + m.y.z * d.z,
+								   m.z.x * d.x + m.z.y * d.y + m.z.z * d.z);
+		}
+
+		//----- array version
+		//p_Out may be p_In itself (the in-place overloads do that); partially
+		//overlapping ranges are not supported.
+
+		inline void transformPoints(const Affine3x4& m, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+		{
+			vector3::simd::transform<vector3::simd::TRANSFORM_POINT>(toMat4x4(m), p_In, p_Out, p_Number);
+		}
+
+		inline void transformPoints(const Affine3x4& m, Vector3* p_InOut, uint32_t p_Number)
+		{
+			transformPoints(m, p_InOut, p_InOut, p_Number);
+		}
+
+		inline void transformDirections(const Affine3x4& m, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+		{
+			vector3::simd::transform<vector3::simd::TRANSFORM_DIRECTION>(toMat4x4(m), p_In, p_Out, p_Number);
+		}
+
+		inline void transformDirections(const Affine3x4& m, Vector3* p_InOut, uint32_t p_Number)
+		{
+			transformDirections(m, p_InOut, p_InOut, p_Number);
+		}
+
+		//---------------------------------------------------------------------------
+
+		//the top 3 rows of each matrix; p_Out may not overlap p_In.
+		inline void fromMat4x4(const Matrix4x4* p_In, Affine3x4* p_Out, uint32_t p_Number)
+		{
+			for(uint32_t i = 0; i < p_Number; ++i)
+				memcpy(&p_Out[i], &p_In[i], sizeof(Affine3x4));
+		}
+
+		//e.g. to upload to an api that wants full matrices; p_Out may not overlap p_In.
+		inline void toMat4x4(const Affine3x4* p_In, Matrix4x4* p_Out, uint32_t p_Number)
+		{
+			for(uint32_t i = 0; i < p_Number; ++i)
+				p_Out[i] = toMat4x4(p_In[i]);
+		}
+
+		//---------------------------------------------------------------------------
+
+		//p_Out[i] = p_Firsts[i] * p_Seconds[i]; p_Out may be either input array.
+		inline void mul(const Affine3x4* p_Firsts, const Affine3x4* p_Seconds, Affine3x4* p_Out, uint32_t p_Number)
+		{
+			switch(cpu::level())
+			{
+#if ALFAR_X86
+			case cpu::LEVEL_AVX512:	simd::mulAVX512(p_Firsts, p_Seconds, p_Out, p_Number); return;
+			case cpu::LEVEL_AVX2:	simd::mulAVX2(p_Firsts, p_Seconds, p_Out, p_Number); return;
+			case cpu::LEVEL_SSE2:	simd::mulSSE2(p_Firsts, p_Seconds, p_Out, p_Number); return;
+#endif
+			default:
+				for(uint32_t i = 0; i < p_Number; ++i)
+					p_Out[i] = mul(p_Firsts[i], p_Seconds[i]);
+				return;
+			}
+		}
+
+		//batch versions of inverse and rigidInverse; p_Out may be p_In.
+		inline void inverse(const Affine3x4* p_In, Affine3x4* p_Out, uint32_t p_Number)
+		{
+#if ALFAR_X86
+			if(cpu::level() >= cpu::LEVEL_SSE2)
+			{
+				simd::inverseSSE2<false>(p_In, p_Out, p_Number);
+				return;
+			}
+#endif
+			for(uint32_t i = 0; i < p_Number; ++i)
+				p_Out[i] = inverse(p_In[i]);
+		}
+
+		inline void rigidInverse(const Affine3x4* p_In, Affine3x4* p_Out, uint32_t p_Number)
+		{
+#if ALFAR_X86
+			if(cpu::level() >= cpu::LEVEL_SSE2)
+			{
+				simd::inverseSSE2<true>(p_In, p_Out, p_Number);
+				return;
+			}
+#endif
+			for(uint32_t i = 0; i < p_Number; ++i)
+				p_Out[i] = rigidInverse(p_In[i]);
+		}
+
+		//===========================================================================
+
+		//hierarchy propagation as mat4x4::propagate: p_Out[i] = p_Out[p_Parents[i]] * p_Locals[i],
+		//or p_Locals[i] for a root (negative parent), with p_Parents[i] < i. Only [p_Start, p_End) is written.
+		inline void propagate(const Affine3x4* p_Locals, const int32_t* p_Parents, Affine3x4* p_Out, uint32_t p_Start, uint32_t p_End)
+		{
+			switch(cpu::level())
+			{
+#if ALFAR_X86
+			case cpu::LEVEL_AVX512:	simd::propagateAVX512(p_Locals, p_Parents, p_Out, p_Start, p_End); return;
+			case cpu::LEVEL_AVX2:	simd::propagateAVX2(p_Locals, p_Parents, p_Out, p_Start, p_End); return;
+			case cpu::LEVEL_SSE2:	simd::propagateSSE2(p_Locals, p_Parents, p_Out, p_Start, p_End); return;
+#endif
+			default:
+				for(uint32_t i = p_Start; i < p_End; ++i)
+					p_Out[i] = p_Parents[i] < 0 ? p_Locals[i] : mul(p_Out[p_Parents[i]], p_Locals[i]);
+				return;
+			}
+		}
+
+		inline void propagate(const Affine3x4* p_Locals, const int32_t* p_Parents, Affine3x4* p_Out, uint32_t p_Number)
+		{
+			propagate(p_Locals, p_Parents, p_Out, 0, p_Number);
+		}
+	}
+}
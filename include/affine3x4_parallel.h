@@ -0,0 +1,22 @@
+#pragma once
+
+#include "affine3x4.h"
+#include "parallel.h"
+#include "mat4x4_parallel.h"
+#include <stdint.h>
+
+// Affine3x4 hierarchy propagation over the pool of a Policy, planned by
+// mat4x4::propagateRanges.
+
+namespace alfar
+{
+	namespace affine3x4
+	{
+		//same result as propagate, with the array split by mat4x4::propagateRanges
+		inline void propagate(const parallel::Policy& p_Policy, const Affine3x4* p_Locals, const int32_t* p_Parents, Affine3x4* p_Out, uint32_t p_Number)
+		{
+			mat4x4::propagateRanges(p_Policy, [=](uint32_t p_Start, uint32_t p_End) { propagate(p_Locals, p_Parents, p_Out, p_Start, p_End); },
+									p_Parents, p_Number);
+		}
+	}
+}
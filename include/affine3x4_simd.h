@@ -0,0 +1,212 @@
+#pragma once
+
+#include "math_types.h"
+#include "cpu.h"
+#include <stdint.h>
+
+// SIMD kernels behind the affine3x4 batch functions, the mat4x4 products
+// without the bottom row: each result row is the rows of b scaled by the
+// broadcast x, y, z of the matching row of a, plus its w in the w lane (the
+// implicit (0,0,0,1) row of b). One row per SSE register, rows 0-1 in one AVX
+// register and row 2 in an SSE one, the whole matrix in one masked AVX-512
+// register. Everything is loaded before the store, so out may be a or b.
+
+namespace alfar
+{
+	namespace affine3x4
+	{
+		namespace simd
+		{
+			static_assert(sizeof(Affine3x4) == 12 * sizeof(float), "Affine3x4 must be 12 packed floats");
+
+#if ALFAR_X86
+
+			ALFAR_TARGET_SSE2 inline void mulSSE2(const Affine3x4& a, const Affine3x4& b, Affine3x4& out)
+			{
+				const __m128 wMask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+
+				__m128 bx = _mm_loadu_ps(&b.x.x);
+				__m128 by = _mm_loadu_ps(&b.y.x);
+				__m128 bz = _mm_loadu_ps(&b.z.x);
+
+				__m128 rows[3] = { _mm_loadu_ps(&a.x.x), _mm_loadu_ps(&a.y.x), _mm_loadu_ps(&a.z.x) };
+
+				for(int r = 0; r < 3; ++r)
+				{
+					__m128 ar = rows[r];
+					__m128 res = _mm_add_ps(_mm_and_ps(ar, wMask), _mm_mul_ps(bx, _mm_shuffle_ps(ar, ar, _MM_SHUFFLE(0, 0, 0, 0))));
+					res = _mm_add_ps(res, _mm_mul_ps(by, _mm_shuffle_ps(ar, ar, _MM_SHUFFLE(1, 1, 1, 1))));
+					res = _mm_add_ps(res, _mm_mul_ps(bz, _mm_shuffle_ps(ar, ar, _MM_SHUFFLE(2, 2, 2, 2))));
+					rows[r] = res;
+				}
+
+				_mm_storeu_ps(&out.x.x, rows[0]);
+				_mm_storeu_ps(&out.y.x, rows[1]);
+				_mm_storeu_ps(&out.z.x, rows[2]);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX2 inline void mulAVX2(const Affine3x4& a, const Affine3x4& b, Affine3x4& out)
+			{
+				const __m256 wMask = _mm256_castsi256_ps(_mm256_setr_epi32(0, 0, 0, -1, 0, 0, 0, -1));
+
+				__m256 bx = _mm256_broadcast_ps((const __m128*)&b.x.x);
+				__m256 by = _mm256_broadcast_ps((const __m128*)&b.y.x);
+				__m256 bz = _mm256_broadcast_ps((const __m128*)&b.z.x);
+
+				__m256 a01 = _mm256_loadu_ps(&a.x.x);
+				__m128 a2 = _mm_loadu_ps(&a.z.x);
+
+				__m256 r01 = _mm256_fmadd_ps(bx, _mm256_shuffle_ps(a01, a01, _MM_SHUFFLE(0, 0, 0, 0)), _mm256_and_ps(a01, wMask));
+				r01 = _mm256_fmadd_ps(by, _mm256_shuffle_ps(a01, a01, _MM_SHUFFLE(1, 1, 1, 1)), r01);
+				r01 = _mm256_fmadd_ps(bz, _mm256_shuffle_ps(a01, a01, _MM_SHUFFLE(2, 2, 2, 2)), r01);
+
+				__m128 r2 = _mm_fmadd_ps(_mm256_castps256_ps128(bx), _mm_shuffle_ps(a2, a2, _MM_SHUFFLE(0, 0, 0, 0)), _mm_and_ps(a2, _mm256_castps256_ps128(wMask)));
+				r2 = _mm_fmadd_ps(_mm256_castps256_ps128(by), _mm_shuffle_ps(a2, a2, _MM_SHUFFLE(1, 1, 1, 1)), r2);
+				r2 = _mm_fmadd_ps(_mm256_castps256_ps128(bz), _mm_shuffle_ps(a2, a2, _MM_SHUFFLE(2, 2, 2, 2)), r2);
+
+				_mm256_storeu_ps(&out.x.x, r01);
+				_mm_storeu_ps(&out.z.x, r2);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX512 inline void mulAVX512(const Affine3x4& a, const Affine3x4& b, Affine3x4& out)
+			{
+				__m512 bx = _mm512_broadcast_f32x4(_mm_loadu_ps(&b.x.x));
+				__m512 by = _mm512_broadcast_f32x4(_mm_loadu_ps(&b.y.x));
+				__m512 bz = _mm512_broadcast_f32x4(_mm_loadu_ps(&b.z.x));
+
+				__m512 m = _mm512_maskz_loadu_ps(0x0fff, &a.x.x);
+
+				__m512 r = _mm512_fmadd_ps(bx, _mm512_permute_ps(m, _MM_SHUFFLE(0, 0, 0, 0)), _mm512_maskz_mov_ps(0x8888, m));
+				r = _mm512_fmadd_ps(by, _mm512_permute_ps(m, _MM_SHUFFLE(1, 1, 1, 1)), r);
+				r = _mm512_fmadd_ps(bz, _mm512_permute_ps(m, _MM_SHUFFLE(2, 2, 2, 2)), r);
+
+				_mm512_mask_storeu_ps(&out.x.x, 0x0fff, r);
+			}
+
+			//===================================================================== batches
+
+			ALFAR_TARGET_SSE2 inline void mulSSE2(const Affine3x4* a, const Affine3x4* b, Affine3x4* out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+					mulSSE2(a[i], b[i], out[i]);
+			}
+
+			ALFAR_TARGET_AVX2 inline void mulAVX2(const Affine3x4* a, const Affine3x4* b, Affine3x4* out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+					mulAVX2(a[i], b[i], out[i]);
+			}
+
+			ALFAR_TARGET_AVX512 inline void mulAVX512(const Affine3x4* a, const Affine3x4* b, Affine3x4* out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+					mulAVX512(a[i], b[i], out[i]);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_SSE2 inline void propagateSSE2(const Affine3x4* p_Locals, const int32_t* p_Parents, Affine3x4* p_Out, uint32_t p_Start, uint32_t p_End)
+			{
+				for(uint32_t i = p_Start; i < p_End; ++i)
+				{
+					if(p_Parents[i] < 0)
+						p_Out[i] = p_Locals[i];
+					else
+						mulSSE2(p_Out[p_Parents[i]], p_Locals[i], p_Out[i]);
+				}
+			}
+
+			ALFAR_TARGET_AVX2 inline void propagateAVX2(const Affine3x4* p_Locals, const int32_t* p_Parents, Affine3x4* p_Out, uint32_t p_Start, uint32_t p_End)
+			{
+				for(uint32_t i = p_Start; i < p_End; ++i)
+				{
+					if(p_Parents[i] < 0)
+						p_Out[i] = p_Locals[i];
+					else
+						mulAVX2(p_Out[p_Parents[i]], p_Locals[i], p_Out[i]);
+				}
+			}
+
+			ALFAR_TARGET_AVX512 inline void propagateAVX512(const Affine3x4* p_Locals, const int32_t* p_Parents, Affine3x4* p_Out, uint32_t p_Start, uint32_t p_End)
+			{
+				for(uint32_t i = p_Start; i < p_End; ++i)
+				{
+					if(p_Parents[i] < 0)
+						p_Out[i] = p_Locals[i];
+					else
+						mulAVX512(p_Out[p_Parents[i]], p_Locals[i], p_Out[i]);
+				}
+			}
+
+			//===================================================================== inverse
+
+			//as mat4x4::simd::affineInverseSSE2: the columns of R^-1 are the cross products of
+			//the rows of R over det(R) (or the rows themselves when RIGID), t' = -R^-1 t, and a
+			//transpose of (c0, c1, c2, t') gives the 3 result rows.
+			template<bool RIGID>
+			ALFAR_TARGET_SSE2 inline void inverseSSE2(const Affine3x4& m, Affine3x4& out)
+			{
+				const __m128 xyzMask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+
+				__m128 r0 = _mm_loadu_ps(&m.x.x);
+				__m128 r1 = _mm_loadu_ps(&m.y.x);
+				__m128 r2 = _mm_loadu_ps(&m.z.x);
+
+				__m128 tx = _mm_shuffle_ps(r0, r0, _MM_SHUFFLE(3, 3, 3, 3));
+				__m128 ty = _mm_shuffle_ps(r1, r1, _MM_SHUFFLE(3, 3, 3, 3));
+				__m128 tz = _mm_shuffle_ps(r2, r2, _MM_SHUFFLE(3, 3, 3, 3));
+
+				r0 = _mm_and_ps(r0, xyzMask);
+				r1 = _mm_and_ps(r1, xyzMask);
+				r2 = _mm_and_ps(r2, xyzMask);
+
+				__m128 c0 = r0, c1 = r1, c2 = r2;
+
+				if(!RIGID)
+				{
+					//a x b = a.yzx * b.zxy - a.zxy * b.yzx
+					__m128 r0yzx = _mm_shuffle_ps(r0, r0, _MM_SHUFFLE(3, 0, 2, 1));
+					__m128 r1yzx = _mm_shuffle_ps(r1, r1, _MM_SHUFFLE(3, 0, 2, 1));
+					__m128 r2yzx = _mm_shuffle_ps(r2, r2, _MM_SHUFFLE(3, 0, 2, 1));
+					__m128 r0zxy = _mm_shuffle_ps(r0, r0, _MM_SHUFFLE(3, 1, 0, 2));
+					__m128 r1zxy = _mm_shuffle_ps(r1, r1, _MM_SHUFFLE(3, 1, 0, 2));
+					__m128 r2zxy = _mm_shuffle_ps(r2, r2, _MM_SHUFFLE(3, 1, 0, 2));
+
+					c0 = _mm_sub_ps(_mm_mul_ps(r1yzx, r2zxy), _mm_mul_ps(r1zxy, r2yzx));
+					c1 = _mm_sub_ps(_mm_mul_ps(r2yzx, r0zxy), _mm_mul_ps(r2zxy, r0yzx));
+					c2 = _mm_sub_ps(_mm_mul_ps(r0yzx, r1zxy), _mm_mul_ps(r0zxy, r1yzx));
+
+					__m128 d = _mm_mul_ps(r0, c0);
+					d = _mm_add_ps(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(2, 3, 0, 1)));
+					d = _mm_add_ps(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(1, 0, 3, 2)));
+
+					__m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), d);
+					c0 = _mm_mul_ps(c0, invDet);
+					c1 = _mm_mul_ps(c1, invDet);
+					c2 = _mm_mul_ps(c2, invDet);
+				}
+
+				__m128 c3 = _mm_sub_ps(_mm_setzero_ps(), _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, tx), _mm_mul_ps(c1, ty)), _mm_mul_ps(c2, tz)));
+
+				_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+				_mm_storeu_ps(&out.x.x, c0);
+				_mm_storeu_ps(&out.y.x, c1);
+				_mm_storeu_ps(&out.z.x, c2);
+			}
+
+			template<bool RIGID>
+			ALFAR_TARGET_SSE2 inline void inverseSSE2(const Affine3x4* p_In, Affine3x4* p_Out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+					inverseSSE2<RIGID>(p_In[i], p_Out[i]);
+			}
+
+#endif
+		}
+	}
+}
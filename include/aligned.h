@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+namespace alfar
+{
+	namespace aligned
+	{
+		const size_t CACHE_LINE = 64;
+
+		//floats per widest SIMD register (AVX-512): padding arrays to this needs no scalar tail.
+		const uint32_t SIMD_WIDTH = 16;
+
+		//---------------------------------------------------------------------
+
+		inline void* allocate(size_t p_Size, size_t p_Alignment = CACHE_LINE)
+		{
+#if defined(_MSC_VER)
+			return _aligned_malloc(p_Size, p_Alignment);
+#else
+			void* ptr = NULL;
+			if(posix_memalign(&ptr, p_Alignment, p_Size) != 0)
+				return NULL;
+
+			return ptr;
+#endif
+		}
+
+		inline void release(void* p_Ptr)
+		{
+#if defined(_MSC_VER)
+			_aligned_free(p_Ptr);
+#else
+			free(p_Ptr);
+#endif
+		}
+
+		//---------------------------------------------------------------------
+
+		//p_Number rounded up to a multiple of p_Multiple; wraps to 0 past the last
+		//multiple below 2^32 (arena::arrayBytes pads in size_t instead)
+		inline uint32_t paddedCount(uint32_t p_Number, uint32_t p_Multiple = SIMD_WIDTH)
+		{
+			return (p_Number + p_Multiple - 1) / p_Multiple * p_Multiple;
+		}
+	}
+}
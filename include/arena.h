@@ -0,0 +1,213 @@
+#pragma once
+
+#include "aligned.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Allocators for the arrays given to the array functions. Every allocation
+// starts on a cache line and arrays of n elements get room for
+// aligned::paddedCount(n) of them, the tail zeroed: the SIMD loads never split
+// a cache line, and calling an array function over the padded count runs no
+// scalar tail (the padding elements are computed and ignored).
+//
+// An Arena hands out memory from one block by bumping an offset, with no
+// header or per allocation bookkeeping, and reset frees everything at once
+// (per frame scratch). mark and rewind free what was allocated after a mark.
+// A Pool hands out blocks of one size from a free list stored in the free
+// blocks themselves, for arrays that outlive a frame. Neither grows, an
+// allocation that does not fit returns NULL, and neither is thread safe: one
+// per thread, or one per job.
+
+namespace alfar
+{
+	struct Arena
+	{
+		char* base;
+		size_t capacity;		//bytes
+		size_t used;			//bytes handed out since the last reset, a multiple of aligned::CACHE_LINE
+	};
+
+	struct Pool
+	{
+		char* base;
+		size_t blockSize;		//bytes, a multiple of aligned::CACHE_LINE
+		uint32_t blockCount;
+		void* free;				//first free block, which holds the next one
+	};
+
+	namespace arena
+	{
+		//bytes of an array of p_Number T once padded, whole cache lines for any T made
+		//of floats; (size_t)-1, which no arena or pool fits, when that overflows size_t
+		template<typename T>
+		inline size_t arrayBytes(uint32_t p_Number)
+		{
+			static_assert(sizeof(T) % sizeof(float) == 0, "arena arrays hold float based types");
+
+			//in size_t, paddedCount wraps past 2^32 - SIMD_WIDTH
+			size_t padded = ((size_t)p_Number + aligned::SIMD_WIDTH - 1) / aligned::SIMD_WIDTH * aligned::SIMD_WIDTH;
+			if(padded < p_Number || padded > ((size_t)-1 - (aligned::CACHE_LINE - 1)) / sizeof(T))
+				return (size_t)-1;
+
+			size_t bytes = padded * sizeof(T);
+			return (bytes + aligned::CACHE_LINE - 1) / aligned::CACHE_LINE * aligned::CACHE_LINE;
+		}
+
+		//---------------------------------------------------------------------
+
+		//capacity 0 when the memory cannot be allocated
+		inline Arena create(size_t p_Capacity)
+		{
+			Arena ret = {};
+			if(p_Capacity > (size_t)-1 - (aligned::CACHE_LINE - 1))
+				return ret;
+
+			ret.capacity = (p_Capacity + aligned::CACHE_LINE - 1) / aligned::CACHE_LINE * aligned::CACHE_LINE;
+			ret.base = (char*)aligned::allocate(ret.capacity);
+			ret.capacity = ret.base != NULL ? ret.capacity : 0;
+			ret.used = 0;
+
+			return ret;
+		}
+
+		inline void destroy(Arena& p_Arena)
+		{
+			aligned::release(p_Arena.base);
+
+			p_Arena.base = NULL;
+			p_Arena.capacity = 0;
+			p_Arena.used = 0;
+		}
+
+		inline void reset(Arena& p_Arena)
+		{
+			p_Arena.used = 0;
+		}
+
+		inline size_t mark(const Arena& p_Arena)
+		{
+			return p_Arena.used;
+		}
+
+		//frees everything allocated since p_Mark was taken
+		inline void rewind(Arena& p_Arena, size_t p_Mark)
+		{
+			p_Arena.used = p_Mark;
+		}
+
+		//---------------------------------------------------------------------
+
+		//p_Size bytes on a cache line, NULL when the arena is full
+		inline void* allocate(Arena& p_Arena, size_t p_Size)
+		{
+			//the space left is whole cache lines, so rounding a size that fits cannot wrap
+			if(p_Size > p_Arena.capacity - p_Arena.used)
+				return NULL;
+
+			size_t size = (p_Size + aligned::CACHE_LINE - 1) / aligned::CACHE_LINE * aligned::CACHE_LINE;
+
+			void* ret = p_Arena.base + p_Arena.used;
+			p_Arena.used += size;
+
+			return ret;
+		}
+
+		//p_Number T, uninitialized, followed by zeroed padding up to arrayBytes<T>(p_Number)
+		template<typename T>
+		inline T* allocateArray(Arena& p_Arena, uint32_t p_Number)
+		{
+			size_t bytes = arrayBytes<T>(p_Number);
+
+			T* ret = (T*)allocate(p_Arena, bytes);
+			if(ret != NULL)
+				memset(ret + p_Number, 0, bytes - p_Number * sizeof(T));
+
+			return ret;
+		}
+	}
+
+	namespace pool
+	{
+		//p_BlockCount blocks of p_BlockSize bytes (at least a cache line, which holds
+		//the free list link), no blocks when the memory cannot be allocated
+		inline Pool create(size_t p_BlockSize, uint32_t p_BlockCount)
+		{
+			Pool ret = {};
+			if(p_BlockSize > (size_t)-1 - (aligned::CACHE_LINE - 1))
+				return ret;
+
+			ret.blockSize = (p_BlockSize + aligned::CACHE_LINE - 1) / aligned::CACHE_LINE * aligned::CACHE_LINE;
+			ret.blockSize = ret.blockSize != 0 ? ret.blockSize : aligned::CACHE_LINE;
+			if(p_BlockCount != 0 && ret.blockSize > (size_t)-1 / p_BlockCount)
+				return ret;
+
+			ret.base = p_BlockCount != 0 ? (char*)aligned::allocate(ret.blockSize * p_BlockCount) : NULL;
+			ret.blockCount = ret.base != NULL ? p_BlockCount : 0;
+			ret.free = NULL;
+
+			//free list in address order
+			for(uint32_t b = ret.blockCount; b > 0; --b)
+			{
+				void* block = ret.base + (size_t)(b - 1) * ret.blockSize;
+				*(void**)block = ret.free;
+				ret.free = block;
+			}
+
+			return ret;
+		}
+
+		//blocks holding an array of up to p_MaxNumber T, padded as in the arena
+		template<typename T>
+		inline Pool createForArrays(uint32_t p_MaxNumber, uint32_t p_BlockCount)
+		{
+			return create(arena::arrayBytes<T>(p_MaxNumber), p_BlockCount);
+		}
+
+		inline void destroy(Pool& p_Pool)
+		{
+			aligned::release(p_Pool.base);
+
+			p_Pool.base = NULL;
+			p_Pool.blockCount = 0;
+			p_Pool.free = NULL;
+		}
+
+		//---------------------------------------------------------------------
+
+		//one uninitialized block on a cache line, NULL when they are all taken
+		inline void* allocate(Pool& p_Pool)
+		{
+			void* ret = p_Pool.free;
+			if(ret != NULL)
+				p_Pool.free = *(void**)ret;
+
+			return ret;
+		}
+
+		inline void release(Pool& p_Pool, void* p_Block)
+		{
+			if(p_Block == NULL)
+				return;
+
+			*(void**)p_Block = p_Pool.free;
+			p_Pool.free = p_Block;
+		}
+
+		//an array of p_Number T (at most the count of createForArrays), uninitialized,
+		//followed by zeroed padding up to arena::arrayBytes<T>(p_Number)
+		template<typename T>
+		inline T* allocateArray(Pool& p_Pool, uint32_t p_Number)
+		{
+			size_t bytes = arena::arrayBytes<T>(p_Number);
+			if(bytes > p_Pool.blockSize)
+				return NULL;
+
+			T* ret = (T*)allocate(p_Pool);
+			if(ret != NULL)
+				memset(ret + p_Number, 0, bytes - p_Number * sizeof(T));
+
+			return ret;
+		}
+	}
+}
@@ -0,0 +1,378 @@
+#pragma once
+
+#include "cpu.h"
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+// SIMD kernels shared by aabb.h (D = 3) and rect.h (D = 2).
+//
+// Both work on the AoS arrays as flat float streams, in blocks of
+// lcm(floats per element, floats per register) floats, repeated for enough
+// work per iteration: every float of a block
+// then sits at a fixed register lane, so its component is known at compile
+// time and no shuffle is needed.
+//  - bounds: per lane min/max over the points, reduced per component at the end.
+//  - overlap: a box is 2*D floats (min then max). Each float is compared
+//    against the query (min <= query max, max >= query min), the compare
+//    masks of a block are packed into one integer and every box of the block
+//    tests its 2*D bits. Results are bits i % 32 of p_Out[i / 32].
+
+namespace alfar
+{
+	namespace bounds
+	{
+		namespace simd
+		{
+			template<uint32_t A, uint32_t B>
+			struct Gcd { enum { value = Gcd<B, A % B>::value }; };
+
+			template<uint32_t A>
+			struct Gcd<A, 0> { enum { value = A }; };
+
+			//a block for elements of FLOATS floats and registers of WIDTH floats,
+			//repeated to hold at least MIN_ELEMENTS elements
+			template<uint32_t FLOATS, uint32_t WIDTH, uint32_t MIN_ELEMENTS>
+			struct Block
+			{
+				enum
+				{
+					lcm = FLOATS * WIDTH / Gcd<FLOATS, WIDTH>::value,
+					repeat = lcm / FLOATS >= MIN_ELEMENTS ? 1 : MIN_ELEMENTS / (lcm / FLOATS),
+					size = lcm * repeat,
+					registers = size / WIDTH,
+					elements = size / FLOATS
+				};
+			};
+
+			//8 boxes per block for the overlaps: whole bytes of the output words,
+			//at most 48 compare bits
+			const uint32_t OVERLAP_BOXES = 8;
+
+			//===================================================================== scalar
+
+			//grows p_Min/p_Max (D floats each) by the points [p_Start, p_Count) of p
+			template<int D>
+			inline void boundsScalar(const float* p, float* p_Min, float* p_Max, uint32_t p_Start, uint32_t p_Count)
+			{
+				for(uint32_t i = p_Start; i < p_Count; ++i)
+				{
+					for(int c = 0; c < D; ++c)
+					{
+						float v = p[i * D + c];
+						p_Min[c] = v < p_Min[c] ? v : p_Min[c];
+						p_Max[c] = v > p_Max[c] ? v : p_Max[c];
+					}
+				}
+			}
+
+			//p_Box and p_Boxes[i] are D min then D max floats, p_Out bits are set, never cleared
+			template<int D>
+			inline void overlapScalar(const float* p_Box, const float* p_Boxes, uint32_t* p_Out, uint32_t p_Start, uint32_t p_Count)
+			{
+				for(uint32_t i = p_Start; i < p_Count; ++i)
+				{
+					const float* b = p_Boxes + i * 2 * D;
+
+					bool hit = true;
+					for(int c = 0; c < D; ++c)
+						hit = hit && b[c] <= p_Box[D + c] && b[D + c] >= p_Box[c];
+
+					if(hit)
+						p_Out[i >> 5] |= 1u << (i & 31);
+				}
+			}
+
+			//---------------------------------------------------------------------
+
+			//per float limits of a block: float k of a box passes if p_Low[k] <= v <= p_High[k]
+			template<int D>
+			inline void overlapLimits(const float* p_Box, float* p_Low, float* p_High, uint32_t p_Size)
+			{
+				for(uint32_t k = 0; k < p_Size; ++k)
+				{
+					uint32_t field = k % (2 * D);
+					bool isMin = field < (uint32_t)D;
+
+					p_Low[k] = isMin ? -INFINITY : p_Box[field - D];
+					p_High[k] = isMin ? p_Box[D + field] : INFINITY;
+				}
+			}
+
+			//p_Mask holds the compare bits of BOXES boxes starting at box p_First
+			template<int D, int BOXES>
+			inline void writeOverlaps(uint64_t p_Mask, uint32_t* p_Out, uint32_t p_First)
+			{
+				const uint64_t full = (1u << (2 * D)) - 1;
+
+				uint32_t bits = 0;
+				for(int b = 0; b < BOXES; ++b)
+					bits |= (((p_Mask >> (2 * D * b)) & full) == full ? 1u : 0u) << b;
+
+				p_Out[p_First >> 5] |= bits << (p_First & 31);
+			}
+
+#if ALFAR_X86
+
+			//===================================================================== SSE2
+
+			template<int D>
+			ALFAR_TARGET_SSE2 inline void boundsSSE2(const float* p, float* p_Min, float* p_Max, uint32_t p_Start, uint32_t p_Count)
+			{
+				typedef Block<D, 4, 2 * 4> B;
+
+				__m128 lo[B::registers], hi[B::registers];
+				for(int r = 0; r < B::registers; ++r)
+				{
+					lo[r] = _mm_set1_ps(INFINITY);
+					hi[r] = _mm_set1_ps(-INFINITY);
+				}
+
+				uint32_t i = p_Start;
+				for(; i + B::elements <= p_Count; i += B::elements)
+				{
+					for(int r = 0; r < B::registers; ++r)
+					{
+						__m128 v = _mm_loadu_ps(p + i * D + r * 4);
+						lo[r] = _mm_min_ps(lo[r], v);
+						hi[r] = _mm_max_ps(hi[r], v);
+					}
+				}
+
+				float l[B::size], h[B::size];
+				for(int r = 0; r < B::registers; ++r)
+				{
+					_mm_storeu_ps(l + r * 4, lo[r]);
+					_mm_storeu_ps(h + r * 4, hi[r]);
+				}
+
+				for(uint32_t k = 0; k < (uint32_t)B::size; ++k)
+				{
+					p_Min[k % D] = l[k] < p_Min[k % D] ? l[k] : p_Min[k % D];
+					p_Max[k % D] = h[k] > p_Max[k % D] ? h[k] : p_Max[k % D];
+				}
+
+				boundsScalar<D>(p, p_Min, p_Max, i, p_Count);
+			}
+
+			template<int D>
+			ALFAR_TARGET_SSE2 inline void overlapSSE2(const float* p_Box, const float* p_Boxes, uint32_t* p_Out, uint32_t p_Start, uint32_t p_Count)
+			{
+				typedef Block<2 * D, 4, OVERLAP_BOXES> B;
+
+				float l[B::size], h[B::size];
+				overlapLimits<D>(p_Box, l, h, B::size);
+
+				__m128 low[B::registers], high[B::registers];
+				for(int r = 0; r < B::registers; ++r)
+				{
+					low[r] = _mm_loadu_ps(l + r * 4);
+					high[r] = _mm_loadu_ps(h + r * 4);
+				}
+
+				uint32_t i = p_Start;
+				for(; i + B::elements <= p_Count; i += B::elements)
+				{
+					uint64_t mask = 0;
+					for(int r = 0; r < B::registers; ++r)
+					{
+						__m128 v = _mm_loadu_ps(p_Boxes + i * 2 * D + r * 4);
+						__m128 pass = _mm_and_ps(_mm_cmple_ps(low[r], v), _mm_cmple_ps(v, high[r]));
+						mask |= (uint64_t)_mm_movemask_ps(pass) << (r * 4);
+					}
+
+					writeOverlaps<D, B::elements>(mask, p_Out, i);
+				}
+
+				overlapScalar<D>(p_Box, p_Boxes, p_Out, i, p_Count);
+			}
+
+			//===================================================================== AVX2
+
+			template<int D>
+			ALFAR_TARGET_AVX2 inline void boundsAVX2(const float* p, float* p_Min, float* p_Max, uint32_t p_Start, uint32_t p_Count)
+			{
+				typedef Block<D, 8, 2 * 8> B;
+
+				__m256 lo[B::registers], hi[B::registers];
+				for(int r = 0; r < B::registers; ++r)
+				{
+					lo[r] = _mm256_set1_ps(INFINITY);
+					hi[r] = _mm256_set1_ps(-INFINITY);
+				}
+
+				uint32_t i = p_Start;
+				for(; i + B::elements <= p_Count; i += B::elements)
+				{
+					for(int r = 0; r < B::registers; ++r)
+					{
+						__m256 v = _mm256_loadu_ps(p + i * D + r * 8);
+						lo[r] = _mm256_min_ps(lo[r], v);
+						hi[r] = _mm256_max_ps(hi[r], v);
+					}
+				}
+
+				float l[B::size], h[B::size];
+				for(int r = 0; r < B::registers; ++r)
+				{
+					_mm256_storeu_ps(l + r * 8, lo[r]);
+					_mm256_storeu_ps(h + r * 8, hi[r]);
+				}
+
+				for(uint32_t k = 0; k < (uint32_t)B::size; ++k)
+				{
+					p_Min[k % D] = l[k] < p_Min[k % D] ? l[k] : p_Min[k % D];
+					p_Max[k % D] = h[k] > p_Max[k % D] ? h[k] : p_Max[k % D];
+				}
+
+				boundsSSE2<D>(p, p_Min, p_Max, i, p_Count);
+			}
+
+			template<int D>
+			ALFAR_TARGET_AVX2 inline void overlapAVX2(const float* p_Box, const float* p_Boxes, uint32_t* p_Out, uint32_t p_Start, uint32_t p_Count)
+			{
+				typedef Block<2 * D, 8, OVERLAP_BOXES> B;
+
+				float l[B::size], h[B::size];
+				overlapLimits<D>(p_Box, l, h, B::size);
+
+				__m256 low[B::registers], high[B::registers];
+				for(int r = 0; r < B::registers; ++r)
+				{
+					low[r] = _mm256_loadu_ps(l + r * 8);
+					high[r] = _mm256_loadu_ps(h + r * 8);
+				}
+
+				uint32_t i = p_Start;
+				for(; i + B::elements <= p_Count; i += B::elements)
+				{
+					uint64_t mask = 0;
+					for(int r = 0; r < B::registers; ++r)
+					{
+						__m256 v = _mm256_loadu_ps(p_Boxes + i * 2 * D + r * 8);
+						__m256 pass = _mm256_and_ps(_mm256_cmp_ps(low[r], v, _CMP_LE_OQ), _mm256_cmp_ps(v, high[r], _CMP_LE_OQ));
+						mask |= (uint64_t)_mm256_movemask_ps(pass) << (r * 8);
+					}
+
+					writeOverlaps<D, B::elements>(mask, p_Out, i);
+				}
+
+				overlapSSE2<D>(p_Box, p_Boxes, p_Out, i, p_Count);
+			}
+
+			//===================================================================== AVX-512
+
+			template<int D>
+			ALFAR_TARGET_AVX512 inline void boundsAVX512(const float* p, float* p_Min, float* p_Max, uint32_t p_Start, uint32_t p_Count)
+			{
+				typedef Block<D, 16, 2 * 16> B;
+
+				__m512 lo[B::registers], hi[B::registers];
+				for(int r = 0; r < B::registers; ++r)
+				{
+					lo[r] = _mm512_set1_ps(INFINITY);
+					hi[r] = _mm512_set1_ps(-INFINITY);
+				}
+
+				uint32_t i = p_Start;
+				for(; i + B::elements <= p_Count; i += B::elements)
+				{
+					for(int r = 0; r < B::registers; ++r)
+					{
+						__m512 v = _mm512_loadu_ps(p + i * D + r * 16);
+						lo[r] = _mm512_min_ps(lo[r], v);
+						hi[r] = _mm512_max_ps(hi[r], v);
+					}
+				}
+
+				float l[B::size], h[B::size];
+				for(int r = 0; r < B::registers; ++r)
+				{
+					_mm512_storeu_ps(l + r * 16, lo[r]);
+					_mm512_storeu_ps(h + r * 16, hi[r]);
+				}
+
+				for(uint32_t k = 0; k < (uint32_t)B::size; ++k)
+				{
+					p_Min[k % D] = l[k] < p_Min[k % D] ? l[k] : p_Min[k % D];
+					p_Max[k % D] = h[k] > p_Max[k % D] ? h[k] : p_Max[k % D];
+				}
+
+				boundsAVX2<D>(p, p_Min, p_Max, i, p_Count);
+			}
+
+			template<int D>
+			ALFAR_TARGET_AVX512 inline void overlapAVX512(const float* p_Box, const float* p_Boxes, uint32_t* p_Out, uint32_t p_Start, uint32_t p_Count)
+			{
+				typedef Block<2 * D, 16, OVERLAP_BOXES> B;
+
+				float l[B::size], h[B::size];
+				overlapLimits<D>(p_Box, l, h, B::size);
+
+				__m512 low[B::registers], high[B::registers];
+				for(int r = 0; r < B::registers; ++r)
+				{
+					low[r] = _mm512_loadu_ps(l + r * 16);
+					high[r] = _mm512_loadu_ps(h + r * 16);
+				}
+
+				uint32_t i = p_Start;
+				for(; i + B::elements <= p_Count; i += B::elements)
+				{
+					uint64_t mask = 0;
+					for(int r = 0; r < B::registers; ++r)
+					{
+						__m512 v = _mm512_loadu_ps(p_Boxes + i * 2 * D + r * 16);
+						__mmask16 pass = _mm512_cmp_ps_mask(low[r], v, _CMP_LE_OQ) & _mm512_cmp_ps_mask(v, high[r], _CMP_LE_OQ);
+						mask |= (uint64_t)pass << (r * 16);
+					}
+
+					writeOverlaps<D, B::elements>(mask, p_Out, i);
+				}
+
+				overlapAVX2<D>(p_Box, p_Boxes, p_Out, i, p_Count);
+			}
+
+#endif
+
+			//===================================================================== dispatch
+
+			template<int D>
+			inline void bounds(const float* p, float* p_Min, float* p_Max, uint32_t p_Count)
+			{
+				for(int c = 0; c < D; ++c)
+				{
+					p_Min[c] = INFINITY;
+					p_Max[c] = -INFINITY;
+				}
+
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	boundsAVX512<D>(p, p_Min, p_Max, 0, p_Count); return;
+				case cpu::LEVEL_AVX2:	boundsAVX2<D>(p, p_Min, p_Max, 0, p_Count); return;
+				case cpu::LEVEL_SSE2:	boundsSSE2<D>(p, p_Min, p_Max, 0, p_Count); return;
+#endif
+				default:				boundsScalar<D>(p, p_Min, p_Max, 0, p_Count); return;
+				}
+			}
+
+			//p_Out holds (p_Count + 31) / 32 words, overwritten
+			template<int D>
+			inline void overlap(const float* p_Box, const float* p_Boxes, uint32_t* p_Out, uint32_t p_Count)
+			{
+				memset(p_Out, 0, (p_Count + 31) / 32 * sizeof(uint32_t));
+
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	overlapAVX512<D>(p_Box, p_Boxes, p_Out, 0, p_Count); return;
+				case cpu::LEVEL_AVX2:	overlapAVX2<D>(p_Box, p_Boxes, p_Out, 0, p_Count); return;
+				case cpu::LEVEL_SSE2:	overlapSSE2<D>(p_Box, p_Boxes, p_Out, 0, p_Count); return;
+#endif
+				default:				overlapScalar<D>(p_Box, p_Boxes, p_Out, 0, p_Count); return;
+				}
+			}
+		}
+	}
+}
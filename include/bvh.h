@@ -0,0 +1,479 @@
+#pragma once
+
+#include "math_types.h"
+#include "aligned.h"
+#include "vector3.h"
+#include "aabb.h"
+#include "parallel.h"
+#include <math.h>
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+// Bounding volume hierarchy over an array of AABB (one per primitive).
+//
+// build is a top down binned SAH builder: each node bins the centroids of its
+// primitives on the axis of largest centroid extent and splits at the bin
+// boundary of lowest surface area cost, or stays a leaf when that is cheaper
+// (up to MAX_LEAF_SIZE primitives). With a parallel::Policy the top levels
+// are built on the calling thread and the subtrees below them on the pool,
+// a few per participant so the stealing evens out unbalanced splits.
+//
+// Nodes are flattened in one 64 bytes aligned array: the root is node 0, node
+// 1 is padding and the two children of a node are allocated together, so
+// siblings (which are always tested together) share a cache line. A child is
+// always stored after its parent, which refit uses to go bottom up in one
+// reverse pass.
+//
+// Queries take the primitive boxes the hierarchy was built (or refit) with.
+// raycast finds the nearest hit visiting the nearest child first and skipping
+// nodes entered beyond the current best; the overlap queries write the
+// indices of the primitives found, in no particular order.
+
+namespace alfar
+{
+	namespace bvh
+	{
+		const uint32_t BINS = 16;
+		const uint32_t MAX_LEAF_SIZE = 8;
+		const uint32_t MAX_DEPTH = 60;			//nodes deeper become leaves, query stacks hold MAX_DEPTH + 4 nodes
+		const uint32_t STACK_SIZE = MAX_DEPTH + 4;
+		const uint32_t PARALLEL_MIN = 4096;		//smallest subtree built as its own pool item
+		const uint32_t SUBTREES_PER_THREAD = 4;
+
+		//---------------------------------------------------------------------
+
+		//half the surface area, enough to compare SAH costs
+		ALFAR_CONSTEXPR float halfArea(const AABB& p_Box)
+		{
+			return (p_Box.max.x - p_Box.min.x) * (p_Box.max.y - p_Box.min.y)
+				 + (p_Box.max.y - p_Box.min.y) * (p_Box.max.z - p_Box.min.z)
+				 + (p_Box.max.z - p_Box.min.z) * (p_Box.max.x - p_Box.min.x);
+		}
+
+		//a primitive during the build, moved around by the partitions so each
+		//node reads its primitives contiguously
+		struct Reference
+		{
+			AABB bounds;
+			uint32_t index;
+			uint32_t bin;			//bin of the current split
+		};
+
+		//centroid times 2
+		ALFAR_CONSTEXPR float centroid(const Reference& p_Reference, int p_Axis)
+		{
+			return (&p_Reference.bounds.min.x)[p_Axis] + (&p_Reference.bounds.max.x)[p_Axis];
+		}
+
+		//a node left for the pool by the top levels of the build
+		struct Subtree
+		{
+			uint32_t node, first, count;
+			AABB bounds, centers;
+		};
+
+		struct Builder
+		{
+			Reference* references;
+			BVHNode* nodes;
+			std::atomic<uint32_t> nodeCount;
+			uint32_t parallelDepth;			//nodes at this depth are left in subtrees, 0 builds everything in place
+			std::vector<Subtree> subtrees;
+		};
+
+		//bounds of the boxes and of their centroids (times 2)
+		inline void rangeBounds(const Reference* p_References, uint32_t p_Count, AABB& p_Bounds, AABB& p_Centers)
+		{
+			p_Bounds = aabb::empty();
+			p_Centers = aabb::empty();
+
+			for(uint32_t i = 0; i < p_Count; ++i)
+			{
+				p_Bounds = aabb::merge(p_Bounds, p_References[i].bounds);
+				p_Centers = aabb::merge(p_Centers, vector3::add(p_References[i].bounds.min, p_References[i].bounds.max));
+			}
+		}
+
+		//builds p_Node over p_Builder.references[p_First, p_First + p_Count), of bounds
+		//p_Bounds and centroid bounds p_Centers. The children bounds come from the bins.
+		inline void buildNode(Builder& p_Builder, uint32_t p_Node, uint32_t p_First, uint32_t p_Count, uint32_t p_Depth, const AABB& p_Bounds, const AABB& p_Centers)
+		{
+			Reference* references = p_Builder.references + p_First;
+
+			BVHNode& node = p_Builder.nodes[p_Node];
+			node.bounds = p_Bounds;
+			node.first = p_First;
+			node.count = p_Count;
+
+			if(p_Count == 1 || p_Depth >= MAX_DEPTH)
+				return;
+
+			Vector3 extent = aabb::size(p_Centers);
+			int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+			float low = (&p_Centers.min.x)[axis];
+			float span = (&extent.x)[axis];
+
+			uint32_t mid;
+			AABB bounds[2], centers[2];
+
+			if(span > 0)
+			{
+				//small nodes have as many bins as primitives, the bins setup and sweeps cost more than the binning there
+				uint32_t bins = p_Count < BINS ? p_Count : BINS;
+
+				AABB binBounds[BINS], binCenters[BINS];
+				uint32_t binCount[BINS];
+				for(uint32_t k = 0; k < bins; ++k)
+				{
+					binBounds[k] = binCenters[k] = aabb::empty();
+					binCount[k] = 0;
+				}
+
+				float scale = bins / span;
+				for(uint32_t i = 0; i < p_Count; ++i)
+				{
+					uint32_t k = (uint32_t)((centroid(references[i], axis) - low) * scale);
+					k = k < bins - 1 ? k : bins - 1;
+
+					references[i].bin = k;
+					binBounds[k] = aabb::merge(binBounds[k], references[i].bounds);
+					binCenters[k] = aabb::merge(binCenters[k], vector3::add(references[i].bounds.min, references[i].bounds.max));
+					binCount[k] += 1;
+				}
+
+				//cost of the split before bin k: count * area on each side
+				float rightArea[BINS];
+				uint32_t rightCount[BINS];
+				AABB side = aabb::empty();
+				uint32_t count = 0;
+				for(uint32_t k = bins - 1; k > 0; --k)
+				{
+					side = aabb::merge(side, binBounds[k]);
+					count += binCount[k];
+					rightArea[k] = count > 0 ? halfArea(side) : 0;
+					rightCount[k] = count;
+				}
+
+				float bestCost = INFINITY;
+				uint32_t bestSplit = 0;
+				side = aabb::empty();
+				count = 0;
+				for(uint32_t k = 1; k < bins; ++k)
+				{
+					side = aabb::merge(side, binBounds[k - 1]);
+					count += binCount[k - 1];
+					if(count == 0 || rightCount[k] == 0)
+						continue;
+
+					float cost = count * halfArea(side) + rightCount[k] * rightArea[k];
+					if(cost < bestCost)
+					{
+						bestCost = cost;
+						bestSplit = k;
+					}
+				}
+
+				//one traversal step plus the expected primitive tests, against testing them all
+				float splitCost = 1.0f + bestCost / halfArea(p_Bounds);
+				if(p_Count <= MAX_LEAF_SIZE && !(splitCost < (float)p_Count))
+					return;
+
+				for(int c = 0; c < 2; ++c)
+					bounds[c] = centers[c] = aabb::empty();
+
+				for(uint32_t k = 0; k < bins; ++k)
+				{
+					int c = k < bestSplit ? 0 : 1;
+					bounds[c] = aabb::merge(bounds[c], binBounds[k]);
+					centers[c] = aabb::merge(centers[c], binCenters[k]);
+				}
+
+				mid = (uint32_t)(std::partition(references, references + p_Count, [=](const Reference& p_Reference) { return p_Reference.bin < bestSplit; }) - references);
+			}
+			else
+			{
+				//all centroids at the same place: the range is split in the middle to keep leaves small
+				if(p_Count <= MAX_LEAF_SIZE)
+					return;
+
+				mid = p_Count / 2;
+				rangeBounds(references, mid, bounds[0], centers[0]);
+				rangeBounds(references + mid, p_Count - mid, bounds[1], centers[1]);
+			}
+
+			uint32_t child = p_Builder.nodeCount.fetch_add(2);
+			node.first = child;
+			node.count = 0;
+
+			for(int c = 0; c < 2; ++c)
+			{
+				uint32_t first = c == 0 ? p_First : p_First + mid;
+				uint32_t count = c == 0 ? mid : p_Count - mid;
+
+				if(p_Depth + 1 == p_Builder.parallelDepth && count >= PARALLEL_MIN)
+				{
+					Subtree subtree = { child + c, first, count, bounds[c], centers[c] };
+					p_Builder.subtrees.push_back(subtree);
+				}
+				else
+					buildNode(p_Builder, child + c, first, count, p_Depth + 1, bounds[c], centers[c]);
+			}
+		}
+
+		//---------------------------------------------------------------------
+
+		//the tree above p_ParallelDepth on the calling thread, the subtrees below on the pool of p_Policy
+		inline BVH buildTree(const parallel::Policy& p_Policy, uint32_t p_ParallelDepth, const AABB* p_Boxes, uint32_t p_Number)
+		{
+			BVH ret = {};
+			if(p_Number == 0)
+				return ret;
+
+			ret.nodes = (BVHNode*)aligned::allocate(2 * (size_t)p_Number * sizeof(BVHNode));
+			ret.indices = (uint32_t*)aligned::allocate((size_t)p_Number * sizeof(uint32_t));
+			Reference* references = (Reference*)aligned::allocate((size_t)p_Number * sizeof(Reference));
+
+			if(ret.nodes == NULL || ret.indices == NULL || references == NULL)
+			{
+				aligned::release(ret.nodes);
+				aligned::release(ret.indices);
+				aligned::release(references);
+				return BVH();
+			}
+
+			for(uint32_t i = 0; i < p_Number; ++i)
+			{
+				references[i].bounds = p_Boxes[i];
+				references[i].index = i;
+				references[i].bin = 0;
+			}
+
+			Builder builder;
+			builder.references = references;
+			builder.nodes = ret.nodes;
+			builder.nodeCount = 2;
+			builder.parallelDepth = p_ParallelDepth;
+
+			ret.nodes[1].bounds = aabb::empty();
+			ret.nodes[1].first = 0;
+			ret.nodes[1].count = 0;
+
+			AABB bounds, centers;
+			rangeBounds(references, p_Number, bounds, centers);
+			buildNode(builder, 0, 0, p_Number, 0, bounds, centers);
+
+			parallel::forEach(p_Policy, (uint32_t)builder.subtrees.size(), 1, [&](uint32_t p_Start, uint32_t p_End)
+			{
+				for(uint32_t k = p_Start; k < p_End; ++k)
+				{
+					const Subtree& t = builder.subtrees[k];
+					buildNode(builder, t.node, t.first, t.count, p_ParallelDepth, t.bounds, t.centers);
+				}
+			});
+
+			for(uint32_t i = 0; i < p_Number; ++i)
+				ret.indices[i] = references[i].index;
+
+			aligned::release(references);
+
+			ret.nodeCount = builder.nodeCount;
+			ret.primitiveCount = p_Number;
+
+			return ret;
+		}
+
+		inline BVH build(const AABB* p_Boxes, uint32_t p_Number)
+		{
+			return buildTree(parallel::policy(), 0, p_Boxes, p_Number);
+		}
+
+		//the tree of build (its nodes stored in another order), the subtrees built on the pool of p_Policy
+		inline BVH build(const parallel::Policy& p_Policy, const AABB* p_Boxes, uint32_t p_Number)
+		{
+			uint32_t depth = 0;
+			uint32_t subtrees = parallel::threadCount(p_Policy) * SUBTREES_PER_THREAD;
+			while(subtrees > (1u << depth) && (p_Number >> depth) >= 2 * PARALLEL_MIN)
+				depth += 1;
+
+			return buildTree(p_Policy, depth, p_Boxes, p_Number);
+		}
+
+		inline void destroy(BVH& p_Bvh)
+		{
+			aligned::release(p_Bvh.nodes);
+			aligned::release(p_Bvh.indices);
+
+			p_Bvh.nodes = NULL;
+			p_Bvh.indices = NULL;
+			p_Bvh.nodeCount = p_Bvh.primitiveCount = 0;
+		}
+
+		//new node bounds for moved primitives, keeping the tree. Cheap, but the
+		//queries slow down as the primitives drift from where they were built.
+		inline void refit(BVH& p_Bvh, const AABB* p_Boxes)
+		{
+			for(uint32_t n = p_Bvh.nodeCount; n-- > 0;)
+			{
+				if(n == 1)
+					continue;
+
+				BVHNode& node = p_Bvh.nodes[n];
+				if(node.count == 0)
+				{
+					node.bounds = aabb::merge(p_Bvh.nodes[node.first].bounds, p_Bvh.nodes[node.first + 1].bounds);
+					continue;
+				}
+
+				AABB bounds = aabb::empty();
+				for(uint32_t i = 0; i < node.count; ++i)
+					bounds = aabb::merge(bounds, p_Boxes[p_Bvh.indices[node.first + i]]);
+
+				node.bounds = bounds;
+			}
+		}
+
+		//----- queries
+
+		//nearest primitive hit: p_Hit(index) returns the distance along the ray to
+		//primitive index (in units of p_RayDir), negative when it is missed. The
+		//lowest index wins among equally near hits.
+		template<typename HIT>
+		inline RayHit raycast(const BVH& p_Bvh, const Vector3& p_RayOrigin, const Vector3& p_RayDir, HIT p_Hit)
+		{
+			RayHit best = { -1.0f, -1 };
+			if(p_Bvh.nodeCount == 0)
+				return best;
+
+			Vector3 inv = vector3::create(1.0f / p_RayDir.x, 1.0f / p_RayDir.y, 1.0f / p_RayDir.z);
+			float bestDistance = INFINITY;
+
+			uint32_t stack[STACK_SIZE];
+			float entry[STACK_SIZE];
+			uint32_t top = 0;
+
+			float root = aabb::rayIntersection(p_Bvh.nodes[0].bounds, p_RayOrigin, inv, bestDistance);
+			if(root >= 0)
+			{
+				stack[top] = 0;
+				entry[top++] = root;
+			}
+
+			while(top > 0)
+			{
+				--top;
+				if(entry[top] > bestDistance)
+					continue;
+
+				const BVHNode& node = p_Bvh.nodes[stack[top]];
+				if(node.count > 0)
+				{
+					for(uint32_t i = 0; i < node.count; ++i)
+					{
+						int32_t index = (int32_t)p_Bvh.indices[node.first + i];
+						float t = p_Hit((uint32_t)index);
+
+						if(t >= 0 && (t < bestDistance || (t == bestDistance && index < best.index)))
+						{
+							bestDistance = t;
+							best.distance = t;
+							best.index = index;
+						}
+					}
+
+					continue;
+				}
+
+				float nearEntry = aabb::rayIntersection(p_Bvh.nodes[node.first].bounds, p_RayOrigin, inv, bestDistance);
+				float farEntry = aabb::rayIntersection(p_Bvh.nodes[node.first + 1].bounds, p_RayOrigin, inv, bestDistance);
+				uint32_t nearNode = node.first, farNode = node.first + 1;
+
+				if(farEntry >= 0 && (nearEntry < 0 || farEntry < nearEntry))
+				{
+					std::swap(nearEntry, farEntry);
+					std::swap(nearNode, farNode);
+				}
+
+				//the nearest one on top
+				if(farEntry >= 0)
+				{
+					stack[top] = farNode;
+					entry[top++] = farEntry;
+				}
+
+				if(nearEntry >= 0)
+				{
+					stack[top] = nearNode;
+					entry[top++] = nearEntry;
+				}
+			}
+
+			return best;
+		}
+
+		//nearest primitive box hit
+		inline RayHit raycast(const BVH& p_Bvh, const AABB* p_Boxes, const Vector3& p_RayOrigin, const Vector3& p_RayDir)
+		{
+			Vector3 inv = vector3::create(1.0f / p_RayDir.x, 1.0f / p_RayDir.y, 1.0f / p_RayDir.z);
+
+			return raycast(p_Bvh, p_RayOrigin, p_RayDir, [&](uint32_t p_Index) { return aabb::rayIntersection(p_Boxes[p_Index], p_RayOrigin, inv, INFINITY); });
+		}
+
+		//---------------------------------------------------------------------
+
+		//primitives whose box passes p_Test(const AABB&), p_Test being true for the
+		//bounds of every node above them. Returns how many there are, only the
+		//first p_Capacity are written.
+		template<typename TEST>
+		inline uint32_t query(const BVH& p_Bvh, const AABB* p_Boxes, TEST p_Test, uint32_t* p_Out, uint32_t p_Capacity)
+		{
+			if(p_Bvh.nodeCount == 0)
+				return 0;
+
+			uint32_t stack[STACK_SIZE];
+			uint32_t top = 0;
+			uint32_t found = 0;
+
+			stack[top++] = 0;
+			while(top > 0)
+			{
+				const BVHNode& node = p_Bvh.nodes[stack[--top]];
+				if(!p_Test(node.bounds))
+					continue;
+
+				if(node.count == 0)
+				{
+					stack[top++] = node.first + 1;
+					stack[top++] = node.first;
+					continue;
+				}
+
+				for(uint32_t i = 0; i < node.count; ++i)
+				{
+					uint32_t index = p_Bvh.indices[node.first + i];
+					if(!p_Test(p_Boxes[index]))
+						continue;
+
+					if(found < p_Capacity)
+						p_Out[found] = index;
+					found += 1;
+				}
+			}
+
+			return found;
+		}
+
+		//primitives overlapping p_Box
+		inline uint32_t overlap(const BVH& p_Bvh, const AABB* p_Boxes, const AABB& p_Box, uint32_t* p_Out, uint32_t p_Capacity)
+		{
+			return query(p_Bvh, p_Boxes, [&](const AABB& p_Node) { return aabb::overlap(p_Node, p_Box); }, p_Out, p_Capacity);
+		}
+
+		//primitives overlapping the sphere p_Center, p_Radius
+		inline uint32_t overlap(const BVH& p_Bvh, const AABB* p_Boxes, const Vector3& p_Center, float p_Radius, uint32_t* p_Out, uint32_t p_Capacity)
+		{
+			return query(p_Bvh, p_Boxes, [&](const AABB& p_Node) { return aabb::overlap(p_Node, p_Center, p_Radius); }, p_Out, p_Capacity);
+		}
+	}
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <stdint.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define ALFAR_X86 1
+#endif
+
+#if ALFAR_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+// GCC 12 flags the _mm*_undefined_ps() placeholders inside its own AVX-512
+// intrinsics as (maybe-)uninitialized once they are inlined.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#else
+#include <immintrin.h>
+#endif
+#endif
+
+// GCC and Clang refuse to emit AVX instructions in a function unless the
+// function is tagged for that ISA; MSVC accepts the intrinsics everywhere.
+// The AVX2 level includes FMA and F16C, as x86-64-v3 does.
+#if ALFAR_X86 && (defined(__GNUC__) || defined(__clang__))
+#define ALFAR_TARGET_SSE2 __attribute__((target("sse2")))
+#define ALFAR_TARGET_AVX2 __attribute__((target("avx2,fma,f16c")))
+#define ALFAR_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma,f16c")))
+#else
+#define ALFAR_TARGET_SSE2
+#define ALFAR_TARGET_AVX2
+#define ALFAR_TARGET_AVX512
+#endif
+
+// Build time bounds of the dispatch, as 0 scalar, 1 sse2, 2 avx2, 3 avx512.
+// ALFAR_MIN_LEVEL is what the compiler flags already guarantee (-mavx2,
+// /arch:AVX2...), ALFAR_MAX_LEVEL the highest level dispatched to (2 keeps
+// AVX-512 out). When they are equal the level is a compile time constant and
+// every dispatch folds to a single path, which the ISA variants of the CMake
+// build rely on.
+#ifndef ALFAR_MIN_LEVEL
+#if defined(__AVX512F__)
+#define ALFAR_MIN_LEVEL 3
+#elif defined(__AVX2__) && ((defined(__FMA__) && defined(__F16C__)) || defined(_MSC_VER))
+#define ALFAR_MIN_LEVEL 2
+#elif ALFAR_X86 && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define ALFAR_MIN_LEVEL 1
+#else
+#define ALFAR_MIN_LEVEL 0
+#endif
+#endif
+
+#if !ALFAR_X86
+#undef ALFAR_MAX_LEVEL
+#define ALFAR_MAX_LEVEL 0
+#elif !defined(ALFAR_MAX_LEVEL)
+#define ALFAR_MAX_LEVEL 3
+#endif
+
+#if ALFAR_MIN_LEVEL > ALFAR_MAX_LEVEL
+#undef ALFAR_MIN_LEVEL
+#define ALFAR_MIN_LEVEL ALFAR_MAX_LEVEL
+#endif
+
+namespace alfar
+{
+	namespace cpu
+	{
+		enum Level
+		{
+			LEVEL_SCALAR = 0,
+			LEVEL_SSE2,
+			LEVEL_AVX2,
+			LEVEL_AVX512
+		};
+
+		//---------------------------------------------------------------------
+
+		//best instruction set supported by both the cpu and the os.
+		inline Level detectHardware()
+		{
+#if ALFAR_X86 && defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 0);
+			int maxLeaf = info[0];
+
+			__cpuid(info, 1);
+			bool sse2 = (info[3] & (1 << 26)) != 0;
+			bool osxsave = (info[2] & (1 << 27)) != 0;
+			bool avx = (info[2] & (1 << 28)) != 0;
+			bool fma = (info[2] & (1 << 12)) != 0;
+			bool f16c = (info[2] & (1 << 29)) != 0;
+
+			bool avx2 = false;
+			bool avx512 = false;
+			if(maxLeaf >= 7)
+			{
+				__cpuidex(info, 7, 0);
+				avx2 = (info[1] & (1 << 5)) != 0;
+				avx512 = (info[1] & (1 << 16)) != 0;
+			}
+
+			unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+			bool ymmState = (xcr0 & 0x6) == 0x6;
+			bool zmmState = (xcr0 & 0xe6) == 0xe6;
+
+			if(avx512 && zmmState)
+				return LEVEL_AVX512;
+			if(avx && avx2 && fma && f16c && ymmState)
+				return LEVEL_AVX2;
+			if(sse2)
+				return LEVEL_SSE2;
+
+			return LEVEL_SCALAR;
+#elif ALFAR_X86
+			__builtin_cpu_init();
+
+			if(__builtin_cpu_supports("avx512f"))
+				return LEVEL_AVX512;
+			if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c"))
+				return LEVEL_AVX2;
+			if(__builtin_cpu_supports("sse2"))
+				return LEVEL_SSE2;
+
+			return LEVEL_SCALAR;
+#else
+			return LEVEL_SCALAR;
+#endif
+		}
+
+		//detectHardware() capped by ALFAR_MAX_LEVEL
+		inline Level detect()
+		{
+			Level hardware = detectHardware();
+			return hardware > ALFAR_MAX_LEVEL ? (Level)ALFAR_MAX_LEVEL : hardware;
+		}
+
+		//---------------------------------------------------------------------
+
+		inline Level& currentLevel()
+		{
+			static Level s_Level = detect();
+			return s_Level;
+		}
+
+		inline Level level()
+		{
+#if ALFAR_MIN_LEVEL == ALFAR_MAX_LEVEL
+			return (Level)ALFAR_MAX_LEVEL;
+#else
+			return currentLevel();
+#endif
+		}
+
+		//force a lower level (e.g. to compare paths). Clamped to what the cpu supports,
+		//and without effect when the build fixes the level (ALFAR_MIN_LEVEL == ALFAR_MAX_LEVEL).
+		inline void setLevel(Level p_Level)
+		{
+			Level supported = detect();
+			currentLevel() = p_Level < supported ? p_Level : supported;
+		}
+
+		//---------------------------------------------------------------------
+
+		inline const char* levelName(Level p_Level)
+		{
+			switch(p_Level)
+			{
+			case LEVEL_SSE2:	return "sse2";
+			case LEVEL_AVX2:	return "avx2";
+			case LEVEL_AVX512:	return "avx512";
+			default:			return "scalar";
+			}
+		}
+	}
+}
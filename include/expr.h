@@ -0,0 +1,410 @@
+#pragma once
+
+#include "math_types.h"
+#include "functions.h"
+#include "lanes.h"
+#include "vector3_simd.h"
+#include "vector4_simd.h"
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+// Lazy expressions over Vector3, Vector4 and float arrays, so that e.g.
+//
+//		expr::assign(p_Out, expr::normalize(expr::ref(a) + expr::ref(b) * expr::ref(s)), n);
+//
+// reads a, b and s once and writes p_Out once instead of going through two
+// temporary arrays. Building an expression only stores the array pointers and
+// constants; assign walks the array BLOCK elements at a time and every node
+// computes its block with the dispatched SIMD kernel of its array function,
+// into a scratch block on the stack: the intermediate values never leave L1
+// and nothing is allocated.
+//
+//	ref(p)				an array, Vector3, Vector4 or float
+//	constant(v)			the same value for every element (plain values also
+//						work as the right or left operand of + - *)
+//	a + b, a - b		component-wise
+//	a * b				component-wise, or each vector times a float element
+//	dot(a, b)			float elements
+//	cross(a, b)			Vector3 only
+//	normalize(a)		exact (zero vectors stay zero), fastNormalize<P>(a) in a Precision tier
+//
+// Each element only depends on the same element of the operands, so p_Out
+// may be one of the arrays of the expression (x = x + v * dt).
+
+namespace alfar
+{
+	namespace expr
+	{
+		const uint32_t BLOCK = 256;			//elements per step, a Vector4 scratch block is 4KB
+
+		template<typename D>
+		struct Node
+		{
+			const D& self() const
+			{
+				return static_cast<const D&>(*this);
+			}
+		};
+
+		template<typename T>
+		struct Floats
+		{
+			static const size_t COUNT = sizeof(T) / sizeof(float);
+		};
+
+		//===================================================================== block kernels
+
+		inline void mulBlock(const Vector3* a, const float* s, Vector3* o, uint32_t p_Count)
+		{
+			vector3::simd::mul(a, s, o, p_Count);
+		}
+
+		inline void mulBlock(const Vector4* a, const float* s, Vector4* o, uint32_t p_Count)
+		{
+			for(uint32_t i = 0; i < p_Count; ++i)
+			{
+				o[i].x = a[i].x * s[i];
+				o[i].y = a[i].y * s[i];
+				o[i].z = a[i].z * s[i];
+				o[i].w = a[i].w * s[i];
+			}
+		}
+
+		inline void dotBlock(const Vector3* a, const Vector3* b, float* o, uint32_t p_Count)
+		{
+			vector3::simd::dot(a, b, o, p_Count);
+		}
+
+		inline void dotBlock(const Vector4* a, const Vector4* b, float* o, uint32_t p_Count)
+		{
+			for(uint32_t i = 0; i < p_Count; ++i)
+				o[i] = a[i].x * b[i].x + a[i].y * b[i].y + a[i].z * b[i].z + a[i].w * b[i].w;
+		}
+
+		template<Precision P>
+		inline void normalizeBlock(const Vector3* a, Vector3* o, uint32_t p_Count)
+		{
+			vector3::simd::normalize<P>(a, o, p_Count);
+		}
+
+		template<Precision P>
+		inline void normalizeBlock(const Vector4* a, Vector4* o, uint32_t p_Count)
+		{
+			vector4::simd::normalize<P>(&a->x, &o->x, p_Count);
+		}
+
+		//===================================================================== nodes
+		//block(start, count, scratch) returns the elements [start, start + count) of
+		//the node, computed into scratch (BLOCK elements) or straight from an array.
+
+		template<typename T>
+		struct Array : Node<Array<T> >
+		{
+			typedef T Value;
+
+			const T* data;
+
+			const T* block(uint32_t p_Start, uint32_t, T*) const
+			{
+				return data + p_Start;
+			}
+		};
+
+		template<typename T>
+		struct Broadcast : Node<Broadcast<T> >
+		{
+			typedef T Value;
+
+			T value;
+
+			const T* block(uint32_t, uint32_t p_Count, T* p_Scratch) const
+			{
+				for(uint32_t i = 0; i < p_Count; ++i)
+					p_Scratch[i] = value;
+
+				return p_Scratch;
+			}
+		};
+
+		//---------------------------------------------------------------------
+
+		//a OP b on operands of the same type, over the flat floats
+		template<lanes::BinaryOp OP, typename L, typename R>
+		struct Binary : Node<Binary<OP, L, R> >
+		{
+			typedef typename L::Value Value;
+
+			L left;
+			R right;
+
+			const Value* block(uint32_t p_Start, uint32_t p_Count, Value* p_Scratch) const
+			{
+				Value a[BLOCK], b[BLOCK];
+				const Value* l = left.block(p_Start, p_Count, a);
+				const Value* r = right.block(p_Start, p_Count, b);
+
+				lanes::binary<OP>((const float*)l, (const float*)r, (float*)p_Scratch, p_Count * Floats<Value>::COUNT);
+				return p_Scratch;
+			}
+		};
+
+		//vectors of L times the floats of R
+		template<typename L, typename R>
+		struct Scaled : Node<Scaled<L, R> >
+		{
+			typedef typename L::Value Value;
+
+			L left;
+			R right;
+
+			const Value* block(uint32_t p_Start, uint32_t p_Count, Value* p_Scratch) const
+			{
+				Value a[BLOCK];
+				float s[BLOCK];
+				const Value* l = left.block(p_Start, p_Count, a);
+				const float* r = right.block(p_Start, p_Count, s);
+
+				mulBlock(l, r, p_Scratch, p_Count);
+				return p_Scratch;
+			}
+		};
+
+		template<typename L, typename R>
+		struct Dot : Node<Dot<L, R> >
+		{
+			typedef float Value;
+
+			L left;
+			R right;
+
+			const float* block(uint32_t p_Start, uint32_t p_Count, float* p_Scratch) const
+			{
+				typename L::Value a[BLOCK];
+				typename R::Value b[BLOCK];
+				const typename L::Value* l = left.block(p_Start, p_Count, a);
+				const typename R::Value* r = right.block(p_Start, p_Count, b);
+
+				dotBlock(l, r, p_Scratch, p_Count);
+				return p_Scratch;
+			}
+		};
+
+		template<typename L, typename R>
+		struct Cross : Node<Cross<L, R> >
+		{
+			typedef Vector3 Value;
+
+			L left;
+			R right;
+
+			const Vector3* block(uint32_t p_Start, uint32_t p_Count, Vector3* p_Scratch) const
+			{
+				Vector3 a[BLOCK], b[BLOCK];
+				const Vector3* l = left.block(p_Start, p_Count, a);
+				const Vector3* r = right.block(p_Start, p_Count, b);
+
+				vector3::simd::cross(l, r, p_Scratch, p_Count);
+				return p_Scratch;
+			}
+		};
+
+		template<Precision P, typename L>
+		struct Normalize : Node<Normalize<P, L> >
+		{
+			typedef typename L::Value Value;
+
+			L operand;
+
+			const Value* block(uint32_t p_Start, uint32_t p_Count, Value* p_Scratch) const
+			{
+				Value a[BLOCK];
+				const Value* v = operand.block(p_Start, p_Count, a);
+
+				normalizeBlock<P>(v, p_Scratch, p_Count);
+				return p_Scratch;
+			}
+		};
+
+		//---------------------------------------------------------------------
+
+		template<lanes::BinaryOp OP, typename L, typename R>
+		inline Binary<OP, L, R> binary(const L& l, const R& r)
+		{
+			static_assert(std::is_same<typename L::Value, typename R::Value>::value, "expr: component-wise operands must have the same type");
+
+			Binary<OP, L, R> ret;
+			ret.left = l;
+			ret.right = r;
+			return ret;
+		}
+
+		//---------------------------------------------------------------------
+
+		//a * b: component-wise between the same types, a vector and a float scale otherwise
+		template<typename L, typename R, typename LV = typename L::Value, typename RV = typename R::Value>
+		struct Product
+		{
+			typedef Binary<lanes::OP_SCALE, L, R> Type;
+			static Type make(const L& l, const R& r) { return binary<lanes::OP_SCALE>(l, r); }
+		};
+
+		template<typename L, typename R, typename LV>
+		struct Product<L, R, LV, float>
+		{
+			typedef Scaled<L, R> Type;
+			static Type make(const L& l, const R& r) { Type ret; ret.left = l; ret.right = r; return ret; }
+		};
+
+		template<typename L, typename R, typename RV>
+		struct Product<L, R, float, RV>
+		{
+			typedef Scaled<R, L> Type;
+			static Type make(const L& l, const R& r) { Type ret; ret.left = r; ret.right = l; return ret; }
+		};
+
+		template<typename L, typename R>
+		struct Product<L, R, float, float>
+		{
+			typedef Binary<lanes::OP_SCALE, L, R> Type;
+			static Type make(const L& l, const R& r) { return binary<lanes::OP_SCALE>(l, r); }
+		};
+
+		//===================================================================== building
+
+		template<typename T>
+		inline Array<T> ref(const T* p_Data)
+		{
+			Array<T> ret;
+			ret.data = p_Data;
+			return ret;
+		}
+
+		template<typename T>
+		inline Broadcast<T> constant(const T& p_Value)
+		{
+			Broadcast<T> ret;
+			ret.value = p_Value;
+			return ret;
+		}
+
+		template<typename L, typename R>
+		inline Binary<lanes::OP_ADD, L, R> operator+(const Node<L>& l, const Node<R>& r)
+		{
+			return binary<lanes::OP_ADD>(l.self(), r.self());
+		}
+
+		template<typename L>
+		inline Binary<lanes::OP_ADD, L, Broadcast<typename L::Value> > operator+(const Node<L>& l, const typename L::Value& r)
+		{
+			return binary<lanes::OP_ADD>(l.self(), constant(r));
+		}
+
+		template<typename R>
+		inline Binary<lanes::OP_ADD, Broadcast<typename R::Value>, R> operator+(const typename R::Value& l, const Node<R>& r)
+		{
+			return binary<lanes::OP_ADD>(constant(l), r.self());
+		}
+
+		template<typename L, typename R>
+		inline Binary<lanes::OP_SUB, L, R> operator-(const Node<L>& l, const Node<R>& r)
+		{
+			return binary<lanes::OP_SUB>(l.self(), r.self());
+		}
+
+		template<typename L>
+		inline Binary<lanes::OP_SUB, L, Broadcast<typename L::Value> > operator-(const Node<L>& l, const typename L::Value& r)
+		{
+			return binary<lanes::OP_SUB>(l.self(), constant(r));
+		}
+
+		template<typename R>
+		inline Binary<lanes::OP_SUB, Broadcast<typename R::Value>, R> operator-(const typename R::Value& l, const Node<R>& r)
+		{
+			return binary<lanes::OP_SUB>(constant(l), r.self());
+		}
+
+		//---------------------------------------------------------------------
+
+		template<typename L, typename R>
+		inline typename Product<L, R>::Type operator*(const Node<L>& l, const Node<R>& r)
+		{
+			return Product<L, R>::make(l.self(), r.self());
+		}
+
+		template<typename L>
+		inline typename Product<L, Broadcast<float> >::Type operator*(const Node<L>& l, float r)
+		{
+			return Product<L, Broadcast<float> >::make(l.self(), constant(r));
+		}
+
+		template<typename R>
+		inline typename Product<Broadcast<float>, R>::Type operator*(float l, const Node<R>& r)
+		{
+			return Product<Broadcast<float>, R>::make(constant(l), r.self());
+		}
+
+		//---------------------------------------------------------------------
+
+		template<typename L, typename R>
+		inline Dot<L, R> dot(const Node<L>& l, const Node<R>& r)
+		{
+			Dot<L, R> ret;
+			ret.left = l.self();
+			ret.right = r.self();
+			return ret;
+		}
+
+		template<typename L, typename R>
+		inline Cross<L, R> cross(const Node<L>& l, const Node<R>& r)
+		{
+			Cross<L, R> ret;
+			ret.left = l.self();
+			ret.right = r.self();
+			return ret;
+		}
+
+		template<Precision P, typename L>
+		inline Normalize<P, L> fastNormalize(const Node<L>& v)
+		{
+			Normalize<P, L> ret;
+			ret.operand = v.self();
+			return ret;
+		}
+
+		template<typename L>
+		inline Normalize<PRECISION_REFINED, L> fastNormalize(const Node<L>& v)
+		{
+			return fastNormalize<PRECISION_REFINED>(v);
+		}
+
+		template<typename L>
+		inline Normalize<PRECISION_EXACT, L> normalize(const Node<L>& v)
+		{
+			return fastNormalize<PRECISION_EXACT>(v);
+		}
+
+		//===================================================================== evaluation
+
+		template<typename E>
+		inline void assignRange(typename E::Value* p_Out, const E& p_Expr, uint32_t p_Start, uint32_t p_End)
+		{
+			for(uint32_t start = p_Start; start < p_End; start += BLOCK)
+			{
+				uint32_t count = p_End - start < BLOCK ? p_End - start : BLOCK;
+
+				//the root computes straight into p_Out, only a bare array comes back elsewhere
+				const typename E::Value* block = p_Expr.block(start, count, p_Out + start);
+				if(block != p_Out + start)
+					memmove(p_Out + start, block, count * sizeof(typename E::Value));
+			}
+		}
+
+		//p_Out[i] = p_Expr at element i, for i in [0, p_Number)
+		template<typename E>
+		inline void assign(typename E::Value* p_Out, const Node<E>& p_Expr, uint32_t p_Number)
+		{
+			assignRange(p_Out, p_Expr.self(), 0, p_Number);
+		}
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "expr.h"
+#include "parallel.h"
+#include <stdint.h>
+
+// expr::assign over the pool of a Policy, each participant walking its
+// range BLOCK elements at a time.
+
+namespace alfar
+{
+	namespace expr
+	{
+		//same as assign, split over the pool of p_Policy
+		template<typename E>
+		inline void assign(const parallel::Policy& p_Policy, typename E::Value* p_Out, const Node<E>& p_Expr, uint32_t p_Number)
+		{
+			const E& e = p_Expr.self();
+			parallel::forRange(p_Policy, p_Number, [&](uint32_t p_Start, uint32_t p_End) { assignRange(p_Out, e, p_Start, p_End); });
+		}
+	}
+}
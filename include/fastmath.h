@@ -0,0 +1,123 @@
+#pragma once
+
+#include "functions.h"
+#include "fastmath_simd.h"
+#include <stddef.h>
+
+// Polynomial sin/cos/atan2/acos/exp/log for hot loops, single values or whole
+// float arrays, in the Precision tiers of functions.h (PRECISION_EXACT calls
+// libm). Max errors measured against the double precision functions, on
+// every dispatch level, rounded up (checked by test/fastmath_test.cpp):
+//
+//				APPROXIMATE			REFINED
+//	sin, cos	1.7e-4 abs			9.4e-8 abs		for |x| < 10^4, the range reduction loses accuracy above
+//	atan2		1.2e-5 rad			2.7e-7 rad
+//	acos		6.8e-5 rad			3.1e-7 rad
+//	exp			1.5e-5 relative		1.2e-7 relative	results below FLT_MIN are flushed to 0
+//	log			8.9e-5 abs			4.7e-8 abs		for results in [-1, 1]
+//				8.6e-5 relative		8.2e-8 relative	beyond, denormals are flushed, log(0) = -inf
+//
+// Infinite and NaN inputs give the libm result except for sin, cos and atan2
+// which expect finite ones. The array versions may work in place (p_Out == p_In).
+
+namespace alfar
+{
+	namespace fastmath
+	{
+		template<Precision P = PRECISION_REFINED>
+		inline void sincos(float x, float& p_Sin, float& p_Cos)
+		{
+			simd::sincosScalar<P>(x, p_Sin, p_Cos);
+		}
+
+		template<Precision P = PRECISION_REFINED>
+		inline float sin(float x)
+		{
+			return simd::unaryScalar<simd::OP_SIN, P>(x);
+		}
+
+		template<Precision P = PRECISION_REFINED>
+		inline float cos(float x)
+		{
+			return simd::unaryScalar<simd::OP_COS, P>(x);
+		}
+
+		//-------------------------------------------------------------------------
+
+		//angle of (x, y) in [-pi, pi], 0 for (0, 0)
+		template<Precision P = PRECISION_REFINED>
+		inline float atan2(float y, float x)
+		{
+			return simd::atan2Scalar<P>(y, x);
+		}
+
+		//in [0, pi] for x in [-1, 1], NaN outside
+		template<Precision P = PRECISION_REFINED>
+		inline float acos(float x)
+		{
+			return simd::acosScalar<P>(x);
+		}
+
+		//-------------------------------------------------------------------------
+
+		template<Precision P = PRECISION_REFINED>
+		inline float exp(float x)
+		{
+			return simd::expScalar<P>(x);
+		}
+
+		template<Precision P = PRECISION_REFINED>
+		inline float log(float x)
+		{
+			return simd::logScalar<P>(x);
+		}
+
+		//----- array version
+
+		template<Precision P = PRECISION_REFINED>
+		inline void sincos(const float* p_In, float* p_Sin, float* p_Cos, size_t p_Count)
+		{
+			simd::sincos<P>(p_In, p_Sin, p_Cos, p_Count);
+		}
+
+		template<Precision P = PRECISION_REFINED>
+		inline void sin(const float* p_In, float* p_Out, size_t p_Count)
+		{
+			simd::unary<simd::OP_SIN, P>(p_In, p_Out, p_Count);
+		}
+
+		template<Precision P = PRECISION_REFINED>
+		inline void cos(const float* p_In, float* p_Out, size_t p_Count)
+		{
+			simd::unary<simd::OP_COS, P>(p_In, p_Out, p_Count);
+		}
+
+		//-------------------------------------------------------------------------
+
+		template<Precision P = PRECISION_REFINED>
+		inline void atan2(const float* p_Y, const float* p_X, float* p_Out, size_t p_Count)
+		{
+			simd::atan2<P>(p_Y, p_X, p_Out, p_Count);
+		}
+
+		template<Precision P = PRECISION_REFINED>
+		inline void acos(const float* p_In, float* p_Out, size_t p_Count)
+		{
+			simd::unary<simd::OP_ACOS, P>(p_In, p_Out, p_Count);
+		}
+
+		//-------------------------------------------------------------------------
+
+		template<Precision P = PRECISION_REFINED>
+		inline void exp(const float* p_In, float* p_Out, size_t p_Count)
+		{
+			simd::unary<simd::OP_EXP, P>(p_In, p_Out, p_Count);
+		}
+
+		template<Precision P = PRECISION_REFINED>
+		inline void log(const float* p_In, float* p_Out, size_t p_Count)
+		{
+			simd::unary<simd::OP_LOG, P>(p_In, p_Out, p_Count);
+		}
+	}
+}
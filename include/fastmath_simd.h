@@ -0,0 +1,968 @@
+#pragma once
+
+#include "cpu.h"
+#include "functions.h"
+#include <float.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Kernels behind fastmath.h. Every function is a range reduction followed by a
+// polynomial, the same on every level, so the scalar kernel gives the SIMD
+// results up to the rounding of the FMA contractions of AVX2 and AVX-512:
+//
+//	sincos	x = q * pi/2 + r, |r| <= pi/4, pi/2 split in 3 parts (exact products
+//			for |q| < 2^16). sin and cos of r are odd/even polynomials, swapped
+//			and negated by the quadrant q & 3.
+//	atan2	atan of min(|x|, |y|) / max(|x|, |y|) in [0, 1], REFINED reducing
+//			it again to [0, tan(pi/8)] with atan(a) = pi/4 + atan((a-1)/(a+1))
+//			in the same division. The octant then comes from the signs and
+//			from |y| > |x|.
+//	acos	REFINED: asin polynomial on [0, 0.5], 2 * asin(sqrt((1-|x|)/2)) above.
+//			APPROXIMATE: sqrt(1-|x|) times a cubic (Abramowitz-Stegun 4.4.45).
+//	exp		x = n * ln2 + r, |r| <= ln2/2, 2^n built in the exponent field in
+//			two halves so n = 128 (x up to ln(FLT_MAX)) does not overflow.
+//	log		x = m * 2^e, m in [sqrt(1/2), sqrt(2)), log(1+f) = f - f^2/2 + f^3 Q(f).
+//
+// REFINED uses the Cephes single precision coefficients (S. Moshier), the
+// APPROXIMATE ones are shorter Chebyshev fits of the same forms, or the
+// Abramowitz-Stegun approximations for atan and acos.
+// PRECISION_EXACT has no SIMD kernel, the dispatch runs the libm loop.
+
+namespace alfar
+{
+	namespace fastmath
+	{
+		namespace simd
+		{
+			enum UnaryOp
+			{
+				OP_SIN,
+				OP_COS,
+				OP_ACOS,
+				OP_EXP,
+				OP_LOG
+			};
+
+			const float PI_F = 3.14159265358979f;
+			const float PIO2_F = 1.57079632679490f;
+			const float PIO4_F = 0.785398163397448f;
+			const float TWO_OVER_PI = 0.636619772367581f;
+			const float PIO2_1 = 1.5703125f;
+			const float PIO2_2 = 4.837512969970703125e-4f;
+			const float PIO2_3 = 7.54978995489188216e-8f;
+			const float TAN_PIO8 = 0.414213562373095f;
+			const float LOG2E = 1.44269504088896f;
+			const float LN2_HI = 0.693359375f;
+			const float LN2_LO = -2.12194440e-4f;
+			const float EXP_HI = 88.7228391f;	//ln(FLT_MAX)
+			const float EXP_LO = -87.3365448f;	//ln(FLT_MIN), results below are flushed to 0
+			const float SQRT_HALF = 0.707106781186548f;
+			const float ROUND_SHIFT = 12582912.0f;	//1.5 * 2^23: v + ROUND_SHIFT is v rounded, in the low mantissa bits, for |v| < 2^22
+
+			//highest degree first
+			static const float SIN_APPROXIMATE[] = { 8.2118555073e-3f, -1.6665731001e-1f };
+			static const float SIN_REFINED[] = { -1.9515295891e-4f, 8.3321608736e-3f, -1.6666654611e-1f };
+			static const float COS_APPROXIMATE[] = { 4.1240649631e-2f };
+			static const float COS_REFINED[] = { 2.443315711809948e-5f, -1.388731625493765e-3f, 4.166664568298827e-2f };
+			static const float ATAN_APPROXIMATE[] = { 0.0208351f, -0.0851330f, 0.1801410f, -0.3302995f, 0.9998660f };
+			static const float ATAN_REFINED[] = { 8.05374449538e-2f, -1.38776856032e-1f, 1.99777106478e-1f, -3.33329491539e-1f };
+			static const float ACOS_APPROXIMATE[] = { -0.0187293f, 0.0742610f, -0.2121144f, 1.5707288f };
+			static const float ASIN_REFINED[] = { 4.2163199048e-2f, 2.4181311049e-2f, 4.5470025998e-2f, 7.4953002686e-2f, 1.6666752422e-1f };
+			static const float EXP_APPROXIMATE[] = { 4.1791986113e-2f, 1.6741898670e-1f, 5.0e-1f };
+			static const float EXP_REFINED[] = { 1.9875691500e-4f, 1.3981999507e-3f, 8.3334519073e-3f, 4.1665795894e-2f, 1.6666665459e-1f, 5.0000001201e-1f };
+			static const float LOG_APPROXIMATE[] = { 1.8363668467e-1f, -2.6335911632e-1f, 3.3416854642e-1f };
+			static const float LOG_REFINED[] = { 7.0376836292e-2f, -1.1514610310e-1f, 1.1676998740e-1f, -1.2420140846e-1f,
+												 1.4249322787e-1f, -1.6668057665e-1f, 2.0000714765e-1f, -2.4999993993e-1f, 3.3333331174e-1f };
+
+			//===================================================================== scalar
+
+			template<int N>
+			inline float hornerScalar(float x, const float (&c)[N])
+			{
+				float acc = c[0];
+				for(int i = 1; i < N; ++i)
+					acc = acc * x + c[i];
+
+				return acc;
+			}
+
+			inline float fromBits(uint32_t p_Bits)
+			{
+				float f = 0;
+				memcpy(&f, &p_Bits, sizeof(float));
+
+				return f;
+			}
+
+			inline uint32_t toBits(float p_Float)
+			{
+				uint32_t b = 0;
+				memcpy(&b, &p_Float, sizeof(float));
+
+				return b;
+			}
+
+			template<Precision P>
+			inline void sincosScalar(float x, float& s, float& c)
+			{
+				if(P == PRECISION_EXACT)
+				{
+					s = sinf(x);
+					c = cosf(x);
+					return;
+				}
+
+				float shifted = x * TWO_OVER_PI + ROUND_SHIFT;
+				float q = shifted - ROUND_SHIFT;
+				float r = ((x - q * PIO2_1) - q * PIO2_2) - q * PIO2_3;
+				float z = r * r;
+
+				float sr = r + r * z * (P == PRECISION_APPROXIMATE ? hornerScalar(z, SIN_APPROXIMATE) : hornerScalar(z, SIN_REFINED));
+				float cr = (1.0f - 0.5f * z) + z * z * (P == PRECISION_APPROXIMATE ? hornerScalar(z, COS_APPROXIMATE) : hornerScalar(z, COS_REFINED));
+
+				//q mod 4, read from the mantissa so huge x do not overflow an int conversion
+				uint32_t quadrant = toBits(shifted);
+
+				s = (quadrant & 1) ? cr : sr;
+				c = (quadrant & 1) ? sr : cr;
+
+				if(quadrant & 2)
+					s = -s;
+
+				if((quadrant + 1) & 2)
+					c = -c;
+			}
+
+			template<Precision P>
+			inline float atan2Scalar(float y, float x)
+			{
+				if(P == PRECISION_EXACT)
+					return atan2f(y, x);
+
+				float ax = fabsf(x), ay = fabsf(y);
+				float mn = ax < ay ? ax : ay;
+				float mx = ax < ay ? ay : ax;
+				float r = 0;
+
+				if(P == PRECISION_APPROXIMATE)
+				{
+					float a = mx > 0 ? mn / mx : 0.0f;
+					r = a * hornerScalar(a * a, ATAN_APPROXIMATE);
+				}
+				else
+				{
+					bool big = mn > TAN_PIO8 * mx;
+					float t = big ? (mn - mx) / (mn + mx) : (mx > 0 ? mn / mx : 0.0f);
+					float z = t * t;
+					r = (big ? PIO4_F : 0.0f) + (t + t * z * hornerScalar(z, ATAN_REFINED));
+				}
+
+				if(ay > ax)
+					r = PIO2_F - r;
+
+				if(signbit(x))
+					r = PI_F - r;
+
+				return copysignf(r, y);
+			}
+
+			template<Precision P>
+			inline float acosScalar(float x)
+			{
+				if(P == PRECISION_EXACT)
+					return acosf(x);
+
+				float a = fabsf(x);
+
+				if(P == PRECISION_APPROXIMATE)
+				{
+					float r = sqrtf(1.0f - a) * hornerScalar(a, ACOS_APPROXIMATE);
+					return x < 0 ? PI_F - r : r;
+				}
+
+				bool big = a > 0.5f;
+				float z = big ? 0.5f * (1.0f - a) : a * a;
+				float s = big ? sqrtf(z) : a;
+				float p = s + s * z * hornerScalar(z, ASIN_REFINED);
+
+				if(big)
+					return x < 0 ? PI_F - 2.0f * p : 2.0f * p;
+
+				return PIO2_F - (x < 0 ? -p : p);
+			}
+
+			template<Precision P>
+			inline float expScalar(float x)
+			{
+				if(P == PRECISION_EXACT)
+					return expf(x);
+
+				//NaN stays NaN
+				if(!(x <= EXP_HI))
+					return x > EXP_HI ? HUGE_VALF : x;
+
+				if(x < EXP_LO)
+					return 0.0f;
+
+				float n = (x * LOG2E + ROUND_SHIFT) - ROUND_SHIFT;
+				float r = (x - n * LN2_HI) - n * LN2_LO;
+				float p = 1.0f + r + r * r * (P == PRECISION_APPROXIMATE ? hornerScalar(r, EXP_APPROXIMATE) : hornerScalar(r, EXP_REFINED));
+
+				int32_t e = (int32_t)n;
+				int32_t h = e / 2;
+
+				return p * fromBits((uint32_t)(h + 127) << 23) * fromBits((uint32_t)(e - h + 127) << 23);
+			}
+
+			template<Precision P>
+			inline float logScalar(float x)
+			{
+				if(P == PRECISION_EXACT)
+					return logf(x);
+
+				//negative and NaN give NaN, 0 and denormals -inf
+				if(!(x >= FLT_MIN))
+					return x >= 0 ? -HUGE_VALF : fromBits(0x7fc00000);
+
+				if(x == HUGE_VALF)
+					return x;
+
+				uint32_t bits = toBits(x);
+				int32_t e = (int32_t)(bits >> 23) - 126;
+				float m = fromBits((bits & 0x007fffff) | 0x3f000000);
+
+				if(m < SQRT_HALF)
+				{
+					e -= 1;
+					m += m;
+				}
+
+				float f = m - 1.0f;
+				float z = f * f;
+				float fe = (float)e;
+
+				float y = f * z * (P == PRECISION_APPROXIMATE ? hornerScalar(f, LOG_APPROXIMATE) : hornerScalar(f, LOG_REFINED));
+				y += fe * LN2_LO;
+				y -= 0.5f * z;
+
+				return (f + y) + fe * LN2_HI;
+			}
+
+			template<UnaryOp OP, Precision P>
+			inline float unaryScalar(float x)
+			{
+				if(OP == OP_SIN || OP == OP_COS)
+				{
+					float s = 0, c = 0;
+					sincosScalar<P>(x, s, c);
+
+					return OP == OP_SIN ? s : c;
+				}
+
+				if(OP == OP_ACOS)
+					return acosScalar<P>(x);
+
+				if(OP == OP_EXP)
+					return expScalar<P>(x);
+
+				return logScalar<P>(x);
+			}
+
+			template<UnaryOp OP, Precision P>
+			inline void unaryScalar(const float* a, float* o, size_t p_Count)
+			{
+				for(size_t i = 0; i < p_Count; ++i)
+					o[i] = unaryScalar<OP, P>(a[i]);
+			}
+
+			template<Precision P>
+			inline void sincosScalar(const float* a, float* s, float* c, size_t p_Count)
+			{
+				for(size_t i = 0; i < p_Count; ++i)
+				{
+					float x = a[i];
+					sincosScalar<P>(x, s[i], c[i]);
+				}
+			}
+
+			template<Precision P>
+			inline void atan2Scalar(const float* y, const float* x, float* o, size_t p_Count)
+			{
+				for(size_t i = 0; i < p_Count; ++i)
+					o[i] = atan2Scalar<P>(y[i], x[i]);
+			}
+
+#if ALFAR_X86
+
+			//===================================================================== SSE2
+
+			template<int N>
+			ALFAR_TARGET_SSE2 inline __m128 hornerSSE2(__m128 x, const float (&c)[N])
+			{
+				__m128 acc = _mm_set1_ps(c[0]);
+				for(int i = 1; i < N; ++i)
+					acc = _mm_add_ps(_mm_mul_ps(acc, x), _mm_set1_ps(c[i]));
+
+				return acc;
+			}
+
+			//m ? a : b, m all ones or all zeros per lane
+			ALFAR_TARGET_SSE2 inline __m128 selectSSE2(__m128 m, __m128 a, __m128 b)
+			{
+				return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+			}
+
+			ALFAR_TARGET_SSE2 inline __m128 signMaskSSE2(__m128 x)
+			{
+				return _mm_castsi128_ps(_mm_srai_epi32(_mm_castps_si128(x), 31));
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_SSE2 inline void sincosSSE2(__m128 x, __m128& s, __m128& c)
+			{
+				__m128i qi = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(TWO_OVER_PI)));
+				__m128 q = _mm_cvtepi32_ps(qi);
+
+				__m128 r = _mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(PIO2_1)));
+				r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(PIO2_2)));
+				r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(PIO2_3)));
+				__m128 z = _mm_mul_ps(r, r);
+
+				__m128 sp = P == PRECISION_APPROXIMATE ? hornerSSE2(z, SIN_APPROXIMATE) : hornerSSE2(z, SIN_REFINED);
+				__m128 cp = P == PRECISION_APPROXIMATE ? hornerSSE2(z, COS_APPROXIMATE) : hornerSSE2(z, COS_REFINED);
+				__m128 sr = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, z), sp));
+				__m128 cr = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), z)), _mm_mul_ps(_mm_mul_ps(z, z), cp));
+
+				__m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(qi, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+				__m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(qi, _mm_set1_epi32(2)), 30));
+				__m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(qi, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+
+				s = _mm_xor_ps(selectSSE2(swap, cr, sr), sinSign);
+				c = _mm_xor_ps(selectSSE2(swap, sr, cr), cosSign);
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_SSE2 inline __m128 atan2SSE2(__m128 y, __m128 x)
+			{
+				const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+				__m128 ax = _mm_and_ps(x, absMask), ay = _mm_and_ps(y, absMask);
+				__m128 mn = _mm_min_ps(ax, ay), mx = _mm_max_ps(ax, ay);
+				__m128 valid = _mm_cmpgt_ps(mx, _mm_setzero_ps());
+				__m128 r;
+
+				if(P == PRECISION_APPROXIMATE)
+				{
+					__m128 a = _mm_and_ps(_mm_div_ps(mn, mx), valid);
+					r = _mm_mul_ps(a, hornerSSE2(_mm_mul_ps(a, a), ATAN_APPROXIMATE));
+				}
+				else
+				{
+					__m128 big = _mm_cmpgt_ps(mn, _mm_mul_ps(_mm_set1_ps(TAN_PIO8), mx));
+					__m128 num = selectSSE2(big, _mm_sub_ps(mn, mx), mn);
+					__m128 den = selectSSE2(big, _mm_add_ps(mn, mx), mx);
+					__m128 t = _mm_and_ps(_mm_div_ps(num, den), valid);
+					__m128 z = _mm_mul_ps(t, t);
+
+					r = _mm_add_ps(t, _mm_mul_ps(_mm_mul_ps(t, z), hornerSSE2(z, ATAN_REFINED)));
+					r = _mm_add_ps(_mm_and_ps(big, _mm_set1_ps(PIO4_F)), r);
+				}
+
+				r = selectSSE2(_mm_cmpgt_ps(ay, ax), _mm_sub_ps(_mm_set1_ps(PIO2_F), r), r);
+				r = selectSSE2(signMaskSSE2(x), _mm_sub_ps(_mm_set1_ps(PI_F), r), r);
+
+				return _mm_or_ps(r, _mm_andnot_ps(absMask, y));
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_SSE2 inline __m128 acosSSE2(__m128 x)
+			{
+				const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+				const __m128 one = _mm_set1_ps(1.0f);
+
+				__m128 a = _mm_and_ps(x, absMask);
+				__m128 negative = _mm_cmplt_ps(x, _mm_setzero_ps());
+
+				if(P == PRECISION_APPROXIMATE)
+				{
+					__m128 r = _mm_mul_ps(_mm_sqrt_ps(_mm_sub_ps(one, a)), hornerSSE2(a, ACOS_APPROXIMATE));
+					return selectSSE2(negative, _mm_sub_ps(_mm_set1_ps(PI_F), r), r);
+				}
+
+				__m128 big = _mm_cmpgt_ps(a, _mm_set1_ps(0.5f));
+				__m128 z = selectSSE2(big, _mm_mul_ps(_mm_set1_ps(0.5f), _mm_sub_ps(one, a)), _mm_mul_ps(a, a));
+				__m128 s = selectSSE2(big, _mm_sqrt_ps(z), a);
+				__m128 p = _mm_add_ps(s, _mm_mul_ps(_mm_mul_ps(s, z), hornerSSE2(z, ASIN_REFINED)));
+
+				__m128 p2 = _mm_add_ps(p, p);
+				__m128 rBig = selectSSE2(negative, _mm_sub_ps(_mm_set1_ps(PI_F), p2), p2);
+				__m128 rSmall = _mm_sub_ps(_mm_set1_ps(PIO2_F), _mm_xor_ps(p, _mm_and_ps(negative, _mm_set1_ps(-0.0f))));
+
+				return selectSSE2(big, rBig, rSmall);
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_SSE2 inline __m128 expSSE2(__m128 x)
+			{
+				__m128i ni = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(LOG2E)));
+				__m128 n = _mm_cvtepi32_ps(ni);
+
+				__m128 r = _mm_sub_ps(_mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(LN2_HI))), _mm_mul_ps(n, _mm_set1_ps(LN2_LO)));
+				__m128 q = P == PRECISION_APPROXIMATE ? hornerSSE2(r, EXP_APPROXIMATE) : hornerSSE2(r, EXP_REFINED);
+				__m128 p = _mm_add_ps(_mm_add_ps(_mm_set1_ps(1.0f), r), _mm_mul_ps(_mm_mul_ps(r, r), q));
+
+				//2^h * 2^(n-h), h = n/2 rounded towards -inf
+				__m128i h = _mm_srai_epi32(ni, 1);
+				__m128i bias = _mm_set1_epi32(127);
+				__m128 s0 = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(h, bias), 23));
+				__m128 s1 = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_sub_epi32(ni, h), bias), 23));
+				p = _mm_mul_ps(_mm_mul_ps(p, s0), s1);
+
+				p = selectSSE2(_mm_cmpgt_ps(x, _mm_set1_ps(EXP_HI)), _mm_set1_ps(HUGE_VALF), p);
+				return _mm_andnot_ps(_mm_cmplt_ps(x, _mm_set1_ps(EXP_LO)), p);
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_SSE2 inline __m128 logSSE2(__m128 x)
+			{
+				__m128i bits = _mm_castps_si128(x);
+				__m128i e = _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(126));
+				__m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f000000)));
+
+				__m128 low = _mm_cmplt_ps(m, _mm_set1_ps(SQRT_HALF));
+				e = _mm_add_epi32(e, _mm_castps_si128(low));	//-1 where low
+				__m128 f = _mm_add_ps(_mm_sub_ps(m, _mm_set1_ps(1.0f)), _mm_and_ps(low, m));
+
+				__m128 z = _mm_mul_ps(f, f);
+				__m128 fe = _mm_cvtepi32_ps(e);
+
+				__m128 y = _mm_mul_ps(_mm_mul_ps(f, z), P == PRECISION_APPROXIMATE ? hornerSSE2(f, LOG_APPROXIMATE) : hornerSSE2(f, LOG_REFINED));
+				y = _mm_add_ps(y, _mm_mul_ps(fe, _mm_set1_ps(LN2_LO)));
+				y = _mm_sub_ps(y, _mm_mul_ps(_mm_set1_ps(0.5f), z));
+				__m128 ret = _mm_add_ps(_mm_add_ps(f, y), _mm_mul_ps(fe, _mm_set1_ps(LN2_HI)));
+
+				ret = selectSSE2(_mm_cmpeq_ps(x, _mm_set1_ps(HUGE_VALF)), x, ret);
+				ret = selectSSE2(_mm_cmplt_ps(x, _mm_set1_ps(FLT_MIN)), _mm_set1_ps(-HUGE_VALF), ret);
+				return selectSSE2(_mm_cmpnge_ps(x, _mm_setzero_ps()), _mm_castsi128_ps(_mm_set1_epi32(0x7fc00000)), ret);
+			}
+
+			template<UnaryOp OP, Precision P>
+			ALFAR_TARGET_SSE2 inline __m128 unarySSE2(__m128 x)
+			{
+				if(OP == OP_SIN || OP == OP_COS)
+				{
+					__m128 s, c;
+					sincosSSE2<P>(x, s, c);
+
+					return OP == OP_SIN ? s : c;
+				}
+
+				if(OP == OP_ACOS)
+					return acosSSE2<P>(x);
+
+				if(OP == OP_EXP)
+					return expSSE2<P>(x);
+
+				return logSSE2<P>(x);
+			}
+
+			template<UnaryOp OP, Precision P>
+			ALFAR_TARGET_SSE2 inline void unarySSE2(const float* a, float* o, size_t p_Count)
+			{
+				size_t i = 0;
+				for(; i + 4 <= p_Count; i += 4)
+					_mm_storeu_ps(o + i, unarySSE2<OP, P>(_mm_loadu_ps(a + i)));
+
+				unaryScalar<OP, P>(a + i, o + i, p_Count - i);
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_SSE2 inline void sincosSSE2(const float* a, float* s, float* c, size_t p_Count)
+			{
+				size_t i = 0;
+				for(; i + 4 <= p_Count; i += 4)
+				{
+					__m128 vs, vc;
+					sincosSSE2<P>(_mm_loadu_ps(a + i), vs, vc);
+
+					_mm_storeu_ps(s + i, vs);
+					_mm_storeu_ps(c + i, vc);
+				}
+
+				sincosScalar<P>(a + i, s + i, c + i, p_Count - i);
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_SSE2 inline void atan2SSE2(const float* y, const float* x, float* o, size_t p_Count)
+			{
+				size_t i = 0;
+				for(; i + 4 <= p_Count; i += 4)
+					_mm_storeu_ps(o + i, atan2SSE2<P>(_mm_loadu_ps(y + i), _mm_loadu_ps(x + i)));
+
+				atan2Scalar<P>(y + i, x + i, o + i, p_Count - i);
+			}
+
+			//===================================================================== AVX2
+
+			template<int N>
+			ALFAR_TARGET_AVX2 inline __m256 hornerAVX2(__m256 x, const float (&c)[N])
+			{
+				__m256 acc = _mm256_set1_ps(c[0]);
+				for(int i = 1; i < N; ++i)
+					acc = _mm256_fmadd_ps(acc, x, _mm256_set1_ps(c[i]));
+
+				return acc;
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_AVX2 inline void sincosAVX2(__m256 x, __m256& s, __m256& c)
+			{
+				__m256 q = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(TWO_OVER_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+				__m256i qi = _mm256_cvtps_epi32(q);
+
+				__m256 r = _mm256_fnmadd_ps(q, _mm256_set1_ps(PIO2_1), x);
+				r = _mm256_fnmadd_ps(q, _mm256_set1_ps(PIO2_2), r);
+				r = _mm256_fnmadd_ps(q, _mm256_set1_ps(PIO2_3), r);
+				__m256 z = _mm256_mul_ps(r, r);
+
+				__m256 sp = P == PRECISION_APPROXIMATE ? hornerAVX2(z, SIN_APPROXIMATE) : hornerAVX2(z, SIN_REFINED);
+				__m256 cp = P == PRECISION_APPROXIMATE ? hornerAVX2(z, COS_APPROXIMATE) : hornerAVX2(z, COS_REFINED);
+				__m256 sr = _mm256_fmadd_ps(_mm256_mul_ps(r, z), sp, r);
+				__m256 cr = _mm256_fmadd_ps(_mm256_mul_ps(z, z), cp, _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), z, _mm256_set1_ps(1.0f)));
+
+				__m256 swap = _mm256_castsi256_ps(_mm256_slli_epi32(qi, 31));
+				__m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(qi, _mm256_set1_epi32(2)), 30));
+				__m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(qi, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30));
+
+				//blendv only reads the sign bit
+				s = _mm256_xor_ps(_mm256_blendv_ps(sr, cr, swap), sinSign);
+				c = _mm256_xor_ps(_mm256_blendv_ps(cr, sr, swap), cosSign);
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_AVX2 inline __m256 atan2AVX2(__m256 y, __m256 x)
+			{
+				const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+
+				__m256 ax = _mm256_and_ps(x, absMask), ay = _mm256_and_ps(y, absMask);
+				__m256 mn = _mm256_min_ps(ax, ay), mx = _mm256_max_ps(ax, ay);
+				__m256 valid = _mm256_cmp_ps(mx, _mm256_setzero_ps(), _CMP_GT_OQ);
+				__m256 r;
+
+				if(P == PRECISION_APPROXIMATE)
+				{
+					__m256 a = _mm256_and_ps(_mm256_div_ps(mn, mx), valid);
+					r = _mm256_mul_ps(a, hornerAVX2(_mm256_mul_ps(a, a), ATAN_APPROXIMATE));
+				}
+				else
+				{
+					__m256 big = _mm256_cmp_ps(mn, _mm256_mul_ps(_mm256_set1_ps(TAN_PIO8), mx), _CMP_GT_OQ);
+					__m256 num = _mm256_blendv_ps(mn, _mm256_sub_ps(mn, mx), big);
+					__m256 den = _mm256_blendv_ps(mx, _mm256_add_ps(mn, mx), big);
+					__m256 t = _mm256_and_ps(_mm256_div_ps(num, den), valid);
+					__m256 z = _mm256_mul_ps(t, t);
+
+					r = _mm256_fmadd_ps(_mm256_mul_ps(t, z), hornerAVX2(z, ATAN_REFINED), t);
+					r = _mm256_add_ps(_mm256_and_ps(big, _mm256_set1_ps(PIO4_F)), r);
+				}
+
+				r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(PIO2_F), r), _mm256_cmp_ps(ay, ax, _CMP_GT_OQ));
+				r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(PI_F), r), x);
+
+				return _mm256_or_ps(r, _mm256_andnot_ps(absMask, y));
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_AVX2 inline __m256 acosAVX2(__m256 x)
+			{
+				const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+				const __m256 one = _mm256_set1_ps(1.0f);
+
+				__m256 a = _mm256_and_ps(x, absMask);
+				__m256 negative = _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ);
+
+				if(P == PRECISION_APPROXIMATE)
+				{
+					__m256 r = _mm256_mul_ps(_mm256_sqrt_ps(_mm256_sub_ps(one, a)), hornerAVX2(a, ACOS_APPROXIMATE));
+					return _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(PI_F), r), negative);
+				}
+
+				__m256 big = _mm256_cmp_ps(a, _mm256_set1_ps(0.5f), _CMP_GT_OQ);
+				__m256 z = _mm256_blendv_ps(_mm256_mul_ps(a, a), _mm256_mul_ps(_mm256_set1_ps(0.5f), _mm256_sub_ps(one, a)), big);
+				__m256 s = _mm256_blendv_ps(a, _mm256_sqrt_ps(z), big);
+				__m256 p = _mm256_fmadd_ps(_mm256_mul_ps(s, z), hornerAVX2(z, ASIN_REFINED), s);
+
+				__m256 p2 = _mm256_add_ps(p, p);
+				__m256 rBig = _mm256_blendv_ps(p2, _mm256_sub_ps(_mm256_set1_ps(PI_F), p2), negative);
+				__m256 rSmall = _mm256_sub_ps(_mm256_set1_ps(PIO2_F), _mm256_xor_ps(p, _mm256_and_ps(negative, _mm256_set1_ps(-0.0f))));
+
+				return _mm256_blendv_ps(rSmall, rBig, big);
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_AVX2 inline __m256 expAVX2(__m256 x)
+			{
+				__m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(LOG2E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+				__m256i ni = _mm256_cvtps_epi32(n);
+
+				__m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(LN2_LO), _mm256_fnmadd_ps(n, _mm256_set1_ps(LN2_HI), x));
+				__m256 q = P == PRECISION_APPROXIMATE ? hornerAVX2(r, EXP_APPROXIMATE) : hornerAVX2(r, EXP_REFINED);
+				__m256 p = _mm256_fmadd_ps(_mm256_mul_ps(r, r), q, _mm256_add_ps(_mm256_set1_ps(1.0f), r));
+
+				__m256i h = _mm256_srai_epi32(ni, 1);
+				__m256i bias = _mm256_set1_epi32(127);
+				__m256 s0 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(h, bias), 23));
+				__m256 s1 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_sub_epi32(ni, h), bias), 23));
+				p = _mm256_mul_ps(_mm256_mul_ps(p, s0), s1);
+
+				p = _mm256_blendv_ps(p, _mm256_set1_ps(HUGE_VALF), _mm256_cmp_ps(x, _mm256_set1_ps(EXP_HI), _CMP_GT_OQ));
+				return _mm256_andnot_ps(_mm256_cmp_ps(x, _mm256_set1_ps(EXP_LO), _CMP_LT_OQ), p);
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_AVX2 inline __m256 logAVX2(__m256 x)
+			{
+				__m256i bits = _mm256_castps_si256(x);
+				__m256i e = _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126));
+				__m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)), _mm256_set1_epi32(0x3f000000)));
+
+				__m256 low = _mm256_cmp_ps(m, _mm256_set1_ps(SQRT_HALF), _CMP_LT_OQ);
+				e = _mm256_add_epi32(e, _mm256_castps_si256(low));
+				__m256 f = _mm256_add_ps(_mm256_sub_ps(m, _mm256_set1_ps(1.0f)), _mm256_and_ps(low, m));
+
+				__m256 z = _mm256_mul_ps(f, f);
+				__m256 fe = _mm256_cvtepi32_ps(e);
+
+				__m256 y = _mm256_mul_ps(_mm256_mul_ps(f, z), P == PRECISION_APPROXIMATE ? hornerAVX2(f, LOG_APPROXIMATE) : hornerAVX2(f, LOG_REFINED));
+				y = _mm256_fmadd_ps(fe, _mm256_set1_ps(LN2_LO), y);
+				y = _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), z, y);
+				__m256 ret = _mm256_fmadd_ps(fe, _mm256_set1_ps(LN2_HI), _mm256_add_ps(f, y));
+
+				ret = _mm256_blendv_ps(ret, x, _mm256_cmp_ps(x, _mm256_set1_ps(HUGE_VALF), _CMP_EQ_OQ));
+				ret = _mm256_blendv_ps(ret, _mm256_set1_ps(-HUGE_VALF), _mm256_cmp_ps(x, _mm256_set1_ps(FLT_MIN), _CMP_LT_OQ));
+				return _mm256_blendv_ps(ret, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fc00000)), _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_NGE_UQ));
+			}
+
+			template<UnaryOp OP, Precision P>
+			ALFAR_TARGET_AVX2 inline __m256 unaryAVX2(__m256 x)
+			{
+				if(OP == OP_SIN || OP == OP_COS)
+				{
+					__m256 s, c;
+					sincosAVX2<P>(x, s, c);
+
+					return OP == OP_SIN ? s : c;
+				}
+
+				if(OP == OP_ACOS)
+					return acosAVX2<P>(x);
+
+				if(OP == OP_EXP)
+					return expAVX2<P>(x);
+
+				return logAVX2<P>(x);
+			}
+
+			template<UnaryOp OP, Precision P>
+			ALFAR_TARGET_AVX2 inline void unaryAVX2(const float* a, float* o, size_t p_Count)
+			{
+				size_t i = 0;
+				for(; i + 8 <= p_Count; i += 8)
+					_mm256_storeu_ps(o + i, unaryAVX2<OP, P>(_mm256_loadu_ps(a + i)));
+
+				unarySSE2<OP, P>(a + i, o + i, p_Count - i);
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_AVX2 inline void sincosAVX2(const float* a, float* s, float* c, size_t p_Count)
+			{
+				size_t i = 0;
+				for(; i + 8 <= p_Count; i += 8)
+				{
+					__m256 vs, vc;
+					sincosAVX2<P>(_mm256_loadu_ps(a + i), vs, vc);
+
+					_mm256_storeu_ps(s + i, vs);
+					_mm256_storeu_ps(c + i, vc);
+				}
+
+				sincosSSE2<P>(a + i, s + i, c + i, p_Count - i);
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_AVX2 inline void atan2AVX2(const float* y, const float* x, float* o, size_t p_Count)
+			{
+				size_t i = 0;
+				for(; i + 8 <= p_Count; i += 8)
+					_mm256_storeu_ps(o + i, atan2AVX2<P>(_mm256_loadu_ps(y + i), _mm256_loadu_ps(x + i)));
+
+				atan2SSE2<P>(y + i, x + i, o + i, p_Count - i);
+			}
+
+			//===================================================================== AVX-512
+
+			template<int N>
+			ALFAR_TARGET_AVX512 inline __m512 hornerAVX512(__m512 x, const float (&c)[N])
+			{
+				__m512 acc = _mm512_set1_ps(c[0]);
+				for(int i = 1; i < N; ++i)
+					acc = _mm512_fmadd_ps(acc, x, _mm512_set1_ps(c[i]));
+
+				return acc;
+			}
+
+			ALFAR_TARGET_AVX512 inline __m512 absAVX512(__m512 x)
+			{
+				return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(x), _mm512_set1_epi32(0x7fffffff)));
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_AVX512 inline void sincosAVX512(__m512 x, __m512& s, __m512& c)
+			{
+				__m512 q = _mm512_roundscale_ps(_mm512_mul_ps(x, _mm512_set1_ps(TWO_OVER_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+				__m512i qi = _mm512_cvtps_epi32(q);
+
+				__m512 r = _mm512_fnmadd_ps(q, _mm512_set1_ps(PIO2_1), x);
+				r = _mm512_fnmadd_ps(q, _mm512_set1_ps(PIO2_2), r);
+				r = _mm512_fnmadd_ps(q, _mm512_set1_ps(PIO2_3), r);
+				__m512 z = _mm512_mul_ps(r, r);
+
+				__m512 sp = P == PRECISION_APPROXIMATE ? hornerAVX512(z, SIN_APPROXIMATE) : hornerAVX512(z, SIN_REFINED);
+				__m512 cp = P == PRECISION_APPROXIMATE ? hornerAVX512(z, COS_APPROXIMATE) : hornerAVX512(z, COS_REFINED);
+				__m512 sr = _mm512_fmadd_ps(_mm512_mul_ps(r, z), sp, r);
+				__m512 cr = _mm512_fmadd_ps(_mm512_mul_ps(z, z), cp, _mm512_fnmadd_ps(_mm512_set1_ps(0.5f), z, _mm512_set1_ps(1.0f)));
+
+				__mmask16 swap = _mm512_test_epi32_mask(qi, _mm512_set1_epi32(1));
+				__m512i sinSign = _mm512_slli_epi32(_mm512_and_si512(qi, _mm512_set1_epi32(2)), 30);
+				__m512i cosSign = _mm512_slli_epi32(_mm512_and_si512(_mm512_add_epi32(qi, _mm512_set1_epi32(1)), _mm512_set1_epi32(2)), 30);
+
+				s = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_mm512_mask_blend_ps(swap, sr, cr)), sinSign));
+				c = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_mm512_mask_blend_ps(swap, cr, sr)), cosSign));
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_AVX512 inline __m512 atan2AVX512(__m512 y, __m512 x)
+			{
+				__m512 ax = absAVX512(x), ay = absAVX512(y);
+				__m512 mn = _mm512_min_ps(ax, ay), mx = _mm512_max_ps(ax, ay);
+				__mmask16 valid = _mm512_cmp_ps_mask(mx, _mm512_setzero_ps(), _CMP_GT_OQ);
+				__m512 r;
+
+				if(P == PRECISION_APPROXIMATE)
+				{
+					__m512 a = _mm512_maskz_div_ps(valid, mn, mx);
+					r = _mm512_mul_ps(a, hornerAVX512(_mm512_mul_ps(a, a), ATAN_APPROXIMATE));
+				}
+				else
+				{
+					__mmask16 big = _mm512_cmp_ps_mask(mn, _mm512_mul_ps(_mm512_set1_ps(TAN_PIO8), mx), _CMP_GT_OQ);
+					__m512 num = _mm512_mask_sub_ps(mn, big, mn, mx);
+					__m512 den = _mm512_mask_add_ps(mx, big, mn, mx);
+					__m512 t = _mm512_maskz_div_ps(valid, num, den);
+					__m512 z = _mm512_mul_ps(t, t);
+
+					r = _mm512_fmadd_ps(_mm512_mul_ps(t, z), hornerAVX512(z, ATAN_REFINED), t);
+					r = _mm512_mask_add_ps(r, big, r, _mm512_set1_ps(PIO4_F));
+				}
+
+				r = _mm512_mask_sub_ps(r, _mm512_cmp_ps_mask(ay, ax, _CMP_GT_OQ), _mm512_set1_ps(PIO2_F), r);
+				r = _mm512_mask_sub_ps(r, _mm512_cmplt_epi32_mask(_mm512_castps_si512(x), _mm512_setzero_si512()), _mm512_set1_ps(PI_F), r);
+
+				__m512i ySign = _mm512_and_si512(_mm512_castps_si512(y), _mm512_set1_epi32((int)0x80000000));
+				return _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(r), ySign));
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_AVX512 inline __m512 acosAVX512(__m512 x)
+			{
+				const __m512 one = _mm512_set1_ps(1.0f);
+
+				__m512 a = absAVX512(x);
+				__mmask16 negative = _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_LT_OQ);
+
+				if(P == PRECISION_APPROXIMATE)
+				{
+					__m512 r = _mm512_mul_ps(_mm512_sqrt_ps(_mm512_sub_ps(one, a)), hornerAVX512(a, ACOS_APPROXIMATE));
+					return _mm512_mask_sub_ps(r, negative, _mm512_set1_ps(PI_F), r);
+				}
+
+				__mmask16 big = _mm512_cmp_ps_mask(a, _mm512_set1_ps(0.5f), _CMP_GT_OQ);
+				__m512 z = _mm512_mask_mul_ps(_mm512_mul_ps(a, a), big, _mm512_set1_ps(0.5f), _mm512_sub_ps(one, a));
+				__m512 s = _mm512_mask_sqrt_ps(a, big, z);
+				__m512 p = _mm512_fmadd_ps(_mm512_mul_ps(s, z), hornerAVX512(z, ASIN_REFINED), s);
+
+				__m512 p2 = _mm512_add_ps(p, p);
+				__m512 rBig = _mm512_mask_sub_ps(p2, negative, _mm512_set1_ps(PI_F), p2);
+				__m512 rSmall = _mm512_sub_ps(_mm512_set1_ps(PIO2_F), _mm512_mask_sub_ps(p, negative, _mm512_setzero_ps(), p));
+
+				return _mm512_mask_blend_ps(big, rSmall, rBig);
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_AVX512 inline __m512 expAVX512(__m512 x)
+			{
+				__m512 n = _mm512_roundscale_ps(_mm512_mul_ps(x, _mm512_set1_ps(LOG2E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+				__m512i ni = _mm512_cvtps_epi32(n);
+
+				__m512 r = _mm512_fnmadd_ps(n, _mm512_set1_ps(LN2_LO), _mm512_fnmadd_ps(n, _mm512_set1_ps(LN2_HI), x));
+				__m512 q = P == PRECISION_APPROXIMATE ? hornerAVX512(r, EXP_APPROXIMATE) : hornerAVX512(r, EXP_REFINED);
+				__m512 p = _mm512_fmadd_ps(_mm512_mul_ps(r, r), q, _mm512_add_ps(_mm512_set1_ps(1.0f), r));
+
+				__m512i h = _mm512_srai_epi32(ni, 1);
+				__m512i bias = _mm512_set1_epi32(127);
+				__m512 s0 = _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_add_epi32(h, bias), 23));
+				__m512 s1 = _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_add_epi32(_mm512_sub_epi32(ni, h), bias), 23));
+				p = _mm512_mul_ps(_mm512_mul_ps(p, s0), s1);
+
+				p = _mm512_mask_mov_ps(p, _mm512_cmp_ps_mask(x, _mm512_set1_ps(EXP_HI), _CMP_GT_OQ), _mm512_set1_ps(HUGE_VALF));
+				return _mm512_mask_mov_ps(p, _mm512_cmp_ps_mask(x, _mm512_set1_ps(EXP_LO), _CMP_LT_OQ), _mm512_setzero_ps());
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_AVX512 inline __m512 logAVX512(__m512 x)
+			{
+				__m512i bits = _mm512_castps_si512(x);
+				__m512i e = _mm512_sub_epi32(_mm512_srli_epi32(bits, 23), _mm512_set1_epi32(126));
+				__m512 m = _mm512_castsi512_ps(_mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi32(0x007fffff)), _mm512_set1_epi32(0x3f000000)));
+
+				__mmask16 low = _mm512_cmp_ps_mask(m, _mm512_set1_ps(SQRT_HALF), _CMP_LT_OQ);
+				e = _mm512_mask_sub_epi32(e, low, e, _mm512_set1_epi32(1));
+				__m512 f = _mm512_sub_ps(_mm512_mask_add_ps(m, low, m, m), _mm512_set1_ps(1.0f));
+
+				__m512 z = _mm512_mul_ps(f, f);
+				__m512 fe = _mm512_cvtepi32_ps(e);
+
+				__m512 y = _mm512_mul_ps(_mm512_mul_ps(f, z), P == PRECISION_APPROXIMATE ? hornerAVX512(f, LOG_APPROXIMATE) : hornerAVX512(f, LOG_REFINED));
+				y = _mm512_fmadd_ps(fe, _mm512_set1_ps(LN2_LO), y);
+				y = _mm512_fnmadd_ps(_mm512_set1_ps(0.5f), z, y);
+				__m512 ret = _mm512_fmadd_ps(fe, _mm512_set1_ps(LN2_HI), _mm512_add_ps(f, y));
+
+				ret = _mm512_mask_mov_ps(ret, _mm512_cmp_ps_mask(x, _mm512_set1_ps(HUGE_VALF), _CMP_EQ_OQ), x);
+				ret = _mm512_mask_mov_ps(ret, _mm512_cmp_ps_mask(x, _mm512_set1_ps(FLT_MIN), _CMP_LT_OQ), _mm512_set1_ps(-HUGE_VALF));
+				return _mm512_mask_mov_ps(ret, _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_NGE_UQ), _mm512_castsi512_ps(_mm512_set1_epi32(0x7fc00000)));
+			}
+
+			template<UnaryOp OP, Precision P>
+			ALFAR_TARGET_AVX512 inline __m512 unaryAVX512(__m512 x)
+			{
+				if(OP == OP_SIN || OP == OP_COS)
+				{
+					__m512 s, c;
+					sincosAVX512<P>(x, s, c);
+
+					return OP == OP_SIN ? s : c;
+				}
+
+				if(OP == OP_ACOS)
+					return acosAVX512<P>(x);
+
+				if(OP == OP_EXP)
+					return expAVX512<P>(x);
+
+				return logAVX512<P>(x);
+			}
+
+			template<UnaryOp OP, Precision P>
+			ALFAR_TARGET_AVX512 inline void unaryAVX512(const float* a, float* o, size_t p_Count)
+			{
+				size_t i = 0;
+				for(; i + 16 <= p_Count; i += 16)
+					_mm512_storeu_ps(o + i, unaryAVX512<OP, P>(_mm512_loadu_ps(a + i)));
+
+				unaryAVX2<OP, P>(a + i, o + i, p_Count - i);
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_AVX512 inline void sincosAVX512(const float* a, float* s, float* c, size_t p_Count)
+			{
+				size_t i = 0;
+				for(; i + 16 <= p_Count; i += 16)
+				{
+					__m512 vs, vc;
+					sincosAVX512<P>(_mm512_loadu_ps(a + i), vs, vc);
+
+					_mm512_storeu_ps(s + i, vs);
+					_mm512_storeu_ps(c + i, vc);
+				}
+
+				sincosAVX2<P>(a + i, s + i, c + i, p_Count - i);
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_AVX512 inline void atan2AVX512(const float* y, const float* x, float* o, size_t p_Count)
+			{
+				size_t i = 0;
+				for(; i + 16 <= p_Count; i += 16)
+					_mm512_storeu_ps(o + i, atan2AVX512<P>(_mm512_loadu_ps(y + i), _mm512_loadu_ps(x + i)));
+
+				atan2AVX2<P>(y + i, x + i, o + i, p_Count - i);
+			}
+
+#endif
+
+			//===================================================================== dispatch
+
+			template<UnaryOp OP, Precision P>
+			inline void unary(const float* a, float* o, size_t p_Count)
+			{
+				if(P == PRECISION_EXACT)
+				{
+					unaryScalar<OP, P>(a, o, p_Count);
+					return;
+				}
+
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	unaryAVX512<OP, P>(a, o, p_Count); return;
+				case cpu::LEVEL_AVX2:	unaryAVX2<OP, P>(a, o, p_Count); return;
+				case cpu::LEVEL_SSE2:	unarySSE2<OP, P>(a, o, p_Count); return;
+#endif
+				default:				unaryScalar<OP, P>(a, o, p_Count); return;
+				}
+			}
+
+			template<Precision P>
+			inline void sincos(const float* a, float* s, float* c, size_t p_Count)
+			{
+				if(P == PRECISION_EXACT)
+				{
+					sincosScalar<P>(a, s, c, p_Count);
+					return;
+				}
+
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	sincosAVX512<P>(a, s, c, p_Count); return;
+				case cpu::LEVEL_AVX2:	sincosAVX2<P>(a, s, c, p_Count); return;
+				case cpu::LEVEL_SSE2:	sincosSSE2<P>(a, s, c, p_Count); return;
+#endif
+				default:				sincosScalar<P>(a, s, c, p_Count); return;
+				}
+			}
+
+			template<Precision P>
+			inline void atan2(const float* y, const float* x, float* o, size_t p_Count)
+			{
+				if(P == PRECISION_EXACT)
+				{
+					atan2Scalar<P>(y, x, o, p_Count);
+					return;
+				}
+
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	atan2AVX512<P>(y, x, o, p_Count); return;
+				case cpu::LEVEL_AVX2:	atan2AVX2<P>(y, x, o, p_Count); return;
+				case cpu::LEVEL_SSE2:	atan2SSE2<P>(y, x, o, p_Count); return;
+#endif
+				default:				atan2Scalar<P>(y, x, o, p_Count); return;
+				}
+			}
+		}
+	}
+}
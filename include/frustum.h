@@ -0,0 +1,100 @@
+#pragma once
+
+#include "math_types.h"
+#include "functions.h"
+#include "vector3.h"
+#include "vector4.h"
+#include "aabb.h"
+#include "frustum_simd.h"
+#include <math.h>
+#include <stdint.h>
+
+// View frustum culling. fromMatrix extracts the 6 planes of a view-projection
+// matrix (Gribb/Hartmann) for the clip space of mat4x4::persp and mat4x4::ortho:
+// -w <= x, y, z <= w with column vectors, i.e. clip = vector4::mul(viewProj, p).
+// Planes are normalized so distances are in world units.
+//
+// The box and sphere tests are conservative: an element outside of a single
+// plane is culled, one straddling two planes near a frustum corner may be
+// kept. The cull functions write the indices of the kept elements to
+// p_Visible, which holds as many entries as there are elements, in increasing
+// order and return their number.
+
+namespace alfar
+{
+	namespace frustum
+	{
+		static_assert(sizeof(Frustum) == 24 * sizeof(float), "Frustum must be 6 packed planes of 4 floats");
+
+		//plane a*x + b*y + c*z + d >= 0 scaled to a unit normal
+		inline Plane plane(const Vector4& p_Coefficients)
+		{
+			float length = sqrtf(p_Coefficients.x * p_Coefficients.x + p_Coefficients.y * p_Coefficients.y + p_Coefficients.z * p_Coefficients.z);
+
+			Plane ret = {};
+			ret.normal = vector3::create(p_Coefficients.x / length, p_Coefficients.y / length, p_Coefficients.z / length);
+			ret.d = p_Coefficients.w / length;
+
+			return ret;
+		}
+
+		inline Frustum fromMatrix(const Matrix4x4& p_ViewProj)
+		{
+			const Matrix4x4& m = p_ViewProj;
+
+			Frustum ret = {};
+			ret.planes[0] = plane(vector4::add(m.t, m.x));
+			ret.planes[1] = plane(vector4::sub(m.t, m.x));
+			ret.planes[2] = plane(vector4::add(m.t, m.y));
+			ret.planes[3] = plane(vector4::sub(m.t, m.y));
+			ret.planes[4] = plane(vector4::add(m.t, m.z));
+			ret.planes[5] = plane(vector4::sub(m.t, m.z));
+
+			return ret;
+		}
+
+		//---------------------------------------------------------------------
+
+		//signed distance, positive inside
+		ALFAR_CONSTEXPR float distance(const Plane& p_Plane, const Vector3& p_Point)
+		{
+			return vector3::dot(p_Plane.normal, p_Point) + p_Plane.d;
+		}
+
+		ALFAR_CONSTEXPR bool contains(const Frustum& p_Frustum, const Vector3& p_Point)
+		{
+			for(int p = 0; p < 6; ++p)
+			{
+				if(distance(p_Frustum.planes[p], p_Point) < 0)
+					return false;
+			}
+
+			return true;
+		}
+
+		//same test as cull, empty boxes are culled
+		inline bool intersects(const Frustum& p_Frustum, const AABB& p_Box)
+		{
+			return simd::boxVisible(&p_Frustum.planes[0].normal.x, &p_Box.min.x);
+		}
+
+		inline bool intersects(const Frustum& p_Frustum, const Vector3& p_Center, float p_Radius)
+		{
+			return simd::sphereVisible(&p_Frustum.planes[0].normal.x, p_Center.x, p_Center.y, p_Center.z, p_Radius);
+		}
+
+		//----- array version
+
+		inline uint32_t cull(const Frustum& p_Frustum, const AABB* p_Boxes, uint32_t p_Number, uint32_t* p_Visible)
+		{
+			return simd::boxes(&p_Frustum.planes[0].normal.x, &p_Boxes->min.x, p_Visible, 0, 0, p_Number);
+		}
+
+		//spheres p_Centers[i], p_Radii[i]
+		inline uint32_t cull(const Frustum& p_Frustum, const Vector3Stream& p_Centers, const float* p_Radii, uint32_t* p_Visible)
+		{
+			const float* c[3] = { p_Centers.x, p_Centers.y, p_Centers.z };
+			return simd::spheres(&p_Frustum.planes[0].normal.x, c, p_Radii, p_Visible, 0, 0, p_Centers.count);
+		}
+	}
+}
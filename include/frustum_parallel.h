@@ -0,0 +1,73 @@
+#pragma once
+
+#include "frustum.h"
+#include "parallel.h"
+#include <stdint.h>
+#include <string.h>
+
+// Frustum culling over the pool of a Policy, with the same output as the
+// serial cull: the slices are compacted in order.
+
+namespace alfar
+{
+	namespace frustum
+	{
+		//runs p_Range(start, end) over slices of at least MIN_SLICE elements on the pool of
+		//p_Policy, at most parallel::MAX_CHUNKS of them. Each slice appends its indices from
+		//p_Visible + start and returns where it stopped; the slices are then moved together
+		//in order.
+		template<typename RANGE>
+		inline uint32_t cullRanges(const parallel::Policy& p_Policy, RANGE p_Range, uint32_t p_Number, uint32_t* p_Visible)
+		{
+			const uint32_t MIN_SLICE = 16384;
+
+			if(p_Number < p_Policy.minElements || p_Number <= MIN_SLICE || parallel::insideJob())
+				return p_Range(0, p_Number);
+
+			uint32_t slice = (uint32_t)(((uint64_t)p_Number + parallel::MAX_CHUNKS - 1) / parallel::MAX_CHUNKS);
+			slice = slice < MIN_SLICE ? MIN_SLICE : aligned::paddedCount(slice);
+			uint32_t slices = (uint32_t)(((uint64_t)p_Number + slice - 1) / slice);
+
+			uint32_t ends[parallel::MAX_CHUNKS];
+			parallel::forEach(p_Policy, slices, 1, [&](uint32_t p_Start, uint32_t p_End)
+			{
+				for(uint32_t k = p_Start; k < p_End; ++k)
+				{
+					uint32_t start = k * slice;
+					ends[k] = p_Range(start, p_Number - start < slice ? p_Number : start + slice);
+				}
+			});
+
+			uint32_t count = ends[0];
+			for(uint32_t k = 1; k < slices; ++k)
+			{
+				uint32_t start = k * slice;
+				memmove(p_Visible + count, p_Visible + start, (ends[k] - start) * sizeof(uint32_t));
+				count += ends[k] - start;
+			}
+
+			return count;
+		}
+
+		//same result as cull, the input split by cullRanges
+		inline uint32_t cull(const parallel::Policy& p_Policy, const Frustum& p_Frustum, const AABB* p_Boxes, uint32_t p_Number, uint32_t* p_Visible)
+		{
+			const float* planes = &p_Frustum.planes[0].normal.x;
+			const float* boxes = &p_Boxes->min.x;
+
+			return cullRanges(p_Policy, [=](uint32_t p_Start, uint32_t p_End) { return simd::boxes(planes, boxes, p_Visible, p_Start, p_Start, p_End); },
+							  p_Number, p_Visible);
+		}
+
+		inline uint32_t cull(const parallel::Policy& p_Policy, const Frustum& p_Frustum, const Vector3Stream& p_Centers, const float* p_Radii, uint32_t* p_Visible)
+		{
+			const float* planes = &p_Frustum.planes[0].normal.x;
+			const float* cx = p_Centers.x;
+			const float* cy = p_Centers.y;
+			const float* cz = p_Centers.z;
+
+			return cullRanges(p_Policy, [=](uint32_t p_Start, uint32_t p_End) { const float* c[3] = { cx, cy, cz }; return simd::spheres(planes, c, p_Radii, p_Visible, p_Start, p_Start, p_End); },
+							  p_Centers.count, p_Visible);
+		}
+	}
+}
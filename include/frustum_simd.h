@@ -0,0 +1,396 @@
+#pragma once
+
+#include "cpu.h"
+#include "vector3_simd.h"
+#include <math.h>
+#include <stdint.h>
+
+// SIMD kernels behind frustum.h. p_Planes is the 6 planes of a Frustum as
+// 24 floats (nx ny nz d each), normalized, positive inside.
+//  - boxes: AoS AABB array (min then max, 6 floats). With c = min + max and
+//    e = max - min a box is kept when dot(n, c) + dot(|n|, e) >= -2d for every
+//    plane, i.e. its most inside corner is on the inside of every plane.
+//  - spheres: SoA centers and radii, kept when dot(n, c) + r >= -d.
+// Comparisons are written so that NaN (e.g. aabb::empty()) is culled.
+// Indices of the kept elements are appended to p_Out in increasing order; a
+// kernel takes the count so far and returns the new count. p_Out is written
+// at most up to the index being tested, so a range [p_Start, p_Count) only
+// touches p_Out[p_Visible .. p_Count).
+
+namespace alfar
+{
+	namespace frustum
+	{
+		namespace simd
+		{
+			//appends p_First + k for the set bits k of p_Mask. Branchless: every
+			//candidate is written, only the kept ones advance the count.
+			template<int BITS>
+			inline uint32_t compact(uint32_t p_Mask, uint32_t p_First, uint32_t* p_Out, uint32_t p_Visible)
+			{
+				for(int k = 0; k < BITS; ++k)
+				{
+					p_Out[p_Visible] = p_First + k;
+					p_Visible += (p_Mask >> k) & 1;
+				}
+
+				return p_Visible;
+			}
+
+			//===================================================================== scalar
+
+			inline bool boxVisible(const float* p_Planes, const float* b)
+			{
+				float cx = b[0] + b[3], cy = b[1] + b[4], cz = b[2] + b[5];
+				float ex = b[3] - b[0], ey = b[4] - b[1], ez = b[5] - b[2];
+
+				for(int p = 0; p < 6; ++p)
+				{
+					const float* n = p_Planes + p * 4;
+					float dist = n[0] * cx + n[1] * cy + n[2] * cz + (fabsf(n[0]) * ex + fabsf(n[1]) * ey + fabsf(n[2]) * ez);
+
+					if(!(dist >= -2.0f * n[3]))
+						return false;
+				}
+
+				return true;
+			}
+
+			inline bool sphereVisible(const float* p_Planes, float cx, float cy, float cz, float r)
+			{
+				for(int p = 0; p < 6; ++p)
+				{
+					const float* n = p_Planes + p * 4;
+					float dist = n[0] * cx + n[1] * cy + n[2] * cz + r;
+
+					if(!(dist >= -n[3]))
+						return false;
+				}
+
+				return true;
+			}
+
+			inline uint32_t boxesScalar(const float* p_Planes, const float* p_Boxes, uint32_t* p_Out, uint32_t p_Visible, uint32_t p_Start, uint32_t p_Count)
+			{
+				for(uint32_t i = p_Start; i < p_Count; ++i)
+				{
+					p_Out[p_Visible] = i;
+					p_Visible += boxVisible(p_Planes, p_Boxes + i * 6) ? 1 : 0;
+				}
+
+				return p_Visible;
+			}
+
+			inline uint32_t spheresScalar(const float* p_Planes, const float* const* c, const float* r, uint32_t* p_Out, uint32_t p_Visible, uint32_t p_Start, uint32_t p_Count)
+			{
+				for(uint32_t i = p_Start; i < p_Count; ++i)
+				{
+					p_Out[p_Visible] = i;
+					p_Visible += sphereVisible(p_Planes, c[0][i], c[1][i], c[2][i], r[i]) ? 1 : 0;
+				}
+
+				return p_Visible;
+			}
+
+#if ALFAR_X86
+
+			//===================================================================== SSE2
+
+			//the 6 planes as broadcast lanes
+			struct PlanesSSE2
+			{
+				__m128 n[6][3], a[6][3], d[6];
+			};
+
+			//the compare limit is -d for the spheres (p_Box false), -2d for the boxes
+			ALFAR_TARGET_SSE2 inline void loadPlanes(const float* p_Planes, bool p_Box, PlanesSSE2& p)
+			{
+				for(int k = 0; k < 6; ++k)
+				{
+					for(int c = 0; c < 3; ++c)
+					{
+						p.n[k][c] = _mm_set1_ps(p_Planes[k * 4 + c]);
+						p.a[k][c] = _mm_set1_ps(fabsf(p_Planes[k * 4 + c]));
+					}
+
+					p.d[k] = _mm_set1_ps(p_Box ? -2.0f * p_Planes[k * 4 + 3] : -p_Planes[k * 4 + 3]);
+				}
+			}
+
+			ALFAR_TARGET_SSE2 inline uint32_t boxesSSE2(const float* p_Planes, const float* p_Boxes, uint32_t* p_Out, uint32_t p_Visible, uint32_t p_Start, uint32_t p_Count)
+			{
+				PlanesSSE2 p;
+				loadPlanes(p_Planes, true, p);
+
+				uint32_t i = p_Start;
+				for(; i + 4 <= p_Count; i += 4)
+				{
+					//8 corners: min0 max0 min1 max1, then boxes 2 and 3
+					const float* b = p_Boxes + i * 6;
+					__m128 x0, y0, z0, x1, y1, z1;
+					vector3::simd::deinterleave(_mm_loadu_ps(b), _mm_loadu_ps(b + 4), _mm_loadu_ps(b + 8), x0, y0, z0);
+					vector3::simd::deinterleave(_mm_loadu_ps(b + 12), _mm_loadu_ps(b + 16), _mm_loadu_ps(b + 20), x1, y1, z1);
+
+					__m128 minX = _mm_shuffle_ps(x0, x1, _MM_SHUFFLE(2, 0, 2, 0)), maxX = _mm_shuffle_ps(x0, x1, _MM_SHUFFLE(3, 1, 3, 1));
+					__m128 minY = _mm_shuffle_ps(y0, y1, _MM_SHUFFLE(2, 0, 2, 0)), maxY = _mm_shuffle_ps(y0, y1, _MM_SHUFFLE(3, 1, 3, 1));
+					__m128 minZ = _mm_shuffle_ps(z0, z1, _MM_SHUFFLE(2, 0, 2, 0)), maxZ = _mm_shuffle_ps(z0, z1, _MM_SHUFFLE(3, 1, 3, 1));
+
+					__m128 cx = _mm_add_ps(minX, maxX), cy = _mm_add_ps(minY, maxY), cz = _mm_add_ps(minZ, maxZ);
+					__m128 ex = _mm_sub_ps(maxX, minX), ey = _mm_sub_ps(maxY, minY), ez = _mm_sub_ps(maxZ, minZ);
+
+					__m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+					for(int k = 0; k < 6; ++k)
+					{
+						__m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(p.n[k][0], cx), _mm_mul_ps(p.n[k][1], cy)), _mm_mul_ps(p.n[k][2], cz)),
+												 _mm_add_ps(_mm_add_ps(_mm_mul_ps(p.a[k][0], ex), _mm_mul_ps(p.a[k][1], ey)), _mm_mul_ps(p.a[k][2], ez)));
+						visible = _mm_and_ps(visible, _mm_cmpge_ps(dist, p.d[k]));
+					}
+
+					p_Visible = compact<4>((uint32_t)_mm_movemask_ps(visible), i, p_Out, p_Visible);
+				}
+
+				return boxesScalar(p_Planes, p_Boxes, p_Out, p_Visible, i, p_Count);
+			}
+
+			ALFAR_TARGET_SSE2 inline uint32_t spheresSSE2(const float* p_Planes, const float* const* c, const float* r, uint32_t* p_Out, uint32_t p_Visible, uint32_t p_Start, uint32_t p_Count)
+			{
+				PlanesSSE2 p;
+				loadPlanes(p_Planes, false, p);
+
+				uint32_t i = p_Start;
+				for(; i + 4 <= p_Count; i += 4)
+				{
+					__m128 cx = _mm_loadu_ps(c[0] + i), cy = _mm_loadu_ps(c[1] + i), cz = _mm_loadu_ps(c[2] + i);
+					__m128 radius = _mm_loadu_ps(r + i);
+
+					__m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+					for(int k = 0; k < 6; ++k)
+					{
+						__m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(p.n[k][0], cx), _mm_mul_ps(p.n[k][1], cy)), _mm_mul_ps(p.n[k][2], cz)), radius);
+						visible = _mm_and_ps(visible, _mm_cmpge_ps(dist, p.d[k]));
+					}
+
+					p_Visible = compact<4>((uint32_t)_mm_movemask_ps(visible), i, p_Out, p_Visible);
+				}
+
+				return spheresScalar(p_Planes, c, r, p_Out, p_Visible, i, p_Count);
+			}
+
+			//===================================================================== AVX2
+
+			struct PlanesAVX2
+			{
+				__m256 n[6][3], a[6][3], d[6];
+			};
+
+			ALFAR_TARGET_AVX2 inline void loadPlanes(const float* p_Planes, bool p_Box, PlanesAVX2& p)
+			{
+				for(int k = 0; k < 6; ++k)
+				{
+					for(int c = 0; c < 3; ++c)
+					{
+						p.n[k][c] = _mm256_set1_ps(p_Planes[k * 4 + c]);
+						p.a[k][c] = _mm256_set1_ps(fabsf(p_Planes[k * 4 + c]));
+					}
+
+					p.d[k] = _mm256_set1_ps(p_Box ? -2.0f * p_Planes[k * 4 + 3] : -p_Planes[k * 4 + 3]);
+				}
+			}
+
+			ALFAR_TARGET_AVX2 inline uint32_t boxesAVX2(const float* p_Planes, const float* p_Boxes, uint32_t* p_Out, uint32_t p_Visible, uint32_t p_Start, uint32_t p_Count)
+			{
+				PlanesAVX2 p;
+				loadPlanes(p_Planes, true, p);
+
+				uint32_t i = p_Start;
+				for(; i + 8 <= p_Count; i += 8)
+				{
+					//corners 0..7 then 8..15 in order, the even/odd split leaves the boxes as 0 1 4 5 | 2 3 6 7
+					const float* b = p_Boxes + i * 6;
+					__m256 m0, m1, m2, x0, y0, z0, x1, y1, z1;
+					vector3::simd::load8(b, m0, m1, m2);
+					vector3::simd::deinterleave(m0, m1, m2, x0, y0, z0);
+					vector3::simd::load8(b + 24, m0, m1, m2);
+					vector3::simd::deinterleave(m0, m1, m2, x1, y1, z1);
+
+					__m256 minX = _mm256_shuffle_ps(x0, x1, _MM_SHUFFLE(2, 0, 2, 0)), maxX = _mm256_shuffle_ps(x0, x1, _MM_SHUFFLE(3, 1, 3, 1));
+					__m256 minY = _mm256_shuffle_ps(y0, y1, _MM_SHUFFLE(2, 0, 2, 0)), maxY = _mm256_shuffle_ps(y0, y1, _MM_SHUFFLE(3, 1, 3, 1));
+					__m256 minZ = _mm256_shuffle_ps(z0, z1, _MM_SHUFFLE(2, 0, 2, 0)), maxZ = _mm256_shuffle_ps(z0, z1, _MM_SHUFFLE(3, 1, 3, 1));
+
+					__m256 cx = _mm256_add_ps(minX, maxX), cy = _mm256_add_ps(minY, maxY), cz = _mm256_add_ps(minZ, maxZ);
+					__m256 ex = _mm256_sub_ps(maxX, minX), ey = _mm256_sub_ps(maxY, minY), ez = _mm256_sub_ps(maxZ, minZ);
+
+					__m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+					for(int k = 0; k < 6; ++k)
+					{
+						__m256 dist = _mm256_fmadd_ps(p.n[k][2], cz, _mm256_fmadd_ps(p.n[k][1], cy, _mm256_mul_ps(p.n[k][0], cx)));
+						dist = _mm256_add_ps(dist, _mm256_fmadd_ps(p.a[k][2], ez, _mm256_fmadd_ps(p.a[k][1], ey, _mm256_mul_ps(p.a[k][0], ex))));
+						visible = _mm256_and_ps(visible, _mm256_cmp_ps(dist, p.d[k], _CMP_GE_OQ));
+					}
+
+					//back to box order: lanes 2 3 hold boxes 4 5 and lanes 4 5 boxes 2 3
+					uint32_t mask = (uint32_t)_mm256_movemask_ps(visible);
+					mask = (mask & 0xc3) | ((mask & 0x0c) << 2) | ((mask & 0x30) >> 2);
+
+					p_Visible = compact<8>(mask, i, p_Out, p_Visible);
+				}
+
+				return boxesSSE2(p_Planes, p_Boxes, p_Out, p_Visible, i, p_Count);
+			}
+
+			ALFAR_TARGET_AVX2 inline uint32_t spheresAVX2(const float* p_Planes, const float* const* c, const float* r, uint32_t* p_Out, uint32_t p_Visible, uint32_t p_Start, uint32_t p_Count)
+			{
+				PlanesAVX2 p;
+				loadPlanes(p_Planes, false, p);
+
+				uint32_t i = p_Start;
+				for(; i + 8 <= p_Count; i += 8)
+				{
+					__m256 cx = _mm256_loadu_ps(c[0] + i), cy = _mm256_loadu_ps(c[1] + i), cz = _mm256_loadu_ps(c[2] + i);
+					__m256 radius = _mm256_loadu_ps(r + i);
+
+					__m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+					for(int k = 0; k < 6; ++k)
+					{
+						__m256 dist = _mm256_fmadd_ps(p.n[k][2], cz, _mm256_fmadd_ps(p.n[k][1], cy, _mm256_mul_ps(p.n[k][0], cx)));
+						visible = _mm256_and_ps(visible, _mm256_cmp_ps(_mm256_add_ps(dist, radius), p.d[k], _CMP_GE_OQ));
+					}
+
+					p_Visible = compact<8>((uint32_t)_mm256_movemask_ps(visible), i, p_Out, p_Visible);
+				}
+
+				return spheresSSE2(p_Planes, c, r, p_Out, p_Visible, i, p_Count);
+			}
+
+			//===================================================================== AVX-512
+
+			struct PlanesAVX512
+			{
+				__m512 n[6][3], a[6][3], d[6];
+			};
+
+			ALFAR_TARGET_AVX512 inline void loadPlanes(const float* p_Planes, bool p_Box, PlanesAVX512& p)
+			{
+				for(int k = 0; k < 6; ++k)
+				{
+					for(int c = 0; c < 3; ++c)
+					{
+						p.n[k][c] = _mm512_set1_ps(p_Planes[k * 4 + c]);
+						p.a[k][c] = _mm512_set1_ps(fabsf(p_Planes[k * 4 + c]));
+					}
+
+					p.d[k] = _mm512_set1_ps(p_Box ? -2.0f * p_Planes[k * 4 + 3] : -p_Planes[k * 4 + 3]);
+				}
+			}
+
+			//compress store of the kept indices
+			ALFAR_TARGET_AVX512 inline uint32_t compact16(__mmask16 p_Mask, uint32_t p_First, uint32_t* p_Out, uint32_t p_Visible)
+			{
+				__m512i index = _mm512_add_epi32(_mm512_set1_epi32((int32_t)p_First), _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+				_mm512_mask_compressstoreu_epi32(p_Out + p_Visible, p_Mask, index);
+
+				uint32_t bits = p_Mask;
+				bits = bits - ((bits >> 1) & 0x5555);
+				bits = (bits & 0x3333) + ((bits >> 2) & 0x3333);
+				bits = (bits + (bits >> 4)) & 0x0f0f;
+
+				return p_Visible + ((bits + (bits >> 8)) & 0x1f);
+			}
+
+			ALFAR_TARGET_AVX512 inline uint32_t boxesAVX512(const float* p_Planes, const float* p_Boxes, uint32_t* p_Out, uint32_t p_Visible, uint32_t p_Start, uint32_t p_Count)
+			{
+				PlanesAVX512 p;
+				loadPlanes(p_Planes, true, p);
+
+				const __m512i even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+				const __m512i odd = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+
+				uint32_t i = p_Start;
+				for(; i + 16 <= p_Count; i += 16)
+				{
+					//corners 0..15 then 16..31 in order, the even ones are the mins
+					const float* b = p_Boxes + i * 6;
+					__m512 m0, m1, m2, x0, y0, z0, x1, y1, z1;
+					vector3::simd::load16(b, m0, m1, m2);
+					vector3::simd::deinterleave(m0, m1, m2, x0, y0, z0);
+					vector3::simd::load16(b + 48, m0, m1, m2);
+					vector3::simd::deinterleave(m0, m1, m2, x1, y1, z1);
+
+					__m512 minX = _mm512_permutex2var_ps(x0, even, x1), maxX = _mm512_permutex2var_ps(x0, odd, x1);
+					__m512 minY = _mm512_permutex2var_ps(y0, even, y1), maxY = _mm512_permutex2var_ps(y0, odd, y1);
+					__m512 minZ = _mm512_permutex2var_ps(z0, even, z1), maxZ = _mm512_permutex2var_ps(z0, odd, z1);
+
+					__m512 cx = _mm512_add_ps(minX, maxX), cy = _mm512_add_ps(minY, maxY), cz = _mm512_add_ps(minZ, maxZ);
+					__m512 ex = _mm512_sub_ps(maxX, minX), ey = _mm512_sub_ps(maxY, minY), ez = _mm512_sub_ps(maxZ, minZ);
+
+					__mmask16 visible = 0xffff;
+					for(int k = 0; k < 6; ++k)
+					{
+						__m512 dist = _mm512_fmadd_ps(p.n[k][2], cz, _mm512_fmadd_ps(p.n[k][1], cy, _mm512_mul_ps(p.n[k][0], cx)));
+						dist = _mm512_add_ps(dist, _mm512_fmadd_ps(p.a[k][2], ez, _mm512_fmadd_ps(p.a[k][1], ey, _mm512_mul_ps(p.a[k][0], ex))));
+						visible = _mm512_mask_cmp_ps_mask(visible, dist, p.d[k], _CMP_GE_OQ);
+					}
+
+					p_Visible = compact16(visible, i, p_Out, p_Visible);
+				}
+
+				return boxesAVX2(p_Planes, p_Boxes, p_Out, p_Visible, i, p_Count);
+			}
+
+			ALFAR_TARGET_AVX512 inline uint32_t spheresAVX512(const float* p_Planes, const float* const* c, const float* r, uint32_t* p_Out, uint32_t p_Visible, uint32_t p_Start, uint32_t p_Count)
+			{
+				PlanesAVX512 p;
+				loadPlanes(p_Planes, false, p);
+
+				uint32_t i = p_Start;
+				for(; i + 16 <= p_Count; i += 16)
+				{
+					__m512 cx = _mm512_loadu_ps(c[0] + i), cy = _mm512_loadu_ps(c[1] + i), cz = _mm512_loadu_ps(c[2] + i);
+					__m512 radius = _mm512_loadu_ps(r + i);
+
+					__mmask16 visible = 0xffff;
+					for(int k = 0; k < 6; ++k)
+					{
+						__m512 dist = _mm512_fmadd_ps(p.n[k][2], cz, _mm512_fmadd_ps(p.n[k][1], cy, _mm512_mul_ps(p.n[k][0], cx)));
+						visible = _mm512_mask_cmp_ps_mask(visible, _mm512_add_ps(dist, radius), p.d[k], _CMP_GE_OQ);
+					}
+
+					p_Visible = compact16(visible, i, p_Out, p_Visible);
+				}
+
+				return spheresAVX2(p_Planes, c, r, p_Out, p_Visible, i, p_Count);
+			}
+
+#endif
+
+			//===================================================================== dispatch
+
+			//returns p_Visible plus the number of boxes kept in [p_Start, p_Count)
+			inline uint32_t boxes(const float* p_Planes, const float* p_Boxes, uint32_t* p_Out, uint32_t p_Visible, uint32_t p_Start, uint32_t p_Count)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	return boxesAVX512(p_Planes, p_Boxes, p_Out, p_Visible, p_Start, p_Count);
+				case cpu::LEVEL_AVX2:	return boxesAVX2(p_Planes, p_Boxes, p_Out, p_Visible, p_Start, p_Count);
+				case cpu::LEVEL_SSE2:	return boxesSSE2(p_Planes, p_Boxes, p_Out, p_Visible, p_Start, p_Count);
+#endif
+				default:				return boxesScalar(p_Planes, p_Boxes, p_Out, p_Visible, p_Start, p_Count);
+				}
+			}
+
+			inline uint32_t spheres(const float* p_Planes, const float* const* c, const float* r, uint32_t* p_Out, uint32_t p_Visible, uint32_t p_Start, uint32_t p_Count)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	return spheresAVX512(p_Planes, c, r, p_Out, p_Visible, p_Start, p_Count);
+				case cpu::LEVEL_AVX2:	return spheresAVX2(p_Planes, c, r, p_Out, p_Visible, p_Start, p_Count);
+				case cpu::LEVEL_SSE2:	return spheresSSE2(p_Planes, c, r, p_Out, p_Visible, p_Start, p_Count);
+#endif
+				default:				return spheresScalar(p_Planes, c, r, p_Out, p_Visible, p_Start, p_Count);
+				}
+			}
+		}
+	}
+}
@@ -1,16 +1,30 @@
 #pragma once
 
+#include "cpu.h"
 #include <math.h>
+#include <string.h>
+#include <limits>
+
+// The scalar, non transcendental functions of the library are ALFAR_CONSTEXPR
+// so constant tables (basis, projection matrices...) are built at compile time.
+// They need C++14 relaxed constexpr, older compilers get plain inline functions.
+#if (defined(__cpp_constexpr) && __cpp_constexpr >= 201304) || (defined(_MSC_VER) && _MSC_VER >= 1910)
+#define ALFAR_CONSTEXPR constexpr
+#define ALFAR_HAS_CONSTEXPR 1
+#else
+#define ALFAR_CONSTEXPR inline
+#define ALFAR_HAS_CONSTEXPR 0
+#endif
 
 namespace alfar
 {
-	inline int iround(const float f)
+	ALFAR_CONSTEXPR int iround(const float f)
 	{
 		return (int)(f+0.5f);
 	}
 
 	template<typename T>
-	T min3(const T a, const T b, const T c)
+	ALFAR_CONSTEXPR T min3(const T a, const T b, const T c)
 	{
 		T t = (a > b ? b : a);
 
@@ -18,7 +32,7 @@ namespace alfar
 	}
 
 	template<typename T>
-	T max3(const T a, const T b, const T c)
+	ALFAR_CONSTEXPR T max3(const T a, const T b, const T c)
 	{
 		T t = (a < b ? b : a);
 
@@ -26,17 +40,121 @@ namespace alfar
 	}
 
 	template<typename T>
-	T clamp(const T v, const T min, const T max)
+	ALFAR_CONSTEXPR T clamp(const T v, const T min, const T max)
 	{
 		T t = v > min ? v : min;
 
 		return t < max ? t : max;
 	}
 
-	inline bool approximatly(float a, float b)
+	ALFAR_CONSTEXPR bool approximatly(float a, float b)
+	{
+		return (a - b) < 0.00001f && (b - a) < 0.00001f;
+	}
+
+	//----- compile time sqrt/sin/cos
+	//libm is not constexpr, those are for constant tables only: they are a lot
+	//slower than sqrtf/sinf/cosf at runtime.
+
+	//newton iterations, starting above the root so the sequence decreases until it converges
+	ALFAR_CONSTEXPR float constSqrt(float x)
+	{
+		if(!(x > 0.0f))
+			return x == 0.0f ? 0.0f : std::numeric_limits<float>::quiet_NaN();
+
+		if(x == std::numeric_limits<float>::infinity())
+			return x;
+
+		double r = x > 1.0f ? x : 1.0;
+
+		for(int i = 0; i < 256; ++i)
+		{
+			double next = 0.5 * (r + x / r);
+			if(next >= r)
+				break;
+
+			r = next;
+		}
+
+		return (float)r;
+	}
+
+	//taylor series on [-pi/2, pi/2] after range reduction, about 1 ulp in float
+	ALFAR_CONSTEXPR double constSinDouble(double a)
+	{
+		const double PI = 3.14159265358979323846;
+
+		double turns = a / (2.0 * PI);
+		a -= 2.0 * PI * (double)(long long)(turns < 0 ? turns - 0.5 : turns + 0.5);
+
+		//a in [-pi, pi], fold to [-pi/2, pi/2] with sin(pi - a) = sin(a)
+		if(a > PI * 0.5)
+			a = PI - a;
+		else if(a < -PI * 0.5)
+			a = -PI - a;
+
+		double a2 = a * a;
+		double term = a;
+		double sum = a;
+
+		for(int i = 1; i < 10; ++i)
+		{
+			term *= -a2 / ((2 * i) * (2 * i + 1));
+			sum += term;
+		}
+
+		return sum;
+	}
+
+	ALFAR_CONSTEXPR float constSin(float x)
 	{
-#define TOLERANCE 0.00001f;
+		return (float)constSinDouble(x);
+	}
+
+	ALFAR_CONSTEXPR float constCos(float x)
+	{
+		return (float)constSinDouble((double)x + 3.14159265358979323846 * 0.5);
+	}
+
+	//----- inverse square root
+	//accuracy tiers of rsqrt and of the fastNormalize/fastMagnitude family, as the
+	//max relative error of the result on every dispatch level. fastmath.h lists
+	//what they mean for each of its functions.
+
+	enum Precision
+	{
+		PRECISION_APPROXIMATE,	//hardware estimate alone, < 4e-4
+		PRECISION_REFINED,		//estimate and one Newton-Raphson step, < 1e-6
+		PRECISION_EXACT			//sqrt and division, about 1 ulp
+	};
+
+	//1 / sqrt(x) for a positive x. Without SSE at build time (ALFAR_MIN_LEVEL 0) the
+	//estimate is a bit trick refined twice and REFINED is 1 / sqrtf(x), both within their tier.
+	template<Precision P>
+	inline float rsqrt(float x)
+	{
+		if(P == PRECISION_EXACT)
+			return 1.0f / sqrtf(x);
+
+#if ALFAR_X86 && ALFAR_MIN_LEVEL >= 1
+		float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+
+		if(P == PRECISION_REFINED)
+			y = y * (1.5f - (0.5f * x) * (y * y));
+
+		return y;
+#else
+		if(P == PRECISION_REFINED)
+			return 1.0f / sqrtf(x);
+
+		uint32_t bits = 0;
+		memcpy(&bits, &x, sizeof(float));
+		bits = 0x5f375a86 - (bits >> 1);
 
-		return fabs(a-b) < TOLERANCE;
+		float y = 0;
+		memcpy(&y, &bits, sizeof(float));
+		y = y * (1.5f - (0.5f * x) * (y * y));
+		return y * (1.5f - (0.5f * x) * (y * y));
+#endif
 	}
-}
\ No newline at end of file
+}
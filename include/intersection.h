@@ -0,0 +1,69 @@
+#pragma once
+
+#include "math_types.h"
+#include "intersection_simd.h"
+#include <stdint.h>
+
+// Batched ray queries. Distances are in units of the ray direction (the
+// direction does not need to be normalized) and -1 means no hit, as for
+// vector3::raySphereIntersection and vector3::linePlaneIntersection which
+// give the same result for a single ray and primitive.
+//
+// Spheres are a Vector3Stream of centers and an array of p_Centers.count
+// radii; ray batches are two Vector3Stream of origins and directions with the
+// same count.
+
+namespace alfar
+{
+	namespace intersection
+	{
+		//----- one ray against many spheres
+
+		//p_Out[i] = distance to sphere i, p_Out holds p_Centers.count floats
+		inline void raySpheres(const Vector3& rayOrigin, const Vector3& rayDir, const Vector3Stream& p_Centers, const float* p_Radii, float* p_Out)
+		{
+			const float* c[3] = { p_Centers.x, p_Centers.y, p_Centers.z };
+			simd::spheres(&rayOrigin.x, &rayDir.x, c, p_Radii, p_Out, p_Centers.count);
+		}
+
+		//nearest sphere hit (the lowest index among equally near ones)
+		inline RayHit nearestSphere(const Vector3& rayOrigin, const Vector3& rayDir, const Vector3Stream& p_Centers, const float* p_Radii)
+		{
+			const float* c[3] = { p_Centers.x, p_Centers.y, p_Centers.z };
+			RayHit ret = { -1.0f, -1 };
+			simd::nearestSphere(&rayOrigin.x, &rayDir.x, c, p_Radii, ret, p_Centers.count);
+
+			return ret;
+		}
+
+		//nearestSphere for each ray, p_Out holds p_RayOrigins.count hits
+		inline void nearestSpheres(const Vector3Stream& p_RayOrigins, const Vector3Stream& p_RayDirs, const Vector3Stream& p_Centers, const float* p_Radii, RayHit* p_Out)
+		{
+			for(uint32_t i = 0; i < p_RayOrigins.count; ++i)
+			{
+				Vector3 o = { p_RayOrigins.x[i], p_RayOrigins.y[i], p_RayOrigins.z[i] };
+				Vector3 d = { p_RayDirs.x[i], p_RayDirs.y[i], p_RayDirs.z[i] };
+
+				p_Out[i] = nearestSphere(o, d, p_Centers, p_Radii);
+			}
+		}
+
+		//----- many rays against one primitive
+
+		//p_Out[i] = distance from ray i to the sphere, p_Out holds p_RayOrigins.count floats
+		inline void raysSphere(const Vector3& sphereCenter, float sphereRadius, const Vector3Stream& p_RayOrigins, const Vector3Stream& p_RayDirs, float* p_Out)
+		{
+			const float* o[3] = { p_RayOrigins.x, p_RayOrigins.y, p_RayOrigins.z };
+			const float* d[3] = { p_RayDirs.x, p_RayDirs.y, p_RayDirs.z };
+			simd::raysSphere(&sphereCenter.x, sphereRadius, o, d, p_Out, p_RayOrigins.count);
+		}
+
+		//p_Out[i] = distance from ray i to the plane (negative behind the origin, -1 when parallel)
+		inline void raysPlane(const Vector3& planeOrigin, const Vector3& planeNormal, const Vector3Stream& p_RayOrigins, const Vector3Stream& p_RayDirs, float* p_Out)
+		{
+			const float* o[3] = { p_RayOrigins.x, p_RayOrigins.y, p_RayOrigins.z };
+			const float* d[3] = { p_RayDirs.x, p_RayDirs.y, p_RayDirs.z };
+			simd::raysPlane(&planeOrigin.x, &planeNormal.x, o, d, p_Out, p_RayOrigins.count);
+		}
+	}
+}
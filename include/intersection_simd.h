@@ -0,0 +1,548 @@
+#pragma once
+
+#include "math_types.h"
+#include "cpu.h"
+#include <math.h>
+#include <stdint.h>
+
+// SIMD kernels behind intersection.h. Primitives and rays come as SoA lanes
+// (one float pointer per component) and every lane computes the same thing as
+// the scalar tests of vector3.h, with masks and selects instead of branches:
+//   sphere: first root >= 0 of |o + t*d - c|^2 = r^2, -1 if none,
+//   plane: dot(p - o, n) / dot(d, n), -1 when either dot is ~0.
+// Kernels run [p_Start, p_Count) and hand the remainder to the tier below.
+
+namespace alfar
+{
+	namespace intersection
+	{
+		namespace simd
+		{
+			const float PLANE_EPSILON = 0.00001f;
+
+			//keeps the nearest hit, the lowest index on a tie
+			inline void merge(RayHit& p_Best, float p_Distance, int32_t p_Index)
+			{
+				if(p_Index < 0 || !(p_Distance >= 0))
+					return;
+
+				if(p_Best.index < 0 || p_Distance < p_Best.distance || (p_Distance == p_Best.distance && p_Index < p_Best.index))
+				{
+					p_Best.distance = p_Distance;
+					p_Best.index = p_Index;
+				}
+			}
+
+			//===================================================================== scalar
+
+			//oc = ray origin - sphere center
+			inline float sphereDistance(float ocx, float ocy, float ocz, float dx, float dy, float dz, float r)
+			{
+				float a = dx * dx + dy * dy + dz * dz;
+				float b = dx * ocx + dy * ocy + dz * ocz;
+				float c = ocx * ocx + ocy * ocy + ocz * ocz - r * r;
+				float disc = b * b - a * c;
+
+				if(disc < 0)
+					return -1.0f;
+
+				float s = sqrtf(disc);
+				float q = b < 0 ? s - b : -b - s;
+				float t0 = q / a;
+				float t1 = c / q;
+				float tmin = t0 < t1 ? t0 : t1;
+				float tmax = t0 < t1 ? t1 : t0;
+
+				return tmin >= 0 ? tmin : (tmax >= 0 ? tmax : -1.0f);
+			}
+
+			//op = plane origin - ray origin
+			inline float planeDistance(float opx, float opy, float opz, float dx, float dy, float dz, float nx, float ny, float nz)
+			{
+				float num = opx * nx + opy * ny + opz * nz;
+				float den = dx * nx + dy * ny + dz * nz;
+
+				if(fabsf(den) < PLANE_EPSILON || fabsf(num) < PLANE_EPSILON)
+					return -1.0f;
+
+				return num / den;
+			}
+
+			//---------------------------------------------------------------------
+
+			//one ray (o, d) against the spheres c[], r[]
+			inline void spheresScalar(const float* o, const float* d, const float* const* c, const float* r, float* p_Out, uint32_t p_Start, uint32_t p_Count)
+			{
+				for(uint32_t i = p_Start; i < p_Count; ++i)
+					p_Out[i] = sphereDistance(o[0] - c[0][i], o[1] - c[1][i], o[2] - c[2][i], d[0], d[1], d[2], r[i]);
+			}
+
+			inline void nearestSphereScalar(const float* o, const float* d, const float* const* c, const float* r, RayHit& p_Best, uint32_t p_Start, uint32_t p_Count)
+			{
+				for(uint32_t i = p_Start; i < p_Count; ++i)
+					merge(p_Best, sphereDistance(o[0] - c[0][i], o[1] - c[1][i], o[2] - c[2][i], d[0], d[1], d[2], r[i]), (int32_t)i);
+			}
+
+			//the rays o[], d[] against one sphere (c, r)
+			inline void raysSphereScalar(const float* c, float r, const float* const* o, const float* const* d, float* p_Out, uint32_t p_Start, uint32_t p_Count)
+			{
+				for(uint32_t i = p_Start; i < p_Count; ++i)
+					p_Out[i] = sphereDistance(o[0][i] - c[0], o[1][i] - c[1], o[2][i] - c[2], d[0][i], d[1][i], d[2][i], r);
+			}
+
+			//the rays o[], d[] against one plane (p, n)
+			inline void raysPlaneScalar(const float* p, const float* n, const float* const* o, const float* const* d, float* p_Out, uint32_t p_Start, uint32_t p_Count)
+			{
+				for(uint32_t i = p_Start; i < p_Count; ++i)
+					p_Out[i] = planeDistance(p[0] - o[0][i], p[1] - o[1][i], p[2] - o[2][i], d[0][i], d[1][i], d[2][i], n[0], n[1], n[2]);
+			}
+
+#if ALFAR_X86
+
+			//===================================================================== SSE2
+
+			ALFAR_TARGET_SSE2 inline __m128 select(__m128 p_Mask, __m128 a, __m128 b)
+			{
+				return _mm_or_ps(_mm_and_ps(p_Mask, a), _mm_andnot_ps(p_Mask, b));
+			}
+
+			ALFAR_TARGET_SSE2 inline __m128 sphereLanes(__m128 ocx, __m128 ocy, __m128 ocz, __m128 dx, __m128 dy, __m128 dz, __m128 r)
+			{
+				const __m128 zero = _mm_setzero_ps();
+				const __m128 miss = _mm_set1_ps(-1.0f);
+
+				__m128 a = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+				__m128 b = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, ocx), _mm_mul_ps(dy, ocy)), _mm_mul_ps(dz, ocz));
+				__m128 c = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ocx, ocx), _mm_mul_ps(ocy, ocy)), _mm_mul_ps(ocz, ocz)), _mm_mul_ps(r, r));
+				__m128 disc = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(a, c));
+
+				__m128 s = _mm_sqrt_ps(_mm_max_ps(disc, zero));
+				__m128 q = select(_mm_cmplt_ps(b, zero), _mm_sub_ps(s, b), _mm_sub_ps(_mm_sub_ps(zero, b), s));
+				__m128 t0 = _mm_div_ps(q, a);
+				__m128 t1 = _mm_div_ps(c, q);
+				__m128 tmin = _mm_min_ps(t0, t1);
+				__m128 tmax = _mm_max_ps(t0, t1);
+
+				__m128 t = select(_mm_cmpge_ps(tmin, zero), tmin, select(_mm_cmpge_ps(tmax, zero), tmax, miss));
+				return select(_mm_cmpge_ps(disc, zero), t, miss);
+			}
+
+			ALFAR_TARGET_SSE2 inline __m128 planeLanes(__m128 opx, __m128 opy, __m128 opz, __m128 dx, __m128 dy, __m128 dz, __m128 nx, __m128 ny, __m128 nz)
+			{
+				const __m128 signMask = _mm_set1_ps(-0.0f);
+				const __m128 epsilon = _mm_set1_ps(PLANE_EPSILON);
+
+				__m128 num = _mm_add_ps(_mm_add_ps(_mm_mul_ps(opx, nx), _mm_mul_ps(opy, ny)), _mm_mul_ps(opz, nz));
+				__m128 den = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, nx), _mm_mul_ps(dy, ny)), _mm_mul_ps(dz, nz));
+				__m128 parallel = _mm_or_ps(_mm_cmplt_ps(_mm_andnot_ps(signMask, den), epsilon), _mm_cmplt_ps(_mm_andnot_ps(signMask, num), epsilon));
+
+				return select(parallel, _mm_set1_ps(-1.0f), _mm_div_ps(num, den));
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_SSE2 inline void spheresSSE2(const float* o, const float* d, const float* const* c, const float* r, float* p_Out, uint32_t p_Start, uint32_t p_Count)
+			{
+				__m128 ox = _mm_set1_ps(o[0]), oy = _mm_set1_ps(o[1]), oz = _mm_set1_ps(o[2]);
+				__m128 dx = _mm_set1_ps(d[0]), dy = _mm_set1_ps(d[1]), dz = _mm_set1_ps(d[2]);
+
+				uint32_t i = p_Start;
+				for(; i + 4 <= p_Count; i += 4)
+				{
+					__m128 ocx = _mm_sub_ps(ox, _mm_loadu_ps(c[0] + i));
+					__m128 ocy = _mm_sub_ps(oy, _mm_loadu_ps(c[1] + i));
+					__m128 ocz = _mm_sub_ps(oz, _mm_loadu_ps(c[2] + i));
+
+					_mm_storeu_ps(p_Out + i, sphereLanes(ocx, ocy, ocz, dx, dy, dz, _mm_loadu_ps(r + i)));
+				}
+
+				spheresScalar(o, d, c, r, p_Out, i, p_Count);
+			}
+
+			ALFAR_TARGET_SSE2 inline void nearestSphereSSE2(const float* o, const float* d, const float* const* c, const float* r, RayHit& p_Best, uint32_t p_Start, uint32_t p_Count)
+			{
+				__m128 ox = _mm_set1_ps(o[0]), oy = _mm_set1_ps(o[1]), oz = _mm_set1_ps(o[2]);
+				__m128 dx = _mm_set1_ps(d[0]), dy = _mm_set1_ps(d[1]), dz = _mm_set1_ps(d[2]);
+				const __m128 zero = _mm_setzero_ps();
+
+				//per lane nearest so far, no cross lane work in the loop
+				__m128 bestDistance = _mm_set1_ps(INFINITY);
+				__m128i bestIndex = _mm_set1_epi32(-1);
+				__m128i index = _mm_add_epi32(_mm_set1_epi32((int32_t)p_Start), _mm_setr_epi32(0, 1, 2, 3));
+				const __m128i step = _mm_set1_epi32(4);
+
+				uint32_t i = p_Start;
+				for(; i + 4 <= p_Count; i += 4)
+				{
+					__m128 ocx = _mm_sub_ps(ox, _mm_loadu_ps(c[0] + i));
+					__m128 ocy = _mm_sub_ps(oy, _mm_loadu_ps(c[1] + i));
+					__m128 ocz = _mm_sub_ps(oz, _mm_loadu_ps(c[2] + i));
+					__m128 t = sphereLanes(ocx, ocy, ocz, dx, dy, dz, _mm_loadu_ps(r + i));
+
+					__m128 closer = _mm_and_ps(_mm_cmpge_ps(t, zero), _mm_cmplt_ps(t, bestDistance));
+					bestDistance = select(closer, t, bestDistance);
+					bestIndex = _mm_castps_si128(select(closer, _mm_castsi128_ps(index), _mm_castsi128_ps(bestIndex)));
+					index = _mm_add_epi32(index, step);
+				}
+
+				float distances[4];
+				int32_t indices[4];
+				_mm_storeu_ps(distances, bestDistance);
+				_mm_storeu_si128((__m128i*)indices, bestIndex);
+
+				for(int k = 0; k < 4; ++k)
+					merge(p_Best, distances[k], indices[k]);
+
+				nearestSphereScalar(o, d, c, r, p_Best, i, p_Count);
+			}
+
+			ALFAR_TARGET_SSE2 inline void raysSphereSSE2(const float* c, float r, const float* const* o, const float* const* d, float* p_Out, uint32_t p_Start, uint32_t p_Count)
+			{
+				__m128 cx = _mm_set1_ps(c[0]), cy = _mm_set1_ps(c[1]), cz = _mm_set1_ps(c[2]);
+				__m128 vr = _mm_set1_ps(r);
+
+				uint32_t i = p_Start;
+				for(; i + 4 <= p_Count; i += 4)
+				{
+					__m128 ocx = _mm_sub_ps(_mm_loadu_ps(o[0] + i), cx);
+					__m128 ocy = _mm_sub_ps(_mm_loadu_ps(o[1] + i), cy);
+					__m128 ocz = _mm_sub_ps(_mm_loadu_ps(o[2] + i), cz);
+
+					_mm_storeu_ps(p_Out + i, sphereLanes(ocx, ocy, ocz, _mm_loadu_ps(d[0] + i), _mm_loadu_ps(d[1] + i), _mm_loadu_ps(d[2] + i), vr));
+				}
+
+				raysSphereScalar(c, r, o, d, p_Out, i, p_Count);
+			}
+
+			ALFAR_TARGET_SSE2 inline void raysPlaneSSE2(const float* p, const float* n, const float* const* o, const float* const* d, float* p_Out, uint32_t p_Start, uint32_t p_Count)
+			{
+				__m128 px = _mm_set1_ps(p[0]), py = _mm_set1_ps(p[1]), pz = _mm_set1_ps(p[2]);
+				__m128 nx = _mm_set1_ps(n[0]), ny = _mm_set1_ps(n[1]), nz = _mm_set1_ps(n[2]);
+
+				uint32_t i = p_Start;
+				for(; i + 4 <= p_Count; i += 4)
+				{
+					__m128 opx = _mm_sub_ps(px, _mm_loadu_ps(o[0] + i));
+					__m128 opy = _mm_sub_ps(py, _mm_loadu_ps(o[1] + i));
+					__m128 opz = _mm_sub_ps(pz, _mm_loadu_ps(o[2] + i));
+
+					_mm_storeu_ps(p_Out + i, planeLanes(opx, opy, opz, _mm_loadu_ps(d[0] + i), _mm_loadu_ps(d[1] + i), _mm_loadu_ps(d[2] + i), nx, ny, nz));
+				}
+
+				raysPlaneScalar(p, n, o, d, p_Out, i, p_Count);
+			}
+
+			//===================================================================== AVX2
+
+			ALFAR_TARGET_AVX2 inline __m256 sphereLanes(__m256 ocx, __m256 ocy, __m256 ocz, __m256 dx, __m256 dy, __m256 dz, __m256 r)
+			{
+				const __m256 zero = _mm256_setzero_ps();
+				const __m256 miss = _mm256_set1_ps(-1.0f);
+
+				__m256 a = _mm256_fmadd_ps(dz, dz, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dx, dx)));
+				__m256 b = _mm256_fmadd_ps(dz, ocz, _mm256_fmadd_ps(dy, ocy, _mm256_mul_ps(dx, ocx)));
+				__m256 c = _mm256_fnmadd_ps(r, r, _mm256_fmadd_ps(ocz, ocz, _mm256_fmadd_ps(ocy, ocy, _mm256_mul_ps(ocx, ocx))));
+				__m256 disc = _mm256_fmsub_ps(b, b, _mm256_mul_ps(a, c));
+
+				__m256 s = _mm256_sqrt_ps(_mm256_max_ps(disc, zero));
+				__m256 q = _mm256_blendv_ps(_mm256_sub_ps(_mm256_sub_ps(zero, b), s), _mm256_sub_ps(s, b), _mm256_cmp_ps(b, zero, _CMP_LT_OQ));
+				__m256 t0 = _mm256_div_ps(q, a);
+				__m256 t1 = _mm256_div_ps(c, q);
+				__m256 tmin = _mm256_min_ps(t0, t1);
+				__m256 tmax = _mm256_max_ps(t0, t1);
+
+				__m256 t = _mm256_blendv_ps(_mm256_blendv_ps(miss, tmax, _mm256_cmp_ps(tmax, zero, _CMP_GE_OQ)), tmin, _mm256_cmp_ps(tmin, zero, _CMP_GE_OQ));
+				return _mm256_blendv_ps(miss, t, _mm256_cmp_ps(disc, zero, _CMP_GE_OQ));
+			}
+
+			ALFAR_TARGET_AVX2 inline __m256 planeLanes(__m256 opx, __m256 opy, __m256 opz, __m256 dx, __m256 dy, __m256 dz, __m256 nx, __m256 ny, __m256 nz)
+			{
+				const __m256 signMask = _mm256_set1_ps(-0.0f);
+				const __m256 epsilon = _mm256_set1_ps(PLANE_EPSILON);
+
+				__m256 num = _mm256_fmadd_ps(opz, nz, _mm256_fmadd_ps(opy, ny, _mm256_mul_ps(opx, nx)));
+				__m256 den = _mm256_fmadd_ps(dz, nz, _mm256_fmadd_ps(dy, ny, _mm256_mul_ps(dx, nx)));
+				__m256 parallel = _mm256_or_ps(_mm256_cmp_ps(_mm256_andnot_ps(signMask, den), epsilon, _CMP_LT_OQ),
+											   _mm256_cmp_ps(_mm256_andnot_ps(signMask, num), epsilon, _CMP_LT_OQ));
+
+				return _mm256_blendv_ps(_mm256_div_ps(num, den), _mm256_set1_ps(-1.0f), parallel);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX2 inline void spheresAVX2(const float* o, const float* d, const float* const* c, const float* r, float* p_Out, uint32_t p_Start, uint32_t p_Count)
+			{
+				__m256 ox = _mm256_set1_ps(o[0]), oy = _mm256_set1_ps(o[1]), oz = _mm256_set1_ps(o[2]);
+				__m256 dx = _mm256_set1_ps(d[0]), dy = _mm256_set1_ps(d[1]), dz = _mm256_set1_ps(d[2]);
+
+				uint32_t i = p_Start;
+				for(; i + 8 <= p_Count; i += 8)
+				{
+					__m256 ocx = _mm256_sub_ps(ox, _mm256_loadu_ps(c[0] + i));
+					__m256 ocy = _mm256_sub_ps(oy, _mm256_loadu_ps(c[1] + i));
+					__m256 ocz = _mm256_sub_ps(oz, _mm256_loadu_ps(c[2] + i));
+
+					_mm256_storeu_ps(p_Out + i, sphereLanes(ocx, ocy, ocz, dx, dy, dz, _mm256_loadu_ps(r + i)));
+				}
+
+				spheresSSE2(o, d, c, r, p_Out, i, p_Count);
+			}
+
+			ALFAR_TARGET_AVX2 inline void nearestSphereAVX2(const float* o, const float* d, const float* const* c, const float* r, RayHit& p_Best, uint32_t p_Start, uint32_t p_Count)
+			{
+				__m256 ox = _mm256_set1_ps(o[0]), oy = _mm256_set1_ps(o[1]), oz = _mm256_set1_ps(o[2]);
+				__m256 dx = _mm256_set1_ps(d[0]), dy = _mm256_set1_ps(d[1]), dz = _mm256_set1_ps(d[2]);
+				const __m256 zero = _mm256_setzero_ps();
+
+				__m256 bestDistance = _mm256_set1_ps(INFINITY);
+				__m256i bestIndex = _mm256_set1_epi32(-1);
+				__m256i index = _mm256_add_epi32(_mm256_set1_epi32((int32_t)p_Start), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+				const __m256i step = _mm256_set1_epi32(8);
+
+				uint32_t i = p_Start;
+				for(; i + 8 <= p_Count; i += 8)
+				{
+					__m256 ocx = _mm256_sub_ps(ox, _mm256_loadu_ps(c[0] + i));
+					__m256 ocy = _mm256_sub_ps(oy, _mm256_loadu_ps(c[1] + i));
+					__m256 ocz = _mm256_sub_ps(oz, _mm256_loadu_ps(c[2] + i));
+					__m256 t = sphereLanes(ocx, ocy, ocz, dx, dy, dz, _mm256_loadu_ps(r + i));
+
+					__m256 closer = _mm256_and_ps(_mm256_cmp_ps(t, zero, _CMP_GE_OQ), _mm256_cmp_ps(t, bestDistance, _CMP_LT_OQ));
+					bestDistance = _mm256_blendv_ps(bestDistance, t, closer);
+					bestIndex = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(bestIndex), _mm256_castsi256_ps(index), closer));
+					index = _mm256_add_epi32(index, step);
+				}
+
+				float distances[8];
+				int32_t indices[8];
+				_mm256_storeu_ps(distances, bestDistance);
+				_mm256_storeu_si256((__m256i*)indices, bestIndex);
+
+				for(int k = 0; k < 8; ++k)
+					merge(p_Best, distances[k], indices[k]);
+
+				nearestSphereSSE2(o, d, c, r, p_Best, i, p_Count);
+			}
+
+			ALFAR_TARGET_AVX2 inline void raysSphereAVX2(const float* c, float r, const float* const* o, const float* const* d, float* p_Out, uint32_t p_Start, uint32_t p_Count)
+			{
+				__m256 cx = _mm256_set1_ps(c[0]), cy = _mm256_set1_ps(c[1]), cz = _mm256_set1_ps(c[2]);
+				__m256 vr = _mm256_set1_ps(r);
+
+				uint32_t i = p_Start;
+				for(; i + 8 <= p_Count; i += 8)
+				{
+					__m256 ocx = _mm256_sub_ps(_mm256_loadu_ps(o[0] + i), cx);
+					__m256 ocy = _mm256_sub_ps(_mm256_loadu_ps(o[1] + i), cy);
+					__m256 ocz = _mm256_sub_ps(_mm256_loadu_ps(o[2] + i), cz);
+
+					_mm256_storeu_ps(p_Out + i, sphereLanes(ocx, ocy, ocz, _mm256_loadu_ps(d[0] + i), _mm256_loadu_ps(d[1] + i), _mm256_loadu_ps(d[2] + i), vr));
+				}
+
+				raysSphereSSE2(c, r, o, d, p_Out, i, p_Count);
+			}
+
+			ALFAR_TARGET_AVX2 inline void raysPlaneAVX2(const float* p, const float* n, const float* const* o, const float* const* d, float* p_Out, uint32_t p_Start, uint32_t p_Count)
+			{
+				__m256 px = _mm256_set1_ps(p[0]), py = _mm256_set1_ps(p[1]), pz = _mm256_set1_ps(p[2]);
+				__m256 nx = _mm256_set1_ps(n[0]), ny = _mm256_set1_ps(n[1]), nz = _mm256_set1_ps(n[2]);
+
+				uint32_t i = p_Start;
+				for(; i + 8 <= p_Count; i += 8)
+				{
+					__m256 opx = _mm256_sub_ps(px, _mm256_loadu_ps(o[0] + i));
+					__m256 opy = _mm256_sub_ps(py, _mm256_loadu_ps(o[1] + i));
+					__m256 opz = _mm256_sub_ps(pz, _mm256_loadu_ps(o[2] + i));
+
+					_mm256_storeu_ps(p_Out + i, planeLanes(opx, opy, opz, _mm256_loadu_ps(d[0] + i), _mm256_loadu_ps(d[1] + i), _mm256_loadu_ps(d[2] + i), nx, ny, nz));
+				}
+
+				raysPlaneSSE2(p, n, o, d, p_Out, i, p_Count);
+			}
+
+			//===================================================================== AVX-512
+
+			ALFAR_TARGET_AVX512 inline __m512 sphereLanes(__m512 ocx, __m512 ocy, __m512 ocz, __m512 dx, __m512 dy, __m512 dz, __m512 r)
+			{
+				const __m512 zero = _mm512_setzero_ps();
+				const __m512 miss = _mm512_set1_ps(-1.0f);
+
+				__m512 a = _mm512_fmadd_ps(dz, dz, _mm512_fmadd_ps(dy, dy, _mm512_mul_ps(dx, dx)));
+				__m512 b = _mm512_fmadd_ps(dz, ocz, _mm512_fmadd_ps(dy, ocy, _mm512_mul_ps(dx, ocx)));
+				__m512 c = _mm512_fnmadd_ps(r, r, _mm512_fmadd_ps(ocz, ocz, _mm512_fmadd_ps(ocy, ocy, _mm512_mul_ps(ocx, ocx))));
+				__m512 disc = _mm512_fmsub_ps(b, b, _mm512_mul_ps(a, c));
+
+				__m512 s = _mm512_sqrt_ps(_mm512_max_ps(disc, zero));
+				__mmask16 negative = _mm512_cmp_ps_mask(b, zero, _CMP_LT_OQ);
+				__m512 q = _mm512_mask_blend_ps(negative, _mm512_sub_ps(_mm512_sub_ps(zero, b), s), _mm512_sub_ps(s, b));
+				__m512 t0 = _mm512_div_ps(q, a);
+				__m512 t1 = _mm512_div_ps(c, q);
+				__m512 tmin = _mm512_min_ps(t0, t1);
+				__m512 tmax = _mm512_max_ps(t0, t1);
+
+				__m512 t = _mm512_mask_mov_ps(miss, _mm512_cmp_ps_mask(tmax, zero, _CMP_GE_OQ), tmax);
+				t = _mm512_mask_mov_ps(t, _mm512_cmp_ps_mask(tmin, zero, _CMP_GE_OQ), tmin);
+				return _mm512_mask_mov_ps(miss, _mm512_cmp_ps_mask(disc, zero, _CMP_GE_OQ), t);
+			}
+
+			ALFAR_TARGET_AVX512 inline __m512 planeLanes(__m512 opx, __m512 opy, __m512 opz, __m512 dx, __m512 dy, __m512 dz, __m512 nx, __m512 ny, __m512 nz)
+			{
+				const __m512 epsilon = _mm512_set1_ps(PLANE_EPSILON);
+
+				__m512 num = _mm512_fmadd_ps(opz, nz, _mm512_fmadd_ps(opy, ny, _mm512_mul_ps(opx, nx)));
+				__m512 den = _mm512_fmadd_ps(dz, nz, _mm512_fmadd_ps(dy, ny, _mm512_mul_ps(dx, nx)));
+				__mmask16 parallel = _mm512_cmp_ps_mask(_mm512_abs_ps(den), epsilon, _CMP_LT_OQ) | _mm512_cmp_ps_mask(_mm512_abs_ps(num), epsilon, _CMP_LT_OQ);
+
+				return _mm512_mask_mov_ps(_mm512_div_ps(num, den), parallel, _mm512_set1_ps(-1.0f));
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX512 inline void spheresAVX512(const float* o, const float* d, const float* const* c, const float* r, float* p_Out, uint32_t p_Start, uint32_t p_Count)
+			{
+				__m512 ox = _mm512_set1_ps(o[0]), oy = _mm512_set1_ps(o[1]), oz = _mm512_set1_ps(o[2]);
+				__m512 dx = _mm512_set1_ps(d[0]), dy = _mm512_set1_ps(d[1]), dz = _mm512_set1_ps(d[2]);
+
+				uint32_t i = p_Start;
+				for(; i + 16 <= p_Count; i += 16)
+				{
+					__m512 ocx = _mm512_sub_ps(ox, _mm512_loadu_ps(c[0] + i));
+					__m512 ocy = _mm512_sub_ps(oy, _mm512_loadu_ps(c[1] + i));
+					__m512 ocz = _mm512_sub_ps(oz, _mm512_loadu_ps(c[2] + i));
+
+					_mm512_storeu_ps(p_Out + i, sphereLanes(ocx, ocy, ocz, dx, dy, dz, _mm512_loadu_ps(r + i)));
+				}
+
+				spheresAVX2(o, d, c, r, p_Out, i, p_Count);
+			}
+
+			ALFAR_TARGET_AVX512 inline void nearestSphereAVX512(const float* o, const float* d, const float* const* c, const float* r, RayHit& p_Best, uint32_t p_Start, uint32_t p_Count)
+			{
+				__m512 ox = _mm512_set1_ps(o[0]), oy = _mm512_set1_ps(o[1]), oz = _mm512_set1_ps(o[2]);
+				__m512 dx = _mm512_set1_ps(d[0]), dy = _mm512_set1_ps(d[1]), dz = _mm512_set1_ps(d[2]);
+				const __m512 zero = _mm512_setzero_ps();
+
+				__m512 bestDistance = _mm512_set1_ps(INFINITY);
+				__m512i bestIndex = _mm512_set1_epi32(-1);
+				__m512i index = _mm512_add_epi32(_mm512_set1_epi32((int32_t)p_Start), _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+				const __m512i step = _mm512_set1_epi32(16);
+
+				uint32_t i = p_Start;
+				for(; i + 16 <= p_Count; i += 16)
+				{
+					__m512 ocx = _mm512_sub_ps(ox, _mm512_loadu_ps(c[0] + i));
+					__m512 ocy = _mm512_sub_ps(oy, _mm512_loadu_ps(c[1] + i));
+					__m512 ocz = _mm512_sub_ps(oz, _mm512_loadu_ps(c[2] + i));
+					__m512 t = sphereLanes(ocx, ocy, ocz, dx, dy, dz, _mm512_loadu_ps(r + i));
+
+					__mmask16 closer = _mm512_cmp_ps_mask(t, zero, _CMP_GE_OQ) & _mm512_cmp_ps_mask(t, bestDistance, _CMP_LT_OQ);
+					bestDistance = _mm512_mask_mov_ps(bestDistance, closer, t);
+					bestIndex = _mm512_mask_mov_epi32(bestIndex, closer, index);
+					index = _mm512_add_epi32(index, step);
+				}
+
+				float distances[16];
+				int32_t indices[16];
+				_mm512_storeu_ps(distances, bestDistance);
+				_mm512_storeu_si512(indices, bestIndex);
+
+				for(int k = 0; k < 16; ++k)
+					merge(p_Best, distances[k], indices[k]);
+
+				nearestSphereAVX2(o, d, c, r, p_Best, i, p_Count);
+			}
+
+			ALFAR_TARGET_AVX512 inline void raysSphereAVX512(const float* c, float r, const float* const* o, const float* const* d, float* p_Out, uint32_t p_Start, uint32_t p_Count)
+			{
+				__m512 cx = _mm512_set1_ps(c[0]), cy = _mm512_set1_ps(c[1]), cz = _mm512_set1_ps(c[2]);
+				__m512 vr = _mm512_set1_ps(r);
+
+				uint32_t i = p_Start;
+				for(; i + 16 <= p_Count; i += 16)
+				{
+					__m512 ocx = _mm512_sub_ps(_mm512_loadu_ps(o[0] + i), cx);
+					__m512 ocy = _mm512_sub_ps(_mm512_loadu_ps(o[1] + i), cy);
+					__m512 ocz = _mm512_sub_ps(_mm512_loadu_ps(o[2] + i), cz);
+
+					_mm512_storeu_ps(p_Out + i, sphereLanes(ocx, ocy, ocz, _mm512_loadu_ps(d[0] + i), _mm512_loadu_ps(d[1] + i), _mm512_loadu_ps(d[2] + i), vr));
+				}
+
+				raysSphereAVX2(c, r, o, d, p_Out, i, p_Count);
+			}
+
+			ALFAR_TARGET_AVX512 inline void raysPlaneAVX512(const float* p, const float* n, const float* const* o, const float* const* d, float* p_Out, uint32_t p_Start, uint32_t p_Count)
+			{
+				__m512 px = _mm512_set1_ps(p[0]), py = _mm512_set1_ps(p[1]), pz = _mm512_set1_ps(p[2]);
+				__m512 nx = _mm512_set1_ps(n[0]), ny = _mm512_set1_ps(n[1]), nz = _mm512_set1_ps(n[2]);
+
+				uint32_t i = p_Start;
+				for(; i + 16 <= p_Count; i += 16)
+				{
+					__m512 opx = _mm512_sub_ps(px, _mm512_loadu_ps(o[0] + i));
+					__m512 opy = _mm512_sub_ps(py, _mm512_loadu_ps(o[1] + i));
+					__m512 opz = _mm512_sub_ps(pz, _mm512_loadu_ps(o[2] + i));
+
+					_mm512_storeu_ps(p_Out + i, planeLanes(opx, opy, opz, _mm512_loadu_ps(d[0] + i), _mm512_loadu_ps(d[1] + i), _mm512_loadu_ps(d[2] + i), nx, ny, nz));
+				}
+
+				raysPlaneAVX2(p, n, o, d, p_Out, i, p_Count);
+			}
+
+#endif
+
+			//===================================================================== dispatch
+
+			inline void spheres(const float* o, const float* d, const float* const* c, const float* r, float* p_Out, uint32_t p_Count)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	spheresAVX512(o, d, c, r, p_Out, 0, p_Count); return;
+				case cpu::LEVEL_AVX2:	spheresAVX2(o, d, c, r, p_Out, 0, p_Count); return;
+				case cpu::LEVEL_SSE2:	spheresSSE2(o, d, c, r, p_Out, 0, p_Count); return;
+#endif
+				default:				spheresScalar(o, d, c, r, p_Out, 0, p_Count); return;
+				}
+			}
+
+			inline void nearestSphere(const float* o, const float* d, const float* const* c, const float* r, RayHit& p_Best, uint32_t p_Count)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	nearestSphereAVX512(o, d, c, r, p_Best, 0, p_Count); return;
+				case cpu::LEVEL_AVX2:	nearestSphereAVX2(o, d, c, r, p_Best, 0, p_Count); return;
+				case cpu::LEVEL_SSE2:	nearestSphereSSE2(o, d, c, r, p_Best, 0, p_Count); return;
+#endif
+				default:				nearestSphereScalar(o, d, c, r, p_Best, 0, p_Count); return;
+				}
+			}
+
+			inline void raysSphere(const float* c, float r, const float* const* o, const float* const* d, float* p_Out, uint32_t p_Count)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	raysSphereAVX512(c, r, o, d, p_Out, 0, p_Count); return;
+				case cpu::LEVEL_AVX2:	raysSphereAVX2(c, r, o, d, p_Out, 0, p_Count); return;
+				case cpu::LEVEL_SSE2:	raysSphereSSE2(c, r, o, d, p_Out, 0, p_Count); return;
+#endif
+				default:				raysSphereScalar(c, r, o, d, p_Out, 0, p_Count); return;
+				}
+			}
+
+			inline void raysPlane(const float* p, const float* n, const float* const* o, const float* const* d, float* p_Out, uint32_t p_Count)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	raysPlaneAVX512(p, n, o, d, p_Out, 0, p_Count); return;
+				case cpu::LEVEL_AVX2:	raysPlaneAVX2(p, n, o, d, p_Out, 0, p_Count); return;
+				case cpu::LEVEL_SSE2:	raysPlaneSSE2(p, n, o, d, p_Out, 0, p_Count); return;
+#endif
+				default:				raysPlaneScalar(p, n, o, d, p_Out, 0, p_Count); return;
+				}
+			}
+		}
+	}
+}
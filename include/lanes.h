@@ -0,0 +1,596 @@
+#pragma once
+
+#include "cpu.h"
+#include "functions.h"
+#include <float.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Kernels over plain float lanes, shared by the AoS array functions (which see
+// a Vector3 array as one flat float stream) and the SoA streams (one lane per
+// component). Multi-lane kernels take N component pointers (N = 3 or 4).
+// Each tier handles what fits its width and hands the rest to the tier below;
+// outputs may alias inputs exactly.
+
+namespace alfar
+{
+	namespace lanes
+	{
+		enum BinaryOp
+		{
+			OP_ADD,
+			OP_SUB,
+			OP_SCALE
+		};
+
+		//===================================================================== scalar
+
+		template<BinaryOp OP>
+		inline void binaryScalar(const float* a, const float* b, float* o, size_t p_Count)
+		{
+			for(size_t i = 0; i < p_Count; ++i)
+			{
+				if(OP == OP_ADD)
+					o[i] = a[i] + b[i];
+				else if(OP == OP_SUB)
+					o[i] = a[i] - b[i];
+				else
+					o[i] = a[i] * b[i];
+			}
+		}
+
+		inline void lerpScalar(const float* a, const float* b, float t, float* o, size_t p_Count)
+		{
+			for(size_t i = 0; i < p_Count; ++i)
+				o[i] = a[i] * (1.0f - t) + b[i] * t;
+		}
+
+		template<int N>
+		inline void dotScalar(const float* const* a, const float* const* b, float* o, size_t p_Start, size_t p_Count)
+		{
+			for(size_t i = p_Start; i < p_Count; ++i)
+			{
+				float d = 0;
+				for(int c = 0; c < N; ++c)
+					d += a[c][i] * b[c][i];
+
+				o[i] = d;
+			}
+		}
+
+		template<int N>
+		inline void magnitudeScalar(const float* const* a, float* o, size_t p_Start, size_t p_Count)
+		{
+			dotScalar<N>(a, a, o, p_Start, p_Count);
+
+			for(size_t i = p_Start; i < p_Count; ++i)
+				o[i] = sqrtf(o[i]);
+		}
+
+		//a vector of squared length d is normalized as normalizeApply(v, normalizeFactor(d)):
+		//the inverse length for the rsqrt precisions, the length itself for PRECISION_EXACT
+		//which divides. Zero vectors stay zero, the rsqrt is taken on max(d, FLT_MIN) and
+		//the division is masked; vectors shorter than sqrt(FLT_MIN) are not made unit.
+		template<Precision P>
+		inline float normalizeFactorScalar(float d)
+		{
+			if(P == PRECISION_EXACT)
+				return sqrtf(d);
+
+			return rsqrt<P>(d > FLT_MIN ? d : FLT_MIN);
+		}
+
+		template<Precision P>
+		inline float normalizeApplyScalar(float v, float f)
+		{
+			if(P == PRECISION_EXACT)
+				return f > 0 ? v / f : 0.0f;
+
+			return v * f;
+		}
+
+		template<int N, Precision P>
+		inline void normalizeScalar(const float* const* a, float* const* o, size_t p_Start, size_t p_Count)
+		{
+			for(size_t i = p_Start; i < p_Count; ++i)
+			{
+				float d = 0;
+				for(int c = 0; c < N; ++c)
+					d += a[c][i] * a[c][i];
+
+				float f = normalizeFactorScalar<P>(d);
+				for(int c = 0; c < N; ++c)
+					o[c][i] = normalizeApplyScalar<P>(a[c][i], f);
+			}
+		}
+
+		inline void crossScalar(const float* const* a, const float* const* b, float* const* o, size_t p_Start, size_t p_Count)
+		{
+			for(size_t i = p_Start; i < p_Count; ++i)
+			{
+				float x = a[1][i] * b[2][i] - b[1][i] * a[2][i];
+				float y = a[2][i] * b[0][i] - b[2][i] * a[0][i];
+				float z = a[0][i] * b[1][i] - b[0][i] * a[1][i];
+
+				o[0][i] = x;
+				o[1][i] = y;
+				o[2][i] = z;
+			}
+		}
+
+#if ALFAR_X86
+
+		//===================================================================== SSE2
+
+		template<BinaryOp OP>
+		ALFAR_TARGET_SSE2 inline void binarySSE2(const float* a, const float* b, float* o, size_t p_Count)
+		{
+			size_t i = 0;
+			for(; i + 4 <= p_Count; i += 4)
+			{
+				__m128 va = _mm_loadu_ps(a + i);
+				__m128 vb = _mm_loadu_ps(b + i);
+				__m128 r = OP == OP_ADD ? _mm_add_ps(va, vb) : (OP == OP_SUB ? _mm_sub_ps(va, vb) : _mm_mul_ps(va, vb));
+				_mm_storeu_ps(o + i, r);
+			}
+
+			binaryScalar<OP>(a + i, b + i, o + i, p_Count - i);
+		}
+
+		ALFAR_TARGET_SSE2 inline void lerpSSE2(const float* a, const float* b, float t, float* o, size_t p_Count)
+		{
+			__m128 vt = _mm_set1_ps(t);
+			__m128 vu = _mm_set1_ps(1.0f - t);
+
+			size_t i = 0;
+			for(; i + 4 <= p_Count; i += 4)
+				_mm_storeu_ps(o + i, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a + i), vu), _mm_mul_ps(_mm_loadu_ps(b + i), vt)));
+
+			lerpScalar(a + i, b + i, t, o + i, p_Count - i);
+		}
+
+		template<int N>
+		ALFAR_TARGET_SSE2 inline void dotSSE2(const float* const* a, const float* const* b, float* o, size_t p_Start, size_t p_Count)
+		{
+			size_t i = p_Start;
+			for(; i + 4 <= p_Count; i += 4)
+			{
+				__m128 d = _mm_mul_ps(_mm_loadu_ps(a[0] + i), _mm_loadu_ps(b[0] + i));
+				for(int c = 1; c < N; ++c)
+					d = _mm_add_ps(d, _mm_mul_ps(_mm_loadu_ps(a[c] + i), _mm_loadu_ps(b[c] + i)));
+
+				_mm_storeu_ps(o + i, d);
+			}
+
+			dotScalar<N>(a, b, o, i, p_Count);
+		}
+
+		template<int N>
+		ALFAR_TARGET_SSE2 inline void magnitudeSSE2(const float* const* a, float* o, size_t p_Start, size_t p_Count)
+		{
+			size_t i = p_Start;
+			for(; i + 4 <= p_Count; i += 4)
+			{
+				__m128 d = _mm_setzero_ps();
+				for(int c = 0; c < N; ++c)
+				{
+					__m128 v = _mm_loadu_ps(a[c] + i);
+					d = _mm_add_ps(d, _mm_mul_ps(v, v));
+				}
+
+				_mm_storeu_ps(o + i, _mm_sqrt_ps(d));
+			}
+
+			magnitudeScalar<N>(a, o, i, p_Count);
+		}
+
+		template<Precision P>
+		ALFAR_TARGET_SSE2 inline __m128 normalizeFactorSSE2(__m128 d)
+		{
+			if(P == PRECISION_EXACT)
+				return _mm_sqrt_ps(d);
+
+			d = _mm_max_ps(d, _mm_set1_ps(FLT_MIN));
+			__m128 y = _mm_rsqrt_ps(d);
+
+			if(P == PRECISION_REFINED)
+				y = _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), d), _mm_mul_ps(y, y))));
+
+			return y;
+		}
+
+		template<Precision P>
+		ALFAR_TARGET_SSE2 inline __m128 normalizeApplySSE2(__m128 v, __m128 f)
+		{
+			if(P == PRECISION_EXACT)
+				return _mm_and_ps(_mm_div_ps(v, f), _mm_cmpgt_ps(f, _mm_setzero_ps()));
+
+			return _mm_mul_ps(v, f);
+		}
+
+		template<int N, Precision P>
+		ALFAR_TARGET_SSE2 inline void normalizeSSE2(const float* const* a, float* const* o, size_t p_Start, size_t p_Count)
+		{
+			size_t i = p_Start;
+			for(; i + 4 <= p_Count; i += 4)
+			{
+				__m128 v[N];
+				__m128 d = _mm_setzero_ps();
+				for(int c = 0; c < N; ++c)
+				{
+					v[c] = _mm_loadu_ps(a[c] + i);
+					d = _mm_add_ps(d, _mm_mul_ps(v[c], v[c]));
+				}
+
+				__m128 f = normalizeFactorSSE2<P>(d);
+				for(int c = 0; c < N; ++c)
+					_mm_storeu_ps(o[c] + i, normalizeApplySSE2<P>(v[c], f));
+			}
+
+			normalizeScalar<N, P>(a, o, i, p_Count);
+		}
+
+		ALFAR_TARGET_SSE2 inline void crossSSE2(const float* const* a, const float* const* b, float* const* o, size_t p_Start, size_t p_Count)
+		{
+			size_t i = p_Start;
+			for(; i + 4 <= p_Count; i += 4)
+			{
+				__m128 ax = _mm_loadu_ps(a[0] + i), ay = _mm_loadu_ps(a[1] + i), az = _mm_loadu_ps(a[2] + i);
+				__m128 bx = _mm_loadu_ps(b[0] + i), by = _mm_loadu_ps(b[1] + i), bz = _mm_loadu_ps(b[2] + i);
+
+				_mm_storeu_ps(o[0] + i, _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(by, az)));
+				_mm_storeu_ps(o[1] + i, _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(bz, ax)));
+				_mm_storeu_ps(o[2] + i, _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(bx, ay)));
+			}
+
+			crossScalar(a, b, o, i, p_Count);
+		}
+
+		//===================================================================== AVX2
+
+		template<BinaryOp OP>
+		ALFAR_TARGET_AVX2 inline void binaryAVX2(const float* a, const float* b, float* o, size_t p_Count)
+		{
+			size_t i = 0;
+			for(; i + 8 <= p_Count; i += 8)
+			{
+				__m256 va = _mm256_loadu_ps(a + i);
+				__m256 vb = _mm256_loadu_ps(b + i);
+				__m256 r = OP == OP_ADD ? _mm256_add_ps(va, vb) : (OP == OP_SUB ? _mm256_sub_ps(va, vb) : _mm256_mul_ps(va, vb));
+				_mm256_storeu_ps(o + i, r);
+			}
+
+			binarySSE2<OP>(a + i, b + i, o + i, p_Count - i);
+		}
+
+		ALFAR_TARGET_AVX2 inline void lerpAVX2(const float* a, const float* b, float t, float* o, size_t p_Count)
+		{
+			__m256 vt = _mm256_set1_ps(t);
+			__m256 vu = _mm256_set1_ps(1.0f - t);
+
+			size_t i = 0;
+			for(; i + 8 <= p_Count; i += 8)
+				_mm256_storeu_ps(o + i, _mm256_fmadd_ps(_mm256_loadu_ps(b + i), vt, _mm256_mul_ps(_mm256_loadu_ps(a + i), vu)));
+
+			lerpSSE2(a + i, b + i, t, o + i, p_Count - i);
+		}
+
+		template<int N>
+		ALFAR_TARGET_AVX2 inline void dotAVX2(const float* const* a, const float* const* b, float* o, size_t p_Start, size_t p_Count)
+		{
+			size_t i = p_Start;
+			for(; i + 8 <= p_Count; i += 8)
+			{
+				__m256 d = _mm256_mul_ps(_mm256_loadu_ps(a[0] + i), _mm256_loadu_ps(b[0] + i));
+				for(int c = 1; c < N; ++c)
+					d = _mm256_fmadd_ps(_mm256_loadu_ps(a[c] + i), _mm256_loadu_ps(b[c] + i), d);
+
+				_mm256_storeu_ps(o + i, d);
+			}
+
+			dotSSE2<N>(a, b, o, i, p_Count);
+		}
+
+		template<int N>
+		ALFAR_TARGET_AVX2 inline void magnitudeAVX2(const float* const* a, float* o, size_t p_Start, size_t p_Count)
+		{
+			size_t i = p_Start;
+			for(; i + 8 <= p_Count; i += 8)
+			{
+				__m256 d = _mm256_setzero_ps();
+				for(int c = 0; c < N; ++c)
+				{
+					__m256 v = _mm256_loadu_ps(a[c] + i);
+					d = _mm256_fmadd_ps(v, v, d);
+				}
+
+				_mm256_storeu_ps(o + i, _mm256_sqrt_ps(d));
+			}
+
+			magnitudeSSE2<N>(a, o, i, p_Count);
+		}
+
+		template<Precision P>
+		ALFAR_TARGET_AVX2 inline __m256 normalizeFactorAVX2(__m256 d)
+		{
+			if(P == PRECISION_EXACT)
+				return _mm256_sqrt_ps(d);
+
+			d = _mm256_max_ps(d, _mm256_set1_ps(FLT_MIN));
+			__m256 y = _mm256_rsqrt_ps(d);
+
+			if(P == PRECISION_REFINED)
+				y = _mm256_mul_ps(y, _mm256_fnmadd_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), d), _mm256_mul_ps(y, y), _mm256_set1_ps(1.5f)));
+
+			return y;
+		}
+
+		template<Precision P>
+		ALFAR_TARGET_AVX2 inline __m256 normalizeApplyAVX2(__m256 v, __m256 f)
+		{
+			if(P == PRECISION_EXACT)
+				return _mm256_and_ps(_mm256_div_ps(v, f), _mm256_cmp_ps(f, _mm256_setzero_ps(), _CMP_GT_OQ));
+
+			return _mm256_mul_ps(v, f);
+		}
+
+		template<int N, Precision P>
+		ALFAR_TARGET_AVX2 inline void normalizeAVX2(const float* const* a, float* const* o, size_t p_Start, size_t p_Count)
+		{
+			size_t i = p_Start;
+			for(; i + 8 <= p_Count; i += 8)
+			{
+				__m256 v[N];
+				__m256 d = _mm256_setzero_ps();
+				for(int c = 0; c < N; ++c)
+				{
+					v[c] = _mm256_loadu_ps(a[c] + i);
+					d = _mm256_fmadd_ps(v[c], v[c], d);
+				}
+
+				__m256 f = normalizeFactorAVX2<P>(d);
+				for(int c = 0; c < N; ++c)
+					_mm256_storeu_ps(o[c] + i, normalizeApplyAVX2<P>(v[c], f));
+			}
+
+			normalizeSSE2<N, P>(a, o, i, p_Count);
+		}
+
+		ALFAR_TARGET_AVX2 inline void crossAVX2(const float* const* a, const float* const* b, float* const* o, size_t p_Start, size_t p_Count)
+		{
+			size_t i = p_Start;
+			for(; i + 8 <= p_Count; i += 8)
+			{
+				__m256 ax = _mm256_loadu_ps(a[0] + i), ay = _mm256_loadu_ps(a[1] + i), az = _mm256_loadu_ps(a[2] + i);
+				__m256 bx = _mm256_loadu_ps(b[0] + i), by = _mm256_loadu_ps(b[1] + i), bz = _mm256_loadu_ps(b[2] + i);
+
+				_mm256_storeu_ps(o[0] + i, _mm256_fmsub_ps(ay, bz, _mm256_mul_ps(by, az)));
+				_mm256_storeu_ps(o[1] + i, _mm256_fmsub_ps(az, bx, _mm256_mul_ps(bz, ax)));
+				_mm256_storeu_ps(o[2] + i, _mm256_fmsub_ps(ax, by, _mm256_mul_ps(bx, ay)));
+			}
+
+			crossSSE2(a, b, o, i, p_Count);
+		}
+
+		//===================================================================== AVX-512
+
+		template<BinaryOp OP>
+		ALFAR_TARGET_AVX512 inline void binaryAVX512(const float* a, const float* b, float* o, size_t p_Count)
+		{
+			size_t i = 0;
+			for(; i + 16 <= p_Count; i += 16)
+			{
+				__m512 va = _mm512_loadu_ps(a + i);
+				__m512 vb = _mm512_loadu_ps(b + i);
+				__m512 r = OP == OP_ADD ? _mm512_add_ps(va, vb) : (OP == OP_SUB ? _mm512_sub_ps(va, vb) : _mm512_mul_ps(va, vb));
+				_mm512_storeu_ps(o + i, r);
+			}
+
+			if(i < p_Count)
+			{
+				__mmask16 mask = (__mmask16)((1u << (p_Count - i)) - 1);
+				__m512 va = _mm512_maskz_loadu_ps(mask, a + i);
+				__m512 vb = _mm512_maskz_loadu_ps(mask, b + i);
+				__m512 r = OP == OP_ADD ? _mm512_add_ps(va, vb) : (OP == OP_SUB ? _mm512_sub_ps(va, vb) : _mm512_mul_ps(va, vb));
+				_mm512_mask_storeu_ps(o + i, mask, r);
+			}
+		}
+
+		ALFAR_TARGET_AVX512 inline void lerpAVX512(const float* a, const float* b, float t, float* o, size_t p_Count)
+		{
+			__m512 vt = _mm512_set1_ps(t);
+			__m512 vu = _mm512_set1_ps(1.0f - t);
+
+			size_t i = 0;
+			for(; i + 16 <= p_Count; i += 16)
+				_mm512_storeu_ps(o + i, _mm512_fmadd_ps(_mm512_loadu_ps(b + i), vt, _mm512_mul_ps(_mm512_loadu_ps(a + i), vu)));
+
+			lerpAVX2(a + i, b + i, t, o + i, p_Count - i);
+		}
+
+		template<int N>
+		ALFAR_TARGET_AVX512 inline void dotAVX512(const float* const* a, const float* const* b, float* o, size_t p_Start, size_t p_Count)
+		{
+			size_t i = p_Start;
+			for(; i + 16 <= p_Count; i += 16)
+			{
+				__m512 d = _mm512_mul_ps(_mm512_loadu_ps(a[0] + i), _mm512_loadu_ps(b[0] + i));
+				for(int c = 1; c < N; ++c)
+					d = _mm512_fmadd_ps(_mm512_loadu_ps(a[c] + i), _mm512_loadu_ps(b[c] + i), d);
+
+				_mm512_storeu_ps(o + i, d);
+			}
+
+			dotAVX2<N>(a, b, o, i, p_Count);
+		}
+
+		template<int N>
+		ALFAR_TARGET_AVX512 inline void magnitudeAVX512(const float* const* a, float* o, size_t p_Start, size_t p_Count)
+		{
+			size_t i = p_Start;
+			for(; i + 16 <= p_Count; i += 16)
+			{
+				__m512 d = _mm512_setzero_ps();
+				for(int c = 0; c < N; ++c)
+				{
+					__m512 v = _mm512_loadu_ps(a[c] + i);
+					d = _mm512_fmadd_ps(v, v, d);
+				}
+
+				_mm512_storeu_ps(o + i, _mm512_sqrt_ps(d));
+			}
+
+			magnitudeAVX2<N>(a, o, i, p_Count);
+		}
+
+		//rsqrt14 is the AVX-512 estimate, 2^-14 instead of the 1.5 * 2^-12 of rsqrtps
+		template<Precision P>
+		ALFAR_TARGET_AVX512 inline __m512 normalizeFactorAVX512(__m512 d)
+		{
+			if(P == PRECISION_EXACT)
+				return _mm512_sqrt_ps(d);
+
+			d = _mm512_max_ps(d, _mm512_set1_ps(FLT_MIN));
+			__m512 y = _mm512_rsqrt14_ps(d);
+
+			if(P == PRECISION_REFINED)
+				y = _mm512_mul_ps(y, _mm512_fnmadd_ps(_mm512_mul_ps(_mm512_set1_ps(0.5f), d), _mm512_mul_ps(y, y), _mm512_set1_ps(1.5f)));
+
+			return y;
+		}
+
+		template<Precision P>
+		ALFAR_TARGET_AVX512 inline __m512 normalizeApplyAVX512(__m512 v, __m512 f)
+		{
+			if(P == PRECISION_EXACT)
+				return _mm512_maskz_div_ps(_mm512_cmp_ps_mask(f, _mm512_setzero_ps(), _CMP_GT_OQ), v, f);
+
+			return _mm512_mul_ps(v, f);
+		}
+
+		template<int N, Precision P>
+		ALFAR_TARGET_AVX512 inline void normalizeAVX512(const float* const* a, float* const* o, size_t p_Start, size_t p_Count)
+		{
+			size_t i = p_Start;
+			for(; i + 16 <= p_Count; i += 16)
+			{
+				__m512 v[N];
+				__m512 d = _mm512_setzero_ps();
+				for(int c = 0; c < N; ++c)
+				{
+					v[c] = _mm512_loadu_ps(a[c] + i);
+					d = _mm512_fmadd_ps(v[c], v[c], d);
+				}
+
+				__m512 f = normalizeFactorAVX512<P>(d);
+				for(int c = 0; c < N; ++c)
+					_mm512_storeu_ps(o[c] + i, normalizeApplyAVX512<P>(v[c], f));
+			}
+
+			normalizeAVX2<N, P>(a, o, i, p_Count);
+		}
+
+		ALFAR_TARGET_AVX512 inline void crossAVX512(const float* const* a, const float* const* b, float* const* o, size_t p_Start, size_t p_Count)
+		{
+			size_t i = p_Start;
+			for(; i + 16 <= p_Count; i += 16)
+			{
+				__m512 ax = _mm512_loadu_ps(a[0] + i), ay = _mm512_loadu_ps(a[1] + i), az = _mm512_loadu_ps(a[2] + i);
+				__m512 bx = _mm512_loadu_ps(b[0] + i), by = _mm512_loadu_ps(b[1] + i), bz = _mm512_loadu_ps(b[2] + i);
+
+				_mm512_storeu_ps(o[0] + i, _mm512_fmsub_ps(ay, bz, _mm512_mul_ps(by, az)));
+				_mm512_storeu_ps(o[1] + i, _mm512_fmsub_ps(az, bx, _mm512_mul_ps(bz, ax)));
+				_mm512_storeu_ps(o[2] + i, _mm512_fmsub_ps(ax, by, _mm512_mul_ps(bx, ay)));
+			}
+
+			crossAVX2(a, b, o, i, p_Count);
+		}
+
+#endif
+
+		//===================================================================== dispatch
+
+		template<BinaryOp OP>
+		inline void binary(const float* a, const float* b, float* o, size_t p_Count)
+		{
+			switch(cpu::level())
+			{
+#if ALFAR_X86
+			case cpu::LEVEL_AVX512:	binaryAVX512<OP>(a, b, o, p_Count); return;
+			case cpu::LEVEL_AVX2:	binaryAVX2<OP>(a, b, o, p_Count); return;
+			case cpu::LEVEL_SSE2:	binarySSE2<OP>(a, b, o, p_Count); return;
+#endif
+			default:				binaryScalar<OP>(a, b, o, p_Count); return;
+			}
+		}
+
+		inline void lerp(const float* a, const float* b, float t, float* o, size_t p_Count)
+		{
+			switch(cpu::level())
+			{
+#if ALFAR_X86
+			case cpu::LEVEL_AVX512:	lerpAVX512(a, b, t, o, p_Count); return;
+			case cpu::LEVEL_AVX2:	lerpAVX2(a, b, t, o, p_Count); return;
+			case cpu::LEVEL_SSE2:	lerpSSE2(a, b, t, o, p_Count); return;
+#endif
+			default:				lerpScalar(a, b, t, o, p_Count); return;
+			}
+		}
+
+		template<int N>
+		inline void dot(const float* const* a, const float* const* b, float* o, size_t p_Count)
+		{
+			switch(cpu::level())
+			{
+#if ALFAR_X86
+			case cpu::LEVEL_AVX512:	dotAVX512<N>(a, b, o, 0, p_Count); return;
+			case cpu::LEVEL_AVX2:	dotAVX2<N>(a, b, o, 0, p_Count); return;
+			case cpu::LEVEL_SSE2:	dotSSE2<N>(a, b, o, 0, p_Count); return;
+#endif
+			default:				dotScalar<N>(a, b, o, 0, p_Count); return;
+			}
+		}
+
+		template<int N>
+		inline void magnitude(const float* const* a, float* o, size_t p_Count)
+		{
+			switch(cpu::level())
+			{
+#if ALFAR_X86
+			case cpu::LEVEL_AVX512:	magnitudeAVX512<N>(a, o, 0, p_Count); return;
+			case cpu::LEVEL_AVX2:	magnitudeAVX2<N>(a, o, 0, p_Count); return;
+			case cpu::LEVEL_SSE2:	magnitudeSSE2<N>(a, o, 0, p_Count); return;
+#endif
+			default:				magnitudeScalar<N>(a, o, 0, p_Count); return;
+			}
+		}
+
+		template<int N, Precision P>
+		inline void normalize(const float* const* a, float* const* o, size_t p_Count)
+		{
+			switch(cpu::level())
+			{
+#if ALFAR_X86
+			case cpu::LEVEL_AVX512:	normalizeAVX512<N, P>(a, o, 0, p_Count); return;
+			case cpu::LEVEL_AVX2:	normalizeAVX2<N, P>(a, o, 0, p_Count); return;
+			case cpu::LEVEL_SSE2:	normalizeSSE2<N, P>(a, o, 0, p_Count); return;
+#endif
+			default:				normalizeScalar<N, P>(a, o, 0, p_Count); return;
+			}
+		}
+
+		inline void cross(const float* const* a, const float* const* b, float* const* o, size_t p_Count)
+		{
+			switch(cpu::level())
+			{
+#if ALFAR_X86
+			case cpu::LEVEL_AVX512:	crossAVX512(a, b, o, 0, p_Count); return;
+			case cpu::LEVEL_AVX2:	crossAVX2(a, b, o, 0, p_Count); return;
+			case cpu::LEVEL_SSE2:	crossSSE2(a, b, o, 0, p_Count); return;
+#endif
+			default:				crossScalar(a, b, o, 0, p_Count); return;
+			}
+		}
+	}
+}
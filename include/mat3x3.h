@@ -0,0 +1,186 @@
+#pragma once
+
+#include "math_types.h"
+#include "vector3.h"
+#include "vector4.h"
+#include "quaternion.h"
+#include "mat3x3_simd.h"
+#include <stdint.h>
+
+// 3x3 matrices for rotations, scales and normal transforms. Same conventions
+// as Matrix4x4: x, y, z are the rows and vectors are columns, so
+// vector3::mul(m, v) gives (dot(m.x, v), dot(m.y, v), dot(m.z, v)) and
+// fromMat4x4 keeps the linear part of an affine matrix.
+
+namespace alfar
+{
+	namespace mat3x3
+	{
+		ALFAR_CONSTEXPR Matrix3x3 create(const Vector3& x, const Vector3& y, const Vector3& z)
+		{
+			Matrix3x3 mat = {};
+			mat.x = x;
+			mat.y = y;
+			mat.z = z;
+
+			return mat;
+		}
+
+		ALFAR_CONSTEXPR Matrix3x3 identity()
+		{
+			return create(vector3::create(1, 0, 0), vector3::create(0, 1, 0), vector3::create(0, 0, 1));
+		}
+
+		//---------------------------------------------------------------------------
+
+		//upper 3x3 block, translation and bottom row dropped
+		ALFAR_CONSTEXPR Matrix3x3 fromMat4x4(const Matrix4x4& m)
+		{
+			return create(vector3::create(m.x.x, m.x.y, m.x.z),
+						  vector3::create(m.y.x, m.y.y, m.y.z),
+						  vector3::create(m.z.x, m.z.y, m.z.z));
+		}
+
+		//[m 0; 0 1]
+		ALFAR_CONSTEXPR Matrix4x4 toMat4x4(const Matrix3x3& m)
+		{
+			Matrix4x4 mat = {};
+			mat.x = vector4::create(m.x.x, m.x.y, m.x.z, 0);
+			mat.y = vector4::create(m.y.x, m.y.y, m.y.z, 0);
+			mat.z = vector4::create(m.z.x, m.z.y, m.z.z, 0);
+			mat.t = vector4::create(0, 0, 0, 1);
+
+			return mat;
+		}
+
+		//rotation matrix of q, normalized first when it is not a unit quaternion (as quaternion::toMat4x4)
+		ALFAR_CONSTEXPR Matrix3x3 fromQuaternion(const Quaternion& q)
+		{
+			return fromMat4x4(quaternion::toMat4x4(q));
+		}
+
+		//===========================================================================
+
+		ALFAR_CONSTEXPR Matrix3x3 mul(const Matrix3x3& a, const Matrix3x3& b)
+		{
+			Matrix3x3 out = {};
+
+			out.x.x = a.x.x * b.x.x + a.x.y * b.y.x + a.x.z * b.z.x;
+			out.x.y = a.x.x * b.x.y + a.x.y * b.y.y + a.x.z * b.z.y;
+			out.x.z = a.x.x * b.x.z + a.x.y * b.y.z + a.x.z * b.z.z;
+
+			out.y.x = a.y.x * b.x.x + a.y.y * b.y.x + a.y.z * b.z.x;
+			out.y.y = a.y.x * b.x.y + a.y.y * b.y.y + a.y.z * b.z.y;
+			out.y.z = a.y.x * b.x.z + a.y.y * b.y.z + a.y.z * b.z.z;
+
+			out.z.x = a.z.x * b.x.x + a.z.y * b.y.x + a.z.z * b.z.x;
+			out.z.y = a.z.x * b.x.y + a.z.y * b.y.y + a.z.z * b.z.y;
+			out.z.z = a.z.x * b.x.z + a.z.y * b.y.z + a.z.z * b.z.z;
+
+			return out;
+		}
+
+		//---------------------------------------------------------------------------
+
+		ALFAR_CONSTEXPR Matrix3x3 transpose(const Matrix3x3& m)
+		{
+			return create(vector3::create(m.x.x, m.y.x, m.z.x),
+						  vector3::create(m.x.y, m.y.y, m.z.y),
+						  vector3::create(m.x.z, m.y.z, m.z.z));
+		}
+
+		//---------------------------------------------------------------------------
+
+		ALFAR_CONSTEXPR float determinant(const Matrix3x3& m)
+		{
+			return vector3::dot(m.x, vector3::cross(m.y, m.z));
+		}
+
+		//---------------------------------------------------------------------------
+
+		//transpose of the inverse: the cofactor rows y x z, z x x, x x y over the determinant.
+		//normals go through it so they stay perpendicular to surfaces under non uniform scale.
+		//a singular matrix gives inf/nan.
+		ALFAR_CONSTEXPR Matrix3x3 normalMatrix(const Matrix3x3& m)
+		{
+			Vector3 c0 = vector3::cross(m.y, m.z);
+			Vector3 c1 = vector3::cross(m.z, m.x);
+			Vector3 c2 = vector3::cross(m.x, m.y);
+
+			float invDet = 1.0f / vector3::dot(m.x, c0);
+
+			return create(vector3::mul(c0, invDet), vector3::mul(c1, invDet), vector3::mul(c2, invDet));
+		}
+
+		//normal matrix of the upper 3x3 block, the translation does not apply to normals
+		ALFAR_CONSTEXPR Matrix3x3 normalMatrix(const Matrix4x4& m)
+		{
+			return normalMatrix(fromMat4x4(m));
+		}
+
+		//---------------------------------------------------------------------------
+
+		//the cofactors as columns, as in mat4x4::affineInverse. a singular matrix gives inf/nan.
+		ALFAR_CONSTEXPR Matrix3x3 inverse(const Matrix3x3& m)
+		{
+			return transpose(normalMatrix(m));
+		}
+
+		//----- array version
+		//p_Out may be p_In itself (the in-place overloads do that); partially
+		//overlapping ranges are not supported.
+
+		//vector3::mul(m, v) for each vector
+		inline void transform(const Matrix3x3& m, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+		{
+			simd::transform<false>(m, p_In, p_Out, p_Number);
+		}
+
+		inline void transform(const Matrix3x3& m, Vector3* p_InOut, uint32_t p_Number)
+		{
+			simd::transform<false>(m, p_InOut, p_InOut, p_Number);
+		}
+
+		//---------------------------------------------------------------------------
+
+		//vector3::normalize(vector3::mul(m, n)) for each normal, m typically a normalMatrix. zero normals stay zero.
+		inline void transformNormals(const Matrix3x3& m, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+		{
+			simd::transform<true>(m, p_In, p_Out, p_Number);
+		}
+
+		inline void transformNormals(const Matrix3x3& m, Vector3* p_InOut, uint32_t p_Number)
+		{
+			simd::transform<true>(m, p_InOut, p_InOut, p_Number);
+		}
+
+		//---------------------------------------------------------------------------
+
+		//p_Out[i] = p_Firsts[i] * p_Seconds[i]; p_Out may be either input array.
+		inline void mul(const Matrix3x3* p_Firsts, const Matrix3x3* p_Seconds, Matrix3x3* p_Out, uint32_t p_Number)
+		{
+			for(uint32_t i = 0; i < p_Number; ++i)
+				p_Out[i] = mul(p_Firsts[i], p_Seconds[i]);
+		}
+
+		//batch versions of inverse and normalMatrix; p_Out may be p_In.
+		inline void inverse(const Matrix3x3* p_In, Matrix3x3* p_Out, uint32_t p_Number)
+		{
+			for(uint32_t i = 0; i < p_Number; ++i)
+				p_Out[i] = inverse(p_In[i]);
+		}
+
+		inline void normalMatrix(const Matrix3x3* p_In, Matrix3x3* p_Out, uint32_t p_Number)
+		{
+			for(uint32_t i = 0; i < p_Number; ++i)
+				p_Out[i] = normalMatrix(p_In[i]);
+		}
+
+		//normal matrices of world matrices, e.g. one per instance
+		inline void normalMatrix(const Matrix4x4* p_In, Matrix3x3* p_Out, uint32_t p_Number)
+		{
+			for(uint32_t i = 0; i < p_Number; ++i)
+				p_Out[i] = normalMatrix(p_In[i]);
+		}
+	}
+}
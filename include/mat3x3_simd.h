@@ -0,0 +1,186 @@
+#pragma once
+
+#include "math_types.h"
+#include "cpu.h"
+#include "vector3_simd.h"
+#include <math.h>
+#include <stdint.h>
+
+// SIMD kernels behind the mat3x3 array transforms. Same scheme as the
+// vector3 matrix transforms: the 9 coefficients are broadcast once and the
+// packed Vector3 input goes through the SoA shuffles of vector3_simd.h, so a
+// vector costs 9 mul/add instead of the 12 of a Matrix4x4 direction transform
+// and the matrix occupies 9 registers instead of 16.
+// NORMALIZE rescales every result to unit length, for normals transformed by
+// a normal matrix, with the exact lanes.h normalize (zero vectors stay zero).
+// Every kernel finishes the remaining vectors with the narrower one and
+// accepts p_Out == p_In.
+
+namespace alfar
+{
+	namespace mat3x3
+	{
+		namespace simd
+		{
+			static_assert(sizeof(Matrix3x3) == 9 * sizeof(float), "Matrix3x3 must be 9 packed floats");
+
+			template<bool NORMALIZE>
+			inline void transformScalar(const Matrix3x3& m, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+				{
+					Vector3 v = p_In[i];
+
+					float x = m.x.x * v.x + m.x.y * v.y + m.x.z * v.z;
+					float y = m.y.x * v.x + m.y.y * v.y + m.y.z * v.z;
+					float z = m.z.x * v.x + m.z.y * v.y + m.z.z * v.z;
+
+					if(NORMALIZE)
+					{
+						float length = lanes::normalizeFactorScalar<PRECISION_EXACT>(x * x + y * y + z * z);
+						x = lanes::normalizeApplyScalar<PRECISION_EXACT>(x, length);
+						y = lanes::normalizeApplyScalar<PRECISION_EXACT>(y, length);
+						z = lanes::normalizeApplyScalar<PRECISION_EXACT>(z, length);
+					}
+
+					p_Out[i].x = x;
+					p_Out[i].y = y;
+					p_Out[i].z = z;
+				}
+			}
+
+#if ALFAR_X86
+
+			//===================================================================== SSE2
+
+			template<bool NORMALIZE>
+			ALFAR_TARGET_SSE2 inline void transformSSE2(const Matrix3x3& p_Mat, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				const float* m = &p_Mat.x.x;
+				__m128 c[9];
+				for(int k = 0; k < 9; ++k)
+					c[k] = _mm_set1_ps(m[k]);
+
+				uint32_t i = 0;
+				for(; i + 4 <= p_Number; i += 4)
+				{
+					const float* a = &p_In[i].x;
+					__m128 x, y, z;
+					vector3::simd::deinterleave(_mm_loadu_ps(a), _mm_loadu_ps(a + 4), _mm_loadu_ps(a + 8), x, y, z);
+
+					__m128 ox = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c[0], x), _mm_mul_ps(c[1], y)), _mm_mul_ps(c[2], z));
+					__m128 oy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c[3], x), _mm_mul_ps(c[4], y)), _mm_mul_ps(c[5], z));
+					__m128 oz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c[6], x), _mm_mul_ps(c[7], y)), _mm_mul_ps(c[8], z));
+
+					if(NORMALIZE)
+					{
+						__m128 length = lanes::normalizeFactorSSE2<PRECISION_EXACT>(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ox, ox), _mm_mul_ps(oy, oy)), _mm_mul_ps(oz, oz)));
+						ox = lanes::normalizeApplySSE2<PRECISION_EXACT>(ox, length);
+						oy = lanes::normalizeApplySSE2<PRECISION_EXACT>(oy, length);
+						oz = lanes::normalizeApplySSE2<PRECISION_EXACT>(oz, length);
+					}
+
+					__m128 m0, m1, m2;
+					vector3::simd::interleave(ox, oy, oz, m0, m1, m2);
+
+					float* o = &p_Out[i].x;
+					_mm_storeu_ps(o, m0);
+					_mm_storeu_ps(o + 4, m1);
+					_mm_storeu_ps(o + 8, m2);
+				}
+
+				transformScalar<NORMALIZE>(p_Mat, p_In + i, p_Out + i, p_Number - i);
+			}
+
+			//===================================================================== AVX2
+
+			template<bool NORMALIZE>
+			ALFAR_TARGET_AVX2 inline void transformAVX2(const Matrix3x3& p_Mat, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				const float* m = &p_Mat.x.x;
+				__m256 c[9];
+				for(int k = 0; k < 9; ++k)
+					c[k] = _mm256_set1_ps(m[k]);
+
+				uint32_t i = 0;
+				for(; i + 8 <= p_Number; i += 8)
+				{
+					__m256 m0, m1, m2, x, y, z;
+					vector3::simd::load8(&p_In[i].x, m0, m1, m2);
+					vector3::simd::deinterleave(m0, m1, m2, x, y, z);
+
+					__m256 ox = _mm256_fmadd_ps(c[2], z, _mm256_fmadd_ps(c[1], y, _mm256_mul_ps(c[0], x)));
+					__m256 oy = _mm256_fmadd_ps(c[5], z, _mm256_fmadd_ps(c[4], y, _mm256_mul_ps(c[3], x)));
+					__m256 oz = _mm256_fmadd_ps(c[8], z, _mm256_fmadd_ps(c[7], y, _mm256_mul_ps(c[6], x)));
+
+					if(NORMALIZE)
+					{
+						__m256 length = lanes::normalizeFactorAVX2<PRECISION_EXACT>(_mm256_fmadd_ps(oz, oz, _mm256_fmadd_ps(oy, oy, _mm256_mul_ps(ox, ox))));
+						ox = lanes::normalizeApplyAVX2<PRECISION_EXACT>(ox, length);
+						oy = lanes::normalizeApplyAVX2<PRECISION_EXACT>(oy, length);
+						oz = lanes::normalizeApplyAVX2<PRECISION_EXACT>(oz, length);
+					}
+
+					vector3::simd::interleave(ox, oy, oz, m0, m1, m2);
+					vector3::simd::store8(&p_Out[i].x, m0, m1, m2);
+				}
+
+				transformSSE2<NORMALIZE>(p_Mat, p_In + i, p_Out + i, p_Number - i);
+			}
+
+			//===================================================================== AVX-512
+
+			template<bool NORMALIZE>
+			ALFAR_TARGET_AVX512 inline void transformAVX512(const Matrix3x3& p_Mat, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				const float* m = &p_Mat.x.x;
+				__m512 c[9];
+				for(int k = 0; k < 9; ++k)
+					c[k] = _mm512_set1_ps(m[k]);
+
+				uint32_t i = 0;
+				for(; i + 16 <= p_Number; i += 16)
+				{
+					__m512 m0, m1, m2, x, y, z;
+					vector3::simd::load16(&p_In[i].x, m0, m1, m2);
+					vector3::simd::deinterleave(m0, m1, m2, x, y, z);
+
+					__m512 ox = _mm512_fmadd_ps(c[2], z, _mm512_fmadd_ps(c[1], y, _mm512_mul_ps(c[0], x)));
+					__m512 oy = _mm512_fmadd_ps(c[5], z, _mm512_fmadd_ps(c[4], y, _mm512_mul_ps(c[3], x)));
+					__m512 oz = _mm512_fmadd_ps(c[8], z, _mm512_fmadd_ps(c[7], y, _mm512_mul_ps(c[6], x)));
+
+					if(NORMALIZE)
+					{
+						__m512 length = lanes::normalizeFactorAVX512<PRECISION_EXACT>(_mm512_fmadd_ps(oz, oz, _mm512_fmadd_ps(oy, oy, _mm512_mul_ps(ox, ox))));
+						ox = lanes::normalizeApplyAVX512<PRECISION_EXACT>(ox, length);
+						oy = lanes::normalizeApplyAVX512<PRECISION_EXACT>(oy, length);
+						oz = lanes::normalizeApplyAVX512<PRECISION_EXACT>(oz, length);
+					}
+
+					vector3::simd::interleave(ox, oy, oz, m0, m1, m2);
+					vector3::simd::store16(&p_Out[i].x, m0, m1, m2);
+				}
+
+				transformAVX2<NORMALIZE>(p_Mat, p_In + i, p_Out + i, p_Number - i);
+			}
+
+#endif
+
+			//===================================================================== dispatch
+
+			template<bool NORMALIZE>
+			inline void transform(const Matrix3x3& p_Mat, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	transformAVX512<NORMALIZE>(p_Mat, p_In, p_Out, p_Number); return;
+				case cpu::LEVEL_AVX2:	transformAVX2<NORMALIZE>(p_Mat, p_In, p_Out, p_Number); return;
+				case cpu::LEVEL_SSE2:	transformSSE2<NORMALIZE>(p_Mat, p_In, p_Out, p_Number); return;
+#endif
+				default:				transformScalar<NORMALIZE>(p_Mat, p_In, p_Out, p_Number); return;
+				}
+			}
+		}
+	}
+}
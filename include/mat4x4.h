@@ -3,15 +3,20 @@
 #include "math_types.h"
 #include "vector3.h"
 #include "vector4.h"
+#include "vector3_simd.h"
+#include "vector4_simd.h"
+#include "mat4x4_simd.h"
+#include "fastmath.h"
 #include <math.h>
+#include <stdint.h>
 
 namespace alfar
 {
     namespace mat4x4
     {
-        inline Matrix4x4 create(const Vector4& x, const Vector4& y, const Vector4& z, const Vector4& t)
+        ALFAR_CONSTEXPR Matrix4x4 create(const Vector4& x, const Vector4& y, const Vector4& z, const Vector4& t)
         {
-            Matrix4x4 mat;
+            Matrix4x4 mat = {};
             mat.x = x;
             mat.y = y;
             mat.z = z;
@@ -22,9 +27,9 @@ namespace alfar
 
         //----------------------------------------------------------------------------------------
 
-        inline Matrix4x4 mul(const Matrix4x4& a, const Matrix4x4& b)
+        ALFAR_CONSTEXPR Matrix4x4 mul(const Matrix4x4& a, const Matrix4x4& b)
         {
-            Matrix4x4 out;
+            Matrix4x4 out = {};
 
             out.x.x = a.x.x * b.x.x + a.x.y * b.y.x + a.x.z * b.z.x + a.x.w *b.t.x;
             out.x.y = a.x.x * b.x.y + a.x.y * b.y.y + a.x.z * b.z.y + a.x.w *b.t.y;
@@ -51,9 +56,9 @@ namespace alfar
 
         //---------------------------------------------------------------------------------------------
 
-        inline Matrix4x4 ortho(float right, float left, float top, float bottom, float zFar, float zNear)
+        ALFAR_CONSTEXPR Matrix4x4 ortho(float right, float left, float top, float bottom, float zFar, float zNear)
         {
-            Matrix4x4 mat;
+            Matrix4x4 mat = {};
 
             mat.x.x = 2.0f / (right - left);
             mat.x.y = 0;
@@ -82,9 +87,12 @@ namespace alfar
 
 		inline Matrix4x4 persp(const float fovY, const float aspect, const float zn, const float zf)
 		{
-			Matrix4x4 mat;
+			Matrix4x4 mat = {};
 
-			float yscale = cos(fovY/2.0f) / sin(fovY/2.0f);
+			float s = 0, c = 0;
+			fastmath::sincos(fovY/2.0f, s, c);
+
+			float yscale = c / s;
 			float xscale = yscale / aspect;
 
 
@@ -96,11 +104,23 @@ namespace alfar
 			return mat;
 		}
 
+		//same as persp with the compile time cos/sin of functions.h, for projections known at compile time
+		ALFAR_CONSTEXPR Matrix4x4 perspConst(const float fovY, const float aspect, const float zn, const float zf)
+		{
+			float yscale = constCos(fovY/2.0f) / constSin(fovY/2.0f);
+			float xscale = yscale / aspect;
+
+			return create(vector4::create(xscale, 0,0,0),
+						  vector4::create(0,yscale, 0,0),
+						  vector4::create(0,0, (-zn - zf)/(zn-zf), (2 * zf * zn)/(zn-zf)),
+						  vector4::create(0,0, 1, 0));
+		}
+
 		//----------------------------------------------------------------------------------------
 
 		inline Matrix4x4 lookAt(const Vector3& p_eyePos, const Vector3& p_target, const Vector3& p_up)
 		{
-			Matrix4x4 mat;
+			Matrix4x4 mat = {};
 			Vector3 zaxis = vector3::normalize(vector3::sub(p_target, p_eyePos));
 			Vector3 xaxis = vector3::normalize(vector3::cross(p_up, zaxis));
 			Vector3 yaxis = vector3::cross(zaxis, xaxis);
@@ -120,14 +140,14 @@ namespace alfar
 
         //----------------------------------------------------------------------------------------
 
-		inline Matrix4x4 identity()
+		ALFAR_CONSTEXPR Matrix4x4 identity()
 		{
 			return create(alfar::vector4::create(1,0,0,0), alfar::vector4::create(0,1,0,0), alfar::vector4::create(0,0,1,0), alfar::vector4::create(0,0,0,1));
 		}
 
 		//=========================================================================================
 
-		inline Matrix4x4 translation (alfar::Vector3 p_Translate)
+		ALFAR_CONSTEXPR Matrix4x4 translation (alfar::Vector3 p_Translate)
 		{
 			Matrix4x4 ret = identity();
 
@@ -140,7 +160,7 @@ namespace alfar
 
 		//===========================================================================
 
-		inline  Matrix4x4 setBase(alfar::Matrix4x4& m, alfar::Vector3 p_X, alfar::Vector3 p_Y, alfar::Vector3 p_Z)
+		ALFAR_CONSTEXPR Matrix4x4 setBase(alfar::Matrix4x4& m, alfar::Vector3 p_X, alfar::Vector3 p_Y, alfar::Vector3 p_Z)
 		{
 			alfar::Matrix4x4 ret = m;
 
@@ -158,5 +178,281 @@ namespace alfar
 
 			return ret;
 		}
+
+		//===========================================================================
+
+		ALFAR_CONSTEXPR float determinant(const Matrix4x4& m)
+		{
+			float s0 = m.x.x * m.y.y - m.y.x * m.x.y;
+			float s1 = m.x.x * m.y.z - m.y.x * m.x.z;
+			float s2 = m.x.x * m.y.w - m.y.x * m.x.w;
+			float s3 = m.x.y * m.y.z - m.y.y * m.x.z;
+			float s4 = m.x.y * m.y.w - m.y.y * m.x.w;
+			float s5 = m.x.z * m.y.w - m.y.z * m.x.w;
+
+			float c5 = m.z.z * m.t.w - m.t.z * m.z.w;
+			float c4 = m.z.y * m.t.w - m.t.y * m.z.w;
+			float c3 = m.z.y * m.t.z - m.t.y * m.z.z;
+			float c2 = m.z.x * m.t.w - m.t.x * m.z.w;
+			float c1 = m.z.x * m.t.z - m.t.x * m.z.z;
+			float c0 = m.z.x * m.t.y - m.t.x * m.z.y;
+
+			return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+		}
+
+		//---------------------------------------------------------------------------
+
+		//general inverse through the 2x2 minors of the top and bottom row pairs.
+		//a singular matrix gives inf/nan, check determinant first if that can happen.
+		ALFAR_CONSTEXPR Matrix4x4 inverse(const Matrix4x4& m)
+		{
+			float s0 = m.x.x * m.y.y - m.y.x * m.x.y;
+			float s1 = m.x.x * m.y.z - m.y.x * m.x.z;
+			float s2 = m.x.x * m.y.w - m.y.x * m.x.w;
+			float s3 = m.x.y * m.y.z - m.y.y * m.x.z;
+			float s4 = m.x.y * m.y.w - m.y.y * m.x.w;
+			float s5 = m.x.z * m.y.w - m.y.z * m.x.w;
+
+			float c5 = m.z.z * m.t.w - m.t.z * m.z.w;
+			float c4 = m.z.y * m.t.w - m.t.y * m.z.w;
+			float c3 = m.z.y * m.t.z - m.t.y * m.z.z;
+			float c2 = m.z.x * m.t.w - m.t.x * m.z.w;
+			float c1 = m.z.x * m.t.z - m.t.x * m.z.z;
+			float c0 = m.z.x * m.t.y - m.t.x * m.z.y;
+
+			float invDet = 1.0f / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+			Matrix4x4 ret = {};
+
+			ret.x.x = ( m.y.y * c5 - m.y.z * c4 + m.y.w * c3) * invDet;
+			ret.x.y = (-m.x.y * c5 + m.x.z * c4 - m.x.w * c3) * invDet;
+			ret.x.z = ( m.t.y * s5 - m.t.z * s4 + m.t.w * s3) * invDet;
+			ret.x.w = (-m.z.y * s5 + m.z.z * s4 - m.z.w * s3) * invDet;
+
+			ret.y.x = (-m.y.x * c5 + m.y.z * c2 - m.y.w * c1) * invDet;
+			ret.y.y = ( m.x.x * c5 - m.x.z * c2 + m.x.w * c1) * invDet;
+			ret.y.z = (-m.t.x * s5 + m.t.z * s2 - m.t.w * s1) * invDet;
+			ret.y.w = ( m.z.x * s5 - m.z.z * s2 + m.z.w * s1) * invDet;
+
+			ret.z.x = ( m.y.x * c4 - m.y.y * c2 + m.y.w * c0) * invDet;
+			ret.z.y = (-m.x.x * c4 + m.x.y * c2 - m.x.w * c0) * invDet;
+			ret.z.z = ( m.t.x * s4 - m.t.y * s2 + m.t.w * s0) * invDet;
+			ret.z.w = (-m.z.x * s4 + m.z.y * s2 - m.z.w * s0) * invDet;
+
+			ret.t.x = (-m.y.x * c3 + m.y.y * c1 - m.y.z * c0) * invDet;
+			ret.t.y = ( m.x.x * c3 - m.x.y * c1 + m.x.z * c0) * invDet;
+			ret.t.z = (-m.t.x * s3 + m.t.y * s1 - m.t.z * s0) * invDet;
+			ret.t.w = ( m.z.x * s3 - m.z.y * s1 + m.z.z * s0) * invDet;
+
+			return ret;
+		}
+
+		//---------------------------------------------------------------------------
+
+		//inverse of [R t; 0 1] for any invertible 3x3 R: [R^-1  -R^-1 t; 0 1]
+		ALFAR_CONSTEXPR Matrix4x4 affineInverse(const Matrix4x4& m)
+		{
+			Vector3 r0 = vector3::create(m.x.x, m.x.y, m.x.z);
+			Vector3 r1 = vector3::create(m.y.x, m.y.y, m.y.z);
+			Vector3 r2 = vector3::create(m.z.x, m.z.y, m.z.z);
+
+			//columns of R^-1
+			Vector3 c0 = vector3::cross(r1, r2);
+			Vector3 c1 = vector3::cross(r2, r0);
+			Vector3 c2 = vector3::cross(r0, r1);
+
+			float invDet = 1.0f / vector3::dot(r0, c0);
+			c0 = vector3::mul(c0, invDet);
+			c1 = vector3::mul(c1, invDet);
+			c2 = vector3::mul(c2, invDet);
+
+			Matrix4x4 ret = {};
+
+			ret.x = vector4::create(c0.x, c1.x, c2.x, -(c0.x * m.x.w + c1.x * m.y.w + c2.x * m.z.w));
+			ret.y = vector4::create(c0.y, c1.y, c2.y, -(c0.y * m.x.w + c1.y * m.y.w + c2.y * m.z.w));
+			ret.z = vector4::create(c0.z, c1.z, c2.z, -(c0.z * m.x.w + c1.z * m.y.w + c2.z * m.z.w));
+			ret.t = vector4::create(0, 0, 0, 1);
+
+			return ret;
+		}
+
+		//---------------------------------------------------------------------------
+
+		//inverse of [R t; 0 1] when R is orthonormal (rotation only, as built by lookAt): [R^T  -R^T t; 0 1]
+		ALFAR_CONSTEXPR Matrix4x4 rigidInverse(const Matrix4x4& m)
+		{
+			Matrix4x4 ret = {};
+
+			ret.x = vector4::create(m.x.x, m.y.x, m.z.x, -(m.x.x * m.x.w + m.y.x * m.y.w + m.z.x * m.z.w));
+			ret.y = vector4::create(m.x.y, m.y.y, m.z.y, -(m.x.y * m.x.w + m.y.y * m.y.w + m.z.y * m.z.w));
+			ret.z = vector4::create(m.x.z, m.y.z, m.z.z, -(m.x.z * m.x.w + m.y.z * m.y.w + m.z.z * m.z.w));
+			ret.t = vector4::create(0, 0, 0, 1);
+
+			return ret;
+		}
+
+		//===========================================================================
+
+		//true when the bottom row is (0,0,0,1), i.e. points need no divide by w
+		ALFAR_CONSTEXPR bool isAffine(const Matrix4x4& m)
+		{
+			return m.t.x == 0 && m.t.y == 0 && m.t.z == 0 && m.t.w == 1;
+		}
+
+		//----- array version
+		//p_Out may be p_In itself (the in-place overloads do that); partially
+		//overlapping ranges are not supported.
+
+		//points with w = 1, the bottom row is assumed to be (0,0,0,1)
+		inline void transformPoints(const Matrix4x4& m, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+		{
+			vector3::simd::transform<vector3::simd::TRANSFORM_POINT>(m, p_In, p_Out, p_Number);
+		}
+
+		inline void transformPoints(const Matrix4x4& m, Vector3* p_InOut, uint32_t p_Number)
+		{
+			transformPoints(m, p_InOut, p_InOut, p_Number);
+		}
+
+		//---------------------------------------------------------------------------
+
+		//directions with w = 0: only the upper 3x3 applies
+		inline void transformDirections(const Matrix4x4& m, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+		{
+			vector3::simd::transform<vector3::simd::TRANSFORM_DIRECTION>(m, p_In, p_Out, p_Number);
+		}
+
+		inline void transformDirections(const Matrix4x4& m, Vector3* p_InOut, uint32_t p_Number)
+		{
+			transformDirections(m, p_InOut, p_InOut, p_Number);
+		}
+
+		//---------------------------------------------------------------------------
+
+		//same result as vector3::mul(m, v) for each point: divides by w, unless m is affine
+		inline void transformPointsProjective(const Matrix4x4& m, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+		{
+			if(isAffine(m))
+				vector3::simd::transform<vector3::simd::TRANSFORM_POINT>(m, p_In, p_Out, p_Number);
+			else
+				vector3::simd::transform<vector3::simd::TRANSFORM_PROJECTIVE>(m, p_In, p_Out, p_Number);
+		}
+
+		inline void transformPointsProjective(const Matrix4x4& m, Vector3* p_InOut, uint32_t p_Number)
+		{
+			transformPointsProjective(m, p_InOut, p_InOut, p_Number);
+		}
+
+		//---------------------------------------------------------------------------
+
+		//vector4::mul(m, v) for each vector
+		inline void transform(const Matrix4x4& m, const Vector4* p_In, Vector4* p_Out, uint32_t p_Number)
+		{
+			vector4::simd::transform(m, p_In, p_Out, p_Number);
+		}
+
+		inline void transform(const Matrix4x4& m, Vector4* p_InOut, uint32_t p_Number)
+		{
+			transform(m, p_InOut, p_InOut, p_Number);
+		}
+
+		//---------------------------------------------------------------------------
+
+		//p_Out[i] = p_Firsts[i] * p_Seconds[i]; p_Out may be either input array.
+		inline void mul(const Matrix4x4* p_Firsts, const Matrix4x4* p_Seconds, Matrix4x4* p_Out, uint32_t p_Number)
+		{
+			switch(cpu::level())
+			{
+#if ALFAR_X86
+			case cpu::LEVEL_AVX512:	simd::mulAVX512(p_Firsts, p_Seconds, p_Out, p_Number); return;
+			case cpu::LEVEL_AVX2:	simd::mulAVX2(p_Firsts, p_Seconds, p_Out, p_Number); return;
+			case cpu::LEVEL_SSE2:	simd::mulSSE2(p_Firsts, p_Seconds, p_Out, p_Number); return;
+#endif
+			default:
+				for(uint32_t i = 0; i < p_Number; ++i)
+					p_Out[i] = mul(p_Firsts[i], p_Seconds[i]);
+				return;
+			}
+		}
+
+		//---------------------------------------------------------------------------
+
+		//batch versions of inverse, affineInverse, rigidInverse and determinant; p_Out may be p_In.
+		inline void inverse(const Matrix4x4* p_In, Matrix4x4* p_Out, uint32_t p_Number)
+		{
+#if ALFAR_X86
+			if(cpu::level() >= cpu::LEVEL_SSE2)
+			{
+				simd::inverseSSE2(p_In, p_Out, p_Number);
+				return;
+			}
+#endif
+			for(uint32_t i = 0; i < p_Number; ++i)
+				p_Out[i] = inverse(p_In[i]);
+		}
+
+		inline void affineInverse(const Matrix4x4* p_In, Matrix4x4* p_Out, uint32_t p_Number)
+		{
+#if ALFAR_X86
+			if(cpu::level() >= cpu::LEVEL_SSE2)
+			{
+				simd::affineInverseSSE2<false>(p_In, p_Out, p_Number);
+				return;
+			}
+#endif
+			for(uint32_t i = 0; i < p_Number; ++i)
+				p_Out[i] = affineInverse(p_In[i]);
+		}
+
+		inline void rigidInverse(const Matrix4x4* p_In, Matrix4x4* p_Out, uint32_t p_Number)
+		{
+#if ALFAR_X86
+			if(cpu::level() >= cpu::LEVEL_SSE2)
+			{
+				simd::affineInverseSSE2<true>(p_In, p_Out, p_Number);
+				return;
+			}
+#endif
+			for(uint32_t i = 0; i < p_Number; ++i)
+				p_Out[i] = rigidInverse(p_In[i]);
+		}
+
+		inline void determinant(const Matrix4x4* p_In, float* p_Out, uint32_t p_Number)
+		{
+#if ALFAR_X86
+			if(cpu::level() >= cpu::LEVEL_SSE2)
+			{
+				simd::determinantSSE2(p_In, p_Out, p_Number);
+				return;
+			}
+#endif
+			for(uint32_t i = 0; i < p_Number; ++i)
+				p_Out[i] = determinant(p_In[i]);
+		}
+
+		//===========================================================================
+
+		//hierarchy propagation: p_Out[i] = p_Out[p_Parents[i]] * p_Locals[i], or p_Locals[i] for a root (negative parent).
+		//parents must come before their children (p_Parents[i] < i). Only [p_Start, p_End) is written.
+		inline void propagate(const Matrix4x4* p_Locals, const int32_t* p_Parents, Matrix4x4* p_Out, uint32_t p_Start, uint32_t p_End)
+		{
+			switch(cpu::level())
+			{
+#if ALFAR_X86
+			case cpu::LEVEL_AVX512:	simd::propagateAVX512(p_Locals, p_Parents, p_Out, p_Start, p_End); return;
+			case cpu::LEVEL_AVX2:	simd::propagateAVX2(p_Locals, p_Parents, p_Out, p_Start, p_End); return;
+			case cpu::LEVEL_SSE2:	simd::propagateSSE2(p_Locals, p_Parents, p_Out, p_Start, p_End); return;
+#endif
+			default:
+				for(uint32_t i = p_Start; i < p_End; ++i)
+					p_Out[i] = p_Parents[i] < 0 ? p_Locals[i] : mul(p_Out[p_Parents[i]], p_Locals[i]);
+				return;
+			}
+		}
+
+		inline void propagate(const Matrix4x4* p_Locals, const int32_t* p_Parents, Matrix4x4* p_Out, uint32_t p_Number)
+		{
+			propagate(p_Locals, p_Parents, p_Out, 0, p_Number);
+		}
     }
-}
\ No newline at end of file
+}
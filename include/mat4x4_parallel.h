@@ -0,0 +1,205 @@
+#pragma once
+
+#include "mat4x4.h"
+#include "parallel.h"
+#include <stdint.h>
+
+// Hierarchy propagation over the pool of a Policy: propagateRanges plans the
+// waves of ranges, propagate runs the Matrix4x4 kernel over them.
+
+namespace alfar
+{
+	namespace mat4x4
+	{
+		//ranges of a hierarchy in waves: a range reads parents in itself or in the ranges of
+		//earlier waves only, so the ranges of one wave run in parallel
+		const uint32_t PROPAGATE_MIN_NODES = 256;		//smallest range planned
+		const uint32_t PROPAGATE_MAX_WAVES = 16;		//one pool job each
+
+		struct PropagateSchedule
+		{
+			uint32_t start[parallel::MAX_CHUNKS];
+			uint32_t end[parallel::MAX_CHUNKS];
+			uint32_t wave[parallel::MAX_CHUNKS];
+			uint32_t count;
+			uint32_t waves;
+			uint32_t target;		//nodes per range
+			uint32_t participants;
+			const int32_t* parents;
+		};
+
+		inline void addRange(PropagateSchedule& p_Schedule, uint32_t p_Start, uint32_t p_End, uint32_t p_Wave)
+		{
+			p_Schedule.start[p_Schedule.count] = p_Start;
+			p_Schedule.end[p_Schedule.count] = p_End;
+			p_Schedule.wave[p_Schedule.count] = p_Wave;
+			++p_Schedule.count;
+
+			p_Schedule.waves = p_Wave + 1 > p_Schedule.waves ? p_Wave + 1 : p_Schedule.waves;
+		}
+
+		//true when [p_Start, p_End) has a cut leaving target nodes on both sides, the
+		//parents before p_Start being computed
+		inline bool hasCut(const PropagateSchedule& p_Schedule, uint32_t p_Start, uint32_t p_End)
+		{
+			int32_t minParent = INT32_MAX;
+			for(uint32_t c = p_End - 1; c >= p_Start + p_Schedule.target; --c)
+			{
+				if(p_Schedule.parents[c] >= (int32_t)p_Start && p_Schedule.parents[c] < minParent)
+					minParent = p_Schedule.parents[c];
+
+				if(p_End - c >= p_Schedule.target && minParent >= (int32_t)c)
+					return true;
+			}
+
+			return false;
+		}
+
+		//end of the nodes from p_Start that read parents before p_Start only, one depth
+		//level in a layout sorted by depth
+		inline uint32_t levelEnd(const PropagateSchedule& p_Schedule, uint32_t p_Start, uint32_t p_End)
+		{
+			uint32_t end = p_Start + 1;
+			while(end < p_End && p_Schedule.parents[end] < (int32_t)p_Start)
+				++end;
+
+			return end;
+		}
+
+		inline void planPiece(PropagateSchedule& p_Schedule, uint32_t p_Start, uint32_t p_End, uint32_t p_Wave, uint32_t p_Reserve);
+
+		//cuts [p_Start, p_End) in wave p_Wave, the parents before p_Start being computed by
+		//earlier waves. Leaves p_Reserve ranges free for the callers.
+		inline void planRanges(PropagateSchedule& p_Schedule, uint32_t p_Start, uint32_t p_End, uint32_t p_Wave, uint32_t p_Reserve)
+		{
+			//walking down, c is a valid cut when no node at or after c reads a parent in [p_Start, c)
+			uint32_t end = p_End;
+			int32_t minParent = INT32_MAX;
+			for(uint32_t c = p_End - 1; c > p_Start; --c)
+			{
+				if(p_Schedule.parents[c] >= (int32_t)p_Start && p_Schedule.parents[c] < minParent)
+					minParent = p_Schedule.parents[c];
+
+				if(end - c >= p_Schedule.target && minParent >= (int32_t)c && p_Schedule.count + 2 + p_Reserve <= parallel::MAX_CHUNKS)
+				{
+					planPiece(p_Schedule, c, end, p_Wave, p_Reserve + 1);
+					end = c;
+				}
+			}
+
+			planPiece(p_Schedule, p_Start, end, p_Wave, p_Reserve);
+		}
+
+		//a piece too large for one range is a single tree, split in the first way that works:
+		//- depth first layouts: its first nodes (the head) run in p_Wave, and the subtrees
+		//  hanging from them are cut in the next wave
+		//- depth sorted layouts: the levels up to the first one larger than a range run on
+		//  one range, then that level in parallel, then the rest is planned after it
+		//anything else (a long chain) stays on one range.
+		inline void planPiece(PropagateSchedule& p_Schedule, uint32_t p_Start, uint32_t p_End, uint32_t p_Wave, uint32_t p_Reserve)
+		{
+			uint32_t target = p_Schedule.target;
+			if(p_End - p_Start <= 2 * target || p_Wave + 1 >= PROPAGATE_MAX_WAVES || p_Schedule.count + 2 + p_Reserve > parallel::MAX_CHUNKS)
+			{
+				addRange(p_Schedule, p_Start, p_End, p_Wave);
+				return;
+			}
+
+			for(uint32_t head = 1; head <= target; head *= 2)
+			{
+				if(hasCut(p_Schedule, p_Start + head, p_End))
+				{
+					addRange(p_Schedule, p_Start, p_Start + head, p_Wave);
+					planRanges(p_Schedule, p_Start + head, p_End, p_Wave + 1, p_Reserve);
+					return;
+				}
+			}
+
+			uint32_t level = p_Start;
+			uint32_t end = levelEnd(p_Schedule, level, p_End);
+			while(end < p_End && end - p_Start <= target)
+			{
+				level = end;
+				end = levelEnd(p_Schedule, level, p_End);
+			}
+
+			uint32_t heads = level > p_Start ? 1 : 0;
+			uint32_t rests = end < p_End ? 1 : 0;
+
+			//as many ranges as participants at least, a level being one wave
+			uint32_t size = end - level;
+			uint32_t ranges = size / target;
+			if(ranges < p_Schedule.participants)
+				ranges = size / PROPAGATE_MIN_NODES < p_Schedule.participants ? size / PROPAGATE_MIN_NODES : p_Schedule.participants;
+			if(ranges > parallel::MAX_CHUNKS - p_Schedule.count - p_Reserve - heads - rests)
+				ranges = parallel::MAX_CHUNKS - p_Schedule.count - p_Reserve - heads - rests;
+
+			if(ranges < 2 || p_Wave + heads + rests >= PROPAGATE_MAX_WAVES)
+			{
+				addRange(p_Schedule, p_Start, p_End, p_Wave);
+				return;
+			}
+
+			if(heads != 0)
+				addRange(p_Schedule, p_Start, level, p_Wave);
+
+			for(uint32_t r = 0; r < ranges; ++r)
+				addRange(p_Schedule, level + (uint32_t)((uint64_t)size * r / ranges), level + (uint32_t)((uint64_t)size * (r + 1) / ranges), p_Wave + heads);
+
+			if(rests != 0)
+				planRanges(p_Schedule, end, p_End, p_Wave + heads + 1, p_Reserve);
+		}
+
+		//runs p_Range(start, end) over ranges of the hierarchy on the pool of p_Policy. The
+		//array is cut at roots where no node crosses the cut to reach its parent (one
+		//skeleton per range), and a tree too large for one range is split further by
+		//planPiece, its ranges running in waves.
+		template<typename RANGE>
+		inline void propagateRanges(const parallel::Policy& p_Policy, RANGE p_Range, const int32_t* p_Parents, uint32_t p_Number)
+		{
+			if(p_Number < p_Policy.minElements || p_Number < 2 * PROPAGATE_MIN_NODES || parallel::insideJob())
+			{
+				p_Range(0, p_Number);
+				return;
+			}
+
+			uint32_t participants = parallel::threadCount(p_Policy);
+			participants = participants < parallel::MAX_PARTICIPANTS ? participants : parallel::MAX_PARTICIPANTS;
+
+			//a few ranges per participant, for the stealing to even out uneven hierarchies
+			PropagateSchedule schedule;
+			schedule.count = 0;
+			schedule.waves = 0;
+			schedule.target = p_Number / (participants * parallel::CHUNKS_PER_PARTICIPANT);
+			schedule.target = schedule.target < PROPAGATE_MIN_NODES ? PROPAGATE_MIN_NODES : schedule.target;
+			schedule.participants = participants;
+			schedule.parents = p_Parents;
+
+			planRanges(schedule, 0, p_Number, 0, 0);
+
+			uint32_t order[parallel::MAX_CHUNKS];
+			for(uint32_t w = 0; w < schedule.waves; ++w)
+			{
+				uint32_t count = 0;
+				for(uint32_t r = 0; r < schedule.count; ++r)
+				{
+					if(schedule.wave[r] == w)
+						order[count++] = r;
+				}
+
+				parallel::forEach(p_Policy, count, 1, [&](uint32_t p_Start, uint32_t p_End)
+				{
+					for(uint32_t k = p_Start; k < p_End; ++k)
+						p_Range(schedule.start[order[k]], schedule.end[order[k]]);
+				});
+			}
+		}
+
+		//same result as propagate, with the array split by propagateRanges
+		inline void propagate(const parallel::Policy& p_Policy, const Matrix4x4* p_Locals, const int32_t* p_Parents, Matrix4x4* p_Out, uint32_t p_Number)
+		{
+			propagateRanges(p_Policy, [=](uint32_t p_Start, uint32_t p_End) { propagate(p_Locals, p_Parents, p_Out, p_Start, p_End); },
+							p_Parents, p_Number);
+		}
+	}
+}
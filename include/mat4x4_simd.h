@@ -0,0 +1,335 @@
+#pragma once
+
+#include "math_types.h"
+#include "cpu.h"
+#include <stdint.h>
+
+// SIMD kernels behind the mat4x4 batch functions. Each row of the product is
+// the rows of b scaled by the broadcast elements of the matching row of a:
+// one row per SSE register, two per AVX register and the whole matrix in one
+// AVX-512 register. Everything is loaded before the store, so out may be a or b.
+// Inverses and determinants shuffle within one matrix and stay on SSE2.
+
+namespace alfar
+{
+	namespace mat4x4
+	{
+		namespace simd
+		{
+#if ALFAR_X86
+
+			ALFAR_TARGET_SSE2 inline void mulSSE2(const Matrix4x4& a, const Matrix4x4& b, Matrix4x4& out)
+			{
+				__m128 bx = _mm_loadu_ps(&b.x.x);
+				__m128 by = _mm_loadu_ps(&b.y.x);
+				__m128 bz = _mm_loadu_ps(&b.z.x);
+				__m128 bt = _mm_loadu_ps(&b.t.x);
+
+				__m128 rows[4] = { _mm_loadu_ps(&a.x.x), _mm_loadu_ps(&a.y.x), _mm_loadu_ps(&a.z.x), _mm_loadu_ps(&a.t.x) };
+
+				for(int r = 0; r < 4; ++r)
+				{
+					__m128 ar = rows[r];
+					__m128 res = _mm_mul_ps(bx, _mm_shuffle_ps(ar, ar, _MM_SHUFFLE(0, 0, 0, 0)));
+					res = _mm_add_ps(res, _mm_mul_ps(by, _mm_shuffle_ps(ar, ar, _MM_SHUFFLE(1, 1, 1, 1))));
+					res = _mm_add_ps(res, _mm_mul_ps(bz, _mm_shuffle_ps(ar, ar, _MM_SHUFFLE(2, 2, 2, 2))));
+					res = _mm_add_ps(res, _mm_mul_ps(bt, _mm_shuffle_ps(ar, ar, _MM_SHUFFLE(3, 3, 3, 3))));
+					rows[r] = res;
+				}
+
+				_mm_storeu_ps(&out.x.x, rows[0]);
+				_mm_storeu_ps(&out.y.x, rows[1]);
+				_mm_storeu_ps(&out.z.x, rows[2]);
+				_mm_storeu_ps(&out.t.x, rows[3]);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX2 inline void mulAVX2(const Matrix4x4& a, const Matrix4x4& b, Matrix4x4& out)
+			{
+				__m256 bx = _mm256_broadcast_ps((const __m128*)&b.x.x);
+				__m256 by = _mm256_broadcast_ps((const __m128*)&b.y.x);
+				__m256 bz = _mm256_broadcast_ps((const __m128*)&b.z.x);
+				__m256 bt = _mm256_broadcast_ps((const __m128*)&b.t.x);
+
+				__m256 a01 = _mm256_loadu_ps(&a.x.x);
+				__m256 a23 = _mm256_loadu_ps(&a.z.x);
+
+				__m256 r01 = _mm256_mul_ps(bx, _mm256_shuffle_ps(a01, a01, _MM_SHUFFLE(0, 0, 0, 0)));
+				r01 = _mm256_fmadd_ps(by, _mm256_shuffle_ps(a01, a01, _MM_SHUFFLE(1, 1, 1, 1)), r01);
+				r01 = _mm256_fmadd_ps(bz, _mm256_shuffle_ps(a01, a01, _MM_SHUFFLE(2, 2, 2, 2)), r01);
+				r01 = _mm256_fmadd_ps(bt, _mm256_shuffle_ps(a01, a01, _MM_SHUFFLE(3, 3, 3, 3)), r01);
+
+				__m256 r23 = _mm256_mul_ps(bx, _mm256_shuffle_ps(a23, a23, _MM_SHUFFLE(0, 0, 0, 0)));
+				r23 = _mm256_fmadd_ps(by, _mm256_shuffle_ps(a23, a23, _MM_SHUFFLE(1, 1, 1, 1)), r23);
+				r23 = _mm256_fmadd_ps(bz, _mm256_shuffle_ps(a23, a23, _MM_SHUFFLE(2, 2, 2, 2)), r23);
+				r23 = _mm256_fmadd_ps(bt, _mm256_shuffle_ps(a23, a23, _MM_SHUFFLE(3, 3, 3, 3)), r23);
+
+				_mm256_storeu_ps(&out.x.x, r01);
+				_mm256_storeu_ps(&out.z.x, r23);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX512 inline void mulAVX512(const Matrix4x4& a, const Matrix4x4& b, Matrix4x4& out)
+			{
+				__m512 bx = _mm512_broadcast_f32x4(_mm_loadu_ps(&b.x.x));
+				__m512 by = _mm512_broadcast_f32x4(_mm_loadu_ps(&b.y.x));
+				__m512 bz = _mm512_broadcast_f32x4(_mm_loadu_ps(&b.z.x));
+				__m512 bt = _mm512_broadcast_f32x4(_mm_loadu_ps(&b.t.x));
+
+				__m512 m = _mm512_loadu_ps(&a.x.x);
+
+				__m512 r = _mm512_mul_ps(bx, _mm512_permute_ps(m, _MM_SHUFFLE(0, 0, 0, 0)));
+				r = _mm512_fmadd_ps(by, _mm512_permute_ps(m, _MM_SHUFFLE(1, 1, 1, 1)), r);
+				r = _mm512_fmadd_ps(bz, _mm512_permute_ps(m, _MM_SHUFFLE(2, 2, 2, 2)), r);
+				r = _mm512_fmadd_ps(bt, _mm512_permute_ps(m, _MM_SHUFFLE(3, 3, 3, 3)), r);
+
+				_mm512_storeu_ps(&out.x.x, r);
+			}
+
+			//===================================================================== batches
+
+			ALFAR_TARGET_SSE2 inline void mulSSE2(const Matrix4x4* a, const Matrix4x4* b, Matrix4x4* out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+					mulSSE2(a[i], b[i], out[i]);
+			}
+
+			ALFAR_TARGET_AVX2 inline void mulAVX2(const Matrix4x4* a, const Matrix4x4* b, Matrix4x4* out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+					mulAVX2(a[i], b[i], out[i]);
+			}
+
+			ALFAR_TARGET_AVX512 inline void mulAVX512(const Matrix4x4* a, const Matrix4x4* b, Matrix4x4* out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+					mulAVX512(a[i], b[i], out[i]);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_SSE2 inline void propagateSSE2(const Matrix4x4* p_Locals, const int32_t* p_Parents, Matrix4x4* p_Out, uint32_t p_Start, uint32_t p_End)
+			{
+				for(uint32_t i = p_Start; i < p_End; ++i)
+				{
+					if(p_Parents[i] < 0)
+						p_Out[i] = p_Locals[i];
+					else
+						mulSSE2(p_Out[p_Parents[i]], p_Locals[i], p_Out[i]);
+				}
+			}
+
+			ALFAR_TARGET_AVX2 inline void propagateAVX2(const Matrix4x4* p_Locals, const int32_t* p_Parents, Matrix4x4* p_Out, uint32_t p_Start, uint32_t p_End)
+			{
+				for(uint32_t i = p_Start; i < p_End; ++i)
+				{
+					if(p_Parents[i] < 0)
+						p_Out[i] = p_Locals[i];
+					else
+						mulAVX2(p_Out[p_Parents[i]], p_Locals[i], p_Out[i]);
+				}
+			}
+
+			ALFAR_TARGET_AVX512 inline void propagateAVX512(const Matrix4x4* p_Locals, const int32_t* p_Parents, Matrix4x4* p_Out, uint32_t p_Start, uint32_t p_End)
+			{
+				for(uint32_t i = p_Start; i < p_End; ++i)
+				{
+					if(p_Parents[i] < 0)
+						p_Out[i] = p_Locals[i];
+					else
+						mulAVX512(p_Out[p_Parents[i]], p_Locals[i], p_Out[i]);
+				}
+			}
+
+			//===================================================================== inverse
+
+			//2x2 blocks are stored row major in one register: (a0 a1 a2 a3) = |a0 a1; a2 a3|
+
+			//a * b
+			ALFAR_TARGET_SSE2 inline __m128 mat2Mul(__m128 a, __m128 b)
+			{
+				return _mm_add_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+					_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+			}
+
+			//adjugate(a) * b
+			ALFAR_TARGET_SSE2 inline __m128 mat2AdjMul(__m128 a, __m128 b)
+			{
+				return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+					_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
+			}
+
+			//a * adjugate(b)
+			ALFAR_TARGET_SSE2 inline __m128 mat2MulAdj(__m128 a, __m128 b)
+			{
+				return _mm_sub_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+					_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+			}
+
+			ALFAR_TARGET_SSE2 inline __m128 horizontalSum(__m128 v)
+			{
+				v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+				return _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+			}
+
+			//---------------------------------------------------------------------
+
+			//block inverse of |A B; C D| with 2x2 blocks:
+			//det = |A||D| + |B||C| - tr((A#B)(D#C)), and each block of the adjugate is a 2x2 product.
+			ALFAR_TARGET_SSE2 inline void inverseSSE2(const Matrix4x4& m, Matrix4x4& out)
+			{
+				__m128 r0 = _mm_loadu_ps(&m.x.x);
+				__m128 r1 = _mm_loadu_ps(&m.y.x);
+				__m128 r2 = _mm_loadu_ps(&m.z.x);
+				__m128 r3 = _mm_loadu_ps(&m.t.x);
+
+				__m128 A = _mm_movelh_ps(r0, r1);
+				__m128 B = _mm_movehl_ps(r1, r0);
+				__m128 C = _mm_movelh_ps(r2, r3);
+				__m128 D = _mm_movehl_ps(r3, r2);
+
+				//(|A| |B| |C| |D|)
+				__m128 detSub = _mm_sub_ps(
+					_mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(3, 1, 3, 1))),
+					_mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(2, 0, 2, 0))));
+
+				__m128 detA = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(0, 0, 0, 0));
+				__m128 detB = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(1, 1, 1, 1));
+				__m128 detC = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(2, 2, 2, 2));
+				__m128 detD = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(3, 3, 3, 3));
+
+				__m128 DC = mat2AdjMul(D, C);
+				__m128 AB = mat2AdjMul(A, B);
+
+				__m128 X = _mm_sub_ps(_mm_mul_ps(detD, A), mat2Mul(B, DC));
+				__m128 W = _mm_sub_ps(_mm_mul_ps(detA, D), mat2Mul(C, AB));
+				__m128 Y = _mm_sub_ps(_mm_mul_ps(detB, C), mat2MulAdj(D, AB));
+				__m128 Z = _mm_sub_ps(_mm_mul_ps(detC, B), mat2MulAdj(A, DC));
+
+				__m128 det = _mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC));
+				det = _mm_sub_ps(det, horizontalSum(_mm_mul_ps(AB, _mm_shuffle_ps(DC, DC, _MM_SHUFFLE(3, 1, 2, 0)))));
+
+				__m128 invDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+
+				X = _mm_mul_ps(X, invDet);
+				Y = _mm_mul_ps(Y, invDet);
+				Z = _mm_mul_ps(Z, invDet);
+				W = _mm_mul_ps(W, invDet);
+
+				//the last shuffle both finishes the adjugates and puts the blocks back in rows
+				_mm_storeu_ps(&out.x.x, _mm_shuffle_ps(X, Y, _MM_SHUFFLE(1, 3, 1, 3)));
+				_mm_storeu_ps(&out.y.x, _mm_shuffle_ps(X, Y, _MM_SHUFFLE(0, 2, 0, 2)));
+				_mm_storeu_ps(&out.z.x, _mm_shuffle_ps(Z, W, _MM_SHUFFLE(1, 3, 1, 3)));
+				_mm_storeu_ps(&out.t.x, _mm_shuffle_ps(Z, W, _MM_SHUFFLE(0, 2, 0, 2)));
+			}
+
+			ALFAR_TARGET_SSE2 inline float determinantSSE2(const Matrix4x4& m)
+			{
+				__m128 r0 = _mm_loadu_ps(&m.x.x);
+				__m128 r1 = _mm_loadu_ps(&m.y.x);
+				__m128 r2 = _mm_loadu_ps(&m.z.x);
+				__m128 r3 = _mm_loadu_ps(&m.t.x);
+
+				__m128 A = _mm_movelh_ps(r0, r1);
+				__m128 B = _mm_movehl_ps(r1, r0);
+				__m128 C = _mm_movelh_ps(r2, r3);
+				__m128 D = _mm_movehl_ps(r3, r2);
+
+				__m128 detSub = _mm_sub_ps(
+					_mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(3, 1, 3, 1))),
+					_mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(2, 0, 2, 0))));
+
+				//|A||D| + |B||C|
+				__m128 products = _mm_mul_ps(detSub, _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(0, 1, 2, 3)));
+				__m128 det = _mm_add_ss(products, _mm_shuffle_ps(products, products, _MM_SHUFFLE(1, 1, 1, 1)));
+
+				__m128 DC = mat2AdjMul(D, C);
+				__m128 AB = mat2AdjMul(A, B);
+
+				det = _mm_sub_ss(det, horizontalSum(_mm_mul_ps(AB, _mm_shuffle_ps(DC, DC, _MM_SHUFFLE(3, 1, 2, 0)))));
+
+				return _mm_cvtss_f32(det);
+			}
+
+			//---------------------------------------------------------------------
+
+			//inverse of [R t; 0 1]: the columns of R^-1 are the cross products of the rows of R
+			//over det(R) (or the rows themselves when RIGID), then t' = -R^-1 t, and one
+			//transpose of (c0, c1, c2, -t') gives the result rows.
+			template<bool RIGID>
+			ALFAR_TARGET_SSE2 inline void affineInverseSSE2(const Matrix4x4& m, Matrix4x4& out)
+			{
+				const __m128 xyzMask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+
+				__m128 r0 = _mm_loadu_ps(&m.x.x);
+				__m128 r1 = _mm_loadu_ps(&m.y.x);
+				__m128 r2 = _mm_loadu_ps(&m.z.x);
+
+				__m128 tx = _mm_shuffle_ps(r0, r0, _MM_SHUFFLE(3, 3, 3, 3));
+				__m128 ty = _mm_shuffle_ps(r1, r1, _MM_SHUFFLE(3, 3, 3, 3));
+				__m128 tz = _mm_shuffle_ps(r2, r2, _MM_SHUFFLE(3, 3, 3, 3));
+
+				r0 = _mm_and_ps(r0, xyzMask);
+				r1 = _mm_and_ps(r1, xyzMask);
+				r2 = _mm_and_ps(r2, xyzMask);
+
+				__m128 c0 = r0, c1 = r1, c2 = r2;
+
+				if(!RIGID)
+				{
+					//a x b = a.yzx * b.zxy - a.zxy * b.yzx
+					__m128 r0yzx = _mm_shuffle_ps(r0, r0, _MM_SHUFFLE(3, 0, 2, 1));
+					__m128 r1yzx = _mm_shuffle_ps(r1, r1, _MM_SHUFFLE(3, 0, 2, 1));
+					__m128 r2yzx = _mm_shuffle_ps(r2, r2, _MM_SHUFFLE(3, 0, 2, 1));
+					__m128 r0zxy = _mm_shuffle_ps(r0, r0, _MM_SHUFFLE(3, 1, 0, 2));
+					__m128 r1zxy = _mm_shuffle_ps(r1, r1, _MM_SHUFFLE(3, 1, 0, 2));
+					__m128 r2zxy = _mm_shuffle_ps(r2, r2, _MM_SHUFFLE(3, 1, 0, 2));
+
+					c0 = _mm_sub_ps(_mm_mul_ps(r1yzx, r2zxy), _mm_mul_ps(r1zxy, r2yzx));
+					c1 = _mm_sub_ps(_mm_mul_ps(r2yzx, r0zxy), _mm_mul_ps(r2zxy, r0yzx));
+					c2 = _mm_sub_ps(_mm_mul_ps(r0yzx, r1zxy), _mm_mul_ps(r0zxy, r1yzx));
+
+					__m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), horizontalSum(_mm_mul_ps(r0, c0)));
+					c0 = _mm_mul_ps(c0, invDet);
+					c1 = _mm_mul_ps(c1, invDet);
+					c2 = _mm_mul_ps(c2, invDet);
+				}
+
+				__m128 t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, tx), _mm_mul_ps(c1, ty)), _mm_mul_ps(c2, tz));
+				__m128 c3 = _mm_sub_ps(_mm_setr_ps(0, 0, 0, 1.0f), t);
+
+				_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+				_mm_storeu_ps(&out.x.x, c0);
+				_mm_storeu_ps(&out.y.x, c1);
+				_mm_storeu_ps(&out.z.x, c2);
+				_mm_storeu_ps(&out.t.x, c3);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_SSE2 inline void inverseSSE2(const Matrix4x4* p_In, Matrix4x4* p_Out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+					inverseSSE2(p_In[i], p_Out[i]);
+			}
+
+			template<bool RIGID>
+			ALFAR_TARGET_SSE2 inline void affineInverseSSE2(const Matrix4x4* p_In, Matrix4x4* p_Out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+					affineInverseSSE2<RIGID>(p_In[i], p_Out[i]);
+			}
+
+			ALFAR_TARGET_SSE2 inline void determinantSSE2(const Matrix4x4* p_In, float* p_Out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+					p_Out[i] = determinantSSE2(p_In[i]);
+			}
+
+#endif
+		}
+	}
+}
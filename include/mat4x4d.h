@@ -0,0 +1,139 @@
+#pragma once
+
+#include "math_types.h"
+#include "functions.h"
+#include "vector3d.h"
+#include "vector3d_simd.h"
+#include <stdint.h>
+
+// Double precision matrices for world transforms and cameras, in the layout
+// of mat4x4.h (rows x, y, z, t, translation in the w column). Rendering gets
+// float matrices relative to an origin near the camera, see vector3d.h:
+//
+//	relative		world matrix M as T(-origin) M, the object seen from the origin
+//	relativeView	view matrix V as V T(origin), for points given relative to the origin
+//
+// so relativeView(V, o) * relative(M, o) is V * M up to float rounding, with
+// only small translations left in float. Both expect affine matrices (t row
+// (0, 0, 0, 1)), as built by translation and lookAt. The array version of
+// relative is the rebase kernel of vector3d_simd.h, bit identical to the
+// single one.
+
+namespace alfar
+{
+	namespace mat4x4d
+	{
+		inline Vector4d row(double x, double y, double z, double w)
+		{
+			Vector4d ret = { x, y, z, w };
+			return ret;
+		}
+
+		inline Matrix4x4d create(const Vector4d& x, const Vector4d& y, const Vector4d& z, const Vector4d& t)
+		{
+			Matrix4x4d ret = { x, y, z, t };
+			return ret;
+		}
+
+		inline Matrix4x4d identity()
+		{
+			return create(row(1, 0, 0, 0), row(0, 1, 0, 0), row(0, 0, 1, 0), row(0, 0, 0, 1));
+		}
+
+		inline Matrix4x4d translation(const Vector3d& p_Translate)
+		{
+			return create(row(1, 0, 0, p_Translate.x), row(0, 1, 0, p_Translate.y), row(0, 0, 1, p_Translate.z), row(0, 0, 0, 1));
+		}
+
+		//---------------------------------------------------------------------
+
+		inline Matrix4x4d fromFloat(const Matrix4x4& m)
+		{
+			return create(row(m.x.x, m.x.y, m.x.z, m.x.w), row(m.y.x, m.y.y, m.y.z, m.y.w),
+						  row(m.z.x, m.z.y, m.z.z, m.z.w), row(m.t.x, m.t.y, m.t.z, m.t.w));
+		}
+
+		inline Matrix4x4 toFloat(const Matrix4x4d& m)
+		{
+			Matrix4x4 ret = {};
+			const double* in = &m.x.x;
+			float* out = &ret.x.x;
+			for(int k = 0; k < 16; ++k)
+				out[k] = (float)in[k];
+
+			return ret;
+		}
+
+		//---------------------------------------------------------------------
+
+		inline Matrix4x4d mul(const Matrix4x4d& a, const Matrix4x4d& b)
+		{
+			Matrix4x4d ret = {};
+			const Vector4d* in = &a.x;
+			Vector4d* out = &ret.x;
+			for(int r = 0; r < 4; ++r)
+			{
+				out[r].x = in[r].x * b.x.x + in[r].y * b.y.x + in[r].z * b.z.x + in[r].w * b.t.x;
+				out[r].y = in[r].x * b.x.y + in[r].y * b.y.y + in[r].z * b.z.y + in[r].w * b.t.y;
+				out[r].z = in[r].x * b.x.z + in[r].y * b.y.z + in[r].z * b.z.z + in[r].w * b.t.z;
+				out[r].w = in[r].x * b.x.w + in[r].y * b.y.w + in[r].z * b.z.w + in[r].w * b.t.w;
+			}
+
+			return ret;
+		}
+
+		//transformed point, affine matrices only
+		inline Vector3d transformPoint(const Matrix4x4d& m, const Vector3d& p_Point)
+		{
+			return vector3d::create(m.x.x * p_Point.x + m.x.y * p_Point.y + m.x.z * p_Point.z + m.x.w,
+									m.y.x * p_Point.x + m.y.y * p_Point.y + m.y.z * p_Point.z + m.y.w,
+									m.z.x * p_Point.x + m.z.y * p_Point.y + m.z.z * p_Point.z + m.z.w);
+		}
+
+		//same as mat4x4::lookAt
+		inline Matrix4x4d lookAt(const Vector3d& p_EyePos, const Vector3d& p_Target, const Vector3d& p_Up)
+		{
+			Vector3d zaxis = vector3d::normalize(vector3d::sub(p_Target, p_EyePos));
+			Vector3d xaxis = vector3d::normalize(vector3d::cross(p_Up, zaxis));
+			Vector3d yaxis = vector3d::cross(zaxis, xaxis);
+
+			return create(row(xaxis.x, xaxis.y, xaxis.z, -vector3d::dot(xaxis, p_EyePos)),
+						  row(yaxis.x, yaxis.y, yaxis.z, -vector3d::dot(yaxis, p_EyePos)),
+						  row(zaxis.x, zaxis.y, zaxis.z, -vector3d::dot(zaxis, p_EyePos)),
+						  row(0, 0, 0, 1));
+		}
+
+		//===========================================================================
+
+		//float view V T(p_Origin): the w column becomes V applied to the origin, small when the origin is near the eye
+		inline Matrix4x4 relativeView(const Matrix4x4d& p_View, const Vector3d& p_Origin)
+		{
+			Matrix4x4d ret = p_View;
+			Vector3d w = transformPoint(p_View, p_Origin);
+			ret.x.w = w.x;
+			ret.y.w = w.y;
+			ret.z.w = w.z;
+
+			return toFloat(ret);
+		}
+
+		//float world matrix T(-p_Origin) M: the origin subtracted from the translation
+		inline Matrix4x4 relative(const Matrix4x4d& p_World, const Vector3d& p_Origin)
+		{
+			Matrix4x4d ret = p_World;
+			ret.x.w -= p_Origin.x;
+			ret.y.w -= p_Origin.y;
+			ret.z.w -= p_Origin.z;
+
+			return toFloat(ret);
+		}
+
+		//----- array version
+
+		inline void relative(const Matrix4x4d* p_Worlds, const Vector3d& p_Origin, Matrix4x4* p_Out, uint32_t p_Number)
+		{
+			const double origin[16] = { 0, 0, 0, p_Origin.x, 0, 0, 0, p_Origin.y, 0, 0, 0, p_Origin.z, 0, 0, 0, 0 };
+			vector3d::simd::relative(&p_Worlds->x.x, &p_Out->x.x, (size_t)p_Number * 16, origin, 16);
+		}
+	}
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "mat4x4d.h"
+#include "parallel.h"
+#include <stdint.h>
+
+// Camera relative rebasing of world matrices over the pool of a Policy.
+
+namespace alfar
+{
+	namespace mat4x4d
+	{
+		inline void relative(const parallel::Policy& p_Policy, const Matrix4x4d* p_Worlds, const Vector3d& p_Origin, Matrix4x4* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { relative(p_Worlds + p_Start, p_Origin, p_Out + p_Start, p_End - p_Start); });
+		}
+	}
+}
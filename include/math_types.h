@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stdint.h>
+
 namespace alfar
 {
     struct Vector2
@@ -32,11 +34,26 @@ namespace alfar
             Vector4 x, y, z, t;
     };
 
+    //Matrix4x4 without its bottom row, implicitly (0,0,0,1), see affine3x4.h
+    struct Affine3x4
+    {
+            Vector4 x, y, z;
+    };
+
     struct Rect
     {
             Vector2 min, max;
     };
 
+    //quad of a 2D sprite, see sprite.h
+    struct Sprite
+    {
+            Vector2 position;   //where the pivot lands
+            Vector2 size;
+            Vector2 pivot;      //in the quad, (0, 0) its first corner and (1, 1) the opposite one
+            Vector2 rotation;   //(cos, sin) of the counter-clockwise angle
+    };
+
     struct AABB
     {
             Vector3 min, max;
@@ -47,4 +64,117 @@ namespace alfar
             Matrix4x4 tm;
             AABB aabb;
     };
+
+    //points p with dot(normal, p) + d >= 0 are on the inside, see frustum.h
+    struct Plane
+    {
+            Vector3 normal;
+            float d;
+    };
+
+    //left, right, bottom, top, near, far
+    struct Frustum
+    {
+            Plane planes[6];
+    };
+
+    //flattened bounding volume hierarchy node, see bvh.h
+    struct BVHNode
+    {
+            AABB bounds;
+            uint32_t first;     //inner node: first child (the second is first + 1), leaf: first entry of BVH::indices
+            uint32_t count;     //primitives of a leaf, 0 for an inner node
+    };
+
+    struct BVH
+    {
+            BVHNode* nodes;     //root at 0
+            uint32_t* indices;  //primitive indices, grouped by leaf
+            uint32_t nodeCount, primitiveCount;
+    };
+
+    //structure of arrays: one aligned lane per component, see vector3_stream.h
+    struct Vector3Stream
+    {
+            float *x, *y, *z;
+            uint32_t count, capacity;
+    };
+
+    struct Vector4Stream
+    {
+            float *x, *y, *z, *w;
+            uint32_t count, capacity;
+    };
+
+    //depth and optional RGBA8 color buffers of the rasterizer, see raster.h
+    struct RasterTarget
+    {
+            uint32_t width, height;
+            uint32_t pitch;     //pixels per row, width padded to a multiple of 16
+            float* depth;       //0 at the near plane, 1 at the far one
+            uint32_t* color;    //r in the low byte, NULL for a depth only target
+    };
+
+    //triangle set up once for the rasterizer: integer edge functions and
+    //attribute planes at pixel centers, see raster.h
+    struct RasterTriangle
+    {
+            Vector4 depthA, depthB, depthC;     //planes of (depth, 1/w, 0, 0)
+            Vector4 colorA, colorB, colorC;     //planes of color/w
+            int64_t edgeC[3];                   //edge i is edgeA[i] x + edgeB[i] y + edgeC[i] at pixel (x, y), exact,
+            int32_t edgeA[3], edgeB[3];         //with the fill rule folded in: pixels where every edge is >= 0 are covered
+            int32_t minX, minY, maxX, maxY;     //covered pixels, inclusive, minX > maxX when there are none
+    };
+
+    //nearest hit of a ray query, see intersection.h
+    struct RayHit
+    {
+            float distance;     //-1 when nothing is hit
+            int32_t index;      //-1 when nothing is hit
+    };
+
+    //compressed storage formats, see quantize.h
+    struct Vector3Half
+    {
+            uint16_t x, y, z;   //IEEE binary16 bits
+    };
+
+    struct Vector4Half
+    {
+            uint16_t x, y, z, w;
+    };
+
+    //unit vector folded onto the octahedron |x| + |y| + |z| = 1, snorm16 coordinates
+    struct NormalOct
+    {
+            int16_t x, y;
+    };
+
+    //unit quaternion as its three smallest components, 48 bits
+    struct QuaternionPacked
+    {
+            uint16_t bits[3];   //15 bits components in the high bits, the index of the dropped one in the low bits of the first two
+    };
+
+    //position as unorm16 coordinates inside an AABB
+    struct Vector3Quantized
+    {
+            uint16_t x, y, z;
+    };
+
+    //double precision world space types, see vector3d.h and mat4x4d.h
+    struct Vector3d
+    {
+            double x, y, z;
+    };
+
+    struct Vector4d
+    {
+            double x, y, z, w;
+    };
+
+    struct Matrix4x4d
+    {
+            Vector4d x, y, z, t;
+    };
 }
\ No newline at end of file
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "math_types.h"
+#include "functions.h"
+#include "vector3.h"
+#include "mat4x4.h"
+#include "aabb.h"
+
+// Oriented boxes: OOBB::aabb in the local space of OOBB::tm. tm must be affine
+// with orthogonal axes (rotation, translation and any scale, no shear) for the
+// overlap tests, which run the separating axis test on the 3 axes of each box
+// and their 9 cross products. Flat boxes (a local size of 0 on an axis) are
+// valid and keep their normal as a test axis.
+
+namespace alfar
+{
+	namespace oobb
+	{
+		ALFAR_CONSTEXPR OOBB create(const Matrix4x4& p_Transform, const AABB& p_Local)
+		{
+			OOBB ret = {};
+			ret.tm = p_Transform;
+			ret.aabb = p_Local;
+
+			return ret;
+		}
+
+		//world center
+		ALFAR_CONSTEXPR Vector3 center(const OOBB& p_Box)
+		{
+			return vector4::toVec3(vector4::mul(p_Box.tm, vector4::create(aabb::center(p_Box.aabb), 1)));
+		}
+
+		//world half size vectors: the local axes of tm scaled by the local half size
+		ALFAR_CONSTEXPR Vector3 halfAxis(const OOBB& p_Box, int p_Axis)
+		{
+			Vector3 h = aabb::halfSize(p_Box.aabb);
+			const Matrix4x4& m = p_Box.tm;
+
+			return p_Axis == 0 ? vector3::create(m.x.x * h.x, m.y.x * h.x, m.z.x * h.x)
+				 : p_Axis == 1 ? vector3::create(m.x.y * h.y, m.y.y * h.y, m.z.y * h.y)
+				 : vector3::create(m.x.z * h.z, m.y.z * h.z, m.z.z * h.z);
+		}
+
+		//world bounds
+		ALFAR_CONSTEXPR AABB toAABB(const OOBB& p_Box)
+		{
+			return aabb::transform(p_Box.tm, p_Box.aabb);
+		}
+
+		ALFAR_CONSTEXPR bool contains(const OOBB& p_Box, const Vector3& p_Point)
+		{
+			Vector4 local = vector4::mul(mat4x4::affineInverse(p_Box.tm), vector4::create(p_Point, 1));
+
+			return aabb::contains(p_Box.aabb, vector4::toVec3(local));
+		}
+
+		//---------------------------------------------------------------------
+
+		//local axis p_Axis of tm in world space, scale included
+		ALFAR_CONSTEXPR Vector3 axis(const OOBB& p_Box, int p_Axis)
+		{
+			const Matrix4x4& m = p_Box.tm;
+
+			return p_Axis == 0 ? vector3::create(m.x.x, m.y.x, m.z.x)
+				 : p_Axis == 1 ? vector3::create(m.x.y, m.y.y, m.z.y)
+				 : vector3::create(m.x.z, m.y.z, m.z.z);
+		}
+
+		//separating axis test of the boxes p_Center +/- p_Half[i] p_Axes[i]. The axes carry
+		//the face normals and the half sizes are projected on their own, so a flat box
+		//(a quad or a decal, one half size 0) still tests its normal. The test along an
+		//axis does not depend on its length, the axes need no normalization.
+		ALFAR_CONSTEXPR bool overlapAxes(const Vector3& p_CenterA, const Vector3* p_AxesA, const Vector3& p_HalfA,
+										 const Vector3& p_CenterB, const Vector3* p_AxesB, const Vector3& p_HalfB)
+		{
+			Vector3 d = vector3::sub(p_CenterB, p_CenterA);
+			const float ha[3] = { p_HalfA.x, p_HalfA.y, p_HalfA.z };
+			const float hb[3] = { p_HalfB.x, p_HalfB.y, p_HalfB.z };
+
+			for(int k = 0; k < 15; ++k)
+			{
+				Vector3 l = k < 3 ? p_AxesA[k] : (k < 6 ? p_AxesB[k - 3] : vector3::cross(p_AxesA[(k - 6) / 3], p_AxesB[(k - 6) % 3]));
+
+				float ra = 0, rb = 0;
+				for(int i = 0; i < 3; ++i)
+				{
+					float pa = vector3::dot(l, p_AxesA[i]);
+					float pb = vector3::dot(l, p_AxesB[i]);
+					ra += ha[i] * (pa < 0 ? -pa : pa);
+					rb += hb[i] * (pb < 0 ? -pb : pb);
+				}
+
+				//parallel edges give a null axis, 0 > 0 keeps it from separating anything
+				float dist = vector3::dot(l, d);
+				if((dist < 0 ? -dist : dist) > ra + rb)
+					return false;
+			}
+
+			return true;
+		}
+
+		ALFAR_CONSTEXPR bool overlap(const OOBB& p_Box, const AABB& p_Other)
+		{
+			if(aabb::isEmpty(p_Box.aabb) || aabb::isEmpty(p_Other))
+				return false;
+
+			Vector3 axesA[3] = { axis(p_Box, 0), axis(p_Box, 1), axis(p_Box, 2) };
+			Vector3 axesB[3] = { vector3::create(1, 0, 0), vector3::create(0, 1, 0), vector3::create(0, 0, 1) };
+
+			return overlapAxes(center(p_Box), axesA, aabb::halfSize(p_Box.aabb), aabb::center(p_Other), axesB, aabb::halfSize(p_Other));
+		}
+
+		ALFAR_CONSTEXPR bool overlap(const OOBB& a, const OOBB& b)
+		{
+			if(aabb::isEmpty(a.aabb) || aabb::isEmpty(b.aabb))
+				return false;
+
+			Vector3 axesA[3] = { axis(a, 0), axis(a, 1), axis(a, 2) };
+			Vector3 axesB[3] = { axis(b, 0), axis(b, 1), axis(b, 2) };
+
+			return overlapAxes(center(a), axesA, aabb::halfSize(a.aabb), center(b), axesB, aabb::halfSize(b.aabb));
+		}
+	}
+}
@@ -0,0 +1,366 @@
+#pragma once
+
+#include "aligned.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+// Parallel for over the array functions. A ThreadPool keeps its threads
+// asleep between calls; forRange cuts [0, p_Number) in chunks of a multiple
+// of aligned::SIMD_WIDTH elements (whole cache lines for any array of floats
+// that starts on one, and no scalar tail in the SIMD kernels), gives every
+// participant a contiguous share of them and lets the participants that run
+// out steal half of what is left of another share. The calling thread is one
+// of the participants.
+//
+// A Policy picks the pool (the shared default one when NULL) and the element
+// count below which everything runs on the calling thread, where waking the
+// pool would cost more than the work. forEach does the same over heavier
+// items (tiles, objects) in chunks of a given size. Either called from inside
+// a pool job runs inline, and a pool runs one job at a time.
+//
+// The Policy overloads of the array functions live in <module>_parallel.h
+// (vector3_parallel.h, mat4x4_parallel.h...), so that including the math
+// headers pulls neither this one nor the Threads link (AlfarMath::parallel).
+
+namespace alfar
+{
+	namespace parallel
+	{
+		const uint32_t MIN_ELEMENTS = 32768;			//default threshold of a Policy
+		const uint32_t MIN_CHUNK = 1024;				//smallest chunk handed to a participant, in elements
+		const uint32_t CHUNKS_PER_PARTICIPANT = 8;		//more is better balanced, less is less atomics
+		const uint32_t MAX_PARTICIPANTS = 64;			//participants planned for by the fixed size schedules, larger pools share them
+		const uint32_t MAX_CHUNKS = MAX_PARTICIPANTS * CHUNKS_PER_PARTICIPANT;
+
+		struct Job
+		{
+			void (*run)(void* p_Context, uint32_t p_Start, uint32_t p_End);
+			void* context;
+			uint32_t number;
+			uint32_t chunk;				//elements per chunk
+			uint32_t participants;
+		};
+
+		//the chunks left to a participant, next in the high 32 bits and end in the low ones,
+		//alone on its cache line as every participant and thief hammers it
+		struct Share
+		{
+			std::atomic<uint64_t> range;
+			char padding[aligned::CACHE_LINE - sizeof(std::atomic<uint64_t>)];
+		};
+
+		struct ThreadPool
+		{
+			std::vector<std::thread> threads;	//the workers, participant 0 is the calling thread
+			Share* shares;						//threads.size() + 1
+
+			std::mutex mutex;
+			std::condition_variable wake;
+			std::condition_variable done;
+			uint64_t generation;				//bumped for every job
+			uint32_t pending;					//workers still in the current job
+			bool quit;
+			Job job;
+
+			std::mutex runMutex;				//one job at a time
+		};
+
+		//Policy p; is the default pool and threshold, as policy()
+		struct Policy
+		{
+			ThreadPool* pool;					//NULL for defaultPool()
+			uint32_t minElements;
+
+			explicit Policy(ThreadPool* p_Pool = NULL, uint32_t p_MinElements = MIN_ELEMENTS) : pool(p_Pool), minElements(p_MinElements) {}
+		};
+
+		inline Policy policy(ThreadPool* p_Pool = NULL, uint32_t p_MinElements = MIN_ELEMENTS)
+		{
+			return Policy(p_Pool, p_MinElements);
+		}
+
+		//---------------------------------------------------------------------
+
+		inline bool& insideJob()
+		{
+			static thread_local bool inside = false;
+			return inside;
+		}
+
+		inline uint64_t packRange(uint32_t p_Next, uint32_t p_End)
+		{
+			return ((uint64_t)p_Next << 32) | p_End;
+		}
+
+		//takes the next chunk of p_Share, false when it is empty
+		inline bool pop(Share& p_Share, uint32_t& p_Chunk)
+		{
+			uint64_t range = p_Share.range.load(std::memory_order_relaxed);
+			for(;;)
+			{
+				uint32_t next = (uint32_t)(range >> 32);
+				uint32_t end = (uint32_t)range;
+				if(next >= end)
+					return false;
+
+				if(p_Share.range.compare_exchange_weak(range, packRange(next + 1, end), std::memory_order_relaxed))
+				{
+					p_Chunk = next;
+					return true;
+				}
+			}
+		}
+
+		//moves the back half of another share into the (empty) share of p_Self,
+		//false when every share is empty
+		inline bool steal(ThreadPool& p_Pool, uint32_t p_Self, uint32_t p_Participants)
+		{
+			for(uint32_t k = 1; k < p_Participants; ++k)
+			{
+				Share& victim = p_Pool.shares[(p_Self + k) % p_Participants];
+
+				uint64_t range = victim.range.load(std::memory_order_relaxed);
+				for(;;)
+				{
+					uint32_t next = (uint32_t)(range >> 32);
+					uint32_t end = (uint32_t)range;
+					if(next >= end)
+						break;
+
+					uint32_t split = end - (end - next + 1) / 2;
+					if(victim.range.compare_exchange_weak(range, packRange(next, split), std::memory_order_relaxed))
+					{
+						//nobody else writes an empty share
+						p_Pool.shares[p_Self].range.store(packRange(split, end), std::memory_order_relaxed);
+						return true;
+					}
+				}
+			}
+
+			return false;
+		}
+
+		inline void work(ThreadPool& p_Pool, const Job& p_Job, uint32_t p_Self)
+		{
+			insideJob() = true;
+
+			uint32_t chunk;
+			for(;;)
+			{
+				if(!pop(p_Pool.shares[p_Self], chunk))
+				{
+					if(!steal(p_Pool, p_Self, p_Job.participants))
+						break;
+					continue;
+				}
+
+				uint32_t start = chunk * p_Job.chunk;
+				uint32_t end = p_Job.number - start < p_Job.chunk ? p_Job.number : start + p_Job.chunk;
+				p_Job.run(p_Job.context, start, end);
+			}
+
+			insideJob() = false;
+		}
+
+		inline void workerLoop(ThreadPool* p_Pool, uint32_t p_Self)
+		{
+			uint64_t seen = 0;
+
+			for(;;)
+			{
+				Job job;
+				{
+					std::unique_lock<std::mutex> lock(p_Pool->mutex);
+					while(!p_Pool->quit && p_Pool->generation == seen)
+						p_Pool->wake.wait(lock);
+
+					if(p_Pool->quit)
+						return;
+
+					seen = p_Pool->generation;
+					job = p_Pool->job;
+				}
+
+				if(p_Self < job.participants)
+					work(*p_Pool, job, p_Self);
+
+				std::lock_guard<std::mutex> lock(p_Pool->mutex);
+				if(--p_Pool->pending == 0)
+					p_Pool->done.notify_one();
+			}
+		}
+
+		//---------------------------------------------------------------------
+
+		//a pool of p_ThreadCount participants counting the calling thread, so
+		//p_ThreadCount - 1 workers (0 for one per hardware thread)
+		inline ThreadPool* create(uint32_t p_ThreadCount = 0)
+		{
+			if(p_ThreadCount == 0)
+				p_ThreadCount = std::thread::hardware_concurrency();
+			if(p_ThreadCount == 0)
+				p_ThreadCount = 1;
+
+			ThreadPool* pool = new ThreadPool();
+			pool->generation = 0;
+			pool->pending = 0;
+			pool->quit = false;
+			pool->job = Job();
+
+			pool->shares = (Share*)aligned::allocate(p_ThreadCount * sizeof(Share));
+			for(uint32_t t = 0; t < p_ThreadCount; ++t)
+				new(&pool->shares[t]) Share();
+
+			for(uint32_t t = 1; t < p_ThreadCount; ++t)
+				pool->threads.push_back(std::thread(workerLoop, pool, t));
+
+			return pool;
+		}
+
+		inline void destroy(ThreadPool* p_Pool)
+		{
+			{
+				std::lock_guard<std::mutex> lock(p_Pool->mutex);
+				p_Pool->quit = true;
+			}
+			p_Pool->wake.notify_all();
+
+			for(size_t t = 0; t < p_Pool->threads.size(); ++t)
+				p_Pool->threads[t].join();
+
+			for(size_t t = 0; t <= p_Pool->threads.size(); ++t)
+				p_Pool->shares[t].~Share();
+			aligned::release(p_Pool->shares);
+
+			delete p_Pool;
+		}
+
+		inline uint32_t threadCount(const ThreadPool& p_Pool)
+		{
+			return (uint32_t)p_Pool.threads.size() + 1;
+		}
+
+		//one participant per hardware thread, created on first use and destroyed at exit
+		inline ThreadPool& defaultPool()
+		{
+			struct Holder
+			{
+				ThreadPool* pool;
+				Holder() : pool(create()) {}
+				~Holder() { destroy(pool); }
+			};
+
+			static Holder holder;
+			return *holder.pool;
+		}
+
+		//participants of the pool of p_Policy
+		inline uint32_t threadCount(const Policy& p_Policy)
+		{
+			return threadCount(p_Policy.pool != NULL ? *p_Policy.pool : defaultPool());
+		}
+
+		//---------------------------------------------------------------------
+
+		template<typename RANGE>
+		inline void invokeRange(void* p_Context, uint32_t p_Start, uint32_t p_End)
+		{
+			(*(RANGE*)p_Context)(p_Start, p_End);
+		}
+
+		//runs p_Range over p_Number elements in chunks of p_Chunk on p_Participants participants of p_Pool
+		template<typename RANGE>
+		inline void run(ThreadPool& p_Pool, uint32_t p_Number, uint32_t p_Chunk, uint32_t p_Participants, RANGE& p_Range)
+		{
+			uint32_t chunks = (p_Number + p_Chunk - 1) / p_Chunk;
+
+			Job job;
+			job.run = invokeRange<RANGE>;
+			job.context = &p_Range;
+			job.number = p_Number;
+			job.chunk = p_Chunk;
+			job.participants = p_Participants;
+
+			std::lock_guard<std::mutex> run(p_Pool.runMutex);
+
+			for(uint32_t p = 0; p < p_Participants; ++p)
+				p_Pool.shares[p].range.store(packRange((uint32_t)((uint64_t)chunks * p / p_Participants), (uint32_t)((uint64_t)chunks * (p + 1) / p_Participants)), std::memory_order_relaxed);
+
+			{
+				std::lock_guard<std::mutex> lock(p_Pool.mutex);
+				p_Pool.job = job;
+				p_Pool.pending = (uint32_t)p_Pool.threads.size();
+				++p_Pool.generation;
+			}
+			p_Pool.wake.notify_all();
+
+			work(p_Pool, job, 0);
+
+			std::unique_lock<std::mutex> lock(p_Pool.mutex);
+			while(p_Pool.pending != 0)
+				p_Pool.done.wait(lock);
+		}
+
+		//p_Range(start, end) over disjoint ranges covering [0, p_Number), in parallel
+		//on the pool of p_Policy; returns once every range is done.
+		template<typename RANGE>
+		inline void forRange(const Policy& p_Policy, uint32_t p_Number, RANGE p_Range)
+		{
+			if(p_Number < p_Policy.minElements || p_Number <= MIN_CHUNK || insideJob())
+			{
+				p_Range(0, p_Number);
+				return;
+			}
+
+			ThreadPool& pool = p_Policy.pool != NULL ? *p_Policy.pool : defaultPool();
+
+			uint32_t participants = threadCount(pool);
+			if(participants > p_Number / MIN_CHUNK)
+				participants = p_Number / MIN_CHUNK;
+
+			if(participants <= 1)
+			{
+				p_Range(0, p_Number);
+				return;
+			}
+
+			uint32_t chunk = p_Number / (participants * CHUNKS_PER_PARTICIPANT);
+			chunk = chunk < MIN_CHUNK ? MIN_CHUNK : aligned::paddedCount(chunk);
+
+			run(pool, p_Number, chunk, participants, p_Range);
+		}
+
+		//same for items far heavier than array elements (tiles, objects...): chunks
+		//of p_Grain items, in parallel as soon as there are two of them whatever
+		//the minElements of p_Policy.
+		template<typename RANGE>
+		inline void forEach(const Policy& p_Policy, uint32_t p_Number, uint32_t p_Grain, RANGE p_Range)
+		{
+			uint32_t chunks = p_Grain == 0 ? 0 : (p_Number + p_Grain - 1) / p_Grain;
+			if(chunks <= 1 || insideJob())
+			{
+				p_Range(0, p_Number);
+				return;
+			}
+
+			ThreadPool& pool = p_Policy.pool != NULL ? *p_Policy.pool : defaultPool();
+
+			uint32_t participants = threadCount(pool);
+			participants = participants < chunks ? participants : chunks;
+
+			if(participants <= 1)
+			{
+				p_Range(0, p_Number);
+				return;
+			}
+
+			run(pool, p_Number, p_Grain, participants, p_Range);
+		}
+	}
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "math_types.h"
+#include "quantize_simd.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Compressed storage formats for vertex streams, animation and network
+// snapshots, single values or whole arrays (quantize_simd.h):
+//
+//	Vector3Half/Vector4Half	6/8 bytes	IEEE binary16 per component
+//	NormalOct				4 bytes		unit vector on the octahedron, snorm16 x y
+//	QuaternionPacked		6 bytes		smallest three, 15 bits per component
+//	Vector3Quantized		6 bytes		unorm16 per axis of an AABB
+//
+// Max errors of an encode/decode round trip, on every dispatch level (checked
+// by test/quantize_test.cpp):
+//
+//	half		2^-11 relative (4.9e-4) for |x| in [6.1e-5, 65504], 2^-25 abs below,
+//				65520 and up give infinity, NaN stays NaN
+//	normal		6.5e-5 rad (0.0037 degree) between the input and the unit result
+//	rotation	6.1e-5 per component, 1.5e-4 rad of rotation, for unit quaternions
+//	position	extent / 131070 per axis plus a few float ulps; outside the AABB clamps to it
+//
+// Encoding rounds to nearest and stores the same bits on every level (NaN
+// payloads of halves aside), decoding may differ in the last bit between
+// levels (FMA in AVX2 and AVX-512). A zero normal encodes as +z, a
+// rotation is stored with its largest component positive (q and -q are the
+// same rotation), and an AABB with a flat axis stores 0 and decodes min on it.
+
+namespace alfar
+{
+	namespace quantize
+	{
+		inline uint16_t toHalf(float p_Value)
+		{
+			return simd::toHalfScalar(p_Value);
+		}
+
+		inline float fromHalf(uint16_t p_Half)
+		{
+			return simd::fromHalfScalar(p_Half);
+		}
+
+		inline Vector3Half toHalf(const Vector3& p_Vec)
+		{
+			Vector3Half ret = { toHalf(p_Vec.x), toHalf(p_Vec.y), toHalf(p_Vec.z) };
+			return ret;
+		}
+
+		inline Vector4Half toHalf(const Vector4& p_Vec)
+		{
+			Vector4Half ret = { toHalf(p_Vec.x), toHalf(p_Vec.y), toHalf(p_Vec.z), toHalf(p_Vec.w) };
+			return ret;
+		}
+
+		inline Vector3 fromHalf(const Vector3Half& p_Vec)
+		{
+			Vector3 ret = { fromHalf(p_Vec.x), fromHalf(p_Vec.y), fromHalf(p_Vec.z) };
+			return ret;
+		}
+
+		inline Vector4 fromHalf(const Vector4Half& p_Vec)
+		{
+			Vector4 ret = { fromHalf(p_Vec.x), fromHalf(p_Vec.y), fromHalf(p_Vec.z), fromHalf(p_Vec.w) };
+			return ret;
+		}
+
+		//---------------------------------------------------------------------
+
+		//p_Normal does not need to be normalized, only its direction is kept
+		inline NormalOct encodeNormal(const Vector3& p_Normal)
+		{
+			return simd::encodeNormalScalar(p_Normal);
+		}
+
+		inline Vector3 decodeNormal(const NormalOct& p_Normal)
+		{
+			return simd::decodeNormalScalar(p_Normal);
+		}
+
+		inline QuaternionPacked encodeRotation(const Quaternion& p_Rotation)
+		{
+			return simd::encodeRotationScalar(p_Rotation);
+		}
+
+		inline Quaternion decodeRotation(const QuaternionPacked& p_Rotation)
+		{
+			return simd::decodeRotationScalar(p_Rotation);
+		}
+
+		//---------------------------------------------------------------------
+
+		//per axis multiplier from the AABB to [0, 65535], 0 on a flat axis
+		inline Vector3 positionScale(const AABB& p_Bounds)
+		{
+			const float* min = &p_Bounds.min.x;
+			const float* max = &p_Bounds.max.x;
+
+			Vector3 ret = {};
+			float* out = &ret.x;
+			for(int k = 0; k < 3; ++k)
+				out[k] = max[k] > min[k] ? 65535.0f / (max[k] - min[k]) : 0.0f;
+
+			return ret;
+		}
+
+		//per axis size of a unorm16 step
+		inline Vector3 positionStep(const AABB& p_Bounds)
+		{
+			Vector3 ret = {};
+			ret.x = (p_Bounds.max.x - p_Bounds.min.x) / 65535.0f;
+			ret.y = (p_Bounds.max.y - p_Bounds.min.y) / 65535.0f;
+			ret.z = (p_Bounds.max.z - p_Bounds.min.z) / 65535.0f;
+
+			return ret;
+		}
+
+		inline Vector3Quantized encodePosition(const Vector3& p_Position, const AABB& p_Bounds)
+		{
+			Vector3 scale = positionScale(p_Bounds);
+
+			Vector3Quantized ret = {};
+			ret.x = simd::encodePositionScalar(p_Position.x, p_Bounds.min.x, scale.x);
+			ret.y = simd::encodePositionScalar(p_Position.y, p_Bounds.min.y, scale.y);
+			ret.z = simd::encodePositionScalar(p_Position.z, p_Bounds.min.z, scale.z);
+
+			return ret;
+		}
+
+		inline Vector3 decodePosition(const Vector3Quantized& p_Position, const AABB& p_Bounds)
+		{
+			Vector3 step = positionStep(p_Bounds);
+
+			Vector3 ret = {};
+			ret.x = simd::decodePositionScalar(p_Position.x, p_Bounds.min.x, step.x);
+			ret.y = simd::decodePositionScalar(p_Position.y, p_Bounds.min.y, step.y);
+			ret.z = simd::decodePositionScalar(p_Position.z, p_Bounds.min.z, step.z);
+
+			return ret;
+		}
+
+		//----- array version
+
+		inline void toHalf(const float* p_In, uint16_t* p_Out, size_t p_Count)
+		{
+			simd::toHalf(p_In, p_Out, p_Count);
+		}
+
+		inline void fromHalf(const uint16_t* p_In, float* p_Out, size_t p_Count)
+		{
+			simd::fromHalf(p_In, p_Out, p_Count);
+		}
+
+		inline void toHalf(const Vector3* p_In, Vector3Half* p_Out, uint32_t p_Number)
+		{
+			simd::toHalf((const float*)p_In, (uint16_t*)p_Out, (size_t)p_Number * 3);
+		}
+
+		inline void toHalf(const Vector4* p_In, Vector4Half* p_Out, uint32_t p_Number)
+		{
+			simd::toHalf((const float*)p_In, (uint16_t*)p_Out, (size_t)p_Number * 4);
+		}
+
+		inline void fromHalf(const Vector3Half* p_In, Vector3* p_Out, uint32_t p_Number)
+		{
+			simd::fromHalf((const uint16_t*)p_In, (float*)p_Out, (size_t)p_Number * 3);
+		}
+
+		inline void fromHalf(const Vector4Half* p_In, Vector4* p_Out, uint32_t p_Number)
+		{
+			simd::fromHalf((const uint16_t*)p_In, (float*)p_Out, (size_t)p_Number * 4);
+		}
+
+		inline void encodeNormal(const Vector3* p_In, NormalOct* p_Out, uint32_t p_Number)
+		{
+			simd::encodeNormal(p_In, p_Out, p_Number);
+		}
+
+		inline void decodeNormal(const NormalOct* p_In, Vector3* p_Out, uint32_t p_Number)
+		{
+			simd::decodeNormal(p_In, p_Out, p_Number);
+		}
+
+		inline void encodeRotation(const Quaternion* p_In, QuaternionPacked* p_Out, uint32_t p_Number)
+		{
+			simd::encodeRotation(p_In, p_Out, p_Number);
+		}
+
+		inline void decodeRotation(const QuaternionPacked* p_In, Quaternion* p_Out, uint32_t p_Number)
+		{
+			simd::decodeRotation(p_In, p_Out, p_Number);
+		}
+
+		inline void encodePosition(const Vector3* p_In, Vector3Quantized* p_Out, uint32_t p_Number, const AABB& p_Bounds)
+		{
+			Vector3 scale = positionScale(p_Bounds);
+			simd::encodePosition((const float*)p_In, (uint16_t*)p_Out, (size_t)p_Number * 3, &p_Bounds.min.x, &scale.x);
+		}
+
+		inline void decodePosition(const Vector3Quantized* p_In, Vector3* p_Out, uint32_t p_Number, const AABB& p_Bounds)
+		{
+			Vector3 step = positionStep(p_Bounds);
+			simd::decodePosition((const uint16_t*)p_In, (float*)p_Out, (size_t)p_Number * 3, &p_Bounds.min.x, &step.x);
+		}
+	}
+}
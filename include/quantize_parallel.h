@@ -0,0 +1,63 @@
+#pragma once
+
+#include "quantize.h"
+#include "parallel.h"
+#include <stdint.h>
+
+// The Policy overloads of the quantize array functions.
+
+namespace alfar
+{
+	namespace quantize
+	{
+		inline void toHalf(const parallel::Policy& p_Policy, const Vector3* p_In, Vector3Half* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { toHalf(p_In + p_Start, p_Out + p_Start, p_End - p_Start); });
+		}
+
+		inline void toHalf(const parallel::Policy& p_Policy, const Vector4* p_In, Vector4Half* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { toHalf(p_In + p_Start, p_Out + p_Start, p_End - p_Start); });
+		}
+
+		inline void fromHalf(const parallel::Policy& p_Policy, const Vector3Half* p_In, Vector3* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { fromHalf(p_In + p_Start, p_Out + p_Start, p_End - p_Start); });
+		}
+
+		inline void fromHalf(const parallel::Policy& p_Policy, const Vector4Half* p_In, Vector4* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { fromHalf(p_In + p_Start, p_Out + p_Start, p_End - p_Start); });
+		}
+
+		inline void encodeNormal(const parallel::Policy& p_Policy, const Vector3* p_In, NormalOct* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { encodeNormal(p_In + p_Start, p_Out + p_Start, p_End - p_Start); });
+		}
+
+		inline void decodeNormal(const parallel::Policy& p_Policy, const NormalOct* p_In, Vector3* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { decodeNormal(p_In + p_Start, p_Out + p_Start, p_End - p_Start); });
+		}
+
+		inline void encodeRotation(const parallel::Policy& p_Policy, const Quaternion* p_In, QuaternionPacked* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { encodeRotation(p_In + p_Start, p_Out + p_Start, p_End - p_Start); });
+		}
+
+		inline void decodeRotation(const parallel::Policy& p_Policy, const QuaternionPacked* p_In, Quaternion* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { decodeRotation(p_In + p_Start, p_Out + p_Start, p_End - p_Start); });
+		}
+
+		inline void encodePosition(const parallel::Policy& p_Policy, const Vector3* p_In, Vector3Quantized* p_Out, uint32_t p_Number, const AABB& p_Bounds)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { encodePosition(p_In + p_Start, p_Out + p_Start, p_End - p_Start, p_Bounds); });
+		}
+
+		inline void decodePosition(const parallel::Policy& p_Policy, const Vector3Quantized* p_In, Vector3* p_Out, uint32_t p_Number, const AABB& p_Bounds)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { decodePosition(p_In + p_Start, p_Out + p_Start, p_End - p_Start, p_Bounds); });
+		}
+	}
+}
@@ -0,0 +1,1331 @@
+#pragma once
+
+#include "math_types.h"
+#include "cpu.h"
+#include "fastmath_simd.h"
+#include "vector3_simd.h"
+#include "quaternion_simd.h"
+#include <float.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// SIMD kernels behind the quantize array functions. Half floats are converted
+// on the flat float stream, by F16C (vcvtps2ph/vcvtph2ps, part of the AVX2
+// level) or, in SSE2 and scalar code, by integer arithmetic on the float bits
+// that rounds to nearest even the same way. Normals and rotations go through
+// x/y/z(/w) lanes (the vector3 and quaternion loads) and their 32 bits results
+// are narrowed to 16 bits with packs in SSE2/AVX2 and the narrowing converts in
+// AVX-512, permutes putting them in array order. Positions are a per axis
+// offset and scale of the flat float stream, register j of a block of 3
+// repeating the axis pattern from axis (j * lanes) % 3.
+//
+// Encoding has no multiply-add and no approximate reciprocal, so every level
+// stores the same bits (NaN payloads of halves aside); decoding uses FMA in
+// the AVX2 and AVX-512 kernels, whose results may then differ from SSE2 in
+// the last bit. Every kernel finishes the remaining elements with the level
+// below.
+
+namespace alfar
+{
+	namespace quantize
+	{
+		namespace simd
+		{
+			static_assert(sizeof(Vector3Half) == 3 * sizeof(uint16_t), "Vector3Half must be 3 packed halves");
+			static_assert(sizeof(Vector4Half) == 4 * sizeof(uint16_t), "Vector4Half must be 4 packed halves");
+			static_assert(sizeof(NormalOct) == 2 * sizeof(int16_t), "NormalOct must be 2 packed int16");
+			static_assert(sizeof(QuaternionPacked) == 3 * sizeof(uint16_t), "QuaternionPacked must be 48 bits");
+			static_assert(sizeof(Vector3Quantized) == 3 * sizeof(uint16_t), "Vector3Quantized must be 3 packed uint16");
+
+			const float NORMAL_SCALE = 32767.0f;
+			const float NORMAL_STEP = 1.0f / 32767.0f;
+
+			//rotation components in [-1/sqrt(2), 1/sqrt(2)] map to [-16383, 16383], stored + 16384
+			const float ROTATION_SCALE = 16383.0f * 1.41421356f;
+			const float ROTATION_STEP = 1.0f / (16383.0f * 1.41421356f);
+
+			//----- scalar tails
+
+			//round to nearest even, 65520 and up give infinity, NaN gives the quiet NaN 0x7e00
+			inline uint16_t toHalfScalar(float p_Value)
+			{
+				uint32_t bits = fastmath::simd::toBits(p_Value);
+				uint32_t sign = bits & 0x80000000u;
+				uint32_t a = bits ^ sign;
+
+				uint32_t h;
+				if(a >= 0x47800000u)
+					h = a > 0x7f800000u ? 0x7e00u : 0x7c00u;
+				else if(a < 0x38800000u)
+					h = fastmath::simd::toBits(fastmath::simd::fromBits(a) + 0.5f) - 0x3f000000u;	//subnormal half: the add rounds the mantissa in place
+				else
+					h = (a + 0xc8000fffu + ((a >> 13) & 1)) >> 13;									//rebias the exponent, round to nearest even
+
+				return (uint16_t)(h | (sign >> 16));
+			}
+
+			inline float fromHalfScalar(uint16_t p_Half)
+			{
+				uint32_t o = (uint32_t)(p_Half & 0x7fff) << 13;
+				uint32_t exponent = o & 0x0f800000u;
+				o += 0x38000000u;
+
+				if(exponent == 0x0f800000u)
+					o += 0x38000000u;
+				else if(exponent == 0)
+					o = fastmath::simd::toBits(fastmath::simd::fromBits(o + 0x00800000u) - fastmath::simd::fromBits(0x38800000u));
+
+				return fastmath::simd::fromBits(o | (uint32_t)(p_Half & 0x8000) << 16);
+			}
+
+			inline void toHalfScalar(const float* p_In, uint16_t* p_Out, size_t p_Count)
+			{
+				for(size_t i = 0; i < p_Count; ++i)
+					p_Out[i] = toHalfScalar(p_In[i]);
+			}
+
+			inline void fromHalfScalar(const uint16_t* p_In, float* p_Out, size_t p_Count)
+			{
+				for(size_t i = 0; i < p_Count; ++i)
+					p_Out[i] = fromHalfScalar(p_In[i]);
+			}
+
+			//---------------------------------------------------------------------
+
+			inline NormalOct encodeNormalScalar(const Vector3& p_Normal)
+			{
+				float l1 = (fabsf(p_Normal.x) + fabsf(p_Normal.y)) + fabsf(p_Normal.z);
+				l1 = l1 > FLT_MIN ? l1 : FLT_MIN;
+
+				float x = p_Normal.x / l1, y = p_Normal.y / l1;
+				if(p_Normal.z < 0)
+				{
+					float fx = (1.0f - fabsf(y)) * (x < 0 ? -1.0f : 1.0f);
+					float fy = (1.0f - fabsf(x)) * (y < 0 ? -1.0f : 1.0f);
+					x = fx;
+					y = fy;
+				}
+
+				NormalOct ret = {};
+				ret.x = (int16_t)lrintf(x * NORMAL_SCALE);
+				ret.y = (int16_t)lrintf(y * NORMAL_SCALE);
+
+				return ret;
+			}
+
+			inline Vector3 decodeNormalScalar(const NormalOct& p_Normal)
+			{
+				float x = p_Normal.x * NORMAL_STEP, y = p_Normal.y * NORMAL_STEP;
+				float z = (1.0f - fabsf(x)) - fabsf(y);
+
+				float t = z < 0 ? -z : 0.0f;
+				x = x < 0 ? x + t : x - t;
+				y = y < 0 ? y + t : y - t;
+
+				float length = sqrtf((x * x + y * y) + z * z);
+
+				Vector3 ret = {};
+				ret.x = x / length;
+				ret.y = y / length;
+				ret.z = z / length;
+
+				return ret;
+			}
+
+			inline void encodeNormalScalar(const Vector3* p_In, NormalOct* p_Out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+					p_Out[i] = encodeNormalScalar(p_In[i]);
+			}
+
+			inline void decodeNormalScalar(const NormalOct* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+					p_Out[i] = decodeNormalScalar(p_In[i]);
+			}
+
+			//---------------------------------------------------------------------
+
+			inline uint32_t rotationComponentScalar(float p_Value)
+			{
+				float v = p_Value * ROTATION_SCALE;
+				v = v > -16383.0f ? v : -16383.0f;
+				v = v < 16383.0f ? v : 16383.0f;
+
+				return (uint32_t)(lrintf(v) + 16384);
+			}
+
+			inline QuaternionPacked encodeRotationScalar(const Quaternion& p_Rotation)
+			{
+				const float* q = &p_Rotation.x;
+
+				uint32_t index = 0;
+				float largest = fabsf(q[0]);
+				for(uint32_t k = 1; k < 4; ++k)
+				{
+					if(fabsf(q[k]) > largest)
+					{
+						index = k;
+						largest = fabsf(q[k]);
+					}
+				}
+
+				//q and -q are the same rotation, the dropped component is kept positive
+				float sign = q[index] < 0 ? -1.0f : 1.0f;
+				float a = (index == 0 ? q[1] : q[0]) * sign;
+				float b = (index <= 1 ? q[2] : q[1]) * sign;
+				float c = (index <= 2 ? q[3] : q[2]) * sign;
+
+				QuaternionPacked ret = {};
+				ret.bits[0] = (uint16_t)(rotationComponentScalar(a) << 1 | (index & 1));
+				ret.bits[1] = (uint16_t)(rotationComponentScalar(b) << 1 | (index >> 1));
+				ret.bits[2] = (uint16_t)(rotationComponentScalar(c) << 1);
+
+				return ret;
+			}
+
+			inline Quaternion decodeRotationScalar(const QuaternionPacked& p_Rotation)
+			{
+				uint32_t index = (p_Rotation.bits[0] & 1) | (p_Rotation.bits[1] & 1) << 1;
+				float a = ((int32_t)(p_Rotation.bits[0] >> 1) - 16384) * ROTATION_STEP;
+				float b = ((int32_t)(p_Rotation.bits[1] >> 1) - 16384) * ROTATION_STEP;
+				float c = ((int32_t)(p_Rotation.bits[2] >> 1) - 16384) * ROTATION_STEP;
+
+				float r = 1.0f - ((a * a + b * b) + c * c);
+				float d = sqrtf(r > 0 ? r : 0.0f);
+
+				Quaternion ret = {};
+				ret.x = index == 0 ? d : a;
+				ret.y = index == 0 ? a : (index == 1 ? d : b);
+				ret.z = index <= 1 ? b : (index == 2 ? d : c);
+				ret.w = index == 3 ? d : c;
+
+				return ret;
+			}
+
+			inline void encodeRotationScalar(const Quaternion* p_In, QuaternionPacked* p_Out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+					p_Out[i] = encodeRotationScalar(p_In[i]);
+			}
+
+			inline void decodeRotationScalar(const QuaternionPacked* p_In, Quaternion* p_Out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+					p_Out[i] = decodeRotationScalar(p_In[i]);
+			}
+
+			//---------------------------------------------------------------------
+
+			inline uint16_t encodePositionScalar(float p_Value, float p_Min, float p_Scale)
+			{
+				float v = (p_Value - p_Min) * p_Scale;
+				v = v > 0 ? v : 0.0f;
+				v = v < 65535.0f ? v : 65535.0f;
+
+				return (uint16_t)lrintf(v);
+			}
+
+			inline float decodePositionScalar(uint16_t p_Value, float p_Min, float p_Step)
+			{
+				return p_Value * p_Step + p_Min;
+			}
+
+			//flat x y z stream of p_Count floats, p_Min/p_Scale hold one float per axis
+			inline void encodePositionScalar(const float* p_In, uint16_t* p_Out, size_t p_Count, const float* p_Min, const float* p_Scale)
+			{
+				for(size_t i = 0, axis = 0; i < p_Count; ++i, axis = axis == 2 ? 0 : axis + 1)
+					p_Out[i] = encodePositionScalar(p_In[i], p_Min[axis], p_Scale[axis]);
+			}
+
+			inline void decodePositionScalar(const uint16_t* p_In, float* p_Out, size_t p_Count, const float* p_Min, const float* p_Step)
+			{
+				for(size_t i = 0, axis = 0; i < p_Count; ++i, axis = axis == 2 ? 0 : axis + 1)
+					p_Out[i] = decodePositionScalar(p_In[i], p_Min[axis], p_Step[axis]);
+			}
+
+			//p_Axes repeated over p_Out[0..p_Lanes + 1], register j of a block then loads p_Out + (j * p_Lanes) % 3
+			inline void repeatAxes(const float* p_Axes, float* p_Out, int p_Lanes)
+			{
+				for(int k = 0; k < p_Lanes + 2; ++k)
+					p_Out[k] = p_Axes[k % 3];
+			}
+
+#if ALFAR_X86
+
+			//===================================================================== SSE2
+
+			ALFAR_TARGET_SSE2 inline __m128i selectSSE2(__m128i m, __m128i a, __m128i b)
+			{
+				return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+			}
+
+			//the low 16 bits of the 8 lanes of a and b, which hold values up to 0xffff
+			ALFAR_TARGET_SSE2 inline __m128i packLowSSE2(__m128i a, __m128i b)
+			{
+				a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+				b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+				return _mm_packs_epi32(a, b);
+			}
+
+			ALFAR_TARGET_SSE2 inline __m128i toHalfLanesSSE2(__m128 p_Value)
+			{
+				__m128i bits = _mm_castps_si128(p_Value);
+				__m128i sign = _mm_and_si128(bits, _mm_set1_epi32((int32_t)0x80000000u));
+				__m128i a = _mm_xor_si128(bits, sign);
+
+				__m128i big = _mm_cmpgt_epi32(a, _mm_set1_epi32(0x477fffff));
+				__m128i nan = _mm_cmpgt_epi32(a, _mm_set1_epi32(0x7f800000));
+				__m128i special = _mm_or_si128(_mm_set1_epi32(0x7c00), _mm_and_si128(nan, _mm_set1_epi32(0x0200)));
+
+				__m128i small = _mm_cmplt_epi32(a, _mm_set1_epi32(0x38800000));
+				__m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(a), _mm_set1_ps(0.5f))), _mm_set1_epi32(0x3f000000));
+
+				__m128i odd = _mm_and_si128(_mm_srli_epi32(a, 13), _mm_set1_epi32(1));
+				__m128i normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(a, _mm_set1_epi32((int32_t)0xc8000fffu)), odd), 13);
+
+				__m128i h = selectSSE2(big, special, selectSSE2(small, subnormal, normal));
+				return _mm_or_si128(h, _mm_srli_epi32(sign, 16));
+			}
+
+			//p_Half holds one half per 32 bits lane
+			ALFAR_TARGET_SSE2 inline __m128 fromHalfLanesSSE2(__m128i p_Half)
+			{
+				__m128i o = _mm_slli_epi32(_mm_and_si128(p_Half, _mm_set1_epi32(0x7fff)), 13);
+				__m128i exponent = _mm_and_si128(o, _mm_set1_epi32(0x0f800000));
+				o = _mm_add_epi32(o, _mm_set1_epi32(0x38000000));
+
+				__m128i infNan = _mm_cmpeq_epi32(exponent, _mm_set1_epi32(0x0f800000));
+				o = _mm_add_epi32(o, _mm_and_si128(infNan, _mm_set1_epi32(0x38000000)));
+
+				__m128i zero = _mm_cmpeq_epi32(exponent, _mm_setzero_si128());
+				__m128 subnormal = _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(o, _mm_set1_epi32(0x00800000))), _mm_castsi128_ps(_mm_set1_epi32(0x38800000)));
+				o = selectSSE2(zero, _mm_castps_si128(subnormal), o);
+
+				return _mm_castsi128_ps(_mm_or_si128(o, _mm_slli_epi32(_mm_and_si128(p_Half, _mm_set1_epi32(0x8000)), 16)));
+			}
+
+			ALFAR_TARGET_SSE2 inline void toHalfSSE2(const float* p_In, uint16_t* p_Out, size_t p_Count)
+			{
+				size_t i = 0;
+				for(; i + 8 <= p_Count; i += 8)
+				{
+					__m128i h0 = toHalfLanesSSE2(_mm_loadu_ps(p_In + i));
+					__m128i h1 = toHalfLanesSSE2(_mm_loadu_ps(p_In + i + 4));
+					_mm_storeu_si128((__m128i*)(p_Out + i), packLowSSE2(h0, h1));
+				}
+
+				toHalfScalar(p_In + i, p_Out + i, p_Count - i);
+			}
+
+			ALFAR_TARGET_SSE2 inline void fromHalfSSE2(const uint16_t* p_In, float* p_Out, size_t p_Count)
+			{
+				size_t i = 0;
+				for(; i + 8 <= p_Count; i += 8)
+				{
+					__m128i h = _mm_loadu_si128((const __m128i*)(p_In + i));
+					_mm_storeu_ps(p_Out + i, fromHalfLanesSSE2(_mm_unpacklo_epi16(h, _mm_setzero_si128())));
+					_mm_storeu_ps(p_Out + i + 4, fromHalfLanesSSE2(_mm_unpackhi_epi16(h, _mm_setzero_si128())));
+				}
+
+				fromHalfScalar(p_In + i, p_Out + i, p_Count - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			//x, y, z lanes to the octahedral coordinates, rounded to snorm16
+			ALFAR_TARGET_SSE2 inline void encodeNormalLanes(__m128 x, __m128 y, __m128 z, __m128i& p_X, __m128i& p_Y)
+			{
+				const __m128 signBit = _mm_set1_ps(-0.0f);
+				const __m128 one = _mm_set1_ps(1.0f);
+				const __m128 zero = _mm_setzero_ps();
+
+				__m128 l1 = _mm_add_ps(_mm_add_ps(_mm_andnot_ps(signBit, x), _mm_andnot_ps(signBit, y)), _mm_andnot_ps(signBit, z));
+				l1 = _mm_max_ps(l1, _mm_set1_ps(FLT_MIN));
+
+				__m128 px = _mm_div_ps(x, l1), py = _mm_div_ps(y, l1);
+				__m128 fx = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signBit, py)), _mm_or_ps(_mm_and_ps(_mm_cmplt_ps(px, zero), signBit), one));
+				__m128 fy = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signBit, px)), _mm_or_ps(_mm_and_ps(_mm_cmplt_ps(py, zero), signBit), one));
+
+				__m128 folded = _mm_cmplt_ps(z, zero);
+				px = _mm_or_ps(_mm_and_ps(folded, fx), _mm_andnot_ps(folded, px));
+				py = _mm_or_ps(_mm_and_ps(folded, fy), _mm_andnot_ps(folded, py));
+
+				p_X = _mm_cvtps_epi32(_mm_mul_ps(px, _mm_set1_ps(NORMAL_SCALE)));
+				p_Y = _mm_cvtps_epi32(_mm_mul_ps(py, _mm_set1_ps(NORMAL_SCALE)));
+			}
+
+			ALFAR_TARGET_SSE2 inline void decodeNormalLanes(__m128i p_X, __m128i p_Y, __m128& x, __m128& y, __m128& z)
+			{
+				const __m128 signBit = _mm_set1_ps(-0.0f);
+				const __m128 zero = _mm_setzero_ps();
+
+				x = _mm_mul_ps(_mm_cvtepi32_ps(p_X), _mm_set1_ps(NORMAL_STEP));
+				y = _mm_mul_ps(_mm_cvtepi32_ps(p_Y), _mm_set1_ps(NORMAL_STEP));
+				z = _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_andnot_ps(signBit, x)), _mm_andnot_ps(signBit, y));
+
+				__m128 t = _mm_max_ps(_mm_sub_ps(zero, z), zero);
+				__m128 nx = _mm_cmplt_ps(x, zero), ny = _mm_cmplt_ps(y, zero);
+				x = _mm_or_ps(_mm_and_ps(nx, _mm_add_ps(x, t)), _mm_andnot_ps(nx, _mm_sub_ps(x, t)));
+				y = _mm_or_ps(_mm_and_ps(ny, _mm_add_ps(y, t)), _mm_andnot_ps(ny, _mm_sub_ps(y, t)));
+
+				__m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+				x = _mm_div_ps(x, length);
+				y = _mm_div_ps(y, length);
+				z = _mm_div_ps(z, length);
+			}
+
+			ALFAR_TARGET_SSE2 inline void encodeNormalSSE2(const Vector3* p_In, NormalOct* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 4 <= p_Number; i += 4)
+				{
+					const float* in = &p_In[i].x;
+
+					__m128 x, y, z;
+					vector3::simd::deinterleave(_mm_loadu_ps(in), _mm_loadu_ps(in + 4), _mm_loadu_ps(in + 8), x, y, z);
+
+					__m128i ex, ey;
+					encodeNormalLanes(x, y, z, ex, ey);
+					_mm_storeu_si128((__m128i*)&p_Out[i].x, _mm_packs_epi32(_mm_unpacklo_epi32(ex, ey), _mm_unpackhi_epi32(ex, ey)));
+				}
+
+				encodeNormalScalar(p_In + i, p_Out + i, p_Number - i);
+			}
+
+			ALFAR_TARGET_SSE2 inline void decodeNormalSSE2(const NormalOct* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 4 <= p_Number; i += 4)
+				{
+					__m128i v = _mm_loadu_si128((const __m128i*)&p_In[i].x);
+					__m128 e0 = _mm_castsi128_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+					__m128 e1 = _mm_castsi128_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+
+					__m128i ex = _mm_castps_si128(_mm_shuffle_ps(e0, e1, _MM_SHUFFLE(2, 0, 2, 0)));
+					__m128i ey = _mm_castps_si128(_mm_shuffle_ps(e0, e1, _MM_SHUFFLE(3, 1, 3, 1)));
+
+					__m128 x, y, z, m0, m1, m2;
+					decodeNormalLanes(ex, ey, x, y, z);
+					vector3::simd::interleave(x, y, z, m0, m1, m2);
+
+					float* out = &p_Out[i].x;
+					_mm_storeu_ps(out, m0);
+					_mm_storeu_ps(out + 4, m1);
+					_mm_storeu_ps(out + 8, m2);
+				}
+
+				decodeNormalScalar(p_In + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			//x, y, z, w lanes to the 3 words of each rotation, one per 32 bits lane
+			ALFAR_TARGET_SSE2 inline void encodeRotationLanes(__m128 x, __m128 y, __m128 z, __m128 w, __m128i& p_W0, __m128i& p_W1, __m128i& p_W2)
+			{
+				const __m128 signBit = _mm_set1_ps(-0.0f);
+
+				//first largest magnitude, as in the scalar loop
+				__m128 largest = _mm_andnot_ps(signBit, x), value = x;
+				__m128i index = _mm_setzero_si128();
+				const __m128 lanes[3] = { y, z, w };
+				for(int k = 0; k < 3; ++k)
+				{
+					__m128 magnitude = _mm_andnot_ps(signBit, lanes[k]);
+					__m128 greater = _mm_cmpgt_ps(magnitude, largest);
+
+					largest = _mm_max_ps(largest, magnitude);
+					value = _mm_or_ps(_mm_and_ps(greater, lanes[k]), _mm_andnot_ps(greater, value));
+					index = selectSSE2(_mm_castps_si128(greater), _mm_set1_epi32(k + 1), index);
+				}
+
+				__m128 sign = _mm_and_ps(value, signBit);
+				__m128i first = _mm_cmpeq_epi32(index, _mm_setzero_si128());
+				__m128i belowTwo = _mm_cmplt_epi32(index, _mm_set1_epi32(2));
+				__m128i belowThree = _mm_cmplt_epi32(index, _mm_set1_epi32(3));
+
+				__m128 a = _mm_xor_ps(_mm_castsi128_ps(selectSSE2(first, _mm_castps_si128(y), _mm_castps_si128(x))), sign);
+				__m128 b = _mm_xor_ps(_mm_castsi128_ps(selectSSE2(belowTwo, _mm_castps_si128(z), _mm_castps_si128(y))), sign);
+				__m128 c = _mm_xor_ps(_mm_castsi128_ps(selectSSE2(belowThree, _mm_castps_si128(w), _mm_castps_si128(z))), sign);
+
+				const __m128 scale = _mm_set1_ps(ROTATION_SCALE), low = _mm_set1_ps(-16383.0f), high = _mm_set1_ps(16383.0f);
+				const __m128i bias = _mm_set1_epi32(16384);
+				__m128i ea = _mm_add_epi32(_mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(a, scale), low), high)), bias);
+				__m128i eb = _mm_add_epi32(_mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(b, scale), low), high)), bias);
+				__m128i ec = _mm_add_epi32(_mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(c, scale), low), high)), bias);
+
+				p_W0 = _mm_or_si128(_mm_slli_epi32(ea, 1), _mm_and_si128(index, _mm_set1_epi32(1)));
+				p_W1 = _mm_or_si128(_mm_slli_epi32(eb, 1), _mm_srli_epi32(index, 1));
+				p_W2 = _mm_slli_epi32(ec, 1);
+			}
+
+			ALFAR_TARGET_SSE2 inline void decodeRotationLanes(__m128i p_W0, __m128i p_W1, __m128i p_W2, __m128* q)
+			{
+				const __m128i one = _mm_set1_epi32(1), bias = _mm_set1_epi32(16384);
+				const __m128 step = _mm_set1_ps(ROTATION_STEP);
+
+				__m128i index = _mm_or_si128(_mm_and_si128(p_W0, one), _mm_slli_epi32(_mm_and_si128(p_W1, one), 1));
+				__m128 a = _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(p_W0, 1), bias)), step);
+				__m128 b = _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(p_W1, 1), bias)), step);
+				__m128 c = _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(p_W2, 1), bias)), step);
+
+				__m128 r = _mm_sub_ps(_mm_set1_ps(1.0f), _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, a), _mm_mul_ps(b, b)), _mm_mul_ps(c, c)));
+				__m128i d = _mm_castps_si128(_mm_sqrt_ps(_mm_max_ps(r, _mm_setzero_ps())));
+
+				__m128i is0 = _mm_cmpeq_epi32(index, _mm_setzero_si128()), is1 = _mm_cmpeq_epi32(index, one);
+				__m128i is2 = _mm_cmpeq_epi32(index, _mm_set1_epi32(2)), is3 = _mm_cmpeq_epi32(index, _mm_set1_epi32(3));
+				__m128i ia = _mm_castps_si128(a), ib = _mm_castps_si128(b), ic = _mm_castps_si128(c);
+
+				q[0] = _mm_castsi128_ps(selectSSE2(is0, d, ia));
+				q[1] = _mm_castsi128_ps(selectSSE2(is0, ia, selectSSE2(is1, d, ib)));
+				q[2] = _mm_castsi128_ps(selectSSE2(_mm_or_si128(is0, is1), ib, selectSSE2(is2, d, ic)));
+				q[3] = _mm_castsi128_ps(selectSSE2(is3, d, ic));
+			}
+
+			ALFAR_TARGET_SSE2 inline void encodeRotationSSE2(const Quaternion* p_In, QuaternionPacked* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 4 <= p_Number; i += 4)
+				{
+					__m128 q[4];
+					for(int k = 0; k < 4; ++k)
+						q[k] = _mm_loadu_ps(&p_In[i + k].x);
+					quaternion::simd::transpose(q);
+
+					__m128i w0, w1, w2;
+					encodeRotationLanes(q[0], q[1], q[2], q[3], w0, w1, w2);
+
+					__m128 m0, m1, m2;
+					vector3::simd::interleave(_mm_castsi128_ps(w0), _mm_castsi128_ps(w1), _mm_castsi128_ps(w2), m0, m1, m2);
+
+					uint16_t* out = p_Out[i].bits;
+					_mm_storeu_si128((__m128i*)out, packLowSSE2(_mm_castps_si128(m0), _mm_castps_si128(m1)));
+					_mm_storel_epi64((__m128i*)(out + 8), packLowSSE2(_mm_castps_si128(m2), _mm_castps_si128(m2)));
+				}
+
+				encodeRotationScalar(p_In + i, p_Out + i, p_Number - i);
+			}
+
+			ALFAR_TARGET_SSE2 inline void decodeRotationSSE2(const QuaternionPacked* p_In, Quaternion* p_Out, uint32_t p_Number)
+			{
+				const __m128i zero = _mm_setzero_si128();
+
+				uint32_t i = 0;
+				for(; i + 4 <= p_Number; i += 4)
+				{
+					const uint16_t* in = p_In[i].bits;
+					__m128i v0 = _mm_loadu_si128((const __m128i*)in);
+					__m128i v1 = _mm_loadl_epi64((const __m128i*)(in + 8));
+
+					__m128 w0, w1, w2;
+					vector3::simd::deinterleave(_mm_castsi128_ps(_mm_unpacklo_epi16(v0, zero)), _mm_castsi128_ps(_mm_unpackhi_epi16(v0, zero)), _mm_castsi128_ps(_mm_unpacklo_epi16(v1, zero)), w0, w1, w2);
+
+					__m128 q[4];
+					decodeRotationLanes(_mm_castps_si128(w0), _mm_castps_si128(w1), _mm_castps_si128(w2), q);
+					quaternion::simd::transpose(q);
+
+					for(int k = 0; k < 4; ++k)
+						_mm_storeu_ps(&p_Out[i + k].x, q[k]);
+				}
+
+				decodeRotationScalar(p_In + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_SSE2 inline void encodePositionSSE2(const float* p_In, uint16_t* p_Out, size_t p_Count, const float* p_Min, const float* p_Scale)
+			{
+				float mins[6], scales[6];
+				repeatAxes(p_Min, mins, 4);
+				repeatAxes(p_Scale, scales, 4);
+
+				__m128 m[3], s[3];
+				for(int j = 0; j < 3; ++j)
+				{
+					m[j] = _mm_loadu_ps(mins + j * 4 % 3);
+					s[j] = _mm_loadu_ps(scales + j * 4 % 3);
+				}
+
+				const __m128 zero = _mm_setzero_ps(), high = _mm_set1_ps(65535.0f);
+
+				size_t i = 0;
+				for(; i + 12 <= p_Count; i += 12)
+				{
+					__m128i e[3];
+					for(int j = 0; j < 3; ++j)
+					{
+						__m128 v = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(p_In + i + j * 4), m[j]), s[j]);
+						e[j] = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(v, zero), high));
+					}
+
+					_mm_storeu_si128((__m128i*)(p_Out + i), packLowSSE2(e[0], e[1]));
+					_mm_storel_epi64((__m128i*)(p_Out + i + 8), packLowSSE2(e[2], e[2]));
+				}
+
+				encodePositionScalar(p_In + i, p_Out + i, p_Count - i, p_Min, p_Scale);
+			}
+
+			ALFAR_TARGET_SSE2 inline void decodePositionSSE2(const uint16_t* p_In, float* p_Out, size_t p_Count, const float* p_Min, const float* p_Step)
+			{
+				float mins[6], steps[6];
+				repeatAxes(p_Min, mins, 4);
+				repeatAxes(p_Step, steps, 4);
+
+				__m128 m[3], s[3];
+				for(int j = 0; j < 3; ++j)
+				{
+					m[j] = _mm_loadu_ps(mins + j * 4 % 3);
+					s[j] = _mm_loadu_ps(steps + j * 4 % 3);
+				}
+
+				const __m128i zero = _mm_setzero_si128();
+
+				size_t i = 0;
+				for(; i + 12 <= p_Count; i += 12)
+				{
+					__m128i v0 = _mm_loadu_si128((const __m128i*)(p_In + i));
+					__m128i v1 = _mm_loadl_epi64((const __m128i*)(p_In + i + 8));
+					__m128i e[3] = { _mm_unpacklo_epi16(v0, zero), _mm_unpackhi_epi16(v0, zero), _mm_unpacklo_epi16(v1, zero) };
+
+					for(int j = 0; j < 3; ++j)
+						_mm_storeu_ps(p_Out + i + j * 4, _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(e[j]), s[j]), m[j]));
+				}
+
+				decodePositionScalar(p_In + i, p_Out + i, p_Count - i, p_Min, p_Step);
+			}
+
+			//===================================================================== AVX2
+
+			ALFAR_TARGET_AVX2 inline __m256i selectAVX2(__m256i m, __m256i a, __m256i b)
+			{
+				return _mm256_blendv_epi8(b, a, m);
+			}
+
+			//8 + 8 lanes of values up to 0xffff to 16 words in array order
+			ALFAR_TARGET_AVX2 inline __m256i packLowAVX2(__m256i a, __m256i b)
+			{
+				return _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+			}
+
+			ALFAR_TARGET_AVX2 inline void toHalfAVX2(const float* p_In, uint16_t* p_Out, size_t p_Count)
+			{
+				size_t i = 0;
+				for(; i + 16 <= p_Count; i += 16)
+				{
+					__m128i h0 = _mm256_cvtps_ph(_mm256_loadu_ps(p_In + i), _MM_FROUND_TO_NEAREST_INT);
+					__m128i h1 = _mm256_cvtps_ph(_mm256_loadu_ps(p_In + i + 8), _MM_FROUND_TO_NEAREST_INT);
+					_mm_storeu_si128((__m128i*)(p_Out + i), h0);
+					_mm_storeu_si128((__m128i*)(p_Out + i + 8), h1);
+				}
+
+				toHalfSSE2(p_In + i, p_Out + i, p_Count - i);
+			}
+
+			ALFAR_TARGET_AVX2 inline void fromHalfAVX2(const uint16_t* p_In, float* p_Out, size_t p_Count)
+			{
+				size_t i = 0;
+				for(; i + 16 <= p_Count; i += 16)
+				{
+					_mm256_storeu_ps(p_Out + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(p_In + i))));
+					_mm256_storeu_ps(p_Out + i + 8, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(p_In + i + 8))));
+				}
+
+				fromHalfSSE2(p_In + i, p_Out + i, p_Count - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX2 inline void encodeNormalLanes(__m256 x, __m256 y, __m256 z, __m256i& p_X, __m256i& p_Y)
+			{
+				const __m256 signBit = _mm256_set1_ps(-0.0f);
+				const __m256 one = _mm256_set1_ps(1.0f);
+				const __m256 zero = _mm256_setzero_ps();
+
+				__m256 l1 = _mm256_add_ps(_mm256_add_ps(_mm256_andnot_ps(signBit, x), _mm256_andnot_ps(signBit, y)), _mm256_andnot_ps(signBit, z));
+				l1 = _mm256_max_ps(l1, _mm256_set1_ps(FLT_MIN));
+
+				__m256 px = _mm256_div_ps(x, l1), py = _mm256_div_ps(y, l1);
+				__m256 fx = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_andnot_ps(signBit, py)), _mm256_or_ps(_mm256_and_ps(_mm256_cmp_ps(px, zero, _CMP_LT_OQ), signBit), one));
+				__m256 fy = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_andnot_ps(signBit, px)), _mm256_or_ps(_mm256_and_ps(_mm256_cmp_ps(py, zero, _CMP_LT_OQ), signBit), one));
+
+				__m256 folded = _mm256_cmp_ps(z, zero, _CMP_LT_OQ);
+				px = _mm256_blendv_ps(px, fx, folded);
+				py = _mm256_blendv_ps(py, fy, folded);
+
+				p_X = _mm256_cvtps_epi32(_mm256_mul_ps(px, _mm256_set1_ps(NORMAL_SCALE)));
+				p_Y = _mm256_cvtps_epi32(_mm256_mul_ps(py, _mm256_set1_ps(NORMAL_SCALE)));
+			}
+
+			ALFAR_TARGET_AVX2 inline void decodeNormalLanes(__m256i p_X, __m256i p_Y, __m256& x, __m256& y, __m256& z)
+			{
+				const __m256 signBit = _mm256_set1_ps(-0.0f);
+				const __m256 zero = _mm256_setzero_ps();
+
+				x = _mm256_mul_ps(_mm256_cvtepi32_ps(p_X), _mm256_set1_ps(NORMAL_STEP));
+				y = _mm256_mul_ps(_mm256_cvtepi32_ps(p_Y), _mm256_set1_ps(NORMAL_STEP));
+				z = _mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_andnot_ps(signBit, x)), _mm256_andnot_ps(signBit, y));
+
+				__m256 t = _mm256_max_ps(_mm256_sub_ps(zero, z), zero);
+				x = _mm256_blendv_ps(_mm256_sub_ps(x, t), _mm256_add_ps(x, t), _mm256_cmp_ps(x, zero, _CMP_LT_OQ));
+				y = _mm256_blendv_ps(_mm256_sub_ps(y, t), _mm256_add_ps(y, t), _mm256_cmp_ps(y, zero, _CMP_LT_OQ));
+
+				__m256 length = _mm256_sqrt_ps(_mm256_fmadd_ps(z, z, _mm256_fmadd_ps(y, y, _mm256_mul_ps(x, x))));
+				x = _mm256_div_ps(x, length);
+				y = _mm256_div_ps(y, length);
+				z = _mm256_div_ps(z, length);
+			}
+
+			//the in-lane unpacks and packs keep the 8 pairs in array order
+			ALFAR_TARGET_AVX2 inline void encodeNormalAVX2(const Vector3* p_In, NormalOct* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 8 <= p_Number; i += 8)
+				{
+					__m256 m0, m1, m2, x, y, z;
+					vector3::simd::load8(&p_In[i].x, m0, m1, m2);
+					vector3::simd::deinterleave(m0, m1, m2, x, y, z);
+
+					__m256i ex, ey;
+					encodeNormalLanes(x, y, z, ex, ey);
+					_mm256_storeu_si256((__m256i*)&p_Out[i].x, _mm256_packs_epi32(_mm256_unpacklo_epi32(ex, ey), _mm256_unpackhi_epi32(ex, ey)));
+				}
+
+				encodeNormalSSE2(p_In + i, p_Out + i, p_Number - i);
+			}
+
+			//the even/odd shuffles give the normals in the order 0 1 4 5 2 3 6 7, put back by a 64 bits permute
+			ALFAR_TARGET_AVX2 inline void decodeNormalAVX2(const NormalOct* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 8 <= p_Number; i += 8)
+				{
+					__m256 e0 = _mm256_castsi256_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)&p_In[i].x)));
+					__m256 e1 = _mm256_castsi256_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)&p_In[i + 4].x)));
+
+					__m256i ex = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(e0, e1, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0));
+					__m256i ey = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(e0, e1, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0));
+
+					__m256 x, y, z, m0, m1, m2;
+					decodeNormalLanes(ex, ey, x, y, z);
+					vector3::simd::interleave(x, y, z, m0, m1, m2);
+					vector3::simd::store8(&p_Out[i].x, m0, m1, m2);
+				}
+
+				decodeNormalSSE2(p_In + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX2 inline void encodeRotationLanes(const __m256* q, __m256i& p_W0, __m256i& p_W1, __m256i& p_W2)
+			{
+				const __m256 signBit = _mm256_set1_ps(-0.0f);
+
+				__m256 largest = _mm256_andnot_ps(signBit, q[0]), value = q[0];
+				__m256i index = _mm256_setzero_si256();
+				for(int k = 1; k < 4; ++k)
+				{
+					__m256 magnitude = _mm256_andnot_ps(signBit, q[k]);
+					__m256 greater = _mm256_cmp_ps(magnitude, largest, _CMP_GT_OQ);
+
+					largest = _mm256_max_ps(largest, magnitude);
+					value = _mm256_blendv_ps(value, q[k], greater);
+					index = selectAVX2(_mm256_castps_si256(greater), _mm256_set1_epi32(k), index);
+				}
+
+				__m256 sign = _mm256_and_ps(value, signBit);
+				__m256 first = _mm256_castsi256_ps(_mm256_cmpeq_epi32(index, _mm256_setzero_si256()));
+				__m256 belowTwo = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(2), index));
+				__m256 belowThree = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(3), index));
+
+				__m256 a = _mm256_xor_ps(_mm256_blendv_ps(q[0], q[1], first), sign);
+				__m256 b = _mm256_xor_ps(_mm256_blendv_ps(q[1], q[2], belowTwo), sign);
+				__m256 c = _mm256_xor_ps(_mm256_blendv_ps(q[2], q[3], belowThree), sign);
+
+				const __m256 scale = _mm256_set1_ps(ROTATION_SCALE), low = _mm256_set1_ps(-16383.0f), high = _mm256_set1_ps(16383.0f);
+				const __m256i bias = _mm256_set1_epi32(16384);
+				__m256i ea = _mm256_add_epi32(_mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(a, scale), low), high)), bias);
+				__m256i eb = _mm256_add_epi32(_mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(b, scale), low), high)), bias);
+				__m256i ec = _mm256_add_epi32(_mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(c, scale), low), high)), bias);
+
+				p_W0 = _mm256_or_si256(_mm256_slli_epi32(ea, 1), _mm256_and_si256(index, _mm256_set1_epi32(1)));
+				p_W1 = _mm256_or_si256(_mm256_slli_epi32(eb, 1), _mm256_srli_epi32(index, 1));
+				p_W2 = _mm256_slli_epi32(ec, 1);
+			}
+
+			ALFAR_TARGET_AVX2 inline void decodeRotationLanes(__m256i p_W0, __m256i p_W1, __m256i p_W2, __m256* q)
+			{
+				const __m256i one = _mm256_set1_epi32(1), bias = _mm256_set1_epi32(16384);
+				const __m256 step = _mm256_set1_ps(ROTATION_STEP);
+
+				__m256i index = _mm256_or_si256(_mm256_and_si256(p_W0, one), _mm256_slli_epi32(_mm256_and_si256(p_W1, one), 1));
+				__m256 a = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(p_W0, 1), bias)), step);
+				__m256 b = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(p_W1, 1), bias)), step);
+				__m256 c = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(p_W2, 1), bias)), step);
+
+				__m256 r = _mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_fmadd_ps(c, c, _mm256_fmadd_ps(b, b, _mm256_mul_ps(a, a))));
+				__m256 d = _mm256_sqrt_ps(_mm256_max_ps(r, _mm256_setzero_ps()));
+
+				__m256 is0 = _mm256_castsi256_ps(_mm256_cmpeq_epi32(index, _mm256_setzero_si256()));
+				__m256 is1 = _mm256_castsi256_ps(_mm256_cmpeq_epi32(index, one));
+				__m256 is2 = _mm256_castsi256_ps(_mm256_cmpeq_epi32(index, _mm256_set1_epi32(2)));
+				__m256 is3 = _mm256_castsi256_ps(_mm256_cmpeq_epi32(index, _mm256_set1_epi32(3)));
+
+				q[0] = _mm256_blendv_ps(a, d, is0);
+				q[1] = _mm256_blendv_ps(_mm256_blendv_ps(b, d, is1), a, is0);
+				q[2] = _mm256_blendv_ps(_mm256_blendv_ps(c, d, is2), b, _mm256_or_ps(is0, is1));
+				q[3] = _mm256_blendv_ps(c, d, is3);
+			}
+
+			//the words are interleaved in the vector3 load8 layout, 4 rotations (12 words) per 128 bits lane
+			ALFAR_TARGET_AVX2 inline void encodeRotationAVX2(const Quaternion* p_In, QuaternionPacked* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 8 <= p_Number; i += 8)
+				{
+					__m256 q[4];
+					quaternion::simd::load8(p_In + i, q);
+
+					__m256i w0, w1, w2;
+					encodeRotationLanes(q, w0, w1, w2);
+
+					__m256 m0, m1, m2;
+					vector3::simd::interleave(_mm256_castsi256_ps(w0), _mm256_castsi256_ps(w1), _mm256_castsi256_ps(w2), m0, m1, m2);
+
+					__m256i first = _mm256_packus_epi32(_mm256_castps_si256(m0), _mm256_castps_si256(m1));
+					__m256i last = _mm256_packus_epi32(_mm256_castps_si256(m2), _mm256_castps_si256(m2));
+
+					uint16_t* out = p_Out[i].bits;
+					_mm_storeu_si128((__m128i*)out, _mm256_castsi256_si128(first));
+					_mm_storel_epi64((__m128i*)(out + 8), _mm256_castsi256_si128(last));
+					_mm_storeu_si128((__m128i*)(out + 12), _mm256_extracti128_si256(first, 1));
+					_mm_storel_epi64((__m128i*)(out + 20), _mm256_extracti128_si256(last, 1));
+				}
+
+				encodeRotationSSE2(p_In + i, p_Out + i, p_Number - i);
+			}
+
+			ALFAR_TARGET_AVX2 inline void decodeRotationAVX2(const QuaternionPacked* p_In, Quaternion* p_Out, uint32_t p_Number)
+			{
+				//back to the order of quaternion::simd::load8 before the in-lane transpose
+				const __m256i order = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+
+				uint32_t i = 0;
+				for(; i + 8 <= p_Number; i += 8)
+				{
+					const uint16_t* in = p_In[i].bits;
+
+					__m256 m[3];
+					for(int j = 0; j < 3; ++j)
+					{
+						__m128i words = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)(in + j * 4)), _mm_loadl_epi64((const __m128i*)(in + 12 + j * 4)));
+						m[j] = _mm256_castsi256_ps(_mm256_cvtepu16_epi32(words));
+					}
+
+					__m256 w0, w1, w2;
+					vector3::simd::deinterleave(m[0], m[1], m[2], w0, w1, w2);
+
+					__m256 q[4];
+					decodeRotationLanes(_mm256_castps_si256(w0), _mm256_castps_si256(w1), _mm256_castps_si256(w2), q);
+
+					for(int k = 0; k < 4; ++k)
+						q[k] = _mm256_permutevar8x32_ps(q[k], order);
+					quaternion::simd::transpose(q);
+
+					for(int k = 0; k < 4; ++k)
+						_mm256_storeu_ps(&p_Out[i + 2 * k].x, q[k]);
+				}
+
+				decodeRotationSSE2(p_In + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX2 inline void encodePositionAVX2(const float* p_In, uint16_t* p_Out, size_t p_Count, const float* p_Min, const float* p_Scale)
+			{
+				float mins[10], scales[10];
+				repeatAxes(p_Min, mins, 8);
+				repeatAxes(p_Scale, scales, 8);
+
+				__m256 m[3], s[3];
+				for(int j = 0; j < 3; ++j)
+				{
+					m[j] = _mm256_loadu_ps(mins + j * 8 % 3);
+					s[j] = _mm256_loadu_ps(scales + j * 8 % 3);
+				}
+
+				const __m256 zero = _mm256_setzero_ps(), high = _mm256_set1_ps(65535.0f);
+
+				size_t i = 0;
+				for(; i + 24 <= p_Count; i += 24)
+				{
+					__m256i e[3];
+					for(int j = 0; j < 3; ++j)
+					{
+						__m256 v = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(p_In + i + j * 8), m[j]), s[j]);
+						e[j] = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(v, zero), high));
+					}
+
+					_mm256_storeu_si256((__m256i*)(p_Out + i), packLowAVX2(e[0], e[1]));
+					_mm_storeu_si128((__m128i*)(p_Out + i + 16), _mm256_castsi256_si128(packLowAVX2(e[2], e[2])));
+				}
+
+				encodePositionSSE2(p_In + i, p_Out + i, p_Count - i, p_Min, p_Scale);
+			}
+
+			ALFAR_TARGET_AVX2 inline void decodePositionAVX2(const uint16_t* p_In, float* p_Out, size_t p_Count, const float* p_Min, const float* p_Step)
+			{
+				float mins[10], steps[10];
+				repeatAxes(p_Min, mins, 8);
+				repeatAxes(p_Step, steps, 8);
+
+				__m256 m[3], s[3];
+				for(int j = 0; j < 3; ++j)
+				{
+					m[j] = _mm256_loadu_ps(mins + j * 8 % 3);
+					s[j] = _mm256_loadu_ps(steps + j * 8 % 3);
+				}
+
+				size_t i = 0;
+				for(; i + 24 <= p_Count; i += 24)
+				{
+					for(int j = 0; j < 3; ++j)
+					{
+						__m256 v = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(p_In + i + j * 8))));
+						_mm256_storeu_ps(p_Out + i + j * 8, _mm256_fmadd_ps(v, s[j], m[j]));
+					}
+				}
+
+				decodePositionSSE2(p_In + i, p_Out + i, p_Count - i, p_Min, p_Step);
+			}
+
+			//===================================================================== AVX-512
+
+			ALFAR_TARGET_AVX512 inline void toHalfAVX512(const float* p_In, uint16_t* p_Out, size_t p_Count)
+			{
+				size_t i = 0;
+				for(; i + 32 <= p_Count; i += 32)
+				{
+					__m256i h0 = _mm512_cvtps_ph(_mm512_loadu_ps(p_In + i), _MM_FROUND_TO_NEAREST_INT);
+					__m256i h1 = _mm512_cvtps_ph(_mm512_loadu_ps(p_In + i + 16), _MM_FROUND_TO_NEAREST_INT);
+					_mm256_storeu_si256((__m256i*)(p_Out + i), h0);
+					_mm256_storeu_si256((__m256i*)(p_Out + i + 16), h1);
+				}
+
+				toHalfAVX2(p_In + i, p_Out + i, p_Count - i);
+			}
+
+			ALFAR_TARGET_AVX512 inline void fromHalfAVX512(const uint16_t* p_In, float* p_Out, size_t p_Count)
+			{
+				size_t i = 0;
+				for(; i + 32 <= p_Count; i += 32)
+				{
+					_mm512_storeu_ps(p_Out + i, _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)(p_In + i))));
+					_mm512_storeu_ps(p_Out + i + 16, _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)(p_In + i + 16))));
+				}
+
+				fromHalfAVX2(p_In + i, p_Out + i, p_Count - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			//(AVX512F has no float and/xor, the sign tricks go through the integer ops)
+			ALFAR_TARGET_AVX512 inline __m512 xorAVX512(__m512 a, __m512 b)
+			{
+				return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a), _mm512_castps_si512(b)));
+			}
+
+			ALFAR_TARGET_AVX512 inline void encodeNormalLanes(__m512 x, __m512 y, __m512 z, __m512i& p_X, __m512i& p_Y)
+			{
+				const __m512 one = _mm512_set1_ps(1.0f), minusOne = _mm512_set1_ps(-1.0f);
+				const __m512 zero = _mm512_setzero_ps();
+
+				__m512 l1 = _mm512_add_ps(_mm512_add_ps(_mm512_abs_ps(x), _mm512_abs_ps(y)), _mm512_abs_ps(z));
+				l1 = _mm512_max_ps(l1, _mm512_set1_ps(FLT_MIN));
+
+				__m512 px = _mm512_div_ps(x, l1), py = _mm512_div_ps(y, l1);
+				__m512 fx = _mm512_mul_ps(_mm512_sub_ps(one, _mm512_abs_ps(py)), _mm512_mask_blend_ps(_mm512_cmp_ps_mask(px, zero, _CMP_LT_OQ), one, minusOne));
+				__m512 fy = _mm512_mul_ps(_mm512_sub_ps(one, _mm512_abs_ps(px)), _mm512_mask_blend_ps(_mm512_cmp_ps_mask(py, zero, _CMP_LT_OQ), one, minusOne));
+
+				__mmask16 folded = _mm512_cmp_ps_mask(z, zero, _CMP_LT_OQ);
+				px = _mm512_mask_blend_ps(folded, px, fx);
+				py = _mm512_mask_blend_ps(folded, py, fy);
+
+				p_X = _mm512_cvtps_epi32(_mm512_mul_ps(px, _mm512_set1_ps(NORMAL_SCALE)));
+				p_Y = _mm512_cvtps_epi32(_mm512_mul_ps(py, _mm512_set1_ps(NORMAL_SCALE)));
+			}
+
+			ALFAR_TARGET_AVX512 inline void decodeNormalLanes(__m512i p_X, __m512i p_Y, __m512& x, __m512& y, __m512& z)
+			{
+				const __m512 zero = _mm512_setzero_ps();
+
+				x = _mm512_mul_ps(_mm512_cvtepi32_ps(p_X), _mm512_set1_ps(NORMAL_STEP));
+				y = _mm512_mul_ps(_mm512_cvtepi32_ps(p_Y), _mm512_set1_ps(NORMAL_STEP));
+				z = _mm512_sub_ps(_mm512_sub_ps(_mm512_set1_ps(1.0f), _mm512_abs_ps(x)), _mm512_abs_ps(y));
+
+				__m512 t = _mm512_max_ps(_mm512_sub_ps(zero, z), zero);
+				x = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(x, zero, _CMP_LT_OQ), _mm512_sub_ps(x, t), _mm512_add_ps(x, t));
+				y = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(y, zero, _CMP_LT_OQ), _mm512_sub_ps(y, t), _mm512_add_ps(y, t));
+
+				__m512 length = _mm512_sqrt_ps(_mm512_fmadd_ps(z, z, _mm512_fmadd_ps(y, y, _mm512_mul_ps(x, x))));
+				x = _mm512_div_ps(x, length);
+				y = _mm512_div_ps(y, length);
+				z = _mm512_div_ps(z, length);
+			}
+
+			ALFAR_TARGET_AVX512 inline void encodeNormalAVX512(const Vector3* p_In, NormalOct* p_Out, uint32_t p_Number)
+			{
+				const __m512i low = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+				const __m512i high = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+
+				uint32_t i = 0;
+				for(; i + 16 <= p_Number; i += 16)
+				{
+					__m512 m0, m1, m2, x, y, z;
+					vector3::simd::load16(&p_In[i].x, m0, m1, m2);
+					vector3::simd::deinterleave(m0, m1, m2, x, y, z);
+
+					__m512i ex, ey;
+					encodeNormalLanes(x, y, z, ex, ey);
+					_mm256_storeu_si256((__m256i*)&p_Out[i].x, _mm512_cvtepi32_epi16(_mm512_permutex2var_epi32(ex, low, ey)));
+					_mm256_storeu_si256((__m256i*)&p_Out[i + 8].x, _mm512_cvtepi32_epi16(_mm512_permutex2var_epi32(ex, high, ey)));
+				}
+
+				encodeNormalAVX2(p_In + i, p_Out + i, p_Number - i);
+			}
+
+			ALFAR_TARGET_AVX512 inline void decodeNormalAVX512(const NormalOct* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				const __m512i even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+				const __m512i odd = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+
+				uint32_t i = 0;
+				for(; i + 16 <= p_Number; i += 16)
+				{
+					__m512i e0 = _mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i*)&p_In[i].x));
+					__m512i e1 = _mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i*)&p_In[i + 8].x));
+
+					__m512 x, y, z, m0, m1, m2;
+					decodeNormalLanes(_mm512_permutex2var_epi32(e0, even, e1), _mm512_permutex2var_epi32(e0, odd, e1), x, y, z);
+					vector3::simd::interleave(x, y, z, m0, m1, m2);
+					vector3::simd::store16(&p_Out[i].x, m0, m1, m2);
+				}
+
+				decodeNormalAVX2(p_In + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX512 inline void encodeRotationLanes(const __m512* q, __m512i& p_W0, __m512i& p_W1, __m512i& p_W2)
+			{
+				__m512 largest = _mm512_abs_ps(q[0]), value = q[0];
+				__m512i index = _mm512_setzero_si512();
+				for(int k = 1; k < 4; ++k)
+				{
+					__m512 magnitude = _mm512_abs_ps(q[k]);
+					__mmask16 greater = _mm512_cmp_ps_mask(magnitude, largest, _CMP_GT_OQ);
+
+					largest = _mm512_max_ps(largest, magnitude);
+					value = _mm512_mask_blend_ps(greater, value, q[k]);
+					index = _mm512_mask_blend_epi32(greater, index, _mm512_set1_epi32(k));
+				}
+
+				__m512 sign = _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(value), _mm512_set1_epi32((int32_t)0x80000000u)));
+				__mmask16 first = _mm512_cmpeq_epi32_mask(index, _mm512_setzero_si512());
+				__mmask16 belowTwo = _mm512_cmplt_epi32_mask(index, _mm512_set1_epi32(2));
+				__mmask16 belowThree = _mm512_cmplt_epi32_mask(index, _mm512_set1_epi32(3));
+
+				__m512 a = xorAVX512(_mm512_mask_blend_ps(first, q[0], q[1]), sign);
+				__m512 b = xorAVX512(_mm512_mask_blend_ps(belowTwo, q[1], q[2]), sign);
+				__m512 c = xorAVX512(_mm512_mask_blend_ps(belowThree, q[2], q[3]), sign);
+
+				const __m512 scale = _mm512_set1_ps(ROTATION_SCALE), low = _mm512_set1_ps(-16383.0f), high = _mm512_set1_ps(16383.0f);
+				const __m512i bias = _mm512_set1_epi32(16384);
+				__m512i ea = _mm512_add_epi32(_mm512_cvtps_epi32(_mm512_min_ps(_mm512_max_ps(_mm512_mul_ps(a, scale), low), high)), bias);
+				__m512i eb = _mm512_add_epi32(_mm512_cvtps_epi32(_mm512_min_ps(_mm512_max_ps(_mm512_mul_ps(b, scale), low), high)), bias);
+				__m512i ec = _mm512_add_epi32(_mm512_cvtps_epi32(_mm512_min_ps(_mm512_max_ps(_mm512_mul_ps(c, scale), low), high)), bias);
+
+				p_W0 = _mm512_or_si512(_mm512_slli_epi32(ea, 1), _mm512_and_si512(index, _mm512_set1_epi32(1)));
+				p_W1 = _mm512_or_si512(_mm512_slli_epi32(eb, 1), _mm512_srli_epi32(index, 1));
+				p_W2 = _mm512_slli_epi32(ec, 1);
+			}
+
+			ALFAR_TARGET_AVX512 inline void decodeRotationLanes(__m512i p_W0, __m512i p_W1, __m512i p_W2, __m512* q)
+			{
+				const __m512i one = _mm512_set1_epi32(1), bias = _mm512_set1_epi32(16384);
+				const __m512 step = _mm512_set1_ps(ROTATION_STEP);
+
+				__m512i index = _mm512_or_si512(_mm512_and_si512(p_W0, one), _mm512_slli_epi32(_mm512_and_si512(p_W1, one), 1));
+				__m512 a = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_sub_epi32(_mm512_srli_epi32(p_W0, 1), bias)), step);
+				__m512 b = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_sub_epi32(_mm512_srli_epi32(p_W1, 1), bias)), step);
+				__m512 c = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_sub_epi32(_mm512_srli_epi32(p_W2, 1), bias)), step);
+
+				__m512 r = _mm512_sub_ps(_mm512_set1_ps(1.0f), _mm512_fmadd_ps(c, c, _mm512_fmadd_ps(b, b, _mm512_mul_ps(a, a))));
+				__m512 d = _mm512_sqrt_ps(_mm512_max_ps(r, _mm512_setzero_ps()));
+
+				__mmask16 is0 = _mm512_cmpeq_epi32_mask(index, _mm512_setzero_si512()), is1 = _mm512_cmpeq_epi32_mask(index, one);
+				__mmask16 is2 = _mm512_cmpeq_epi32_mask(index, _mm512_set1_epi32(2)), is3 = _mm512_cmpeq_epi32_mask(index, _mm512_set1_epi32(3));
+
+				q[0] = _mm512_mask_blend_ps(is0, a, d);
+				q[1] = _mm512_mask_blend_ps(is0, _mm512_mask_blend_ps(is1, b, d), a);
+				q[2] = _mm512_mask_blend_ps(is0 | is1, _mm512_mask_blend_ps(is2, c, d), b);
+				q[3] = _mm512_mask_blend_ps(is3, c, d);
+			}
+
+			//word j of a block of 16 rotations is word j % 3 of rotation j / 3: the 48 words are
+			//gathered from the first two lanes by a two sources permute, then from the third
+			struct RotationWords
+			{
+				__m512i pair[3], single[3];
+				__mmask16 fromThird[3];
+			};
+
+			//p_Interleave: w0/w1/w2 lanes to the 48 words, otherwise the 48 words to w0/w1/w2 lanes
+			ALFAR_TARGET_AVX512 inline RotationWords rotationWords(bool p_Interleave)
+			{
+				int32_t pair[48], single[48];
+				RotationWords ret = {};
+
+				for(int j = 0; j < 48; ++j)
+				{
+					//interleave: source lane (j % 3) at j / 3. deinterleave: lane j / 16 of word 3 (j % 16) + j / 16
+					int lane = p_Interleave ? j % 3 : (3 * (j % 16) + j / 16) / 16;
+					int index = p_Interleave ? j / 3 : (3 * (j % 16) + j / 16) % 16;
+
+					pair[j] = lane == 1 ? 16 + index : index;
+					single[j] = index;
+					if(lane == 2)
+						ret.fromThird[j / 16] = (__mmask16)(ret.fromThird[j / 16] | 1 << (j % 16));
+				}
+
+				for(int r = 0; r < 3; ++r)
+				{
+					ret.pair[r] = _mm512_loadu_si512(pair + 16 * r);
+					ret.single[r] = _mm512_loadu_si512(single + 16 * r);
+				}
+
+				return ret;
+			}
+
+			ALFAR_TARGET_AVX512 inline __m512i gatherWords(const RotationWords& p_Words, int r, __m512i p_0, __m512i p_1, __m512i p_2)
+			{
+				__m512i ret = _mm512_permutex2var_epi32(p_0, p_Words.pair[r], p_1);
+				return _mm512_mask_permutexvar_epi32(ret, p_Words.fromThird[r], p_Words.single[r], p_2);
+			}
+
+			ALFAR_TARGET_AVX512 inline void encodeRotationAVX512(const Quaternion* p_In, QuaternionPacked* p_Out, uint32_t p_Number)
+			{
+				const RotationWords words = rotationWords(true);
+
+				uint32_t i = 0;
+				for(; i + 16 <= p_Number; i += 16)
+				{
+					__m512 q[4];
+					quaternion::simd::load16(p_In + i, q);
+
+					__m512i w0, w1, w2;
+					encodeRotationLanes(q, w0, w1, w2);
+
+					uint16_t* out = p_Out[i].bits;
+					for(int r = 0; r < 3; ++r)
+						_mm256_storeu_si256((__m256i*)(out + 16 * r), _mm512_cvtepi32_epi16(gatherWords(words, r, w0, w1, w2)));
+				}
+
+				encodeRotationAVX2(p_In + i, p_Out + i, p_Number - i);
+			}
+
+			ALFAR_TARGET_AVX512 inline void decodeRotationAVX512(const QuaternionPacked* p_In, Quaternion* p_Out, uint32_t p_Number)
+			{
+				//the permute of quaternion::simd::load16 is its own inverse
+				const __m512i order = _mm512_setr_epi32(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+				const RotationWords words = rotationWords(false);
+
+				uint32_t i = 0;
+				for(; i + 16 <= p_Number; i += 16)
+				{
+					const uint16_t* in = p_In[i].bits;
+					__m512i d0 = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*)in));
+					__m512i d1 = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*)(in + 16)));
+					__m512i d2 = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*)(in + 32)));
+
+					__m512 q[4];
+					decodeRotationLanes(gatherWords(words, 0, d0, d1, d2), gatherWords(words, 1, d0, d1, d2), gatherWords(words, 2, d0, d1, d2), q);
+
+					for(int k = 0; k < 4; ++k)
+						q[k] = _mm512_permutexvar_ps(order, q[k]);
+					quaternion::simd::transpose(q);
+
+					for(int k = 0; k < 4; ++k)
+						_mm512_storeu_ps(&p_Out[i + 4 * k].x, q[k]);
+				}
+
+				decodeRotationAVX2(p_In + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX512 inline void encodePositionAVX512(const float* p_In, uint16_t* p_Out, size_t p_Count, const float* p_Min, const float* p_Scale)
+			{
+				float mins[18], scales[18];
+				repeatAxes(p_Min, mins, 16);
+				repeatAxes(p_Scale, scales, 16);
+
+				__m512 m[3], s[3];
+				for(int j = 0; j < 3; ++j)
+				{
+					m[j] = _mm512_loadu_ps(mins + j * 16 % 3);
+					s[j] = _mm512_loadu_ps(scales + j * 16 % 3);
+				}
+
+				const __m512 zero = _mm512_setzero_ps(), high = _mm512_set1_ps(65535.0f);
+
+				size_t i = 0;
+				for(; i + 48 <= p_Count; i += 48)
+				{
+					for(int j = 0; j < 3; ++j)
+					{
+						__m512 v = _mm512_mul_ps(_mm512_sub_ps(_mm512_loadu_ps(p_In + i + j * 16), m[j]), s[j]);
+						__m512i e = _mm512_cvtps_epi32(_mm512_min_ps(_mm512_max_ps(v, zero), high));
+						_mm256_storeu_si256((__m256i*)(p_Out + i + j * 16), _mm512_cvtepi32_epi16(e));
+					}
+				}
+
+				encodePositionAVX2(p_In + i, p_Out + i, p_Count - i, p_Min, p_Scale);
+			}
+
+			ALFAR_TARGET_AVX512 inline void decodePositionAVX512(const uint16_t* p_In, float* p_Out, size_t p_Count, const float* p_Min, const float* p_Step)
+			{
+				float mins[18], steps[18];
+				repeatAxes(p_Min, mins, 16);
+				repeatAxes(p_Step, steps, 16);
+
+				__m512 m[3], s[3];
+				for(int j = 0; j < 3; ++j)
+				{
+					m[j] = _mm512_loadu_ps(mins + j * 16 % 3);
+					s[j] = _mm512_loadu_ps(steps + j * 16 % 3);
+				}
+
+				size_t i = 0;
+				for(; i + 48 <= p_Count; i += 48)
+				{
+					for(int j = 0; j < 3; ++j)
+					{
+						__m512 v = _mm512_cvtepi32_ps(_mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*)(p_In + i + j * 16))));
+						_mm512_storeu_ps(p_Out + i + j * 16, _mm512_fmadd_ps(v, s[j], m[j]));
+					}
+				}
+
+				decodePositionAVX2(p_In + i, p_Out + i, p_Count - i, p_Min, p_Step);
+			}
+
+#endif
+
+			//===================================================================== dispatch
+
+			inline void toHalf(const float* p_In, uint16_t* p_Out, size_t p_Count)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	toHalfAVX512(p_In, p_Out, p_Count); return;
+				case cpu::LEVEL_AVX2:	toHalfAVX2(p_In, p_Out, p_Count); return;
+				case cpu::LEVEL_SSE2:	toHalfSSE2(p_In, p_Out, p_Count); return;
+#endif
+				default:				toHalfScalar(p_In, p_Out, p_Count); return;
+				}
+			}
+
+			inline void fromHalf(const uint16_t* p_In, float* p_Out, size_t p_Count)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	fromHalfAVX512(p_In, p_Out, p_Count); return;
+				case cpu::LEVEL_AVX2:	fromHalfAVX2(p_In, p_Out, p_Count); return;
+				case cpu::LEVEL_SSE2:	fromHalfSSE2(p_In, p_Out, p_Count); return;
+#endif
+				default:				fromHalfScalar(p_In, p_Out, p_Count); return;
+				}
+			}
+
+			inline void encodeNormal(const Vector3* p_In, NormalOct* p_Out, uint32_t p_Number)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	encodeNormalAVX512(p_In, p_Out, p_Number); return;
+				case cpu::LEVEL_AVX2:	encodeNormalAVX2(p_In, p_Out, p_Number); return;
+				case cpu::LEVEL_SSE2:	encodeNormalSSE2(p_In, p_Out, p_Number); return;
+#endif
+				default:				encodeNormalScalar(p_In, p_Out, p_Number); return;
+				}
+			}
+
+			inline void decodeNormal(const NormalOct* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	decodeNormalAVX512(p_In, p_Out, p_Number); return;
+				case cpu::LEVEL_AVX2:	decodeNormalAVX2(p_In, p_Out, p_Number); return;
+				case cpu::LEVEL_SSE2:	decodeNormalSSE2(p_In, p_Out, p_Number); return;
+#endif
+				default:				decodeNormalScalar(p_In, p_Out, p_Number); return;
+				}
+			}
+
+			inline void encodeRotation(const Quaternion* p_In, QuaternionPacked* p_Out, uint32_t p_Number)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	encodeRotationAVX512(p_In, p_Out, p_Number); return;
+				case cpu::LEVEL_AVX2:	encodeRotationAVX2(p_In, p_Out, p_Number); return;
+				case cpu::LEVEL_SSE2:	encodeRotationSSE2(p_In, p_Out, p_Number); return;
+#endif
+				default:				encodeRotationScalar(p_In, p_Out, p_Number); return;
+				}
+			}
+
+			inline void decodeRotation(const QuaternionPacked* p_In, Quaternion* p_Out, uint32_t p_Number)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	decodeRotationAVX512(p_In, p_Out, p_Number); return;
+				case cpu::LEVEL_AVX2:	decodeRotationAVX2(p_In, p_Out, p_Number); return;
+				case cpu::LEVEL_SSE2:	decodeRotationSSE2(p_In, p_Out, p_Number); return;
+#endif
+				default:				decodeRotationScalar(p_In, p_Out, p_Number); return;
+				}
+			}
+
+			inline void encodePosition(const float* p_In, uint16_t* p_Out, size_t p_Count, const float* p_Min, const float* p_Scale)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	encodePositionAVX512(p_In, p_Out, p_Count, p_Min, p_Scale); return;
+				case cpu::LEVEL_AVX2:	encodePositionAVX2(p_In, p_Out, p_Count, p_Min, p_Scale); return;
+				case cpu::LEVEL_SSE2:	encodePositionSSE2(p_In, p_Out, p_Count, p_Min, p_Scale); return;
+#endif
+				default:				encodePositionScalar(p_In, p_Out, p_Count, p_Min, p_Scale); return;
+				}
+			}
+
+			inline void decodePosition(const uint16_t* p_In, float* p_Out, size_t p_Count, const float* p_Min, const float* p_Step)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	decodePositionAVX512(p_In, p_Out, p_Count, p_Min, p_Step); return;
+				case cpu::LEVEL_AVX2:	decodePositionAVX2(p_In, p_Out, p_Count, p_Min, p_Step); return;
+				case cpu::LEVEL_SSE2:	decodePositionSSE2(p_In, p_Out, p_Count, p_Min, p_Step); return;
+#endif
+				default:				decodePositionScalar(p_In, p_Out, p_Count, p_Min, p_Step); return;
+				}
+			}
+		}
+	}
+}
@@ -2,16 +2,20 @@
 
 #include "math_types.h"
 #include "functions.h"
+#include "fastmath.h"
+#include "vector3.h"
 #include "vector4.h"
+#include "quaternion_simd.h"
+#include <stdint.h>
 
 namespace alfar
 {
     namespace quaternion
     {
 		
-        inline Quaternion create(float x, float y, float z, float w)
+        ALFAR_CONSTEXPR Quaternion create(float x, float y, float z, float w)
         {
-            Quaternion quat;
+            Quaternion quat = {};
             quat.x = x;
             quat.y = y;
             quat.z = z;
@@ -22,14 +26,14 @@ namespace alfar
 
 		//=============================================================
 
-		inline Quaternion identity()
+		ALFAR_CONSTEXPR Quaternion identity()
 		{
 			return create(0,0,0,1);
 		}
 
         //-------------------------------------------------------------
 
-        inline float sqrMagnitude(const Quaternion& p_Quat)
+        ALFAR_CONSTEXPR float sqrMagnitude(const Quaternion& p_Quat)
         {
             return p_Quat.x * p_Quat.x + p_Quat.y * p_Quat.y + p_Quat.z * p_Quat.z + p_Quat.w * p_Quat.w;
         }
@@ -41,10 +45,15 @@ namespace alfar
 
         //---------------------------------------------------------------
 
+        //a zero quaternion stays zero
         inline Quaternion normalized(const Quaternion& p_Quat)
         {
-            Quaternion quat;
+            Quaternion quat = {};
             float mag = magnitude(p_Quat);
+
+            if(mag <= 0)
+                return quat;
+
             quat.x = p_Quat.x / mag;
             quat.y = p_Quat.y / mag;
             quat.z = p_Quat.z / mag;
@@ -53,11 +62,32 @@ namespace alfar
             return quat;
         }
 
+        //normalized and magnitude through rsqrt<P>, see Precision for the relative error
+        //of each tier. Renormalizing after integration or blending only needs REFINED.
+        template<Precision P = PRECISION_REFINED>
+        inline Quaternion fastNormalized(const Quaternion& p_Quat)
+        {
+            float f = lanes::normalizeFactorScalar<P>(sqrMagnitude(p_Quat));
+
+            return create(lanes::normalizeApplyScalar<P>(p_Quat.x, f),
+                          lanes::normalizeApplyScalar<P>(p_Quat.y, f),
+                          lanes::normalizeApplyScalar<P>(p_Quat.z, f),
+                          lanes::normalizeApplyScalar<P>(p_Quat.w, f));
+        }
+
+        template<Precision P = PRECISION_REFINED>
+        inline float fastMagnitude(const Quaternion& p_Quat)
+        {
+            float d = sqrMagnitude(p_Quat);
+
+            return P == PRECISION_EXACT ? sqrtf(d) : d * lanes::normalizeFactorScalar<P>(d);
+        }
+
 		//--------------------------------------------------------------------
 
-		inline Quaternion mul(const Quaternion& a, const Quaternion& b)
+		ALFAR_CONSTEXPR Quaternion mul(const Quaternion& a, const Quaternion& b)
 		{
-			Quaternion quat;
+			Quaternion quat = {};
 
 			quat.w = (a.w*b.w - a.x*b.x - a.y*b.y - a.z*b.z);
 			quat.x = (a.w*b.x + a.x*b.w + a.y*b.z - a.z*b.y);
@@ -71,25 +101,77 @@ namespace alfar
 		
 		inline Quaternion axisAngle(const Vector3& axis, const float angle)
 		{
-			Quaternion quat;
+			float s = 0, c = 0;
+			fastmath::sincos(angle / 2.0f, s, c);
 
-			float angOver2 = angle / 2.0f;
+			return create(axis.x * s, axis.y * s, axis.z * s, c);
+		}
 
-			quat.w = cosf(angOver2);
-			quat.x = axis.x * sinf(angOver2);
-			quat.y = axis.y * sinf(angOver2);
-			quat.z = axis.z * sinf(angOver2);
+		//same as axisAngle with the compile time cos/sin of functions.h
+		ALFAR_CONSTEXPR Quaternion axisAngleConst(const Vector3& axis, const float angle)
+		{
+			float s = constSin(angle / 2.0f);
 
-			return quat;
+			return create(axis.x * s, axis.y * s, axis.z * s, constCos(angle / 2.0f));
+		}
+
+		//=====================================================================
+
+		ALFAR_CONSTEXPR float dot(const Quaternion& a, const Quaternion& b)
+		{
+			return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+		}
+
+		//---------------------------------------------------------------------
+		//interpolations between unit quaternions, along the shortest path (b is
+		//negated when dot(a, b) < 0), for t in [0, 1].
+
+		//normalized linear interpolation: cheap, exact at t = 0, 0.5 and 1, the
+		//angular speed is not constant in between.
+		inline Quaternion nlerp(const Quaternion& a, const Quaternion& b, float t)
+		{
+			Quaternion ret;
+			simd::blendScalar<simd::BLEND_NLERP>(&a, &b, NULL, t, &ret, 1);
+
+			return ret;
+		}
+
+		//spherical linear interpolation through acos/sin
+		inline Quaternion slerp(const Quaternion& a, const Quaternion& b, float t)
+		{
+			float cosAngle = dot(a, b);
+			float sign = cosAngle < 0 ? -1.0f : 1.0f;
+			cosAngle *= sign;
+
+			//sin(angle) goes to 0, the arc is a line at that point
+			if(cosAngle > 0.9995f)
+				return nlerp(a, b, t);
+
+			float angle = acosf(cosAngle);
+			float invSin = 1.0f / sinf(angle);
+			float ca = sinf((1.0f - t) * angle) * invSin;
+			float cb = sinf(t * angle) * invSin * sign;
+
+			return create(ca * a.x + cb * b.x, ca * a.y + cb * b.y, ca * a.z + cb * b.z, ca * a.w + cb * b.w);
+		}
+
+		//slerp through a polynomial instead of acos/sin, within 1.5e-6 of slerp
+		//per component (see quaternion_simd.h). It is what the array version uses.
+		inline Quaternion slerpFast(const Quaternion& a, const Quaternion& b, float t)
+		{
+			Quaternion ret;
+			simd::blendScalar<simd::BLEND_SLERP>(&a, &b, NULL, t, &ret, 1);
+
+			return ret;
 		}
 
 		//=====================================================================
 
-		inline Matrix4x4 toMat4x4(const Quaternion& q)
+		ALFAR_CONSTEXPR Matrix4x4 toMat4x4(const Quaternion& q)
 		{
 			Quaternion uq = approximatly(sqrMagnitude(q), 1.0f) ? q : normalized(q);
 
-			Matrix4x4 mat;
+			Matrix4x4 mat = {};
 
 			mat.x = vector4::create(1 - 2 * uq.y * uq.y - 2 * uq.z * uq.z, 
 									2 * uq.x * uq.y - 2 * uq.w * uq.z,
@@ -98,11 +180,11 @@ namespace alfar
 
 			mat.y = vector4::create(2 * uq.x * uq.y + 2 * uq.w * uq.z,
 									1 - 2 * uq.x * uq.x - 2 * uq.z * uq.z,
-									2 * uq.y * uq.z + 2 * uq.w * uq.x, 
+									2 * uq.y * uq.z - 2 * uq.w * uq.x, 
 									0);
 
 			mat.z = vector4::create(2 * uq.x * uq.z - 2 * uq.w * uq.y,
-									2 * uq.y * uq.z - 2 * uq.w * uq.x,
+									2 * uq.y * uq.z + 2 * uq.w * uq.x,
 									1 - 2 * uq.x * uq.x - 2* uq.y * uq.y,
 									0);
 
@@ -110,5 +192,122 @@ namespace alfar
 
 			return mat;
 		}
+
+		//translation * rotation * scale, q must be a unit quaternion
+		ALFAR_CONSTEXPR Matrix4x4 toMat4x4(const Vector3& translation, const Quaternion& q, const Vector3& scale)
+		{
+			Matrix4x4 mat = {};
+			simd::composeOne(translation, q, scale, mat);
+
+			return mat;
+		}
+
+		//---------------------------------------------------------------------
+
+		//q * v * conjugate(q) for a unit quaternion q, as v + w * t + u x t with
+		//t = 2 * u x v, u = (q.x, q.y, q.z): 2 cross products instead of 2 quaternion products.
+		ALFAR_CONSTEXPR Vector3 rotate(const Quaternion& q, const Vector3& v)
+		{
+			Vector3 u = vector3::create(q.x, q.y, q.z);
+			Vector3 t = vector3::mul(vector3::cross(u, v), 2.0f);
+
+			return vector3::add(vector3::add(v, vector3::mul(t, q.w)), vector3::cross(u, t));
+		}
+
+		//----- array version
+		//p_Out may be either input array; partially overlapping ranges are not supported.
+
+		//p_Out[i] = nlerp(p_Firsts[i], p_Seconds[i], p_T[i])
+		inline void nlerp(const Quaternion* p_Firsts, const Quaternion* p_Seconds, const float* p_T, Quaternion* p_Out, uint32_t p_Number)
+		{
+			simd::blend<simd::BLEND_NLERP>(p_Firsts, p_Seconds, p_T, 0, p_Out, p_Number);
+		}
+
+		//same t for every element
+		inline void nlerp(const Quaternion* p_Firsts, const Quaternion* p_Seconds, float p_T, Quaternion* p_Out, uint32_t p_Number)
+		{
+			simd::blend<simd::BLEND_NLERP>(p_Firsts, p_Seconds, NULL, p_T, p_Out, p_Number);
+		}
+
+		//---------------------------------------------------------------------
+
+		//p_Out[i] = slerpFast(p_Firsts[i], p_Seconds[i], p_T[i])
+		inline void slerp(const Quaternion* p_Firsts, const Quaternion* p_Seconds, const float* p_T, Quaternion* p_Out, uint32_t p_Number)
+		{
+			simd::blend<simd::BLEND_SLERP>(p_Firsts, p_Seconds, p_T, 0, p_Out, p_Number);
+		}
+
+		//same t for every element
+		inline void slerp(const Quaternion* p_Firsts, const Quaternion* p_Seconds, float p_T, Quaternion* p_Out, uint32_t p_Number)
+		{
+			simd::blend<simd::BLEND_SLERP>(p_Firsts, p_Seconds, NULL, p_T, p_Out, p_Number);
+		}
+
+		//---------------------------------------------------------------------
+
+		//p_Out[i] = normalized(p_In[i]) and fastNormalized<P>(p_In[i]), through the
+		//4 floats kernels of vector4_simd.h; p_Out may be p_In.
+		inline void normalized(const Quaternion* p_In, Quaternion* p_Out, uint32_t p_Number)
+		{
+			vector4::simd::normalize<PRECISION_EXACT>(&p_In->x, &p_Out->x, p_Number);
+		}
+
+		template<Precision P = PRECISION_REFINED>
+		inline void fastNormalized(const Quaternion* p_In, Quaternion* p_Out, uint32_t p_Number)
+		{
+			vector4::simd::normalize<P>(&p_In->x, &p_Out->x, p_Number);
+		}
+
+		//p_Out[i] = axisAngle(p_Axes[i], p_Angles[i]), the half angles going through
+		//the fastmath::sincos kernels by blocks
+		inline void axisAngle(const Vector3* p_Axes, const float* p_Angles, Quaternion* p_Out, uint32_t p_Number)
+		{
+			const uint32_t BLOCK = 256;
+			float half[BLOCK], s[BLOCK], c[BLOCK];
+
+			for(uint32_t start = 0; start < p_Number; start += BLOCK)
+			{
+				uint32_t count = p_Number - start < BLOCK ? p_Number - start : BLOCK;
+
+				for(uint32_t i = 0; i < count; ++i)
+					half[i] = p_Angles[start + i] / 2.0f;
+
+				fastmath::sincos(half, s, c, count);
+
+				for(uint32_t i = 0; i < count; ++i)
+				{
+					const Vector3& axis = p_Axes[start + i];
+					p_Out[start + i] = create(axis.x * s[i], axis.y * s[i], axis.z * s[i], c[i]);
+				}
+			}
+		}
+
+		//---------------------------------------------------------------------
+		//the rotations below must be unit quaternions (they are not normalized).
+
+		//p_Out[i] = rotate(q, p_In[i]), through the rotation matrix of q
+		inline void rotate(const Quaternion& q, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+		{
+			vector3::simd::transform<vector3::simd::TRANSFORM_DIRECTION>(toMat4x4(q), p_In, p_Out, p_Number);
+		}
+
+		//p_Out[i] = rotate(p_Rotations[i], p_In[i])
+		inline void rotate(const Quaternion* p_Rotations, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+		{
+			simd::rotate(p_Rotations, p_In, p_Out, p_Number);
+		}
+
+		//p_Out[i] = toMat4x4(p_Rotations[i])
+		inline void toMat4x4(const Quaternion* p_Rotations, Matrix4x4* p_Out, uint32_t p_Number)
+		{
+			simd::compose(NULL, p_Rotations, NULL, p_Out, p_Number);
+		}
+
+		//p_Out[i] = toMat4x4(p_Translations[i], p_Rotations[i], p_Scales[i]).
+		//p_Translations and p_Scales may be NULL for no translation / a unit scale.
+		inline void toMat4x4(const Vector3* p_Translations, const Quaternion* p_Rotations, const Vector3* p_Scales, Matrix4x4* p_Out, uint32_t p_Number)
+		{
+			simd::compose(p_Translations, p_Rotations, p_Scales, p_Out, p_Number);
+		}
     }
-}
\ No newline at end of file
+}
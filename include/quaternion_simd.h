@@ -0,0 +1,834 @@
+#pragma once
+
+#include "math_types.h"
+#include "cpu.h"
+#include "functions.h"
+#include "vector3_simd.h"
+#include <math.h>
+#include <stdint.h>
+
+// SIMD kernels behind the quaternion array functions. Quaternions are
+// transposed to x, y, z, w lanes 4 at a time (per 128 bits lane for AVX2 and
+// AVX-512, so the lanes hold the quaternions in a shuffled order that the
+// transpose back undoes; the per element t are permuted the same way, and
+// the kernels mixing quaternions with Vector3 permute the lanes back to the
+// array order). p_Out may alias an input of the same type exactly.
+//
+// rotate and compose expect unit quaternions.
+//
+// slerp does not call acos/sin: sin(t*a)/sin(a), with cos(a) = x, is the
+// polynomial t * (1 + b1 * (1 + b2 * (1 + ... b12))) where
+// b_i = (u_i * t^2 - v_i) * (x - 1), u_i = 1/(i(2i+1)) and v_i = i/(2i+1)
+// (D. Eberly, "A Fast and Accurate Algorithm for Computing SLERP"), the last
+// term scaled by 1.89372 to balance the truncation error. For x and t in
+// [0, 1] the coefficients are within 7.2e-7 of the exact ones, so every
+// component of the result is within 1.5e-6 of the exact slerp.
+
+namespace alfar
+{
+	namespace quaternion
+	{
+		namespace simd
+		{
+			static_assert(sizeof(Quaternion) == 4 * sizeof(float), "Quaternion must be 4 packed floats");
+
+			enum BlendMode
+			{
+				BLEND_NLERP,
+				BLEND_SLERP
+			};
+
+			const int SLERP_TERMS = 12;
+
+			static const float SLERP_U[SLERP_TERMS] = {
+				0.333333333f, 0.1f, 0.0476190476f, 0.0277777778f, 0.0181818182f, 0.0128205128f,
+				0.00952380952f, 0.00735294118f, 0.00584795322f, 0.00476190476f, 0.00395256917f, 0.0063124f };
+
+			static const float SLERP_V[SLERP_TERMS] = {
+				0.333333333f, 0.4f, 0.428571429f, 0.444444444f, 0.454545455f, 0.461538462f,
+				0.466666667f, 0.470588235f, 0.473684211f, 0.476190476f, 0.47826087f, 0.9089856f };
+
+			//sin(t*a)/sin(a) for p_XMinus1 = cos(a) - 1
+			inline float slerpCoefficient(float p_T, float p_XMinus1)
+			{
+				float t2 = p_T * p_T;
+				float acc = 1.0f;
+
+				for(int i = SLERP_TERMS - 1; i >= 0; --i)
+					acc = 1.0f + (SLERP_U[i] * t2 - SLERP_V[i]) * p_XMinus1 * acc;
+
+				return p_T * acc;
+			}
+
+			//p_T NULL uses p_SharedT for every element
+			template<BlendMode MODE>
+			inline void blendScalar(const Quaternion* p_First, const Quaternion* p_Second, const float* p_T, float p_SharedT, Quaternion* p_Out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+				{
+					Quaternion a = p_First[i];
+					Quaternion b = p_Second[i];
+					float t = p_T ? p_T[i] : p_SharedT;
+
+					//shortest path: q and -q are the same rotation
+					float x = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+					float sign = x < 0 ? -1.0f : 1.0f;
+					x *= sign;
+
+					float ct = t;
+					float cd = 1.0f - t;
+					if(MODE == BLEND_SLERP)
+					{
+						ct = slerpCoefficient(ct, x - 1.0f);
+						cd = slerpCoefficient(cd, x - 1.0f);
+					}
+					ct *= sign;
+
+					Quaternion o;
+					o.x = cd * a.x + ct * b.x;
+					o.y = cd * a.y + ct * b.y;
+					o.z = cd * a.z + ct * b.z;
+					o.w = cd * a.w + ct * b.w;
+
+					if(MODE == BLEND_NLERP)
+					{
+						float inv = 1.0f / sqrtf(o.x * o.x + o.y * o.y + o.z * o.z + o.w * o.w);
+						o.x *= inv;
+						o.y *= inv;
+						o.z *= inv;
+						o.w *= inv;
+					}
+
+					p_Out[i] = o;
+				}
+			}
+
+			//v + w * t + u x t with t = 2 * u x v, u = (q.x, q.y, q.z)
+			inline void rotateScalar(const Quaternion* p_Rotations, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+				{
+					Quaternion q = p_Rotations[i];
+					Vector3 v = p_In[i];
+
+					float tx = 2.0f * (q.y * v.z - q.z * v.y);
+					float ty = 2.0f * (q.z * v.x - q.x * v.z);
+					float tz = 2.0f * (q.x * v.y - q.y * v.x);
+
+					p_Out[i].x = v.x + q.w * tx + (q.y * tz - q.z * ty);
+					p_Out[i].y = v.y + q.w * ty + (q.z * tx - q.x * tz);
+					p_Out[i].z = v.z + q.w * tz + (q.x * ty - q.y * tx);
+				}
+			}
+
+			//translation * rotation * scale
+			ALFAR_CONSTEXPR void composeOne(const Vector3& t, const Quaternion& q, const Vector3& s, Matrix4x4& m)
+			{
+				float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+				float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+				float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+				m.x.x = (1 - 2 * (yy + zz)) * s.x;	m.x.y = 2 * (xy - wz) * s.y;		m.x.z = 2 * (xz + wy) * s.z;		m.x.w = t.x;
+				m.y.x = 2 * (xy + wz) * s.x;		m.y.y = (1 - 2 * (xx + zz)) * s.y;	m.y.z = 2 * (yz - wx) * s.z;		m.y.w = t.y;
+				m.z.x = 2 * (xz - wy) * s.x;		m.z.y = 2 * (yz + wx) * s.y;		m.z.z = (1 - 2 * (xx + yy)) * s.z;	m.z.w = t.z;
+				m.t.x = 0;							m.t.y = 0;							m.t.z = 0;							m.t.w = 1;
+			}
+
+			//p_Translations and p_Scales may be NULL (no translation, unit scale)
+			inline void composeScalar(const Vector3* p_Translations, const Quaternion* p_Rotations, const Vector3* p_Scales, Matrix4x4* p_Out, uint32_t p_Number)
+			{
+				const Vector3 zero = { 0, 0, 0 };
+				const Vector3 one = { 1, 1, 1 };
+
+				for(uint32_t i = 0; i < p_Number; ++i)
+					composeOne(p_Translations ? p_Translations[i] : zero, p_Rotations[i], p_Scales ? p_Scales[i] : one, p_Out[i]);
+			}
+
+#if ALFAR_X86
+
+			ALFAR_TARGET_SSE2 inline void transpose(__m128* r)
+			{
+				_MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+			}
+
+			template<BlendMode MODE>
+			ALFAR_TARGET_SSE2 inline void blendLanes(const __m128* a, const __m128* b, __m128 t, __m128* o)
+			{
+				const __m128 one = _mm_set1_ps(1.0f);
+
+				__m128 x = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])),
+									  _mm_add_ps(_mm_mul_ps(a[2], b[2]), _mm_mul_ps(a[3], b[3])));
+				__m128 sign = _mm_and_ps(x, _mm_set1_ps(-0.0f));
+				x = _mm_xor_ps(x, sign);
+
+				__m128 ct = t;
+				__m128 cd = _mm_sub_ps(one, t);
+				if(MODE == BLEND_SLERP)
+				{
+					__m128 xm1 = _mm_sub_ps(x, one);
+					__m128 t2 = _mm_mul_ps(ct, ct);
+					__m128 d2 = _mm_mul_ps(cd, cd);
+					__m128 accT = one, accD = one;
+
+					for(int i = SLERP_TERMS - 1; i >= 0; --i)
+					{
+						__m128 u = _mm_set1_ps(SLERP_U[i]);
+						__m128 v = _mm_set1_ps(SLERP_V[i]);
+
+						accT = _mm_add_ps(one, _mm_mul_ps(_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(u, t2), v), xm1), accT));
+						accD = _mm_add_ps(one, _mm_mul_ps(_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(u, d2), v), xm1), accD));
+					}
+
+					ct = _mm_mul_ps(ct, accT);
+					cd = _mm_mul_ps(cd, accD);
+				}
+				ct = _mm_xor_ps(ct, sign);
+
+				for(int k = 0; k < 4; ++k)
+					o[k] = _mm_add_ps(_mm_mul_ps(cd, a[k]), _mm_mul_ps(ct, b[k]));
+
+				if(MODE == BLEND_NLERP)
+				{
+					__m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(o[0], o[0]), _mm_mul_ps(o[1], o[1])),
+											 _mm_add_ps(_mm_mul_ps(o[2], o[2]), _mm_mul_ps(o[3], o[3])));
+					__m128 inv = _mm_div_ps(one, _mm_sqrt_ps(len2));
+
+					for(int k = 0; k < 4; ++k)
+						o[k] = _mm_mul_ps(o[k], inv);
+				}
+			}
+
+			template<BlendMode MODE>
+			ALFAR_TARGET_SSE2 inline void blendSSE2(const Quaternion* p_First, const Quaternion* p_Second, const float* p_T, float p_SharedT, Quaternion* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 4 <= p_Number; i += 4)
+				{
+					__m128 a[4], b[4], o[4];
+					for(int k = 0; k < 4; ++k)
+					{
+						a[k] = _mm_loadu_ps(&p_First[i + k].x);
+						b[k] = _mm_loadu_ps(&p_Second[i + k].x);
+					}
+					transpose(a);
+					transpose(b);
+
+					__m128 t = p_T ? _mm_loadu_ps(p_T + i) : _mm_set1_ps(p_SharedT);
+					blendLanes<MODE>(a, b, t, o);
+
+					transpose(o);
+					for(int k = 0; k < 4; ++k)
+						_mm_storeu_ps(&p_Out[i + k].x, o[k]);
+				}
+
+				blendScalar<MODE>(p_First + i, p_Second + i, p_T ? p_T + i : NULL, p_SharedT, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			//v + w * t + u x t with t = 2 * u x v, on x, y, z, w lanes
+			ALFAR_TARGET_SSE2 inline void rotateLanes(const __m128* q, __m128& vx, __m128& vy, __m128& vz)
+			{
+				__m128 tx = _mm_sub_ps(_mm_mul_ps(q[1], vz), _mm_mul_ps(q[2], vy));
+				__m128 ty = _mm_sub_ps(_mm_mul_ps(q[2], vx), _mm_mul_ps(q[0], vz));
+				__m128 tz = _mm_sub_ps(_mm_mul_ps(q[0], vy), _mm_mul_ps(q[1], vx));
+				tx = _mm_add_ps(tx, tx);
+				ty = _mm_add_ps(ty, ty);
+				tz = _mm_add_ps(tz, tz);
+
+				vx = _mm_add_ps(_mm_add_ps(vx, _mm_mul_ps(q[3], tx)), _mm_sub_ps(_mm_mul_ps(q[1], tz), _mm_mul_ps(q[2], ty)));
+				vy = _mm_add_ps(_mm_add_ps(vy, _mm_mul_ps(q[3], ty)), _mm_sub_ps(_mm_mul_ps(q[2], tx), _mm_mul_ps(q[0], tz)));
+				vz = _mm_add_ps(_mm_add_ps(vz, _mm_mul_ps(q[3], tz)), _mm_sub_ps(_mm_mul_ps(q[0], ty), _mm_mul_ps(q[1], tx)));
+			}
+
+			ALFAR_TARGET_SSE2 inline void rotateSSE2(const Quaternion* p_Rotations, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 4 <= p_Number; i += 4)
+				{
+					__m128 q[4];
+					for(int k = 0; k < 4; ++k)
+						q[k] = _mm_loadu_ps(&p_Rotations[i + k].x);
+					transpose(q);
+
+					const float* in = &p_In[i].x;
+					__m128 vx, vy, vz;
+					vector3::simd::deinterleave(_mm_loadu_ps(in), _mm_loadu_ps(in + 4), _mm_loadu_ps(in + 8), vx, vy, vz);
+
+					rotateLanes(q, vx, vy, vz);
+
+					__m128 m0, m1, m2;
+					vector3::simd::interleave(vx, vy, vz, m0, m1, m2);
+
+					float* out = &p_Out[i].x;
+					_mm_storeu_ps(out, m0);
+					_mm_storeu_ps(out + 4, m1);
+					_mm_storeu_ps(out + 8, m2);
+				}
+
+				rotateScalar(p_Rotations + i, p_In + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			//rows of the rotation * scale part, r[3 * row + column], from x, y, z, w lanes
+			ALFAR_TARGET_SSE2 inline void rotationScaleLanes(const __m128* q, __m128 sx, __m128 sy, __m128 sz, __m128* r)
+			{
+				const __m128 one = _mm_set1_ps(1.0f);
+
+				__m128 x2 = _mm_add_ps(q[0], q[0]), y2 = _mm_add_ps(q[1], q[1]), z2 = _mm_add_ps(q[2], q[2]);
+				__m128 xx = _mm_mul_ps(q[0], x2), yy = _mm_mul_ps(q[1], y2), zz = _mm_mul_ps(q[2], z2);
+				__m128 xy = _mm_mul_ps(q[0], y2), xz = _mm_mul_ps(q[0], z2), yz = _mm_mul_ps(q[1], z2);
+				__m128 wx = _mm_mul_ps(q[3], x2), wy = _mm_mul_ps(q[3], y2), wz = _mm_mul_ps(q[3], z2);
+
+				r[0] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx);
+				r[1] = _mm_mul_ps(_mm_sub_ps(xy, wz), sy);
+				r[2] = _mm_mul_ps(_mm_add_ps(xz, wy), sz);
+				r[3] = _mm_mul_ps(_mm_add_ps(xy, wz), sx);
+				r[4] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy);
+				r[5] = _mm_mul_ps(_mm_sub_ps(yz, wx), sz);
+				r[6] = _mm_mul_ps(_mm_sub_ps(xz, wy), sx);
+				r[7] = _mm_mul_ps(_mm_add_ps(yz, wx), sy);
+				r[8] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz);
+			}
+
+			ALFAR_TARGET_SSE2 inline void composeSSE2(const Vector3* p_Translations, const Quaternion* p_Rotations, const Vector3* p_Scales, Matrix4x4* p_Out, uint32_t p_Number)
+			{
+				const __m128 zero = _mm_setzero_ps();
+				const __m128 one = _mm_set1_ps(1.0f);
+				const __m128 bottom = _mm_setr_ps(0, 0, 0, 1);
+
+				uint32_t i = 0;
+				for(; i + 4 <= p_Number; i += 4)
+				{
+					__m128 q[4];
+					for(int k = 0; k < 4; ++k)
+						q[k] = _mm_loadu_ps(&p_Rotations[i + k].x);
+					transpose(q);
+
+					__m128 tx = zero, ty = zero, tz = zero;
+					if(p_Translations)
+					{
+						const float* t = &p_Translations[i].x;
+						vector3::simd::deinterleave(_mm_loadu_ps(t), _mm_loadu_ps(t + 4), _mm_loadu_ps(t + 8), tx, ty, tz);
+					}
+
+					__m128 sx = one, sy = one, sz = one;
+					if(p_Scales)
+					{
+						const float* sc = &p_Scales[i].x;
+						vector3::simd::deinterleave(_mm_loadu_ps(sc), _mm_loadu_ps(sc + 4), _mm_loadu_ps(sc + 8), sx, sy, sz);
+					}
+
+					__m128 r[9];
+					rotationScaleLanes(q, sx, sy, sz, r);
+
+					//each transpose gives one row of the 4 matrices
+					__m128 rows[3][4] = {
+						{ r[0], r[1], r[2], tx },
+						{ r[3], r[4], r[5], ty },
+						{ r[6], r[7], r[8], tz } };
+
+					for(int row = 0; row < 3; ++row)
+					{
+						transpose(rows[row]);
+						for(int k = 0; k < 4; ++k)
+							_mm_storeu_ps(&p_Out[i + k].x.x + 4 * row, rows[row][k]);
+					}
+
+					for(int k = 0; k < 4; ++k)
+						_mm_storeu_ps(&p_Out[i + k].t.x, bottom);
+				}
+
+				composeScalar(p_Translations ? p_Translations + i : NULL, p_Rotations + i, p_Scales ? p_Scales + i : NULL, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			//4x4 transpose inside each 128 bits lane
+			ALFAR_TARGET_AVX2 inline void transpose(__m256* r)
+			{
+				__m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+				__m256 t1 = _mm256_unpacklo_ps(r[2], r[3]);
+				__m256 t2 = _mm256_unpackhi_ps(r[0], r[1]);
+				__m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+
+				r[0] = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+				r[1] = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+				r[2] = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+				r[3] = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+			}
+
+			template<BlendMode MODE>
+			ALFAR_TARGET_AVX2 inline void blendLanes(const __m256* a, const __m256* b, __m256 t, __m256* o)
+			{
+				const __m256 one = _mm256_set1_ps(1.0f);
+
+				__m256 x = _mm256_mul_ps(a[0], b[0]);
+				x = _mm256_fmadd_ps(a[1], b[1], x);
+				x = _mm256_fmadd_ps(a[2], b[2], x);
+				x = _mm256_fmadd_ps(a[3], b[3], x);
+				__m256 sign = _mm256_and_ps(x, _mm256_set1_ps(-0.0f));
+				x = _mm256_xor_ps(x, sign);
+
+				__m256 ct = t;
+				__m256 cd = _mm256_sub_ps(one, t);
+				if(MODE == BLEND_SLERP)
+				{
+					__m256 xm1 = _mm256_sub_ps(x, one);
+					__m256 t2 = _mm256_mul_ps(ct, ct);
+					__m256 d2 = _mm256_mul_ps(cd, cd);
+					__m256 accT = one, accD = one;
+
+					for(int i = SLERP_TERMS - 1; i >= 0; --i)
+					{
+						__m256 u = _mm256_set1_ps(SLERP_U[i]);
+						__m256 v = _mm256_set1_ps(SLERP_V[i]);
+
+						accT = _mm256_fmadd_ps(_mm256_mul_ps(_mm256_fmsub_ps(u, t2, v), xm1), accT, one);
+						accD = _mm256_fmadd_ps(_mm256_mul_ps(_mm256_fmsub_ps(u, d2, v), xm1), accD, one);
+					}
+
+					ct = _mm256_mul_ps(ct, accT);
+					cd = _mm256_mul_ps(cd, accD);
+				}
+				ct = _mm256_xor_ps(ct, sign);
+
+				for(int k = 0; k < 4; ++k)
+					o[k] = _mm256_fmadd_ps(cd, a[k], _mm256_mul_ps(ct, b[k]));
+
+				if(MODE == BLEND_NLERP)
+				{
+					__m256 len2 = _mm256_mul_ps(o[0], o[0]);
+					len2 = _mm256_fmadd_ps(o[1], o[1], len2);
+					len2 = _mm256_fmadd_ps(o[2], o[2], len2);
+					len2 = _mm256_fmadd_ps(o[3], o[3], len2);
+					__m256 inv = _mm256_div_ps(one, _mm256_sqrt_ps(len2));
+
+					for(int k = 0; k < 4; ++k)
+						o[k] = _mm256_mul_ps(o[k], inv);
+				}
+			}
+
+			template<BlendMode MODE>
+			ALFAR_TARGET_AVX2 inline void blendAVX2(const Quaternion* p_First, const Quaternion* p_Second, const float* p_T, float p_SharedT, Quaternion* p_Out, uint32_t p_Number)
+			{
+				//lane j of row k holds quaternion 2k + j
+				const __m256i tOrder = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+
+				uint32_t i = 0;
+				for(; i + 8 <= p_Number; i += 8)
+				{
+					__m256 a[4], b[4], o[4];
+					for(int k = 0; k < 4; ++k)
+					{
+						a[k] = _mm256_loadu_ps(&p_First[i + 2 * k].x);
+						b[k] = _mm256_loadu_ps(&p_Second[i + 2 * k].x);
+					}
+					transpose(a);
+					transpose(b);
+
+					__m256 t = p_T ? _mm256_permutevar8x32_ps(_mm256_loadu_ps(p_T + i), tOrder) : _mm256_set1_ps(p_SharedT);
+					blendLanes<MODE>(a, b, t, o);
+
+					transpose(o);
+					for(int k = 0; k < 4; ++k)
+						_mm256_storeu_ps(&p_Out[i + 2 * k].x, o[k]);
+				}
+
+				blendSSE2<MODE>(p_First + i, p_Second + i, p_T ? p_T + i : NULL, p_SharedT, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			//8 quaternions to x, y, z, w lanes in array order
+			ALFAR_TARGET_AVX2 inline void load8(const Quaternion* p, __m256* q)
+			{
+				const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+				for(int k = 0; k < 4; ++k)
+					q[k] = _mm256_loadu_ps(&p[2 * k].x);
+				transpose(q);
+
+				for(int k = 0; k < 4; ++k)
+					q[k] = _mm256_permutevar8x32_ps(q[k], order);
+			}
+
+			ALFAR_TARGET_AVX2 inline void rotateLanes(const __m256* q, __m256& vx, __m256& vy, __m256& vz)
+			{
+				__m256 tx = _mm256_fmsub_ps(q[1], vz, _mm256_mul_ps(q[2], vy));
+				__m256 ty = _mm256_fmsub_ps(q[2], vx, _mm256_mul_ps(q[0], vz));
+				__m256 tz = _mm256_fmsub_ps(q[0], vy, _mm256_mul_ps(q[1], vx));
+				tx = _mm256_add_ps(tx, tx);
+				ty = _mm256_add_ps(ty, ty);
+				tz = _mm256_add_ps(tz, tz);
+
+				vx = _mm256_add_ps(_mm256_fmadd_ps(q[3], tx, vx), _mm256_fmsub_ps(q[1], tz, _mm256_mul_ps(q[2], ty)));
+				vy = _mm256_add_ps(_mm256_fmadd_ps(q[3], ty, vy), _mm256_fmsub_ps(q[2], tx, _mm256_mul_ps(q[0], tz)));
+				vz = _mm256_add_ps(_mm256_fmadd_ps(q[3], tz, vz), _mm256_fmsub_ps(q[0], ty, _mm256_mul_ps(q[1], tx)));
+			}
+
+			ALFAR_TARGET_AVX2 inline void rotateAVX2(const Quaternion* p_Rotations, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 8 <= p_Number; i += 8)
+				{
+					__m256 q[4];
+					load8(p_Rotations + i, q);
+
+					__m256 m0, m1, m2, vx, vy, vz;
+					vector3::simd::load8(&p_In[i].x, m0, m1, m2);
+					vector3::simd::deinterleave(m0, m1, m2, vx, vy, vz);
+
+					rotateLanes(q, vx, vy, vz);
+
+					vector3::simd::interleave(vx, vy, vz, m0, m1, m2);
+					vector3::simd::store8(&p_Out[i].x, m0, m1, m2);
+				}
+
+				rotateSSE2(p_Rotations + i, p_In + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX2 inline void rotationScaleLanes(const __m256* q, __m256 sx, __m256 sy, __m256 sz, __m256* r)
+			{
+				const __m256 one = _mm256_set1_ps(1.0f);
+
+				__m256 x2 = _mm256_add_ps(q[0], q[0]), y2 = _mm256_add_ps(q[1], q[1]), z2 = _mm256_add_ps(q[2], q[2]);
+				__m256 xx = _mm256_mul_ps(q[0], x2), yy = _mm256_mul_ps(q[1], y2), zz = _mm256_mul_ps(q[2], z2);
+				__m256 xy = _mm256_mul_ps(q[0], y2), xz = _mm256_mul_ps(q[0], z2), yz = _mm256_mul_ps(q[1], z2);
+				__m256 wx = _mm256_mul_ps(q[3], x2), wy = _mm256_mul_ps(q[3], y2), wz = _mm256_mul_ps(q[3], z2);
+
+				r[0] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx);
+				r[1] = _mm256_mul_ps(_mm256_sub_ps(xy, wz), sy);
+				r[2] = _mm256_mul_ps(_mm256_add_ps(xz, wy), sz);
+				r[3] = _mm256_mul_ps(_mm256_add_ps(xy, wz), sx);
+				r[4] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy);
+				r[5] = _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz);
+				r[6] = _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx);
+				r[7] = _mm256_mul_ps(_mm256_add_ps(yz, wx), sy);
+				r[8] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz);
+			}
+
+			ALFAR_TARGET_AVX2 inline void composeAVX2(const Vector3* p_Translations, const Quaternion* p_Rotations, const Vector3* p_Scales, Matrix4x4* p_Out, uint32_t p_Number)
+			{
+				const __m256 zero = _mm256_setzero_ps();
+				const __m256 one = _mm256_set1_ps(1.0f);
+				const __m128 bottom = _mm_setr_ps(0, 0, 0, 1);
+
+				uint32_t i = 0;
+				for(; i + 8 <= p_Number; i += 8)
+				{
+					__m256 q[4];
+					load8(p_Rotations + i, q);
+
+					__m256 m0, m1, m2;
+					__m256 tx = zero, ty = zero, tz = zero;
+					if(p_Translations)
+					{
+						vector3::simd::load8(&p_Translations[i].x, m0, m1, m2);
+						vector3::simd::deinterleave(m0, m1, m2, tx, ty, tz);
+					}
+
+					__m256 sx = one, sy = one, sz = one;
+					if(p_Scales)
+					{
+						vector3::simd::load8(&p_Scales[i].x, m0, m1, m2);
+						vector3::simd::deinterleave(m0, m1, m2, sx, sy, sz);
+					}
+
+					__m256 r[9];
+					rotationScaleLanes(q, sx, sy, sz, r);
+
+					//after the in lane transpose, rows[row][k] holds that row of matrices k and 4 + k
+					__m256 rows[3][4] = {
+						{ r[0], r[1], r[2], tx },
+						{ r[3], r[4], r[5], ty },
+						{ r[6], r[7], r[8], tz } };
+
+					for(int row = 0; row < 3; ++row)
+					{
+						transpose(rows[row]);
+						for(int k = 0; k < 4; ++k)
+						{
+							_mm_storeu_ps(&p_Out[i + k].x.x + 4 * row, _mm256_castps256_ps128(rows[row][k]));
+							_mm_storeu_ps(&p_Out[i + 4 + k].x.x + 4 * row, _mm256_extractf128_ps(rows[row][k], 1));
+						}
+					}
+
+					for(int k = 0; k < 8; ++k)
+						_mm_storeu_ps(&p_Out[i + k].t.x, bottom);
+				}
+
+				composeSSE2(p_Translations ? p_Translations + i : NULL, p_Rotations + i, p_Scales ? p_Scales + i : NULL, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX512 inline void transpose(__m512* r)
+			{
+				__m512 t0 = _mm512_unpacklo_ps(r[0], r[1]);
+				__m512 t1 = _mm512_unpacklo_ps(r[2], r[3]);
+				__m512 t2 = _mm512_unpackhi_ps(r[0], r[1]);
+				__m512 t3 = _mm512_unpackhi_ps(r[2], r[3]);
+
+				r[0] = _mm512_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+				r[1] = _mm512_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+				r[2] = _mm512_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+				r[3] = _mm512_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+			}
+
+			template<BlendMode MODE>
+			ALFAR_TARGET_AVX512 inline void blendLanes(const __m512* a, const __m512* b, __m512 t, __m512* o)
+			{
+				const __m512 one = _mm512_set1_ps(1.0f);
+
+				__m512 x = _mm512_mul_ps(a[0], b[0]);
+				x = _mm512_fmadd_ps(a[1], b[1], x);
+				x = _mm512_fmadd_ps(a[2], b[2], x);
+				x = _mm512_fmadd_ps(a[3], b[3], x);
+				__m512i sign = _mm512_and_epi32(_mm512_castps_si512(x), _mm512_set1_epi32((int)0x80000000));
+				x = _mm512_abs_ps(x);
+
+				__m512 ct = t;
+				__m512 cd = _mm512_sub_ps(one, t);
+				if(MODE == BLEND_SLERP)
+				{
+					__m512 xm1 = _mm512_sub_ps(x, one);
+					__m512 t2 = _mm512_mul_ps(ct, ct);
+					__m512 d2 = _mm512_mul_ps(cd, cd);
+					__m512 accT = one, accD = one;
+
+					for(int i = SLERP_TERMS - 1; i >= 0; --i)
+					{
+						__m512 u = _mm512_set1_ps(SLERP_U[i]);
+						__m512 v = _mm512_set1_ps(SLERP_V[i]);
+
+						accT = _mm512_fmadd_ps(_mm512_mul_ps(_mm512_fmsub_ps(u, t2, v), xm1), accT, one);
+						accD = _mm512_fmadd_ps(_mm512_mul_ps(_mm512_fmsub_ps(u, d2, v), xm1), accD, one);
+					}
+
+					ct = _mm512_mul_ps(ct, accT);
+					cd = _mm512_mul_ps(cd, accD);
+				}
+				ct = _mm512_castsi512_ps(_mm512_xor_epi32(_mm512_castps_si512(ct), sign));
+
+				for(int k = 0; k < 4; ++k)
+					o[k] = _mm512_fmadd_ps(cd, a[k], _mm512_mul_ps(ct, b[k]));
+
+				if(MODE == BLEND_NLERP)
+				{
+					__m512 len2 = _mm512_mul_ps(o[0], o[0]);
+					len2 = _mm512_fmadd_ps(o[1], o[1], len2);
+					len2 = _mm512_fmadd_ps(o[2], o[2], len2);
+					len2 = _mm512_fmadd_ps(o[3], o[3], len2);
+					__m512 inv = _mm512_div_ps(one, _mm512_sqrt_ps(len2));
+
+					for(int k = 0; k < 4; ++k)
+						o[k] = _mm512_mul_ps(o[k], inv);
+				}
+			}
+
+			template<BlendMode MODE>
+			ALFAR_TARGET_AVX512 inline void blendAVX512(const Quaternion* p_First, const Quaternion* p_Second, const float* p_T, float p_SharedT, Quaternion* p_Out, uint32_t p_Number)
+			{
+				//lane j of row k holds quaternion 4k + j
+				const __m512i tOrder = _mm512_setr_epi32(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+
+				uint32_t i = 0;
+				for(; i + 16 <= p_Number; i += 16)
+				{
+					__m512 a[4], b[4], o[4];
+					for(int k = 0; k < 4; ++k)
+					{
+						a[k] = _mm512_loadu_ps(&p_First[i + 4 * k].x);
+						b[k] = _mm512_loadu_ps(&p_Second[i + 4 * k].x);
+					}
+					transpose(a);
+					transpose(b);
+
+					__m512 t = p_T ? _mm512_permutexvar_ps(tOrder, _mm512_loadu_ps(p_T + i)) : _mm512_set1_ps(p_SharedT);
+					blendLanes<MODE>(a, b, t, o);
+
+					transpose(o);
+					for(int k = 0; k < 4; ++k)
+						_mm512_storeu_ps(&p_Out[i + 4 * k].x, o[k]);
+				}
+
+				blendAVX2<MODE>(p_First + i, p_Second + i, p_T ? p_T + i : NULL, p_SharedT, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			//16 quaternions to x, y, z, w lanes in array order
+			ALFAR_TARGET_AVX512 inline void load16(const Quaternion* p, __m512* q)
+			{
+				const __m512i order = _mm512_setr_epi32(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+
+				for(int k = 0; k < 4; ++k)
+					q[k] = _mm512_loadu_ps(&p[4 * k].x);
+				transpose(q);
+
+				for(int k = 0; k < 4; ++k)
+					q[k] = _mm512_permutexvar_ps(order, q[k]);
+			}
+
+			ALFAR_TARGET_AVX512 inline void rotateLanes(const __m512* q, __m512& vx, __m512& vy, __m512& vz)
+			{
+				__m512 tx = _mm512_fmsub_ps(q[1], vz, _mm512_mul_ps(q[2], vy));
+				__m512 ty = _mm512_fmsub_ps(q[2], vx, _mm512_mul_ps(q[0], vz));
+				__m512 tz = _mm512_fmsub_ps(q[0], vy, _mm512_mul_ps(q[1], vx));
+				tx = _mm512_add_ps(tx, tx);
+				ty = _mm512_add_ps(ty, ty);
+				tz = _mm512_add_ps(tz, tz);
+
+				vx = _mm512_add_ps(_mm512_fmadd_ps(q[3], tx, vx), _mm512_fmsub_ps(q[1], tz, _mm512_mul_ps(q[2], ty)));
+				vy = _mm512_add_ps(_mm512_fmadd_ps(q[3], ty, vy), _mm512_fmsub_ps(q[2], tx, _mm512_mul_ps(q[0], tz)));
+				vz = _mm512_add_ps(_mm512_fmadd_ps(q[3], tz, vz), _mm512_fmsub_ps(q[0], ty, _mm512_mul_ps(q[1], tx)));
+			}
+
+			ALFAR_TARGET_AVX512 inline void rotateAVX512(const Quaternion* p_Rotations, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 16 <= p_Number; i += 16)
+				{
+					__m512 q[4];
+					load16(p_Rotations + i, q);
+
+					__m512 m0, m1, m2, vx, vy, vz;
+					vector3::simd::load16(&p_In[i].x, m0, m1, m2);
+					vector3::simd::deinterleave(m0, m1, m2, vx, vy, vz);
+
+					rotateLanes(q, vx, vy, vz);
+
+					vector3::simd::interleave(vx, vy, vz, m0, m1, m2);
+					vector3::simd::store16(&p_Out[i].x, m0, m1, m2);
+				}
+
+				rotateAVX2(p_Rotations + i, p_In + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX512 inline void rotationScaleLanes(const __m512* q, __m512 sx, __m512 sy, __m512 sz, __m512* r)
+			{
+				const __m512 one = _mm512_set1_ps(1.0f);
+
+				__m512 x2 = _mm512_add_ps(q[0], q[0]), y2 = _mm512_add_ps(q[1], q[1]), z2 = _mm512_add_ps(q[2], q[2]);
+				__m512 xx = _mm512_mul_ps(q[0], x2), yy = _mm512_mul_ps(q[1], y2), zz = _mm512_mul_ps(q[2], z2);
+				__m512 xy = _mm512_mul_ps(q[0], y2), xz = _mm512_mul_ps(q[0], z2), yz = _mm512_mul_ps(q[1], z2);
+				__m512 wx = _mm512_mul_ps(q[3], x2), wy = _mm512_mul_ps(q[3], y2), wz = _mm512_mul_ps(q[3], z2);
+
+				r[0] = _mm512_mul_ps(_mm512_sub_ps(one, _mm512_add_ps(yy, zz)), sx);
+				r[1] = _mm512_mul_ps(_mm512_sub_ps(xy, wz), sy);
+				r[2] = _mm512_mul_ps(_mm512_add_ps(xz, wy), sz);
+				r[3] = _mm512_mul_ps(_mm512_add_ps(xy, wz), sx);
+				r[4] = _mm512_mul_ps(_mm512_sub_ps(one, _mm512_add_ps(xx, zz)), sy);
+				r[5] = _mm512_mul_ps(_mm512_sub_ps(yz, wx), sz);
+				r[6] = _mm512_mul_ps(_mm512_sub_ps(xz, wy), sx);
+				r[7] = _mm512_mul_ps(_mm512_add_ps(yz, wx), sy);
+				r[8] = _mm512_mul_ps(_mm512_sub_ps(one, _mm512_add_ps(xx, yy)), sz);
+			}
+
+			ALFAR_TARGET_AVX512 inline void composeAVX512(const Vector3* p_Translations, const Quaternion* p_Rotations, const Vector3* p_Scales, Matrix4x4* p_Out, uint32_t p_Number)
+			{
+				const __m512 zero = _mm512_setzero_ps();
+				const __m512 one = _mm512_set1_ps(1.0f);
+				const __m128 bottom = _mm_setr_ps(0, 0, 0, 1);
+
+				uint32_t i = 0;
+				for(; i + 16 <= p_Number; i += 16)
+				{
+					__m512 q[4];
+					load16(p_Rotations + i, q);
+
+					__m512 m0, m1, m2;
+					__m512 tx = zero, ty = zero, tz = zero;
+					if(p_Translations)
+					{
+						vector3::simd::load16(&p_Translations[i].x, m0, m1, m2);
+						vector3::simd::deinterleave(m0, m1, m2, tx, ty, tz);
+					}
+
+					__m512 sx = one, sy = one, sz = one;
+					if(p_Scales)
+					{
+						vector3::simd::load16(&p_Scales[i].x, m0, m1, m2);
+						vector3::simd::deinterleave(m0, m1, m2, sx, sy, sz);
+					}
+
+					__m512 r[9];
+					rotationScaleLanes(q, sx, sy, sz, r);
+
+					//after the in lane transpose, lane j of rows[row][k] holds that row of matrix 4j + k
+					__m512 rows[3][4] = {
+						{ r[0], r[1], r[2], tx },
+						{ r[3], r[4], r[5], ty },
+						{ r[6], r[7], r[8], tz } };
+
+					for(int row = 0; row < 3; ++row)
+					{
+						transpose(rows[row]);
+						for(int k = 0; k < 4; ++k)
+						{
+							_mm_storeu_ps(&p_Out[i + k].x.x + 4 * row, _mm512_extractf32x4_ps(rows[row][k], 0));
+							_mm_storeu_ps(&p_Out[i + 4 + k].x.x + 4 * row, _mm512_extractf32x4_ps(rows[row][k], 1));
+							_mm_storeu_ps(&p_Out[i + 8 + k].x.x + 4 * row, _mm512_extractf32x4_ps(rows[row][k], 2));
+							_mm_storeu_ps(&p_Out[i + 12 + k].x.x + 4 * row, _mm512_extractf32x4_ps(rows[row][k], 3));
+						}
+					}
+
+					for(int k = 0; k < 16; ++k)
+						_mm_storeu_ps(&p_Out[i + k].t.x, bottom);
+				}
+
+				composeAVX2(p_Translations ? p_Translations + i : NULL, p_Rotations + i, p_Scales ? p_Scales + i : NULL, p_Out + i, p_Number - i);
+			}
+
+#endif
+
+			//===================================================================== dispatch
+
+			template<BlendMode MODE>
+			inline void blend(const Quaternion* p_First, const Quaternion* p_Second, const float* p_T, float p_SharedT, Quaternion* p_Out, uint32_t p_Number)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	blendAVX512<MODE>(p_First, p_Second, p_T, p_SharedT, p_Out, p_Number); return;
+				case cpu::LEVEL_AVX2:	blendAVX2<MODE>(p_First, p_Second, p_T, p_SharedT, p_Out, p_Number); return;
+				case cpu::LEVEL_SSE2:	blendSSE2<MODE>(p_First, p_Second, p_T, p_SharedT, p_Out, p_Number); return;
+#endif
+				default:				blendScalar<MODE>(p_First, p_Second, p_T, p_SharedT, p_Out, p_Number); return;
+				}
+			}
+
+			inline void rotate(const Quaternion* p_Rotations, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	rotateAVX512(p_Rotations, p_In, p_Out, p_Number); return;
+				case cpu::LEVEL_AVX2:	rotateAVX2(p_Rotations, p_In, p_Out, p_Number); return;
+				case cpu::LEVEL_SSE2:	rotateSSE2(p_Rotations, p_In, p_Out, p_Number); return;
+#endif
+				default:				rotateScalar(p_Rotations, p_In, p_Out, p_Number); return;
+				}
+			}
+
+			inline void compose(const Vector3* p_Translations, const Quaternion* p_Rotations, const Vector3* p_Scales, Matrix4x4* p_Out, uint32_t p_Number)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	composeAVX512(p_Translations, p_Rotations, p_Scales, p_Out, p_Number); return;
+				case cpu::LEVEL_AVX2:	composeAVX2(p_Translations, p_Rotations, p_Scales, p_Out, p_Number); return;
+				case cpu::LEVEL_SSE2:	composeSSE2(p_Translations, p_Rotations, p_Scales, p_Out, p_Number); return;
+#endif
+				default:				composeScalar(p_Translations, p_Rotations, p_Scales, p_Out, p_Number); return;
+				}
+			}
+		}
+	}
+}
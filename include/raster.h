@@ -0,0 +1,496 @@
+#pragma once
+
+#include "math_types.h"
+#include "aligned.h"
+#include "vector3.h"
+#include "vector4.h"
+#include "mat4x4.h"
+#include "parallel.h"
+#include "raster_simd.h"
+#include <math.h>
+#include <stdint.h>
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Tiled software rasterizer for occlusion culling (depth only) and small
+// color renders. draw goes through:
+//
+//	- the clip space transform of the vertices by p_ViewProj (view then
+//	  mat4x4::persp, whose depth goes from -w at the near plane to w at the far
+//	  one), with trivial reject of triangles outside one of the clip planes
+//	- clipping against the near plane and a guard band of GUARD_BAND pixels
+//	  around the target (a clipped triangle becomes a fan of up to six), the
+//	  rest is left to the screen bounds and the depth test against the far
+//	  plane clear value
+//	- setup, once per triangle: the vertices snapped to 1/256 of a pixel, the
+//	  edge functions at pixel centers in integers, with the top-left fill rule
+//	  as a bias of -1 on the other edges, and the barycentric gradient of
+//	  vector3::barycentric,
+//	  through which vector4::interpolatedFromBarycentric gives planes of depth,
+//	  1/w and color/w, so a pixel costs no divide (but the 1/w of the
+//	  perspective correct color)
+//	- binning to TILE x TILE tiles, one tile row per task
+//	- the tiles, each on one thread, with the triangles in submission order in
+//	  spans of 4, 8 or 16 pixels (raster_simd.h)
+//
+// Every step runs on the pool of the parallel::Policy. The output does not
+// depend on the thread count, and the coverage is exact: two triangles sharing
+// an edge never both cover, nor both miss, a pixel center on it, on every
+// level and whatever the FTZ/DAZ mode (checked by test/raster_test.cpp). The
+// AVX2 and AVX-512 kernels use FMA, so the depth and color of a pixel may
+// differ in the last bits from SSE2. Front faces are counter-clockwise in
+// normalized device coordinates (x right, y up), pixel (0, 0) is the top left
+// one; the target is at most 65536 pixels across.
+
+namespace alfar
+{
+	namespace raster
+	{
+		const uint32_t TILE = 64;				//a multiple of every span width
+		const uint32_t SETUP_GRAIN = 256;		//triangles per chunk of the setup step
+		const uint32_t SUBPIXEL_BITS = 8;		//vertices snap to 1/256 of a pixel
+		const float GUARD_BAND = 1048576.0f;	//pixels around the target kept by clipping, so the snapped vertices fit in int32
+		const uint32_t MAX_CLIPPED = 8;			//vertices of a triangle clipped by the near plane and the guard band
+
+		enum Cull
+		{
+			CULL_NONE,
+			CULL_BACK
+		};
+
+		inline RasterTarget create(uint32_t p_Width, uint32_t p_Height, bool p_Color)
+		{
+			RasterTarget ret = {};
+			ret.width = p_Width;
+			ret.height = p_Height;
+			ret.pitch = aligned::paddedCount(p_Width);
+
+			size_t pixels = (size_t)ret.pitch * p_Height;
+			ret.depth = (float*)aligned::allocate(pixels * sizeof(float));
+			ret.color = p_Color ? (uint32_t*)aligned::allocate(pixels * sizeof(uint32_t)) : NULL;
+
+			return ret;
+		}
+
+		inline void destroy(RasterTarget& p_Target)
+		{
+			aligned::release(p_Target.depth);
+			aligned::release(p_Target.color);
+
+			p_Target.depth = NULL;
+			p_Target.color = NULL;
+		}
+
+		//depth 1 is the far plane, p_Color is RGBA8 with r in the low byte
+		inline void clear(RasterTarget& p_Target, float p_Depth = 1.0f, uint32_t p_Color = 0)
+		{
+			size_t pixels = (size_t)p_Target.pitch * p_Target.height;
+
+			std::fill(p_Target.depth, p_Target.depth + pixels, p_Depth);
+			if(p_Target.color != NULL)
+				std::fill(p_Target.color, p_Target.color + pixels, p_Color);
+		}
+
+		//---------------------------------------------------------------------
+
+		//signed distance of p_Vertex to clip plane p_Plane, inside when >= 0: the
+		//near plane (z >= -w) then the guard band, |x| <= p_GuardX w, |y| <= p_GuardY w
+		inline float planeDistance(const Vector4& p_Vertex, uint32_t p_Plane, float p_GuardX, float p_GuardY)
+		{
+			switch(p_Plane)
+			{
+			case 0:		return p_Vertex.z + p_Vertex.w;
+			case 1:		return p_GuardX * p_Vertex.w + p_Vertex.x;
+			case 2:		return p_GuardX * p_Vertex.w - p_Vertex.x;
+			case 3:		return p_GuardY * p_Vertex.w + p_Vertex.y;
+			default:	return p_GuardY * p_Vertex.w - p_Vertex.y;
+			}
+		}
+
+		//the part of the clip space polygon p_In (p_Count vertices) inside plane
+		//p_Plane, returns its vertex count (at most one more)
+		inline uint32_t clipPlane(const Vector4* p_In, const Vector4* p_InColors, uint32_t p_Count, uint32_t p_Plane, float p_GuardX, float p_GuardY,
+								  Vector4* p_Out, Vector4* p_OutColors)
+		{
+			uint32_t count = 0;
+
+			for(uint32_t k = 0; k < p_Count; ++k)
+			{
+				uint32_t next = (k + 1) % p_Count;
+				float da = planeDistance(p_In[k], p_Plane, p_GuardX, p_GuardY);
+				float db = planeDistance(p_In[next], p_Plane, p_GuardX, p_GuardY);
+
+				if(da >= 0)
+				{
+					p_Out[count] = p_In[k];
+					p_OutColors[count] = p_InColors[k];
+					++count;
+				}
+
+				//from the inside vertex, so that the triangles sharing the edge cut it at the same point
+				if((da >= 0) != (db >= 0))
+				{
+					uint32_t in = da >= 0 ? k : next;
+					uint32_t out = da >= 0 ? next : k;
+					float t = da >= 0 ? da / (da - db) : db / (db - da);
+
+					p_Out[count] = vector4::lerp(p_In[in], p_In[out], t);
+					p_OutColors[count] = vector4::lerp(p_InColors[in], p_InColors[out], t);
+					++count;
+				}
+			}
+
+			return count;
+		}
+
+		//floor(p_Value / 2^SUBPIXEL_BITS)
+		inline int64_t floorSubpixel(int64_t p_Value)
+		{
+			const int64_t one = (int64_t)1 << SUBPIXEL_BITS;
+			return p_Value >= 0 ? p_Value / one : -((one - 1 - p_Value) / one);
+		}
+
+		//edge functions and planes of a clip space triangle in front of the near
+		//plane and inside the guard band; false when it covers no pixel center or
+		//is culled
+		inline bool setup(const Vector4* p_Clip, const Vector4* p_Colors, const RasterTarget& p_Target, Cull p_Cull, RasterTriangle& t)
+		{
+			const int64_t one = (int64_t)1 << SUBPIXEL_BITS;
+			const int64_t half = one / 2;
+
+			float width = (float)p_Target.width;
+			float height = (float)p_Target.height;
+
+			//screen positions in 1/256 pixels
+			int64_t sx[3], sy[3];
+			Vector4 planes[3], colors[3];
+			for(int k = 0; k < 3; ++k)
+			{
+				float invW = 1.0f / p_Clip[k].w;
+
+				sx[k] = (int64_t)lrintf((p_Clip[k].x * invW + 1.0f) * 0.5f * width * (float)one);
+				sy[k] = (int64_t)lrintf((1.0f - p_Clip[k].y * invW) * 0.5f * height * (float)one);
+				planes[k] = vector4::create(p_Clip[k].z * invW * 0.5f + 0.5f, invW, 0, 0);
+				colors[k] = vector4::mul(p_Colors[k], invW);
+			}
+
+			//twice the signed area, negative for the front faces as y goes down on screen
+			int64_t area = (sx[1] - sx[0]) * (sy[2] - sy[0]) - (sx[2] - sx[0]) * (sy[1] - sy[0]);
+			if(area == 0 || (p_Cull == CULL_BACK && area > 0))
+				return false;
+
+			if(area < 0)
+			{
+				std::swap(sx[1], sx[2]);
+				std::swap(sy[1], sy[2]);
+				std::swap(planes[1], planes[2]);
+				std::swap(colors[1], colors[2]);
+				area = -area;
+			}
+
+			//bounds of the covered pixel centers (x + 0.5, y + 0.5)
+			int64_t minX = std::min(sx[0], std::min(sx[1], sx[2]));
+			int64_t maxX = std::max(sx[0], std::max(sx[1], sx[2]));
+			int64_t minY = std::min(sy[0], std::min(sy[1], sy[2]));
+			int64_t maxY = std::max(sy[0], std::max(sy[1], sy[2]));
+
+			t.minX = (int32_t)std::max(-floorSubpixel(half - minX), (int64_t)0);
+			t.minY = (int32_t)std::max(-floorSubpixel(half - minY), (int64_t)0);
+			t.maxX = (int32_t)std::min(floorSubpixel(maxX - half), (int64_t)p_Target.width - 1);
+			t.maxY = (int32_t)std::min(floorSubpixel(maxY - half), (int64_t)p_Target.height - 1);
+
+			if(t.minX > t.maxX || t.minY > t.maxY)
+				return false;
+
+			//edge i, opposite to vertex i, is positive inside and worth area at vertex i;
+			//at the center of pixel (x, y) it is 256 (a x + b y) + 128 (a + b) + c
+			double invArea = 1.0 / (double)area;
+			Vector3 gradA, gradB, gradC;
+			for(int i = 0; i < 3; ++i)
+			{
+				int j = (i + 1) % 3, k = (i + 2) % 3;
+
+				int64_t a = sy[j] - sy[k];
+				int64_t b = sx[k] - sx[j];
+				int64_t c = half * (a + b) + sx[j] * sy[k] - sy[j] * sx[k];
+
+				//pixel centers on a left or top edge are covered (>= 0), on the others the bias makes > into >=,
+				//then a x + b y >= -c / 256 is a x + b y + floor(c / 256) >= 0 as a x + b y is an integer
+				bool topLeft = a > 0 || (a == 0 && b > 0);
+				t.edgeA[i] = (int32_t)a;
+				t.edgeB[i] = (int32_t)b;
+				t.edgeC[i] = floorSubpixel(topLeft ? c : c - 1);
+
+				//barycentric coordinates of pixel (x, y) are gradA * x + gradB * y + gradC
+				(&gradA.x)[i] = (float)((double)(a * one) * invArea);
+				(&gradB.x)[i] = (float)((double)(b * one) * invArea);
+				(&gradC.x)[i] = (float)((double)c * invArea);
+			}
+
+			t.depthA = vector4::interpolatedFromBarycentric(planes[0], planes[1], planes[2], gradA);
+			t.depthB = vector4::interpolatedFromBarycentric(planes[0], planes[1], planes[2], gradB);
+			t.depthC = vector4::interpolatedFromBarycentric(planes[0], planes[1], planes[2], gradC);
+
+			t.colorA = vector4::interpolatedFromBarycentric(colors[0], colors[1], colors[2], gradA);
+			t.colorB = vector4::interpolatedFromBarycentric(colors[0], colors[1], colors[2], gradB);
+			t.colorC = vector4::interpolatedFromBarycentric(colors[0], colors[1], colors[2], gradC);
+
+			return true;
+		}
+
+		//---------------------------------------------------------------------
+
+		//buffers of draw, kept by each calling thread from one draw to the next
+		struct Scratch
+		{
+			std::vector<Vector4> clip;
+			std::vector<RasterTriangle> triangles;				//one per input triangle, empty ones have minX > maxX
+			std::vector<std::pair<uint32_t, RasterTriangle> > splits;	//the rest of the fans of the clipped triangles
+			std::vector<std::vector<uint32_t> > bins;			//per tile, indices in triangles then splits (after triangles.size())
+			std::mutex splitMutex;
+		};
+
+		inline Scratch& scratch()
+		{
+			static thread_local Scratch s;
+			return s;
+		}
+
+		inline bool splitOrder(const std::pair<uint32_t, RasterTriangle>& a, const std::pair<uint32_t, RasterTriangle>& b)
+		{
+			return a.first < b.first;
+		}
+
+		//trivial reject, clipping and setup of triangle p_Index into p_Scratch.triangles[p_Index]
+		inline void setupTriangle(Scratch& p_Scratch, const RasterTarget& p_Target, const Vector4* p_Colors, const uint32_t* p_Indices, uint32_t p_Index, Cull p_Cull)
+		{
+			RasterTriangle& t = p_Scratch.triangles[p_Index];
+			t.minX = 1;
+			t.maxX = 0;
+
+			//the guard band in normalized device coordinates
+			float guardX = 1.0f + 2.0f * GUARD_BAND / (float)p_Target.width;
+			float guardY = 1.0f + 2.0f * GUARD_BAND / (float)p_Target.height;
+
+			Vector4 clip[MAX_CLIPPED], colors[MAX_CLIPPED];
+			uint32_t outside[6] = { 0, 0, 0, 0, 0, 0 };
+			uint32_t clipped = 0;		//bit p for the vertices outside plane p of planeDistance
+			for(int k = 0; k < 3; ++k)
+			{
+				uint32_t index = p_Indices[p_Index * 3 + k];
+				clip[k] = p_Scratch.clip[index];
+				colors[k] = p_Colors != NULL ? p_Colors[index] : vector4::create(0, 0, 0, 0);
+
+				outside[0] += clip[k].x < -clip[k].w;
+				outside[1] += clip[k].x > clip[k].w;
+				outside[2] += clip[k].y < -clip[k].w;
+				outside[3] += clip[k].y > clip[k].w;
+				outside[4] += clip[k].z < -clip[k].w;
+				outside[5] += clip[k].z > clip[k].w;
+
+				for(uint32_t p = 0; p < 5; ++p)
+					clipped |= (planeDistance(clip[k], p, guardX, guardY) < 0) << p;
+			}
+
+			for(int p = 0; p < 6; ++p)
+			{
+				if(outside[p] == 3)
+					return;
+			}
+
+			if(clipped == 0)
+			{
+				setup(clip, colors, p_Target, p_Cull, t);
+				return;
+			}
+
+			Vector4 other[MAX_CLIPPED], otherColors[MAX_CLIPPED];
+			Vector4* polygon = clip;
+			Vector4* polygonColors = colors;
+			uint32_t count = 3;
+			for(uint32_t p = 0; p < 5 && count >= 3; ++p)
+			{
+				if(clipped & (1 << p))
+				{
+					Vector4* out = polygon == clip ? other : clip;
+					Vector4* outColors = polygon == clip ? otherColors : colors;
+
+					count = clipPlane(polygon, polygonColors, count, p, guardX, guardY, out, outColors);
+					polygon = out;
+					polygonColors = outColors;
+				}
+			}
+
+			if(count < 3)
+				return;
+
+			setup(polygon, polygonColors, p_Target, p_Cull, t);
+
+			//the rest of the fan around polygon[0]
+			for(uint32_t k = 2; k + 1 < count; ++k)
+			{
+				Vector4 fan[3] = { polygon[0], polygon[k], polygon[k + 1] };
+				Vector4 fanColors[3] = { polygonColors[0], polygonColors[k], polygonColors[k + 1] };
+
+				RasterTriangle split;
+				if(setup(fan, fanColors, p_Target, p_Cull, split))
+				{
+					std::lock_guard<std::mutex> lock(p_Scratch.splitMutex);
+					p_Scratch.splits.push_back(std::make_pair(p_Index, split));
+				}
+			}
+		}
+
+		//appends triangle p_Index to the bins of tile row p_Row it overlaps
+		inline void binTriangle(Scratch& p_Scratch, const RasterTriangle& t, uint32_t p_Index, uint32_t p_Row, uint32_t p_TilesX)
+		{
+			int32_t top = (int32_t)(p_Row * TILE);
+			if(t.minX > t.maxX || t.maxY < top || t.minY >= top + (int32_t)TILE)
+				return;
+
+			std::vector<uint32_t>* bins = &p_Scratch.bins[p_Row * p_TilesX];
+			for(int32_t x = t.minX / (int32_t)TILE; x <= t.maxX / (int32_t)TILE; ++x)
+				bins[x].push_back(p_Index);
+		}
+
+		//---------------------------------------------------------------------
+
+		//rasterizes the p_TriangleCount triangles p_Indices[3 i], p_Indices[3 i + 1],
+		//p_Indices[3 i + 2] of p_Positions (p_VertexCount of them) into p_Target,
+		//with the vertex colors p_Colors when both they and the color buffer exist.
+		inline void draw(const parallel::Policy& p_Policy, RasterTarget& p_Target, const Matrix4x4& p_ViewProj, const Vector3* p_Positions, uint32_t p_VertexCount,
+						 const Vector4* p_Colors, const uint32_t* p_Indices, uint32_t p_TriangleCount, Cull p_Cull = CULL_NONE)
+		{
+			if(p_Target.width == 0 || p_Target.height == 0)
+				return;
+
+			Scratch& s = scratch();
+			s.clip.resize(p_VertexCount);
+			s.triangles.resize(p_TriangleCount);
+			s.splits.clear();
+
+			Vector4* clip = s.clip.data();
+			parallel::forRange(p_Policy, p_VertexCount, [=](uint32_t p_Start, uint32_t p_End)
+			{
+				for(uint32_t i = p_Start; i < p_End; ++i)
+					clip[i] = vector4::mul(p_ViewProj, vector4::create(p_Positions[i].x, p_Positions[i].y, p_Positions[i].z, 1.0f));
+			});
+
+			parallel::forEach(p_Policy, p_TriangleCount, SETUP_GRAIN, [&](uint32_t p_Start, uint32_t p_End)
+			{
+				for(uint32_t i = p_Start; i < p_End; ++i)
+					setupTriangle(s, p_Target, p_Colors, p_Indices, i, p_Cull);
+			});
+
+			//the pieces of one triangle stay in fan order
+			std::stable_sort(s.splits.begin(), s.splits.end(), splitOrder);
+
+			uint32_t tilesX = (p_Target.width + TILE - 1) / TILE;
+			uint32_t tilesY = (p_Target.height + TILE - 1) / TILE;
+			s.bins.resize(tilesX * tilesY);
+
+			//in submission order, the rest of a fan right after its first triangle
+			parallel::forEach(p_Policy, tilesY, 1, [&](uint32_t p_Start, uint32_t p_End)
+			{
+				for(uint32_t row = p_Start; row < p_End; ++row)
+				{
+					for(uint32_t x = 0; x < tilesX; ++x)
+						s.bins[row * tilesX + x].clear();
+
+					size_t split = 0;
+					for(uint32_t i = 0; i < p_TriangleCount; ++i)
+					{
+						binTriangle(s, s.triangles[i], i, row, tilesX);
+
+						for(; split < s.splits.size() && s.splits[split].first == i; ++split)
+							binTriangle(s, s.splits[split].second, p_TriangleCount + (uint32_t)split, row, tilesX);
+					}
+				}
+			});
+
+			//the splits go after the triangles, so the bin indices address one array
+			for(size_t k = 0; k < s.splits.size(); ++k)
+				s.triangles.push_back(s.splits[k].second);
+
+			bool color = p_Target.color != NULL && p_Colors != NULL;
+			const RasterTriangle* triangles = s.triangles.data();
+
+			parallel::forEach(p_Policy, tilesX * tilesY, 1, [&](uint32_t p_Start, uint32_t p_End)
+			{
+				for(uint32_t tile = p_Start; tile < p_End; ++tile)
+				{
+					const std::vector<uint32_t>& bin = s.bins[tile];
+					if(bin.empty())
+						continue;
+
+					int32_t x0 = (int32_t)((tile % tilesX) * TILE);
+					int32_t y0 = (int32_t)((tile / tilesX) * TILE);
+					int32_t x1 = std::min(x0 + (int32_t)TILE, (int32_t)p_Target.width);
+					int32_t y1 = std::min(y0 + (int32_t)TILE, (int32_t)p_Target.height);
+
+					if(color)
+						simd::tile<true>(triangles, bin.data(), (uint32_t)bin.size(), p_Target, x0, y0, x1, y1);
+					else
+						simd::tile<false>(triangles, bin.data(), (uint32_t)bin.size(), p_Target, x0, y0, x1, y1);
+				}
+			});
+		}
+
+		inline void draw(RasterTarget& p_Target, const Matrix4x4& p_ViewProj, const Vector3* p_Positions, uint32_t p_VertexCount,
+						 const Vector4* p_Colors, const uint32_t* p_Indices, uint32_t p_TriangleCount, Cull p_Cull = CULL_NONE)
+		{
+			draw(parallel::policy(), p_Target, p_ViewProj, p_Positions, p_VertexCount, p_Colors, p_Indices, p_TriangleCount, p_Cull);
+		}
+
+		//---------------------------------------------------------------------
+
+		//true when p_Box is hidden by what is already in the depth buffer (or off
+		//screen): every pixel of its screen bounds is nearer than its nearest
+		//corner. Conservative, a box crossing the near plane is never occluded.
+		inline bool occluded(const RasterTarget& p_Target, const Matrix4x4& p_ViewProj, const AABB& p_Box)
+		{
+			float minX = std::numeric_limits<float>::infinity(), minY = minX, minDepth = minX;
+			float maxX = -minX, maxY = -minX;
+
+			for(int k = 0; k < 8; ++k)
+			{
+				Vector4 corner = vector4::create(k & 1 ? p_Box.max.x : p_Box.min.x, k & 2 ? p_Box.max.y : p_Box.min.y, k & 4 ? p_Box.max.z : p_Box.min.z, 1.0f);
+				Vector4 c = vector4::mul(p_ViewProj, corner);
+
+				if(c.z < -c.w || c.w <= 0)
+					return false;
+
+				float invW = 1.0f / c.w;
+				float sx = (c.x * invW + 1.0f) * 0.5f * p_Target.width;
+				float sy = (1.0f - c.y * invW) * 0.5f * p_Target.height;
+
+				minX = std::min(minX, sx);
+				maxX = std::max(maxX, sx);
+				minY = std::min(minY, sy);
+				maxY = std::max(maxY, sy);
+				minDepth = std::min(minDepth, c.z * invW * 0.5f + 0.5f);
+			}
+
+			//every pixel the box may touch, not only the covered centers
+			int32_t x0 = (int32_t)std::max(floorf(minX), 0.0f);
+			int32_t y0 = (int32_t)std::max(floorf(minY), 0.0f);
+			int32_t x1 = (int32_t)std::min(ceilf(maxX), (float)p_Target.width);
+			int32_t y1 = (int32_t)std::min(ceilf(maxY), (float)p_Target.height);
+
+			for(int32_t y = y0; y < y1; ++y)
+			{
+				const float* depth = p_Target.depth + (size_t)y * p_Target.pitch;
+				for(int32_t x = x0; x < x1; ++x)
+				{
+					if(!(depth[x] < minDepth))
+						return false;
+				}
+			}
+
+			return true;
+		}
+	}
+}
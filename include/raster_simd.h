@@ -0,0 +1,408 @@
+#pragma once
+
+#include "math_types.h"
+#include "cpu.h"
+#include <stdint.h>
+
+// SIMD kernels behind raster.h: a set up triangle over a rectangle of pixels
+// (part of one tile), one row at a time in spans of 4 (SSE2), 8 (AVX2) or 16
+// (AVX-512) pixels. The covered columns of a row come from the integer edge
+// functions, walked down the rows exactly (EdgeWalk), so they are the same on
+// every level; a span starts on a multiple of its width, so the depth and
+// color loads are aligned (rows start on 64 bytes), and its pixels are covered
+// when their column is in the row's.
+// The depth test is less than, and the color is the perspective correct
+// color/w plane over the 1/w plane, clamped to [0, 1] and packed to RGBA8.
+//
+// The planes are evaluated from scratch at each span (an FMA per value), so
+// no error accumulates along the rows.
+
+namespace alfar
+{
+	namespace raster
+	{
+		namespace simd
+		{
+			inline uint32_t packColor(float r, float g, float b, float a)
+			{
+				r = r < 0 ? 0 : (r > 1 ? 1 : r);
+				g = g < 0 ? 0 : (g > 1 ? 1 : g);
+				b = b < 0 ? 0 : (b > 1 ? 1 : b);
+				a = a < 0 ? 0 : (a > 1 ? 1 : a);
+
+				return (uint32_t)(r * 255.0f + 0.5f) | ((uint32_t)(g * 255.0f + 0.5f) << 8) | ((uint32_t)(b * 255.0f + 0.5f) << 16) | ((uint32_t)(a * 255.0f + 0.5f) << 24);
+			}
+
+			//the edges of a triangle walked down its rows, exactly: x[i] is the first
+			//column inside edge i when edgeA[i] > 0, the last one when < 0, and v[i]
+			//the edge there, in [0, |edgeA[i]|) (the edge on the whole row when 0)
+			struct EdgeWalk
+			{
+				int64_t x[3], v[3];
+				int64_t size[3];		//|edgeA[i]|
+				int64_t rest[3];		//edgeB[i] mod size[i], added to v[i] per row
+				int64_t step[3];		//moves of x[i] per row, before the carry of v[i]
+				int64_t dir[3];			//move of x[i] per carry, -1 when edgeA[i] > 0, 1 when < 0
+			};
+
+			//floor(p_Value / p_Divisor), p_Divisor > 0
+			inline int64_t floorDiv(int64_t p_Value, int64_t p_Divisor)
+			{
+				int64_t q = p_Value / p_Divisor;
+				return q * p_Divisor > p_Value ? q - 1 : q;
+			}
+
+			inline void startWalk(const RasterTriangle& t, int32_t y, EdgeWalk& w)
+			{
+				for(int i = 0; i < 3; ++i)
+				{
+					int64_t a = t.edgeA[i];
+					int64_t b = t.edgeB[i];
+					int64_t r = b * y + t.edgeC[i];
+
+					if(a == 0)
+					{
+						w.x[i] = 0;
+						w.v[i] = r;
+						w.size[i] = 0;
+						w.rest[i] = b;
+						w.step[i] = 0;
+						w.dir[i] = 0;
+						continue;
+					}
+
+					//a x + r >= 0 from x = ceil(-r / a) on, or up to x = floor(r / -a)
+					w.size[i] = a > 0 ? a : -a;
+					w.dir[i] = a > 0 ? -1 : 1;
+					w.x[i] = w.dir[i] * floorDiv(r, w.size[i]);
+					w.v[i] = a * w.x[i] + r;
+
+					int64_t q = floorDiv(b, w.size[i]);
+					w.rest[i] = b - q * w.size[i];
+					w.step[i] = w.dir[i] * q;
+				}
+			}
+
+			inline void nextRow(EdgeWalk& w)
+			{
+				for(int i = 0; i < 3; ++i)
+				{
+					//masks rather than a branch, the carry is as good as random (size and dir are 0 when edgeA[i] is)
+					w.v[i] += w.rest[i];
+					int64_t carry = -(int64_t)(w.v[i] >= w.size[i]);
+					w.v[i] -= w.size[i] & carry;
+					w.x[i] += w.step[i] + (w.dir[i] & carry);
+				}
+			}
+
+			//narrows [p_Start, p_End) to the columns of the current row inside every edge
+			inline void rowSpan(const EdgeWalk& w, int32_t& p_Start, int32_t& p_End)
+			{
+				int64_t start = p_Start, end = p_End;
+				bool empty = false;
+				for(int i = 0; i < 3; ++i)
+				{
+					int64_t x = w.x[i];
+					start = w.dir[i] < 0 && x > start ? x : start;
+					end = w.dir[i] > 0 && x + 1 < end ? x + 1 : end;
+					empty |= w.dir[i] == 0 && w.v[i] < 0;
+				}
+				end = empty ? start : end;
+
+				if(start >= end)
+					p_End = p_Start;
+				else
+				{
+					p_Start = (int32_t)start;
+					p_End = (int32_t)end;
+				}
+			}
+
+			//pixels [x0, x1) x [y0, y1) of p_Tri, inside its bounds
+			template<bool COLOR>
+			inline void rasterizeScalar(const RasterTriangle& t, const RasterTarget& p_Target, int32_t x0, int32_t y0, int32_t x1, int32_t y1)
+			{
+				EdgeWalk walk;
+				startWalk(t, y0, walk);
+
+				for(int32_t y = y0; y < y1; ++y, nextRow(walk))
+				{
+					int32_t xs = x0, xe = x1;
+					rowSpan(walk, xs, xe);
+
+					float fy = (float)y;
+					float* depth = p_Target.depth + (size_t)y * p_Target.pitch;
+					uint32_t* color = COLOR ? p_Target.color + (size_t)y * p_Target.pitch : NULL;
+
+					for(int32_t x = xs; x < xe; ++x)
+					{
+						float fx = (float)x;
+						float z = t.depthA.x * fx + (t.depthB.x * fy + t.depthC.x);
+						if(!(z < depth[x]))
+							continue;
+
+						depth[x] = z;
+
+						if(COLOR)
+						{
+							float w = 1.0f / (t.depthA.y * fx + (t.depthB.y * fy + t.depthC.y));
+							color[x] = packColor((t.colorA.x * fx + (t.colorB.x * fy + t.colorC.x)) * w,
+												 (t.colorA.y * fx + (t.colorB.y * fy + t.colorC.y)) * w,
+												 (t.colorA.z * fx + (t.colorB.z * fy + t.colorC.z)) * w,
+												 (t.colorA.w * fx + (t.colorB.w * fy + t.colorC.w)) * w);
+						}
+					}
+				}
+			}
+
+#if ALFAR_X86
+
+			//===================================================================== SSE2
+
+			ALFAR_TARGET_SSE2 inline __m128i packColorSSE2(__m128 r, __m128 g, __m128 b, __m128 a)
+			{
+				const __m128 zero = _mm_setzero_ps();
+				const __m128 one = _mm_set1_ps(1.0f);
+				const __m128 scale = _mm_set1_ps(255.0f);
+				const __m128 half = _mm_set1_ps(0.5f);
+
+				__m128i ri = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(r, zero), one), scale), half));
+				__m128i gi = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(g, zero), one), scale), half));
+				__m128i bi = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(b, zero), one), scale), half));
+				__m128i ai = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(a, zero), one), scale), half));
+
+				return _mm_or_si128(_mm_or_si128(ri, _mm_slli_epi32(gi, 8)), _mm_or_si128(_mm_slli_epi32(bi, 16), _mm_slli_epi32(ai, 24)));
+			}
+
+			template<bool COLOR>
+			ALFAR_TARGET_SSE2 inline void rasterizeSSE2(const RasterTriangle& t, const RasterTarget& p_Target, int32_t x0, int32_t y0, int32_t x1, int32_t y1)
+			{
+				const __m128 lane = _mm_setr_ps(0, 1, 2, 3);
+
+				__m128 zA = _mm_set1_ps(t.depthA.x), wA = _mm_set1_ps(t.depthA.y);
+				__m128 cA[4] = { _mm_set1_ps(t.colorA.x), _mm_set1_ps(t.colorA.y), _mm_set1_ps(t.colorA.z), _mm_set1_ps(t.colorA.w) };
+
+				EdgeWalk walk;
+				startWalk(t, y0, walk);
+
+				for(int32_t y = y0; y < y1; ++y, nextRow(walk))
+				{
+					int32_t xs = x0, xe = x1;
+					rowSpan(walk, xs, xe);
+					if(xs >= xe)
+						continue;
+
+					__m128 start = _mm_set1_ps((float)xs);
+					__m128 end = _mm_set1_ps((float)xe);
+
+					float fy = (float)y;
+					__m128 rz = _mm_set1_ps(t.depthB.x * fy + t.depthC.x);
+
+					float* depth = p_Target.depth + (size_t)y * p_Target.pitch;
+					uint32_t* color = COLOR ? p_Target.color + (size_t)y * p_Target.pitch : NULL;
+
+					for(int32_t x = xs & ~3; x < xe; x += 4)
+					{
+						__m128 px = _mm_add_ps(_mm_set1_ps((float)x), lane);
+
+						__m128 mask = _mm_and_ps(_mm_cmpge_ps(px, start), _mm_cmplt_ps(px, end));
+
+						__m128 z = _mm_add_ps(_mm_mul_ps(zA, px), rz);
+						__m128 d = _mm_load_ps(depth + x);
+						mask = _mm_and_ps(mask, _mm_cmplt_ps(z, d));
+						if(_mm_movemask_ps(mask) == 0)
+							continue;
+
+						_mm_store_ps(depth + x, _mm_or_ps(_mm_and_ps(mask, z), _mm_andnot_ps(mask, d)));
+
+						if(COLOR)
+						{
+							__m128 w = _mm_div_ps(_mm_set1_ps(1.0f), _mm_add_ps(_mm_mul_ps(wA, px), _mm_set1_ps(t.depthB.y * fy + t.depthC.y)));
+							__m128 c[4];
+							for(int k = 0; k < 4; ++k)
+								c[k] = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(cA[k], px), _mm_set1_ps((&t.colorB.x)[k] * fy + (&t.colorC.x)[k])), w);
+
+							__m128 packed = _mm_castsi128_ps(packColorSSE2(c[0], c[1], c[2], c[3]));
+							__m128 old = _mm_load_ps((const float*)(color + x));
+							_mm_store_ps((float*)(color + x), _mm_or_ps(_mm_and_ps(mask, packed), _mm_andnot_ps(mask, old)));
+						}
+					}
+				}
+			}
+
+			//===================================================================== AVX2
+
+			ALFAR_TARGET_AVX2 inline __m256i packColorAVX2(__m256 r, __m256 g, __m256 b, __m256 a)
+			{
+				const __m256 zero = _mm256_setzero_ps();
+				const __m256 one = _mm256_set1_ps(1.0f);
+				const __m256 scale = _mm256_set1_ps(255.0f);
+				const __m256 half = _mm256_set1_ps(0.5f);
+
+				__m256i ri = _mm256_cvttps_epi32(_mm256_fmadd_ps(_mm256_min_ps(_mm256_max_ps(r, zero), one), scale, half));
+				__m256i gi = _mm256_cvttps_epi32(_mm256_fmadd_ps(_mm256_min_ps(_mm256_max_ps(g, zero), one), scale, half));
+				__m256i bi = _mm256_cvttps_epi32(_mm256_fmadd_ps(_mm256_min_ps(_mm256_max_ps(b, zero), one), scale, half));
+				__m256i ai = _mm256_cvttps_epi32(_mm256_fmadd_ps(_mm256_min_ps(_mm256_max_ps(a, zero), one), scale, half));
+
+				return _mm256_or_si256(_mm256_or_si256(ri, _mm256_slli_epi32(gi, 8)), _mm256_or_si256(_mm256_slli_epi32(bi, 16), _mm256_slli_epi32(ai, 24)));
+			}
+
+			template<bool COLOR>
+			ALFAR_TARGET_AVX2 inline void rasterizeAVX2(const RasterTriangle& t, const RasterTarget& p_Target, int32_t x0, int32_t y0, int32_t x1, int32_t y1)
+			{
+				const __m256 lane = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+
+				__m256 zA = _mm256_set1_ps(t.depthA.x), wA = _mm256_set1_ps(t.depthA.y);
+				__m256 cA[4] = { _mm256_set1_ps(t.colorA.x), _mm256_set1_ps(t.colorA.y), _mm256_set1_ps(t.colorA.z), _mm256_set1_ps(t.colorA.w) };
+
+				EdgeWalk walk;
+				startWalk(t, y0, walk);
+
+				for(int32_t y = y0; y < y1; ++y, nextRow(walk))
+				{
+					int32_t xs = x0, xe = x1;
+					rowSpan(walk, xs, xe);
+					if(xs >= xe)
+						continue;
+
+					__m256 start = _mm256_set1_ps((float)xs);
+					__m256 end = _mm256_set1_ps((float)xe);
+
+					float fy = (float)y;
+					__m256 rz = _mm256_set1_ps(t.depthB.x * fy + t.depthC.x);
+
+					float* depth = p_Target.depth + (size_t)y * p_Target.pitch;
+					uint32_t* color = COLOR ? p_Target.color + (size_t)y * p_Target.pitch : NULL;
+
+					for(int32_t x = xs & ~7; x < xe; x += 8)
+					{
+						__m256 px = _mm256_add_ps(_mm256_set1_ps((float)x), lane);
+
+						__m256 mask = _mm256_and_ps(_mm256_cmp_ps(px, start, _CMP_GE_OQ), _mm256_cmp_ps(px, end, _CMP_LT_OQ));
+
+						__m256 z = _mm256_fmadd_ps(zA, px, rz);
+						__m256 d = _mm256_load_ps(depth + x);
+						mask = _mm256_and_ps(mask, _mm256_cmp_ps(z, d, _CMP_LT_OQ));
+						if(_mm256_movemask_ps(mask) == 0)
+							continue;
+
+						_mm256_store_ps(depth + x, _mm256_blendv_ps(d, z, mask));
+
+						if(COLOR)
+						{
+							__m256 w = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_fmadd_ps(wA, px, _mm256_set1_ps(t.depthB.y * fy + t.depthC.y)));
+							__m256 c[4];
+							for(int k = 0; k < 4; ++k)
+								c[k] = _mm256_mul_ps(_mm256_fmadd_ps(cA[k], px, _mm256_set1_ps((&t.colorB.x)[k] * fy + (&t.colorC.x)[k])), w);
+
+							__m256 packed = _mm256_castsi256_ps(packColorAVX2(c[0], c[1], c[2], c[3]));
+							__m256 old = _mm256_load_ps((const float*)(color + x));
+							_mm256_store_ps((float*)(color + x), _mm256_blendv_ps(old, packed, mask));
+						}
+					}
+				}
+			}
+
+			//===================================================================== AVX-512
+
+			ALFAR_TARGET_AVX512 inline __m512i packColorAVX512(__m512 r, __m512 g, __m512 b, __m512 a)
+			{
+				const __m512 zero = _mm512_setzero_ps();
+				const __m512 one = _mm512_set1_ps(1.0f);
+				const __m512 scale = _mm512_set1_ps(255.0f);
+				const __m512 half = _mm512_set1_ps(0.5f);
+
+				__m512i ri = _mm512_cvttps_epi32(_mm512_fmadd_ps(_mm512_min_ps(_mm512_max_ps(r, zero), one), scale, half));
+				__m512i gi = _mm512_cvttps_epi32(_mm512_fmadd_ps(_mm512_min_ps(_mm512_max_ps(g, zero), one), scale, half));
+				__m512i bi = _mm512_cvttps_epi32(_mm512_fmadd_ps(_mm512_min_ps(_mm512_max_ps(b, zero), one), scale, half));
+				__m512i ai = _mm512_cvttps_epi32(_mm512_fmadd_ps(_mm512_min_ps(_mm512_max_ps(a, zero), one), scale, half));
+
+				return _mm512_or_si512(_mm512_or_si512(ri, _mm512_slli_epi32(gi, 8)), _mm512_or_si512(_mm512_slli_epi32(bi, 16), _mm512_slli_epi32(ai, 24)));
+			}
+
+			template<bool COLOR>
+			ALFAR_TARGET_AVX512 inline void rasterizeAVX512(const RasterTriangle& t, const RasterTarget& p_Target, int32_t x0, int32_t y0, int32_t x1, int32_t y1)
+			{
+				const __m512 lane = _mm512_setr_ps(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+				__m512 zA = _mm512_set1_ps(t.depthA.x), wA = _mm512_set1_ps(t.depthA.y);
+				__m512 cA[4] = { _mm512_set1_ps(t.colorA.x), _mm512_set1_ps(t.colorA.y), _mm512_set1_ps(t.colorA.z), _mm512_set1_ps(t.colorA.w) };
+
+				EdgeWalk walk;
+				startWalk(t, y0, walk);
+
+				for(int32_t y = y0; y < y1; ++y, nextRow(walk))
+				{
+					int32_t xs = x0, xe = x1;
+					rowSpan(walk, xs, xe);
+					if(xs >= xe)
+						continue;
+
+					__m512 start = _mm512_set1_ps((float)xs);
+					__m512 end = _mm512_set1_ps((float)xe);
+
+					float fy = (float)y;
+					__m512 rz = _mm512_set1_ps(t.depthB.x * fy + t.depthC.x);
+
+					float* depth = p_Target.depth + (size_t)y * p_Target.pitch;
+					uint32_t* color = COLOR ? p_Target.color + (size_t)y * p_Target.pitch : NULL;
+
+					for(int32_t x = xs & ~15; x < xe; x += 16)
+					{
+						__m512 px = _mm512_add_ps(_mm512_set1_ps((float)x), lane);
+
+						__mmask16 mask = _mm512_mask_cmp_ps_mask(_mm512_cmp_ps_mask(px, start, _CMP_GE_OQ), px, end, _CMP_LT_OQ);
+
+						__m512 z = _mm512_fmadd_ps(zA, px, rz);
+						mask = _mm512_mask_cmp_ps_mask(mask, z, _mm512_load_ps(depth + x), _CMP_LT_OQ);
+						if(mask == 0)
+							continue;
+
+						_mm512_mask_store_ps(depth + x, mask, z);
+
+						if(COLOR)
+						{
+							__m512 w = _mm512_div_ps(_mm512_set1_ps(1.0f), _mm512_fmadd_ps(wA, px, _mm512_set1_ps(t.depthB.y * fy + t.depthC.y)));
+							__m512 c[4];
+							for(int k = 0; k < 4; ++k)
+								c[k] = _mm512_mul_ps(_mm512_fmadd_ps(cA[k], px, _mm512_set1_ps((&t.colorB.x)[k] * fy + (&t.colorC.x)[k])), w);
+
+							_mm512_mask_store_epi32(color + x, mask, packColorAVX512(c[0], c[1], c[2], c[3]));
+						}
+					}
+				}
+			}
+
+#endif
+
+			//===================================================================== tiles
+
+			//the p_Count triangles p_Triangles[p_Bin[k]] in order over the tile [x0, x1) x [y0, y1)
+			template<bool COLOR>
+			inline void tile(const RasterTriangle* p_Triangles, const uint32_t* p_Bin, uint32_t p_Count, const RasterTarget& p_Target, int32_t x0, int32_t y0, int32_t x1, int32_t y1)
+			{
+				cpu::Level level = cpu::level();
+
+				for(uint32_t k = 0; k < p_Count; ++k)
+				{
+					const RasterTriangle& t = p_Triangles[p_Bin[k]];
+
+					int32_t tx0 = t.minX > x0 ? t.minX : x0;
+					int32_t ty0 = t.minY > y0 ? t.minY : y0;
+					int32_t tx1 = t.maxX + 1 < x1 ? t.maxX + 1 : x1;
+					int32_t ty1 = t.maxY + 1 < y1 ? t.maxY + 1 : y1;
+
+					switch(level)
+					{
+#if ALFAR_X86
+					case cpu::LEVEL_AVX512:	rasterizeAVX512<COLOR>(t, p_Target, tx0, ty0, tx1, ty1); break;
+					case cpu::LEVEL_AVX2:	rasterizeAVX2<COLOR>(t, p_Target, tx0, ty0, tx1, ty1); break;
+					case cpu::LEVEL_SSE2:	rasterizeSSE2<COLOR>(t, p_Target, tx0, ty0, tx1, ty1); break;
+#endif
+					default:				rasterizeScalar<COLOR>(t, p_Target, tx0, ty0, tx1, ty1); break;
+					}
+				}
+			}
+		}
+	}
+}
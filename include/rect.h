@@ -0,0 +1,98 @@
+#pragma once
+
+#include "math_types.h"
+#include "functions.h"
+#include "vector2.h"
+#include "bounds_simd.h"
+#include <stdint.h>
+#include <limits>
+
+// 2D axis aligned rectangles, same conventions as aabb.h: inclusive bounds,
+// empty() is the identity of merge.
+
+namespace alfar
+{
+	namespace rect
+	{
+		static_assert(sizeof(Rect) == 4 * sizeof(float), "Rect must be 4 packed floats");
+
+		ALFAR_CONSTEXPR Rect create(const Vector2& p_Min, const Vector2& p_Max)
+		{
+			Rect ret = {};
+			ret.min = p_Min;
+			ret.max = p_Max;
+
+			return ret;
+		}
+
+		ALFAR_CONSTEXPR Rect empty()
+		{
+			return create(vector2::create(std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity()),
+						  vector2::create(-std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()));
+		}
+
+		ALFAR_CONSTEXPR bool isEmpty(const Rect& p_Rect)
+		{
+			return p_Rect.min.x > p_Rect.max.x || p_Rect.min.y > p_Rect.max.y;
+		}
+
+		//---------------------------------------------------------------------
+
+		ALFAR_CONSTEXPR Vector2 center(const Rect& p_Rect)
+		{
+			return vector2::mul(vector2::add(p_Rect.min, p_Rect.max), 0.5f);
+		}
+
+		ALFAR_CONSTEXPR Vector2 size(const Rect& p_Rect)
+		{
+			return vector2::sub(p_Rect.max, p_Rect.min);
+		}
+
+		//---------------------------------------------------------------------
+
+		ALFAR_CONSTEXPR Rect merge(const Rect& a, const Rect& b)
+		{
+			return create(vector2::min(a.min, b.min), vector2::max(a.max, b.max));
+		}
+
+		ALFAR_CONSTEXPR Rect merge(const Rect& p_Rect, const Vector2& p_Point)
+		{
+			return create(vector2::min(p_Rect.min, p_Point), vector2::max(p_Rect.max, p_Point));
+		}
+
+		//---------------------------------------------------------------------
+
+		ALFAR_CONSTEXPR bool contains(const Rect& p_Rect, const Vector2& p_Point)
+		{
+			return p_Point.x >= p_Rect.min.x && p_Point.x <= p_Rect.max.x
+				&& p_Point.y >= p_Rect.min.y && p_Point.y <= p_Rect.max.y;
+		}
+
+		ALFAR_CONSTEXPR bool contains(const Rect& p_Rect, const Rect& p_Inner)
+		{
+			return !isEmpty(p_Inner) && contains(p_Rect, p_Inner.min) && contains(p_Rect, p_Inner.max);
+		}
+
+		ALFAR_CONSTEXPR bool overlap(const Rect& a, const Rect& b)
+		{
+			return a.min.x <= b.max.x && b.min.x <= a.max.x
+				&& a.min.y <= b.max.y && b.min.y <= a.max.y;
+		}
+
+		//----- array version
+
+		inline Rect fromPoints(const Vector2* p_Points, uint32_t p_Number)
+		{
+			Rect ret;
+			bounds::simd::bounds<2>(&p_Points->x, &ret.min.x, &ret.max.x, p_Number);
+
+			return ret;
+		}
+
+		//bit i % 32 of p_Out[i / 32] = overlap(p_Rect, p_Rects[i]). p_Out holds (p_Number + 31) / 32 words.
+		inline void overlap(const Rect& p_Rect, const Rect* p_Rects, uint32_t p_Number, uint32_t* p_Out)
+		{
+			bounds::simd::overlap<2>(&p_Rect.min.x, &p_Rects->min.x, p_Out, p_Number);
+		}
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "math_types.h"
+#include "functions.h"
+#include "fastmath.h"
+#include "vector2.h"
+#include "sprite_simd.h"
+#include <stdint.h>
+
+// 2D sprite quads: a size x size rectangle rotated around its pivot, which
+// lands on position. corners expands sprites to the 4 corners of their quad,
+// in the order (0, 0), (1, 0), (1, 1), (0, 1) of the unit quad, so
+// counter-clockwise when y goes up. The rotation is kept as (cos, sin) so the
+// batch is multiplies and adds only, create and setAngle pay the sincos.
+
+namespace alfar
+{
+	namespace sprite
+	{
+		inline Sprite create(const Vector2& p_Position, const Vector2& p_Size, float p_Angle, const Vector2& p_Pivot = vector2::create(0.5f, 0.5f))
+		{
+			Sprite ret = {};
+			ret.position = p_Position;
+			ret.size = p_Size;
+			ret.pivot = p_Pivot;
+			fastmath::sincos(p_Angle, ret.rotation.y, ret.rotation.x);
+
+			return ret;
+		}
+
+		inline void setAngle(Sprite& p_Sprite, float p_Angle)
+		{
+			fastmath::sincos(p_Angle, p_Sprite.rotation.y, p_Sprite.rotation.x);
+		}
+
+		//---------------------------------------------------------------------
+
+		//the 4 corners of p_Sprite in p_Out
+		inline void corners(const Sprite& p_Sprite, Vector2* p_Out)
+		{
+			float ax = -p_Sprite.pivot.x * p_Sprite.size.x, bx = ax + p_Sprite.size.x;
+			float ay = -p_Sprite.pivot.y * p_Sprite.size.y, by = ay + p_Sprite.size.y;
+
+			p_Out[0] = vector2::add(p_Sprite.position, vector2::rotate(vector2::create(ax, ay), p_Sprite.rotation));
+			p_Out[1] = vector2::add(p_Sprite.position, vector2::rotate(vector2::create(bx, ay), p_Sprite.rotation));
+			p_Out[2] = vector2::add(p_Sprite.position, vector2::rotate(vector2::create(bx, by), p_Sprite.rotation));
+			p_Out[3] = vector2::add(p_Sprite.position, vector2::rotate(vector2::create(ax, by), p_Sprite.rotation));
+		}
+
+		//----- array version
+
+		//corners of p_Sprites[i] in p_Out[4 i] to p_Out[4 i + 3]; p_Out holds 4 * p_Number vectors
+		inline void corners(const Sprite* p_Sprites, Vector2* p_Out, uint32_t p_Number)
+		{
+			simd::corners(p_Sprites, p_Out, p_Number);
+		}
+	}
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "sprite.h"
+#include "parallel.h"
+#include <stdint.h>
+
+// Sprite corners over the pool of a Policy.
+
+namespace alfar
+{
+	namespace sprite
+	{
+		inline void corners(const parallel::Policy& p_Policy, const Sprite* p_Sprites, Vector2* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { corners(p_Sprites + p_Start, p_Out + p_Start * 4, p_End - p_Start); });
+		}
+	}
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "math_types.h"
+#include "cpu.h"
+#include <stdint.h>
+
+// SIMD kernels behind sprite::corners. A sprite is 8 floats (position, size,
+// pivot, rotation) and gives 8 floats (its 4 corners). SSE2 transposes 4
+// sprites to x/y/size/pivot/cos/sin lanes and the 4 corners back. AVX2 keeps
+// one sprite per register (two per AVX-512 register): lane permutes repeat
+// position, size, pivot, cos and sin over the 4 corners, and with the corner
+// offsets l = (uv - pivot) * size two fmaddsub give
+//
+//	even lanes	x + cos lx - sin ly
+//	odd lanes	y + cos ly + sin lx
+//
+// with no transpose. SSE2 finishes the remaining sprites with scalar code,
+// AVX-512 with the AVX2 kernel.
+
+namespace alfar
+{
+	namespace sprite
+	{
+		namespace simd
+		{
+			static_assert(sizeof(Sprite) == 8 * sizeof(float), "Sprite must be 8 packed floats");
+
+			//----- scalar tails
+
+			inline void cornersScalar(const Sprite* p_Sprites, Vector2* p_Out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+				{
+					const Sprite& s = p_Sprites[i];
+					float ax = -s.pivot.x * s.size.x, bx = ax + s.size.x;
+					float ay = -s.pivot.y * s.size.y, by = ay + s.size.y;
+					float c = s.rotation.x, sn = s.rotation.y;
+
+					Vector2* o = p_Out + i * 4;
+					o[0].x = s.position.x + c * ax - sn * ay; o[0].y = s.position.y + sn * ax + c * ay;
+					o[1].x = s.position.x + c * bx - sn * ay; o[1].y = s.position.y + sn * bx + c * ay;
+					o[2].x = s.position.x + c * bx - sn * by; o[2].y = s.position.y + sn * bx + c * by;
+					o[3].x = s.position.x + c * ax - sn * by; o[3].y = s.position.y + sn * ax + c * by;
+				}
+			}
+
+#if ALFAR_X86
+
+			//===================================================================== SSE2
+
+			ALFAR_TARGET_SSE2 inline void cornersSSE2(const Sprite* p_Sprites, Vector2* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 4 <= p_Number; i += 4)
+				{
+					const float* p = &p_Sprites[i].position.x;
+					float* o = &p_Out[i * 4].x;
+
+					__m128 px = _mm_loadu_ps(p), py = _mm_loadu_ps(p + 8), sx = _mm_loadu_ps(p + 16), sy = _mm_loadu_ps(p + 24);
+					__m128 vx = _mm_loadu_ps(p + 4), vy = _mm_loadu_ps(p + 12), c = _mm_loadu_ps(p + 20), s = _mm_loadu_ps(p + 28);
+					_MM_TRANSPOSE4_PS(px, py, sx, sy);
+					_MM_TRANSPOSE4_PS(vx, vy, c, s);
+
+					__m128 ax = _mm_mul_ps(_mm_sub_ps(_mm_setzero_ps(), vx), sx), bx = _mm_add_ps(ax, sx);
+					__m128 ay = _mm_mul_ps(_mm_sub_ps(_mm_setzero_ps(), vy), sy), by = _mm_add_ps(ay, sy);
+
+					__m128 cax = _mm_add_ps(px, _mm_mul_ps(c, ax)), cbx = _mm_add_ps(px, _mm_mul_ps(c, bx));
+					__m128 sax = _mm_add_ps(py, _mm_mul_ps(s, ax)), sbx = _mm_add_ps(py, _mm_mul_ps(s, bx));
+					__m128 say = _mm_mul_ps(s, ay), sby = _mm_mul_ps(s, by);
+					__m128 cay = _mm_mul_ps(c, ay), cby = _mm_mul_ps(c, by);
+
+					__m128 x0 = _mm_sub_ps(cax, say), y0 = _mm_add_ps(sax, cay);
+					__m128 x1 = _mm_sub_ps(cbx, say), y1 = _mm_add_ps(sbx, cay);
+					__m128 x2 = _mm_sub_ps(cbx, sby), y2 = _mm_add_ps(sbx, cby);
+					__m128 x3 = _mm_sub_ps(cax, sby), y3 = _mm_add_ps(sax, cby);
+
+					//after the transposes x0, y0, x1, y1 hold corners 0-1 of sprites 0 to 3, x2, y2, x3, y3 their corners 2-3
+					_MM_TRANSPOSE4_PS(x0, y0, x1, y1);
+					_MM_TRANSPOSE4_PS(x2, y2, x3, y3);
+
+					_mm_storeu_ps(o, x0); _mm_storeu_ps(o + 4, x2);
+					_mm_storeu_ps(o + 8, y0); _mm_storeu_ps(o + 12, y2);
+					_mm_storeu_ps(o + 16, x1); _mm_storeu_ps(o + 20, x3);
+					_mm_storeu_ps(o + 24, y1); _mm_storeu_ps(o + 28, y3);
+				}
+
+				cornersScalar(p_Sprites + i, p_Out + i * 4, p_Number - i);
+			}
+
+			//===================================================================== AVX2
+
+			ALFAR_TARGET_AVX2 inline void cornersAVX2(const Sprite* p_Sprites, Vector2* p_Out, uint32_t p_Number)
+			{
+				const __m256i position = _mm256_setr_epi32(0, 1, 0, 1, 0, 1, 0, 1);
+				const __m256i size = _mm256_setr_epi32(2, 3, 2, 3, 2, 3, 2, 3);
+				const __m256i pivot = _mm256_setr_epi32(4, 5, 4, 5, 4, 5, 4, 5);
+				const __m256 uv = _mm256_setr_ps(0, 0, 1, 0, 1, 1, 0, 1);
+
+				uint32_t i = 0;
+				for(; i < p_Number; ++i)
+				{
+					__m256 v = _mm256_loadu_ps(&p_Sprites[i].position.x);
+
+					__m256 l = _mm256_mul_ps(_mm256_sub_ps(uv, _mm256_permutevar8x32_ps(v, pivot)), _mm256_permutevar8x32_ps(v, size));
+					__m256 c = _mm256_permutevar8x32_ps(v, _mm256_set1_epi32(6));
+					__m256 s = _mm256_permutevar8x32_ps(v, _mm256_set1_epi32(7));
+
+					__m256 q = _mm256_fmaddsub_ps(s, _mm256_permute_ps(l, _MM_SHUFFLE(2, 3, 0, 1)), _mm256_permutevar8x32_ps(v, position));
+					_mm256_storeu_ps(&p_Out[i * 4].x, _mm256_fmaddsub_ps(c, l, q));
+				}
+			}
+
+			//===================================================================== AVX-512
+
+			ALFAR_TARGET_AVX512 inline void cornersAVX512(const Sprite* p_Sprites, Vector2* p_Out, uint32_t p_Number)
+			{
+				const __m512i position = _mm512_setr_epi32(0, 1, 0, 1, 0, 1, 0, 1, 8, 9, 8, 9, 8, 9, 8, 9);
+				const __m512i size = _mm512_setr_epi32(2, 3, 2, 3, 2, 3, 2, 3, 10, 11, 10, 11, 10, 11, 10, 11);
+				const __m512i pivot = _mm512_setr_epi32(4, 5, 4, 5, 4, 5, 4, 5, 12, 13, 12, 13, 12, 13, 12, 13);
+				const __m512i cosine = _mm512_setr_epi32(6, 6, 6, 6, 6, 6, 6, 6, 14, 14, 14, 14, 14, 14, 14, 14);
+				const __m512i sine = _mm512_setr_epi32(7, 7, 7, 7, 7, 7, 7, 7, 15, 15, 15, 15, 15, 15, 15, 15);
+				const __m512 uv = _mm512_setr_ps(0, 0, 1, 0, 1, 1, 0, 1, 0, 0, 1, 0, 1, 1, 0, 1);
+
+				uint32_t i = 0;
+				for(; i + 2 <= p_Number; i += 2)
+				{
+					__m512 v = _mm512_loadu_ps(&p_Sprites[i].position.x);
+
+					__m512 l = _mm512_mul_ps(_mm512_sub_ps(uv, _mm512_permutexvar_ps(pivot, v)), _mm512_permutexvar_ps(size, v));
+					__m512 c = _mm512_permutexvar_ps(cosine, v);
+					__m512 s = _mm512_permutexvar_ps(sine, v);
+
+					__m512 q = _mm512_fmaddsub_ps(s, _mm512_permute_ps(l, _MM_SHUFFLE(2, 3, 0, 1)), _mm512_permutexvar_ps(position, v));
+					_mm512_storeu_ps(&p_Out[i * 4].x, _mm512_fmaddsub_ps(c, l, q));
+				}
+
+				cornersAVX2(p_Sprites + i, p_Out + i * 4, p_Number - i);
+			}
+
+#endif
+
+			//===================================================================== dispatch
+
+			inline void corners(const Sprite* p_Sprites, Vector2* p_Out, uint32_t p_Number)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	cornersAVX512(p_Sprites, p_Out, p_Number); return;
+				case cpu::LEVEL_AVX2:	cornersAVX2(p_Sprites, p_Out, p_Number); return;
+				case cpu::LEVEL_SSE2:	cornersSSE2(p_Sprites, p_Out, p_Number); return;
+#endif
+				default:				cornersScalar(p_Sprites, p_Out, p_Number); return;
+				}
+			}
+		}
+	}
+}
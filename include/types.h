@@ -1,12 +1,14 @@
 #ifndef _ALFAR_TYPES_H
 #define _ALFAR_TYPES_H
 
-#if _WIN64
-
 #include <stdint.h>
 
+#ifndef TRUE
 #define TRUE	1
+#endif
+#ifndef FALSE
 #define FALSE	0
+#endif
 
 typedef uint8_t uint8;
 typedef uint16_t uint16;
@@ -20,5 +22,3 @@ typedef float float32;
 typedef double float64;
 
 #endif
-
-#endif
\ No newline at end of file
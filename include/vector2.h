@@ -1,25 +1,29 @@
 #pragma once
 
 #include "math_types.h"
+#include "functions.h"
+#include "lanes.h"
+#include "vector2_simd.h"
 #include <stdint.h>
+#include <string.h>
 #include <memory>
 
 namespace alfar
 {
     namespace vector2
     {
-        inline Vector2 create(float x, float y)
+        ALFAR_CONSTEXPR Vector2 create(float x, float y)
         {
-            Vector2 ret;
+            Vector2 ret = {};
             ret.x = x;
             ret.y = y;
 
 			return ret;
         }
 
-        inline Vector2 add(const Vector2& p_First, const Vector2& p_Second)
+        ALFAR_CONSTEXPR Vector2 add(const Vector2& p_First, const Vector2& p_Second)
         {
-            Vector2 ret;
+            Vector2 ret = {};
             ret.x = p_First.x + p_Second.x;
             ret.y = p_First.y + p_Second.y;
 
@@ -28,9 +32,9 @@ namespace alfar
 
         //---------------------------------------------------------------------
 
-        inline Vector2 sub(const Vector2& p_First, const Vector2& p_Second)
+        ALFAR_CONSTEXPR Vector2 sub(const Vector2& p_First, const Vector2& p_Second)
         {
-            Vector2 ret;
+            Vector2 ret = {};
             ret.x = p_First.x - p_Second.x;
             ret.y = p_First.y - p_Second.y;
 
@@ -39,9 +43,9 @@ namespace alfar
 
         //---------------------------------------------------------------------
 
-        inline Vector2 mul(const Vector2& p_Vec, const float p_Scalar)
+        ALFAR_CONSTEXPR Vector2 mul(const Vector2& p_Vec, const float p_Scalar)
         {
-            Vector2 ret;
+            Vector2 ret = {};
             ret.x = p_Vec.x * p_Scalar;
             ret.y = p_Vec.y * p_Scalar;
 
@@ -50,9 +54,9 @@ namespace alfar
 
         //-----------------------------------------------------------------------
 
-        inline Vector2 scale(const Vector2& p_First, const Vector2& p_Second)
+        ALFAR_CONSTEXPR Vector2 scale(const Vector2& p_First, const Vector2& p_Second)
         {
-            Vector2 ret;
+            Vector2 ret = {};
             ret.x = p_First.x * p_Second.x;
             ret.y = p_First.y * p_Second.y;
 
@@ -61,14 +65,38 @@ namespace alfar
 
         //---------------------------------------------------------------------------
 
-        inline float dot(const Vector2& p_First, const Vector2& p_Second)
+        ALFAR_CONSTEXPR float dot(const Vector2& p_First, const Vector2& p_Second)
         {
             return p_First.x * p_Second.x + p_First.y * p_Second.y;
         }
 
         //-------------------------------------------------------------------------
 
-        inline float sqrMagnitude(const Vector2& p_Vector)
+        //component wise
+        ALFAR_CONSTEXPR Vector2 min(const Vector2& p_First, const Vector2& p_Second)
+        {
+            return create(p_First.x < p_Second.x ? p_First.x : p_Second.x,
+                          p_First.y < p_Second.y ? p_First.y : p_Second.y);
+        }
+
+        ALFAR_CONSTEXPR Vector2 max(const Vector2& p_First, const Vector2& p_Second)
+        {
+            return create(p_First.x > p_Second.x ? p_First.x : p_Second.x,
+                          p_First.y > p_Second.y ? p_First.y : p_Second.y);
+        }
+
+        //-------------------------------------------------------------------------
+
+        //p_Vec rotated counter-clockwise by the angle whose (cos, sin) is p_Rotation
+        ALFAR_CONSTEXPR Vector2 rotate(const Vector2& p_Vec, const Vector2& p_Rotation)
+        {
+            return create(p_Rotation.x * p_Vec.x - p_Rotation.y * p_Vec.y,
+                          p_Rotation.y * p_Vec.x + p_Rotation.x * p_Vec.y);
+        }
+
+        //-------------------------------------------------------------------------
+
+        ALFAR_CONSTEXPR float sqrMagnitude(const Vector2& p_Vector)
         {
             return p_Vector.x * p_Vector.x + p_Vector.y * p_Vector.y;
         }
@@ -90,75 +118,35 @@ namespace alfar
 
         inline void add(Vector2* p_Firsts, Vector2* p_Seconds, Vector2* p_Out, uint32_t p_Number)
         {
-            for(uint32_t i = 0; i < p_Number; ++i)
-            {
-                alfar::Vector2& o = *(p_Out+i);
-                alfar::Vector2& a = *(p_Firsts+i);
-                alfar::Vector2& b = *(p_Seconds+i);
-
-                o.x = a.x + b.x;
-                o.y = a.y + b.y;
-            }
+            lanes::binary<lanes::OP_ADD>(&p_Firsts->x, &p_Seconds->x, &p_Out->x, (size_t)p_Number * 2);
         }
 
         //---------------------------------------------------------------------------
 
         inline void sub(Vector2* p_Firsts, Vector2* p_Seconds, Vector2* p_Out, uint32_t p_Number)
         {
-            for(uint32_t i = 0; i < p_Number; ++i)
-            {
-                alfar::Vector2& o = *(p_Out+i);
-                alfar::Vector2& a = *(p_Firsts+i);
-                alfar::Vector2& b = *(p_Seconds+i);
-
-                o.x = a.x - b.x;
-                o.y = a.y - b.y;
-            }
+            lanes::binary<lanes::OP_SUB>(&p_Firsts->x, &p_Seconds->x, &p_Out->x, (size_t)p_Number * 2);
         }
 
         //------------------------------------------------------------------------------
 
         inline void mul(Vector2* p_Firsts, float* p_Scalars, Vector2* p_Out, uint32_t p_Number)
         {
-            for(uint32_t i = 0; i < p_Number; ++i)
-            {
-                alfar::Vector2& o = *(p_Out+i);
-                alfar::Vector2& a = *(p_Firsts+i);
-                float& s = *(p_Scalars+i);
-
-                o.x = a.x * s;
-                o.y = a.y * s;
-            }
+            simd::mul(p_Firsts, p_Scalars, p_Out, p_Number);
         }
 
         //----------------------------------------------------------------------------------
 
         inline void scale(Vector2* p_Firsts, Vector2* p_Seconds, Vector2* p_Out, uint32_t p_Number)
         {
-            for(uint32_t i = 0; i < p_Number; ++i)
-            {
-                alfar::Vector2& o = *(p_Out+i);
-                alfar::Vector2& a = *(p_Firsts+i);
-                alfar::Vector2& b = *(p_Seconds+i);
-
-                o.x = a.x * b.x;
-                o.y = a.y * b.y;
-            }
+            lanes::binary<lanes::OP_SCALE>(&p_Firsts->x, &p_Seconds->x, &p_Out->x, (size_t)p_Number * 2);
         }
 
         //--------------------------------------------------------------------------------------
 
-        void dot(Vector2* p_Firsts, Vector2* p_Seconds, float* p_Out, uint32_t p_Number)
+        inline void dot(Vector2* p_Firsts, Vector2* p_Seconds, float* p_Out, uint32_t p_Number)
         {
-            for(uint32_t i = 0; i < p_Number; ++i)
-            {
-                float& o = *(p_Out+i);
-                alfar::Vector2& a = *(p_Firsts+i);
-                alfar::Vector2& b = *(p_Seconds+i);
-
-                o = a.x * b.x + a.y * b.y;
-            }
+            simd::dot(p_Firsts, p_Seconds, p_Out, p_Number);
         }
     }
 }
-
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "vector2.h"
+#include "parallel.h"
+#include <stdint.h>
+
+// The Policy overloads of the vector2 array functions.
+
+namespace alfar
+{
+	namespace vector2
+	{
+		inline void add(const parallel::Policy& p_Policy, Vector2* p_Firsts, Vector2* p_Seconds, Vector2* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { add(p_Firsts + p_Start, p_Seconds + p_Start, p_Out + p_Start, p_End - p_Start); });
+		}
+
+		//--------------------------------------------------------------------------
+
+		inline void sub(const parallel::Policy& p_Policy, Vector2* p_Firsts, Vector2* p_Seconds, Vector2* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { sub(p_Firsts + p_Start, p_Seconds + p_Start, p_Out + p_Start, p_End - p_Start); });
+		}
+
+		//--------------------------------------------------------------------------
+
+		inline void mul(const parallel::Policy& p_Policy, Vector2* p_Firsts, float* p_Scalars, Vector2* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { mul(p_Firsts + p_Start, p_Scalars + p_Start, p_Out + p_Start, p_End - p_Start); });
+		}
+
+		//--------------------------------------------------------------------------
+
+		inline void scale(const parallel::Policy& p_Policy, Vector2* p_Firsts, Vector2* p_Seconds, Vector2* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { scale(p_Firsts + p_Start, p_Seconds + p_Start, p_Out + p_Start, p_End - p_Start); });
+		}
+
+		//--------------------------------------------------------------------------
+
+		inline void dot(const parallel::Policy& p_Policy, Vector2* p_Firsts, Vector2* p_Seconds, float* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { dot(p_Firsts + p_Start, p_Seconds + p_Start, p_Out + p_Start, p_End - p_Start); });
+		}
+	}
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+#include "math_types.h"
+#include "cpu.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// SIMD kernels behind the vector2 array functions. Vector2 arrays are packed
+// float pairs, so element-wise ops (add, sub, scale) run on the flat float
+// stream through lanes.h. mul repeats each scalar over its pair (unpack in
+// SSE2, a lane permute in AVX2/AVX-512), dot multiplies the pairs as they are
+// and splits the products into x and y lanes (even/odd shuffles) before the
+// add. Every kernel finishes the remaining vectors with scalar code and
+// accepts p_Out aliasing one of its inputs exactly.
+
+namespace alfar
+{
+	namespace vector2
+	{
+		namespace simd
+		{
+			static_assert(sizeof(Vector2) == 2 * sizeof(float), "Vector2 must be a packed float pair");
+
+			//----- scalar tails
+
+			inline void mulScalar(const Vector2* p_Firsts, const float* p_Scalars, Vector2* p_Out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+				{
+					float s = p_Scalars[i];
+					p_Out[i].x = p_Firsts[i].x * s;
+					p_Out[i].y = p_Firsts[i].y * s;
+				}
+			}
+
+			inline void dotScalar(const Vector2* p_Firsts, const Vector2* p_Seconds, float* p_Out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+					p_Out[i] = p_Firsts[i].x * p_Seconds[i].x + p_Firsts[i].y * p_Seconds[i].y;
+			}
+
+#if ALFAR_X86
+
+			//===================================================================== SSE2
+
+			ALFAR_TARGET_SSE2 inline void mulSSE2(const Vector2* p_Firsts, const float* p_Scalars, Vector2* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 4 <= p_Number; i += 4)
+				{
+					const float* a = &p_Firsts[i].x;
+					float* o = &p_Out[i].x;
+					__m128 s = _mm_loadu_ps(p_Scalars + i);
+
+					__m128 r0 = _mm_mul_ps(_mm_loadu_ps(a), _mm_unpacklo_ps(s, s));
+					__m128 r1 = _mm_mul_ps(_mm_loadu_ps(a + 4), _mm_unpackhi_ps(s, s));
+
+					_mm_storeu_ps(o, r0);
+					_mm_storeu_ps(o + 4, r1);
+				}
+
+				mulScalar(p_Firsts + i, p_Scalars + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_SSE2 inline void dotSSE2(const Vector2* p_Firsts, const Vector2* p_Seconds, float* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 4 <= p_Number; i += 4)
+				{
+					const float* a = &p_Firsts[i].x;
+					const float* b = &p_Seconds[i].x;
+
+					__m128 p0 = _mm_mul_ps(_mm_loadu_ps(a), _mm_loadu_ps(b));
+					__m128 p1 = _mm_mul_ps(_mm_loadu_ps(a + 4), _mm_loadu_ps(b + 4));
+
+					__m128 d = _mm_add_ps(_mm_shuffle_ps(p0, p1, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(p0, p1, _MM_SHUFFLE(3, 1, 3, 1)));
+					_mm_storeu_ps(p_Out + i, d);
+				}
+
+				dotScalar(p_Firsts + i, p_Seconds + i, p_Out + i, p_Number - i);
+			}
+
+			//===================================================================== AVX2
+
+			ALFAR_TARGET_AVX2 inline void mulAVX2(const Vector2* p_Firsts, const float* p_Scalars, Vector2* p_Out, uint32_t p_Number)
+			{
+				const __m256i low = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+				const __m256i high = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+
+				uint32_t i = 0;
+				for(; i + 8 <= p_Number; i += 8)
+				{
+					const float* a = &p_Firsts[i].x;
+					float* o = &p_Out[i].x;
+					__m256 s = _mm256_loadu_ps(p_Scalars + i);
+
+					__m256 r0 = _mm256_mul_ps(_mm256_loadu_ps(a), _mm256_permutevar8x32_ps(s, low));
+					__m256 r1 = _mm256_mul_ps(_mm256_loadu_ps(a + 8), _mm256_permutevar8x32_ps(s, high));
+
+					_mm256_storeu_ps(o, r0);
+					_mm256_storeu_ps(o + 8, r1);
+				}
+
+				mulSSE2(p_Firsts + i, p_Scalars + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			//the in-lane shuffles give the vectors in the order 0 1 4 5 2 3 6 7, put back by a 64 bits permute
+			ALFAR_TARGET_AVX2 inline void dotAVX2(const Vector2* p_Firsts, const Vector2* p_Seconds, float* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 8 <= p_Number; i += 8)
+				{
+					const float* a = &p_Firsts[i].x;
+					const float* b = &p_Seconds[i].x;
+
+					__m256 a0 = _mm256_loadu_ps(a), a1 = _mm256_loadu_ps(a + 8);
+					__m256 b0 = _mm256_loadu_ps(b), b1 = _mm256_loadu_ps(b + 8);
+
+					__m256 x = _mm256_shuffle_ps(_mm256_mul_ps(a0, b0), _mm256_mul_ps(a1, b1), _MM_SHUFFLE(2, 0, 2, 0));
+					__m256 d = _mm256_fmadd_ps(_mm256_shuffle_ps(a0, a1, _MM_SHUFFLE(3, 1, 3, 1)), _mm256_shuffle_ps(b0, b1, _MM_SHUFFLE(3, 1, 3, 1)), x);
+
+					_mm256_storeu_ps(p_Out + i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(d), _MM_SHUFFLE(3, 1, 2, 0))));
+				}
+
+				dotSSE2(p_Firsts + i, p_Seconds + i, p_Out + i, p_Number - i);
+			}
+
+			//===================================================================== AVX-512
+
+			ALFAR_TARGET_AVX512 inline void mulAVX512(const Vector2* p_Firsts, const float* p_Scalars, Vector2* p_Out, uint32_t p_Number)
+			{
+				const __m512i low = _mm512_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7);
+				const __m512i high = _mm512_setr_epi32(8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13, 14, 14, 15, 15);
+
+				uint32_t i = 0;
+				for(; i + 16 <= p_Number; i += 16)
+				{
+					const float* a = &p_Firsts[i].x;
+					float* o = &p_Out[i].x;
+					__m512 s = _mm512_loadu_ps(p_Scalars + i);
+
+					__m512 r0 = _mm512_mul_ps(_mm512_loadu_ps(a), _mm512_permutexvar_ps(low, s));
+					__m512 r1 = _mm512_mul_ps(_mm512_loadu_ps(a + 16), _mm512_permutexvar_ps(high, s));
+
+					_mm512_storeu_ps(o, r0);
+					_mm512_storeu_ps(o + 16, r1);
+				}
+
+				mulAVX2(p_Firsts + i, p_Scalars + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX512 inline void dotAVX512(const Vector2* p_Firsts, const Vector2* p_Seconds, float* p_Out, uint32_t p_Number)
+			{
+				const __m512i even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+				const __m512i odd = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+
+				uint32_t i = 0;
+				for(; i + 16 <= p_Number; i += 16)
+				{
+					const float* a = &p_Firsts[i].x;
+					const float* b = &p_Seconds[i].x;
+
+					__m512 a0 = _mm512_loadu_ps(a), a1 = _mm512_loadu_ps(a + 16);
+					__m512 b0 = _mm512_loadu_ps(b), b1 = _mm512_loadu_ps(b + 16);
+
+					__m512 x = _mm512_mul_ps(_mm512_permutex2var_ps(a0, even, a1), _mm512_permutex2var_ps(b0, even, b1));
+					__m512 d = _mm512_fmadd_ps(_mm512_permutex2var_ps(a0, odd, a1), _mm512_permutex2var_ps(b0, odd, b1), x);
+
+					_mm512_storeu_ps(p_Out + i, d);
+				}
+
+				dotAVX2(p_Firsts + i, p_Seconds + i, p_Out + i, p_Number - i);
+			}
+
+#endif
+
+			//===================================================================== dispatch
+
+			inline void mul(const Vector2* p_Firsts, const float* p_Scalars, Vector2* p_Out, uint32_t p_Number)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	mulAVX512(p_Firsts, p_Scalars, p_Out, p_Number); return;
+				case cpu::LEVEL_AVX2:	mulAVX2(p_Firsts, p_Scalars, p_Out, p_Number); return;
+				case cpu::LEVEL_SSE2:	mulSSE2(p_Firsts, p_Scalars, p_Out, p_Number); return;
+#endif
+				default:				mulScalar(p_Firsts, p_Scalars, p_Out, p_Number); return;
+				}
+			}
+
+			inline void dot(const Vector2* p_Firsts, const Vector2* p_Seconds, float* p_Out, uint32_t p_Number)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	dotAVX512(p_Firsts, p_Seconds, p_Out, p_Number); return;
+				case cpu::LEVEL_AVX2:	dotAVX2(p_Firsts, p_Seconds, p_Out, p_Number); return;
+				case cpu::LEVEL_SSE2:	dotSSE2(p_Firsts, p_Seconds, p_Out, p_Number); return;
+#endif
+				default:				dotScalar(p_Firsts, p_Seconds, p_Out, p_Number); return;
+				}
+			}
+		}
+	}
+}
@@ -2,18 +2,21 @@
 
 #include "math_types.h"
 #include "functions.h"
+#include "lanes.h"
+#include "vector3_simd.h"
 #include <stdint.h>
 #include <algorithm>
 #include <math.h>
 #include <memory>
+#include <string.h>
 
 namespace alfar
 {
     namespace vector3
     {
-        inline Vector3 create(float x, float y, float z)
+        ALFAR_CONSTEXPR Vector3 create(float x, float y, float z)
         {
-            Vector3 ret;
+            Vector3 ret = {};
             ret.x = x;
             ret.y = y;
             ret.z = z;
@@ -21,9 +24,9 @@ namespace alfar
             return ret;
         }
 
-        inline Vector3 add(const Vector3& p_First, const Vector3& p_Second)
+        ALFAR_CONSTEXPR Vector3 add(const Vector3& p_First, const Vector3& p_Second)
         {
-            Vector3 ret;
+            Vector3 ret = {};
             ret.x = p_First.x + p_Second.x;
             ret.y = p_First.y + p_Second.y;
             ret.z = p_First.z + p_Second.z;
@@ -33,9 +36,9 @@ namespace alfar
 
         //---------------------------------------------------------------------
 
-        inline Vector3 sub(const Vector3& p_First, const Vector3& p_Second)
+        ALFAR_CONSTEXPR Vector3 sub(const Vector3& p_First, const Vector3& p_Second)
         {
-            Vector3 ret;
+            Vector3 ret = {};
             ret.x = p_First.x - p_Second.x;
             ret.y = p_First.y - p_Second.y;
             ret.z = p_First.z - p_Second.z;
@@ -45,9 +48,9 @@ namespace alfar
 
         //---------------------------------------------------------------------
 
-        inline Vector3 mul(const Vector3& p_Vec, const float p_Scalar)
+        ALFAR_CONSTEXPR Vector3 mul(const Vector3& p_Vec, const float p_Scalar)
         {
-            Vector3 ret;
+            Vector3 ret = {};
             ret.x = p_Vec.x * p_Scalar;
             ret.y = p_Vec.y * p_Scalar;
             ret.z = p_Vec.z * p_Scalar;
@@ -57,9 +60,9 @@ namespace alfar
 
 		//=======================================================================
 
-		inline Vector3 mul(const Matrix4x4& p_Mat, const Vector3& p_Vec)
+		ALFAR_CONSTEXPR Vector3 mul(const Matrix4x4& p_Mat, const Vector3& p_Vec)
 		{
-			Vector3 ret;
+			Vector3 ret = {};
 
 			float w = p_Mat.t.x * p_Vec.x + p_Mat.t.y * p_Vec.y + p_Mat.t.z * p_Vec.z + p_Mat.t.w * 1;
 
@@ -71,11 +74,22 @@ namespace alfar
 			return ret;
 		}
 
+		ALFAR_CONSTEXPR Vector3 mul(const Matrix3x3& p_Mat, const Vector3& p_Vec)
+		{
+			Vector3 ret = {};
+
+			ret.x = p_Mat.x.x * p_Vec.x + p_Mat.x.y * p_Vec.y + p_Mat.x.z * p_Vec.z;
+			ret.y = p_Mat.y.x * p_Vec.x + p_Mat.y.y * p_Vec.y + p_Mat.y.z * p_Vec.z;
+			ret.z = p_Mat.z.x * p_Vec.x + p_Mat.z.y * p_Vec.y + p_Mat.z.z * p_Vec.z;
+
+			return ret;
+		}
+
         //-----------------------------------------------------------------------
 
-        inline Vector3 scale(const Vector3& p_First, const Vector3& p_Second)
+        ALFAR_CONSTEXPR Vector3 scale(const Vector3& p_First, const Vector3& p_Second)
         {
-            Vector3 ret;
+            Vector3 ret = {};
             ret.x = p_First.x * p_Second.x;
             ret.y = p_First.y * p_Second.y;
             ret.z = p_First.z * p_Second.z;
@@ -85,9 +99,9 @@ namespace alfar
 
         //------------------------------------------------------------------------
 
-        inline Vector3 cross(const Vector3& p_First, const Vector3& p_Second)
+        ALFAR_CONSTEXPR Vector3 cross(const Vector3& p_First, const Vector3& p_Second)
         {
-            Vector3 ret;
+            Vector3 ret = {};
             ret.x = p_First.y * p_Second.z - p_Second.y * p_First.z;
             ret.y = p_First.z * p_Second.x - p_Second.z * p_First.x;
             ret.z = p_First.x * p_Second.y - p_Second.x * p_First.y;
@@ -97,14 +111,31 @@ namespace alfar
 
         //---------------------------------------------------------------------------
 
-        inline float dot(const Vector3& p_First, const Vector3& p_Second)
+        ALFAR_CONSTEXPR float dot(const Vector3& p_First, const Vector3& p_Second)
         {
             return p_First.x * p_Second.x + p_First.y * p_Second.y + p_First.z * p_Second.z;
         }
 
         //-------------------------------------------------------------------------
 
-        inline float sqrMagnitude(const Vector3& p_Vector)
+        //component wise
+        ALFAR_CONSTEXPR Vector3 min(const Vector3& p_First, const Vector3& p_Second)
+        {
+            return create(p_First.x < p_Second.x ? p_First.x : p_Second.x,
+                          p_First.y < p_Second.y ? p_First.y : p_Second.y,
+                          p_First.z < p_Second.z ? p_First.z : p_Second.z);
+        }
+
+        ALFAR_CONSTEXPR Vector3 max(const Vector3& p_First, const Vector3& p_Second)
+        {
+            return create(p_First.x > p_Second.x ? p_First.x : p_Second.x,
+                          p_First.y > p_Second.y ? p_First.y : p_Second.y,
+                          p_First.z > p_Second.z ? p_First.z : p_Second.z);
+        }
+
+        //-------------------------------------------------------------------------
+
+        ALFAR_CONSTEXPR float sqrMagnitude(const Vector3& p_Vector)
         {
             return p_Vector.x * p_Vector.x + p_Vector.y * p_Vector.y + p_Vector.z * p_Vector.z;
         }
@@ -114,11 +145,15 @@ namespace alfar
             return sqrt(sqrMagnitude(p_Vector));
         }
 
+		//zero vectors stay zero
 		inline Vector3 normalize(const Vector3& p_Vector)
 		{
-			Vector3 ret;
+			Vector3 ret = {};
 			float norme = magnitude(p_Vector);
 
+			if(norme <= 0)
+				return ret;
+
 			ret.x = p_Vector.x / norme;
 			ret.y = p_Vector.y / norme;
 			ret.z = p_Vector.z / norme;
@@ -126,7 +161,27 @@ namespace alfar
 			return ret;
 		}
 
-		inline Vector3 barycentric(const Vector3 a, const Vector3 b, const Vector3 c, const Vector3 pos)
+		//normalize and magnitude through rsqrt<P>, see Precision for the relative error
+		//of each tier. zero vectors stay zero.
+		template<Precision P = PRECISION_REFINED>
+		inline Vector3 fastNormalize(const Vector3& p_Vector)
+		{
+			float f = lanes::normalizeFactorScalar<P>(sqrMagnitude(p_Vector));
+
+			return create(lanes::normalizeApplyScalar<P>(p_Vector.x, f),
+						  lanes::normalizeApplyScalar<P>(p_Vector.y, f),
+						  lanes::normalizeApplyScalar<P>(p_Vector.z, f));
+		}
+
+		template<Precision P = PRECISION_REFINED>
+		inline float fastMagnitude(const Vector3& p_Vector)
+		{
+			float d = sqrMagnitude(p_Vector);
+
+			return P == PRECISION_EXACT ? sqrtf(d) : d * lanes::normalizeFactorScalar<P>(d);
+		}
+
+		ALFAR_CONSTEXPR Vector3 barycentric(const Vector3 a, const Vector3 b, const Vector3 c, const Vector3 pos)
 		{
 			float det = ((b.y-c.y)*(a.x-c.x) + (c.x-b.x)*(a.y-c.y));
 
@@ -141,7 +196,7 @@ namespace alfar
 
 
 		//return dist to intersections. return -1 if no intersection or behind.
-		inline float linePlaneIntersection(const Vector3& planeOrigin, const Vector3& planeNormal, const Vector3 rayOrigin, const Vector3& rayDir)
+		ALFAR_CONSTEXPR float linePlaneIntersection(const Vector3& planeOrigin, const Vector3& planeNormal, const Vector3 rayOrigin, const Vector3& rayDir)
 		{
 			float num = vector3::dot(vector3::sub(planeOrigin, rayOrigin), planeNormal);
 			float den = vector3::dot(rayDir, planeNormal);
@@ -175,10 +230,11 @@ namespace alfar
 			float distSqrt = sqrtf(disc);
 			float q;
 
+			//q = -(b + sign(b) * sqrt(disc)) / 2 does not cancel, the other root is c / q
 			if(b < 0 )
-				q = (-b - distSqrt)/2.0f;
-			else
 				q = (-b + distSqrt)/2.0f;
+			else
+				q = (-b - distSqrt)/2.0f;
 
 			float t0 = q / a;
 			float t1 = c / q;
@@ -216,94 +272,56 @@ namespace alfar
 
         inline void add(Vector3* p_Firsts, Vector3* p_Seconds, Vector3* p_Out, uint32_t p_Number)
         {
-            for(uint32_t i = 0; i < p_Number; ++i)
-            {
-                alfar::Vector3& o = *(p_Out+i);
-                alfar::Vector3& a = *(p_Firsts+i);
-                alfar::Vector3& b = *(p_Seconds+i);
-
-                o.x = a.x + b.x;
-                o.y = a.y + b.y;
-                o.z = a.z + b.z;
-            }
+            lanes::binary<lanes::OP_ADD>(&p_Firsts->x, &p_Seconds->x, &p_Out->x, (size_t)p_Number * 3);
         }
 
         //---------------------------------------------------------------------------
 
         inline void sub(Vector3* p_Firsts, Vector3* p_Seconds, Vector3* p_Out, uint32_t p_Number)
         {
-            for(uint32_t i = 0; i < p_Number; ++i)
-            {
-                alfar::Vector3& o = *(p_Out+i);
-                alfar::Vector3& a = *(p_Firsts+i);
-                alfar::Vector3& b = *(p_Seconds+i);
-
-                o.x = a.x - b.x;
-                o.y = a.y - b.y;
-                o.z = a.z - b.z;
-            }
+            lanes::binary<lanes::OP_SUB>(&p_Firsts->x, &p_Seconds->x, &p_Out->x, (size_t)p_Number * 3);
         }
 
         //------------------------------------------------------------------------------
 
         inline void mul(Vector3* p_Firsts, float* p_Scalars, Vector3* p_Out, uint32_t p_Number)
         {
-            for(uint32_t i = 0; i < p_Number; ++i)
-            {
-                alfar::Vector3& o = *(p_Out+i);
-                alfar::Vector3& a = *(p_Firsts+i);
-                float& s = *(p_Scalars+i);
-
-                o.x = a.x * s;
-                o.y = a.y * s;
-                o.z = a.z * s;
-            }
+            simd::mul(p_Firsts, p_Scalars, p_Out, p_Number);
         }
 
         //----------------------------------------------------------------------------------
 
         inline void scale(Vector3* p_Firsts, Vector3* p_Seconds, Vector3* p_Out, uint32_t p_Number)
         {
-            for(uint32_t i = 0; i < p_Number; ++i)
-            {
-                alfar::Vector3& o = *(p_Out+i);
-                alfar::Vector3& a = *(p_Firsts+i);
-                alfar::Vector3& b = *(p_Seconds+i);
-
-                o.x = a.x * b.x;
-                o.y = a.y * b.y;
-                o.z = a.z * b.z;
-            }
+            lanes::binary<lanes::OP_SCALE>(&p_Firsts->x, &p_Seconds->x, &p_Out->x, (size_t)p_Number * 3);
         }
 
         //-----------------------------------------------------------------------------------
             
         inline void cross(Vector3* p_Firsts, Vector3* p_Seconds, Vector3* p_Out, uint32_t p_Number)
         {
-            for(uint32_t i = 0; i < p_Number; ++i)
-            {
-                alfar::Vector3& o = *(p_Out+i);
-                alfar::Vector3& a = *(p_Firsts+i);
-                alfar::Vector3& b = *(p_Seconds+i);
-
-                o.x = a.y * b.z - b.y * a.z;
-                o.y = a.z * b.x - b.z * a.x;
-                o.z = a.x * b.y - b.x * a.y;
-            }
+            simd::cross(p_Firsts, p_Seconds, p_Out, p_Number);
         }
 
         //--------------------------------------------------------------------------------------
 
         inline void dot(Vector3* p_Firsts, Vector3* p_Seconds, float* p_Out, uint32_t p_Number)
         {
-            for(uint32_t i = 0; i < p_Number; ++i)
-            {
-                float& o = *(p_Out+i);
-                alfar::Vector3& a = *(p_Firsts+i);
-                alfar::Vector3& b = *(p_Seconds+i);
-
-                o = a.x * b.x + a.y * b.y + a.z * b.z;
-            }
+            simd::dot(p_Firsts, p_Seconds, p_Out, p_Number);
+        }
+
+        //--------------------------------------------------------------------------------------
+
+        //p_Out[i] = normalize(p_In[i]) and fastNormalize<P>(p_In[i]); p_Out may be p_In.
+        inline void normalize(const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+        {
+            simd::normalize<PRECISION_EXACT>(p_In, p_Out, p_Number);
+        }
+
+        template<Precision P = PRECISION_REFINED>
+        inline void fastNormalize(const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+        {
+            simd::normalize<P>(p_In, p_Out, p_Number);
         }
     }
 }
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "vector3.h"
+#include "parallel.h"
+#include <stdint.h>
+
+// The Policy overloads of the vector3 array functions.
+
+namespace alfar
+{
+	namespace vector3
+	{
+		inline void add(const parallel::Policy& p_Policy, Vector3* p_Firsts, Vector3* p_Seconds, Vector3* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { add(p_Firsts + p_Start, p_Seconds + p_Start, p_Out + p_Start, p_End - p_Start); });
+		}
+
+		//--------------------------------------------------------------------------
+
+		inline void sub(const parallel::Policy& p_Policy, Vector3* p_Firsts, Vector3* p_Seconds, Vector3* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { sub(p_Firsts + p_Start, p_Seconds + p_Start, p_Out + p_Start, p_End - p_Start); });
+		}
+
+		//--------------------------------------------------------------------------
+
+		inline void mul(const parallel::Policy& p_Policy, Vector3* p_Firsts, float* p_Scalars, Vector3* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { mul(p_Firsts + p_Start, p_Scalars + p_Start, p_Out + p_Start, p_End - p_Start); });
+		}
+
+		//--------------------------------------------------------------------------
+
+		inline void scale(const parallel::Policy& p_Policy, Vector3* p_Firsts, Vector3* p_Seconds, Vector3* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { scale(p_Firsts + p_Start, p_Seconds + p_Start, p_Out + p_Start, p_End - p_Start); });
+		}
+
+		//--------------------------------------------------------------------------
+
+		inline void cross(const parallel::Policy& p_Policy, Vector3* p_Firsts, Vector3* p_Seconds, Vector3* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { cross(p_Firsts + p_Start, p_Seconds + p_Start, p_Out + p_Start, p_End - p_Start); });
+		}
+
+		//--------------------------------------------------------------------------
+
+		inline void dot(const parallel::Policy& p_Policy, Vector3* p_Firsts, Vector3* p_Seconds, float* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { dot(p_Firsts + p_Start, p_Seconds + p_Start, p_Out + p_Start, p_End - p_Start); });
+		}
+
+		//--------------------------------------------------------------------------
+
+		inline void normalize(const parallel::Policy& p_Policy, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { normalize(p_In + p_Start, p_Out + p_Start, p_End - p_Start); });
+		}
+
+		template<Precision P = PRECISION_REFINED>
+		inline void fastNormalize(const parallel::Policy& p_Policy, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { fastNormalize<P>(p_In + p_Start, p_Out + p_Start, p_End - p_Start); });
+		}
+	}
+}
@@ -0,0 +1,732 @@
+#pragma once
+
+#include "math_types.h"
+#include "cpu.h"
+#include "lanes.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// SIMD kernels behind the vector3 array functions. Vector3 arrays are packed
+// float triples, so element-wise ops (add, sub, scale) run on the flat float
+// stream through lanes.h, while mul/cross/dot load 4 vectors per 128 bits lane
+// (3 registers) and shuffle them to x/y/z lanes. Wider ISAs repeat the same
+// lane layout. normalize takes the SoA x/y/z to the lanes.h normalize
+// factors of its Precision.
+// Every kernel finishes the remaining vectors with scalar code and accepts
+// p_Out aliasing one of its inputs exactly.
+
+namespace alfar
+{
+	namespace vector3
+	{
+		namespace simd
+		{
+			static_assert(sizeof(Vector3) == 3 * sizeof(float), "Vector3 must be a packed float triple");
+			static_assert(sizeof(Matrix4x4) == 16 * sizeof(float), "Matrix4x4 must be 16 packed floats");
+
+			//----- scalar tails
+
+			inline void mulScalar(const Vector3* p_Firsts, const float* p_Scalars, Vector3* p_Out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+				{
+					float s = p_Scalars[i];
+
+					p_Out[i].x = p_Firsts[i].x * s;
+					p_Out[i].y = p_Firsts[i].y * s;
+					p_Out[i].z = p_Firsts[i].z * s;
+				}
+			}
+
+			inline void crossScalar(const Vector3* p_Firsts, const Vector3* p_Seconds, Vector3* p_Out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+				{
+					Vector3 a = p_Firsts[i];
+					Vector3 b = p_Seconds[i];
+
+					p_Out[i].x = a.y * b.z - b.y * a.z;
+					p_Out[i].y = a.z * b.x - b.z * a.x;
+					p_Out[i].z = a.x * b.y - b.x * a.y;
+				}
+			}
+
+			inline void dotScalar(const Vector3* p_Firsts, const Vector3* p_Seconds, float* p_Out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+				{
+					const Vector3& a = p_Firsts[i];
+					const Vector3& b = p_Seconds[i];
+
+					p_Out[i] = a.x * b.x + a.y * b.y + a.z * b.z;
+				}
+			}
+
+			template<Precision P>
+			inline void normalizeScalar(const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+				{
+					Vector3 v = p_In[i];
+					float f = lanes::normalizeFactorScalar<P>(v.x * v.x + v.y * v.y + v.z * v.z);
+
+					p_Out[i].x = lanes::normalizeApplyScalar<P>(v.x, f);
+					p_Out[i].y = lanes::normalizeApplyScalar<P>(v.y, f);
+					p_Out[i].z = lanes::normalizeApplyScalar<P>(v.z, f);
+				}
+			}
+
+			//----- matrix transforms
+
+			enum TransformMode
+			{
+				TRANSFORM_POINT,		//w = 1, bottom row ignored
+				TRANSFORM_DIRECTION,	//w = 0, bottom row ignored
+				TRANSFORM_PROJECTIVE	//w = 1, divided by the resulting w
+			};
+
+			template<TransformMode MODE>
+			inline void transformScalar(const Matrix4x4& m, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+				{
+					Vector3 v = p_In[i];
+
+					float x = m.x.x * v.x + m.x.y * v.y + m.x.z * v.z;
+					float y = m.y.x * v.x + m.y.y * v.y + m.y.z * v.z;
+					float z = m.z.x * v.x + m.z.y * v.y + m.z.z * v.z;
+
+					if(MODE != TRANSFORM_DIRECTION)
+					{
+						x += m.x.w;
+						y += m.y.w;
+						z += m.z.w;
+					}
+
+					if(MODE == TRANSFORM_PROJECTIVE)
+					{
+						float w = m.t.x * v.x + m.t.y * v.y + m.t.z * v.z + m.t.w;
+						x /= w;
+						y /= w;
+						z /= w;
+					}
+
+					p_Out[i].x = x;
+					p_Out[i].y = y;
+					p_Out[i].z = z;
+				}
+			}
+
+#if ALFAR_X86
+
+			//===================================================================== SSE2
+
+			//m0 = x0 y0 z0 x1, m1 = y1 z1 x2 y2, m2 = z2 x3 y3 z3  ->  x0..x3, y0..y3, z0..z3
+			ALFAR_TARGET_SSE2 inline void deinterleave(__m128 m0, __m128 m1, __m128 m2, __m128& x, __m128& y, __m128& z)
+			{
+				__m128 xy = _mm_shuffle_ps(m1, m2, _MM_SHUFFLE(2, 1, 3, 2));
+				__m128 yz = _mm_shuffle_ps(m0, m1, _MM_SHUFFLE(1, 0, 2, 1));
+
+				x = _mm_shuffle_ps(m0, xy, _MM_SHUFFLE(2, 0, 3, 0));
+				y = _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+				z = _mm_shuffle_ps(yz, m2, _MM_SHUFFLE(3, 0, 3, 1));
+			}
+
+			ALFAR_TARGET_SSE2 inline void interleave(__m128 x, __m128 y, __m128 z, __m128& m0, __m128& m1, __m128& m2)
+			{
+				__m128 xy = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+				__m128 yz = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+				__m128 zx = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+
+				m0 = _mm_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0));
+				m1 = _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+				m2 = _mm_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1));
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_SSE2 inline void mulSSE2(const Vector3* p_Firsts, const float* p_Scalars, Vector3* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 4 <= p_Number; i += 4)
+				{
+					const float* a = &p_Firsts[i].x;
+					float* o = &p_Out[i].x;
+					__m128 s = _mm_loadu_ps(p_Scalars + i);
+
+					__m128 r0 = _mm_mul_ps(_mm_loadu_ps(a + 0), _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 0, 0, 0)));
+					__m128 r1 = _mm_mul_ps(_mm_loadu_ps(a + 4), _mm_shuffle_ps(s, s, _MM_SHUFFLE(2, 2, 1, 1)));
+					__m128 r2 = _mm_mul_ps(_mm_loadu_ps(a + 8), _mm_shuffle_ps(s, s, _MM_SHUFFLE(3, 3, 3, 2)));
+
+					_mm_storeu_ps(o + 0, r0);
+					_mm_storeu_ps(o + 4, r1);
+					_mm_storeu_ps(o + 8, r2);
+				}
+
+				mulScalar(p_Firsts + i, p_Scalars + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_SSE2 inline void crossSSE2(const Vector3* p_Firsts, const Vector3* p_Seconds, Vector3* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 4 <= p_Number; i += 4)
+				{
+					const float* a = &p_Firsts[i].x;
+					const float* b = &p_Seconds[i].x;
+					float* o = &p_Out[i].x;
+
+					__m128 ax, ay, az, bx, by, bz;
+					deinterleave(_mm_loadu_ps(a), _mm_loadu_ps(a + 4), _mm_loadu_ps(a + 8), ax, ay, az);
+					deinterleave(_mm_loadu_ps(b), _mm_loadu_ps(b + 4), _mm_loadu_ps(b + 8), bx, by, bz);
+
+					__m128 cx = _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(by, az));
+					__m128 cy = _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(bz, ax));
+					__m128 cz = _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(bx, ay));
+
+					__m128 m0, m1, m2;
+					interleave(cx, cy, cz, m0, m1, m2);
+
+					_mm_storeu_ps(o, m0);
+					_mm_storeu_ps(o + 4, m1);
+					_mm_storeu_ps(o + 8, m2);
+				}
+
+				crossScalar(p_Firsts + i, p_Seconds + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_SSE2 inline void dotSSE2(const Vector3* p_Firsts, const Vector3* p_Seconds, float* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 4 <= p_Number; i += 4)
+				{
+					const float* a = &p_Firsts[i].x;
+					const float* b = &p_Seconds[i].x;
+
+					__m128 ax, ay, az, bx, by, bz;
+					deinterleave(_mm_loadu_ps(a), _mm_loadu_ps(a + 4), _mm_loadu_ps(a + 8), ax, ay, az);
+					deinterleave(_mm_loadu_ps(b), _mm_loadu_ps(b + 4), _mm_loadu_ps(b + 8), bx, by, bz);
+
+					__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+					_mm_storeu_ps(p_Out + i, d);
+				}
+
+				dotScalar(p_Firsts + i, p_Seconds + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			template<Precision P>
+			ALFAR_TARGET_SSE2 inline void normalizeSSE2(const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 4 <= p_Number; i += 4)
+				{
+					const float* a = &p_In[i].x;
+					__m128 x, y, z;
+					deinterleave(_mm_loadu_ps(a), _mm_loadu_ps(a + 4), _mm_loadu_ps(a + 8), x, y, z);
+
+					__m128 f = lanes::normalizeFactorSSE2<P>(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+
+					__m128 m0, m1, m2;
+					interleave(lanes::normalizeApplySSE2<P>(x, f), lanes::normalizeApplySSE2<P>(y, f), lanes::normalizeApplySSE2<P>(z, f), m0, m1, m2);
+
+					float* o = &p_Out[i].x;
+					_mm_storeu_ps(o, m0);
+					_mm_storeu_ps(o + 4, m1);
+					_mm_storeu_ps(o + 8, m2);
+				}
+
+				normalizeScalar<P>(p_In + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			//matrix coefficients are broadcast once, then 4 vectors per lane go through the SoA shuffle.
+			template<TransformMode MODE>
+			ALFAR_TARGET_SSE2 inline void transformSSE2(const Matrix4x4& p_Mat, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				const float* m = &p_Mat.x.x;
+				__m128 c[16];
+				for(int k = 0; k < 16; ++k)
+					c[k] = _mm_set1_ps(m[k]);
+
+				uint32_t i = 0;
+				for(; i + 4 <= p_Number; i += 4)
+				{
+					const float* a = &p_In[i].x;
+					__m128 x, y, z;
+					deinterleave(_mm_loadu_ps(a), _mm_loadu_ps(a + 4), _mm_loadu_ps(a + 8), x, y, z);
+
+					__m128 ox = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c[0], x), _mm_mul_ps(c[1], y)), _mm_mul_ps(c[2], z));
+					__m128 oy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c[4], x), _mm_mul_ps(c[5], y)), _mm_mul_ps(c[6], z));
+					__m128 oz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c[8], x), _mm_mul_ps(c[9], y)), _mm_mul_ps(c[10], z));
+
+					if(MODE != TRANSFORM_DIRECTION)
+					{
+						ox = _mm_add_ps(ox, c[3]);
+						oy = _mm_add_ps(oy, c[7]);
+						oz = _mm_add_ps(oz, c[11]);
+					}
+
+					if(MODE == TRANSFORM_PROJECTIVE)
+					{
+						__m128 w = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(c[12], x), _mm_mul_ps(c[13], y)), _mm_mul_ps(c[14], z)), c[15]);
+						ox = _mm_div_ps(ox, w);
+						oy = _mm_div_ps(oy, w);
+						oz = _mm_div_ps(oz, w);
+					}
+
+					__m128 m0, m1, m2;
+					interleave(ox, oy, oz, m0, m1, m2);
+
+					float* o = &p_Out[i].x;
+					_mm_storeu_ps(o, m0);
+					_mm_storeu_ps(o + 4, m1);
+					_mm_storeu_ps(o + 8, m2);
+				}
+
+				transformScalar<MODE>(p_Mat, p_In + i, p_Out + i, p_Number - i);
+			}
+
+			//===================================================================== AVX2
+
+			//lane k of m0/m1/m2 holds the 12 floats of vectors 4k..4k+3, as in the SSE2 layout.
+			ALFAR_TARGET_AVX2 inline void load8(const float* p, __m256& m0, __m256& m1, __m256& m2)
+			{
+				m0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 0)), _mm_loadu_ps(p + 12), 1);
+				m1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 4)), _mm_loadu_ps(p + 16), 1);
+				m2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 8)), _mm_loadu_ps(p + 20), 1);
+			}
+
+			ALFAR_TARGET_AVX2 inline void store8(float* p, __m256 m0, __m256 m1, __m256 m2)
+			{
+				_mm_storeu_ps(p + 0, _mm256_castps256_ps128(m0));
+				_mm_storeu_ps(p + 4, _mm256_castps256_ps128(m1));
+				_mm_storeu_ps(p + 8, _mm256_castps256_ps128(m2));
+				_mm_storeu_ps(p + 12, _mm256_extractf128_ps(m0, 1));
+				_mm_storeu_ps(p + 16, _mm256_extractf128_ps(m1, 1));
+				_mm_storeu_ps(p + 20, _mm256_extractf128_ps(m2, 1));
+			}
+
+			ALFAR_TARGET_AVX2 inline void deinterleave(__m256 m0, __m256 m1, __m256 m2, __m256& x, __m256& y, __m256& z)
+			{
+				__m256 xy = _mm256_shuffle_ps(m1, m2, _MM_SHUFFLE(2, 1, 3, 2));
+				__m256 yz = _mm256_shuffle_ps(m0, m1, _MM_SHUFFLE(1, 0, 2, 1));
+
+				x = _mm256_shuffle_ps(m0, xy, _MM_SHUFFLE(2, 0, 3, 0));
+				y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+				z = _mm256_shuffle_ps(yz, m2, _MM_SHUFFLE(3, 0, 3, 1));
+			}
+
+			ALFAR_TARGET_AVX2 inline void interleave(__m256 x, __m256 y, __m256 z, __m256& m0, __m256& m1, __m256& m2)
+			{
+				__m256 xy = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+				__m256 yz = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+				__m256 zx = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+
+				m0 = _mm256_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0));
+				m1 = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+				m2 = _mm256_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1));
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX2 inline void mulAVX2(const Vector3* p_Firsts, const float* p_Scalars, Vector3* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 8 <= p_Number; i += 8)
+				{
+					__m256 m0, m1, m2;
+					load8(&p_Firsts[i].x, m0, m1, m2);
+					__m256 s = _mm256_loadu_ps(p_Scalars + i);
+
+					m0 = _mm256_mul_ps(m0, _mm256_shuffle_ps(s, s, _MM_SHUFFLE(1, 0, 0, 0)));
+					m1 = _mm256_mul_ps(m1, _mm256_shuffle_ps(s, s, _MM_SHUFFLE(2, 2, 1, 1)));
+					m2 = _mm256_mul_ps(m2, _mm256_shuffle_ps(s, s, _MM_SHUFFLE(3, 3, 3, 2)));
+
+					store8(&p_Out[i].x, m0, m1, m2);
+				}
+
+				mulSSE2(p_Firsts + i, p_Scalars + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX2 inline void crossAVX2(const Vector3* p_Firsts, const Vector3* p_Seconds, Vector3* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 8 <= p_Number; i += 8)
+				{
+					__m256 m0, m1, m2;
+					__m256 ax, ay, az, bx, by, bz;
+
+					load8(&p_Firsts[i].x, m0, m1, m2);
+					deinterleave(m0, m1, m2, ax, ay, az);
+					load8(&p_Seconds[i].x, m0, m1, m2);
+					deinterleave(m0, m1, m2, bx, by, bz);
+
+					__m256 cx = _mm256_fmsub_ps(ay, bz, _mm256_mul_ps(by, az));
+					__m256 cy = _mm256_fmsub_ps(az, bx, _mm256_mul_ps(bz, ax));
+					__m256 cz = _mm256_fmsub_ps(ax, by, _mm256_mul_ps(bx, ay));
+
+					interleave(cx, cy, cz, m0, m1, m2);
+					store8(&p_Out[i].x, m0, m1, m2);
+				}
+
+				crossSSE2(p_Firsts + i, p_Seconds + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX2 inline void dotAVX2(const Vector3* p_Firsts, const Vector3* p_Seconds, float* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 8 <= p_Number; i += 8)
+				{
+					__m256 m0, m1, m2;
+					__m256 ax, ay, az, bx, by, bz;
+
+					load8(&p_Firsts[i].x, m0, m1, m2);
+					deinterleave(m0, m1, m2, ax, ay, az);
+					load8(&p_Seconds[i].x, m0, m1, m2);
+					deinterleave(m0, m1, m2, bx, by, bz);
+
+					__m256 d = _mm256_fmadd_ps(az, bz, _mm256_fmadd_ps(ay, by, _mm256_mul_ps(ax, bx)));
+					_mm256_storeu_ps(p_Out + i, d);
+				}
+
+				dotSSE2(p_Firsts + i, p_Seconds + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			template<Precision P>
+			ALFAR_TARGET_AVX2 inline void normalizeAVX2(const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 8 <= p_Number; i += 8)
+				{
+					__m256 m0, m1, m2, x, y, z;
+					load8(&p_In[i].x, m0, m1, m2);
+					deinterleave(m0, m1, m2, x, y, z);
+
+					__m256 f = lanes::normalizeFactorAVX2<P>(_mm256_fmadd_ps(z, z, _mm256_fmadd_ps(y, y, _mm256_mul_ps(x, x))));
+
+					interleave(lanes::normalizeApplyAVX2<P>(x, f), lanes::normalizeApplyAVX2<P>(y, f), lanes::normalizeApplyAVX2<P>(z, f), m0, m1, m2);
+					store8(&p_Out[i].x, m0, m1, m2);
+				}
+
+				normalizeSSE2<P>(p_In + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			//matrix coefficients are broadcast once, then 4 vectors per lane go through the SoA shuffle.
+			template<TransformMode MODE>
+			ALFAR_TARGET_AVX2 inline void transformAVX2(const Matrix4x4& p_Mat, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				const float* m = &p_Mat.x.x;
+				__m256 c[16];
+				for(int k = 0; k < 16; ++k)
+					c[k] = _mm256_set1_ps(m[k]);
+
+				uint32_t i = 0;
+				for(; i + 8 <= p_Number; i += 8)
+				{
+					__m256 m0, m1, m2, x, y, z;
+					load8(&p_In[i].x, m0, m1, m2);
+					deinterleave(m0, m1, m2, x, y, z);
+
+					__m256 ox = _mm256_fmadd_ps(c[2], z, _mm256_fmadd_ps(c[1], y, _mm256_mul_ps(c[0], x)));
+					__m256 oy = _mm256_fmadd_ps(c[6], z, _mm256_fmadd_ps(c[5], y, _mm256_mul_ps(c[4], x)));
+					__m256 oz = _mm256_fmadd_ps(c[10], z, _mm256_fmadd_ps(c[9], y, _mm256_mul_ps(c[8], x)));
+
+					if(MODE != TRANSFORM_DIRECTION)
+					{
+						ox = _mm256_add_ps(ox, c[3]);
+						oy = _mm256_add_ps(oy, c[7]);
+						oz = _mm256_add_ps(oz, c[11]);
+					}
+
+					if(MODE == TRANSFORM_PROJECTIVE)
+					{
+						__m256 w = _mm256_add_ps(_mm256_fmadd_ps(c[14], z, _mm256_fmadd_ps(c[13], y, _mm256_mul_ps(c[12], x))), c[15]);
+						ox = _mm256_div_ps(ox, w);
+						oy = _mm256_div_ps(oy, w);
+						oz = _mm256_div_ps(oz, w);
+					}
+
+					interleave(ox, oy, oz, m0, m1, m2);
+					store8(&p_Out[i].x, m0, m1, m2);
+				}
+
+				transformSSE2<MODE>(p_Mat, p_In + i, p_Out + i, p_Number - i);
+			}
+
+			//===================================================================== AVX-512
+
+			//masked accesses place each 4 floats block in its lane without extract/insert shuffles.
+			ALFAR_TARGET_AVX512 inline __m512 loadLanes(const float* p)
+			{
+				__m512 r = _mm512_maskz_loadu_ps(0x000f, p);
+				r = _mm512_mask_loadu_ps(r, 0x00f0, p + 8);
+				r = _mm512_mask_loadu_ps(r, 0x0f00, p + 16);
+				return _mm512_mask_loadu_ps(r, 0xf000, p + 24);
+			}
+
+			ALFAR_TARGET_AVX512 inline void storeLanes(float* p, __m512 m)
+			{
+				_mm512_mask_storeu_ps(p, 0x000f, m);
+				_mm512_mask_storeu_ps(p + 8, 0x00f0, m);
+				_mm512_mask_storeu_ps(p + 16, 0x0f00, m);
+				_mm512_mask_storeu_ps(p + 24, 0xf000, m);
+			}
+
+			ALFAR_TARGET_AVX512 inline void load16(const float* p, __m512& m0, __m512& m1, __m512& m2)
+			{
+				m0 = loadLanes(p);
+				m1 = loadLanes(p + 4);
+				m2 = loadLanes(p + 8);
+			}
+
+			ALFAR_TARGET_AVX512 inline void store16(float* p, __m512 m0, __m512 m1, __m512 m2)
+			{
+				storeLanes(p, m0);
+				storeLanes(p + 4, m1);
+				storeLanes(p + 8, m2);
+			}
+
+			ALFAR_TARGET_AVX512 inline void deinterleave(__m512 m0, __m512 m1, __m512 m2, __m512& x, __m512& y, __m512& z)
+			{
+				__m512 xy = _mm512_shuffle_ps(m1, m2, _MM_SHUFFLE(2, 1, 3, 2));
+				__m512 yz = _mm512_shuffle_ps(m0, m1, _MM_SHUFFLE(1, 0, 2, 1));
+
+				x = _mm512_shuffle_ps(m0, xy, _MM_SHUFFLE(2, 0, 3, 0));
+				y = _mm512_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+				z = _mm512_shuffle_ps(yz, m2, _MM_SHUFFLE(3, 0, 3, 1));
+			}
+
+			ALFAR_TARGET_AVX512 inline void interleave(__m512 x, __m512 y, __m512 z, __m512& m0, __m512& m1, __m512& m2)
+			{
+				__m512 xy = _mm512_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+				__m512 yz = _mm512_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+				__m512 zx = _mm512_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+
+				m0 = _mm512_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0));
+				m1 = _mm512_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+				m2 = _mm512_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1));
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX512 inline void mulAVX512(const Vector3* p_Firsts, const float* p_Scalars, Vector3* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 16 <= p_Number; i += 16)
+				{
+					__m512 m0, m1, m2;
+					load16(&p_Firsts[i].x, m0, m1, m2);
+					__m512 s = _mm512_loadu_ps(p_Scalars + i);
+
+					m0 = _mm512_mul_ps(m0, _mm512_shuffle_ps(s, s, _MM_SHUFFLE(1, 0, 0, 0)));
+					m1 = _mm512_mul_ps(m1, _mm512_shuffle_ps(s, s, _MM_SHUFFLE(2, 2, 1, 1)));
+					m2 = _mm512_mul_ps(m2, _mm512_shuffle_ps(s, s, _MM_SHUFFLE(3, 3, 3, 2)));
+
+					store16(&p_Out[i].x, m0, m1, m2);
+				}
+
+				mulAVX2(p_Firsts + i, p_Scalars + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX512 inline void crossAVX512(const Vector3* p_Firsts, const Vector3* p_Seconds, Vector3* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 16 <= p_Number; i += 16)
+				{
+					__m512 m0, m1, m2;
+					__m512 ax, ay, az, bx, by, bz;
+
+					load16(&p_Firsts[i].x, m0, m1, m2);
+					deinterleave(m0, m1, m2, ax, ay, az);
+					load16(&p_Seconds[i].x, m0, m1, m2);
+					deinterleave(m0, m1, m2, bx, by, bz);
+
+					__m512 cx = _mm512_fmsub_ps(ay, bz, _mm512_mul_ps(by, az));
+					__m512 cy = _mm512_fmsub_ps(az, bx, _mm512_mul_ps(bz, ax));
+					__m512 cz = _mm512_fmsub_ps(ax, by, _mm512_mul_ps(bx, ay));
+
+					interleave(cx, cy, cz, m0, m1, m2);
+					store16(&p_Out[i].x, m0, m1, m2);
+				}
+
+				crossAVX2(p_Firsts + i, p_Seconds + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX512 inline void dotAVX512(const Vector3* p_Firsts, const Vector3* p_Seconds, float* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 16 <= p_Number; i += 16)
+				{
+					__m512 m0, m1, m2;
+					__m512 ax, ay, az, bx, by, bz;
+
+					load16(&p_Firsts[i].x, m0, m1, m2);
+					deinterleave(m0, m1, m2, ax, ay, az);
+					load16(&p_Seconds[i].x, m0, m1, m2);
+					deinterleave(m0, m1, m2, bx, by, bz);
+
+					__m512 d = _mm512_fmadd_ps(az, bz, _mm512_fmadd_ps(ay, by, _mm512_mul_ps(ax, bx)));
+					_mm512_storeu_ps(p_Out + i, d);
+				}
+
+				dotAVX2(p_Firsts + i, p_Seconds + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			template<Precision P>
+			ALFAR_TARGET_AVX512 inline void normalizeAVX512(const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 16 <= p_Number; i += 16)
+				{
+					__m512 m0, m1, m2, x, y, z;
+					load16(&p_In[i].x, m0, m1, m2);
+					deinterleave(m0, m1, m2, x, y, z);
+
+					__m512 f = lanes::normalizeFactorAVX512<P>(_mm512_fmadd_ps(z, z, _mm512_fmadd_ps(y, y, _mm512_mul_ps(x, x))));
+
+					interleave(lanes::normalizeApplyAVX512<P>(x, f), lanes::normalizeApplyAVX512<P>(y, f), lanes::normalizeApplyAVX512<P>(z, f), m0, m1, m2);
+					store16(&p_Out[i].x, m0, m1, m2);
+				}
+
+				normalizeAVX2<P>(p_In + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			//matrix coefficients are broadcast once, then 4 vectors per lane go through the SoA shuffle.
+			template<TransformMode MODE>
+			ALFAR_TARGET_AVX512 inline void transformAVX512(const Matrix4x4& p_Mat, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				const float* m = &p_Mat.x.x;
+				__m512 c[16];
+				for(int k = 0; k < 16; ++k)
+					c[k] = _mm512_set1_ps(m[k]);
+
+				uint32_t i = 0;
+				for(; i + 16 <= p_Number; i += 16)
+				{
+					__m512 m0, m1, m2, x, y, z;
+					load16(&p_In[i].x, m0, m1, m2);
+					deinterleave(m0, m1, m2, x, y, z);
+
+					__m512 ox = _mm512_fmadd_ps(c[2], z, _mm512_fmadd_ps(c[1], y, _mm512_mul_ps(c[0], x)));
+					__m512 oy = _mm512_fmadd_ps(c[6], z, _mm512_fmadd_ps(c[5], y, _mm512_mul_ps(c[4], x)));
+					__m512 oz = _mm512_fmadd_ps(c[10], z, _mm512_fmadd_ps(c[9], y, _mm512_mul_ps(c[8], x)));
+
+					if(MODE != TRANSFORM_DIRECTION)
+					{
+						ox = _mm512_add_ps(ox, c[3]);
+						oy = _mm512_add_ps(oy, c[7]);
+						oz = _mm512_add_ps(oz, c[11]);
+					}
+
+					if(MODE == TRANSFORM_PROJECTIVE)
+					{
+						__m512 w = _mm512_add_ps(_mm512_fmadd_ps(c[14], z, _mm512_fmadd_ps(c[13], y, _mm512_mul_ps(c[12], x))), c[15]);
+						ox = _mm512_div_ps(ox, w);
+						oy = _mm512_div_ps(oy, w);
+						oz = _mm512_div_ps(oz, w);
+					}
+
+					interleave(ox, oy, oz, m0, m1, m2);
+					store16(&p_Out[i].x, m0, m1, m2);
+				}
+
+				transformAVX2<MODE>(p_Mat, p_In + i, p_Out + i, p_Number - i);
+			}
+
+#endif
+
+			//===================================================================== dispatch
+
+			inline void mul(const Vector3* p_Firsts, const float* p_Scalars, Vector3* p_Out, uint32_t p_Number)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	mulAVX512(p_Firsts, p_Scalars, p_Out, p_Number); return;
+				case cpu::LEVEL_AVX2:	mulAVX2(p_Firsts, p_Scalars, p_Out, p_Number); return;
+				case cpu::LEVEL_SSE2:	mulSSE2(p_Firsts, p_Scalars, p_Out, p_Number); return;
+#endif
+				default:				mulScalar(p_Firsts, p_Scalars, p_Out, p_Number); return;
+				}
+			}
+
+			inline void cross(const Vector3* p_Firsts, const Vector3* p_Seconds, Vector3* p_Out, uint32_t p_Number)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	crossAVX512(p_Firsts, p_Seconds, p_Out, p_Number); return;
+				case cpu::LEVEL_AVX2:	crossAVX2(p_Firsts, p_Seconds, p_Out, p_Number); return;
+				case cpu::LEVEL_SSE2:	crossSSE2(p_Firsts, p_Seconds, p_Out, p_Number); return;
+#endif
+				default:				crossScalar(p_Firsts, p_Seconds, p_Out, p_Number); return;
+				}
+			}
+
+			inline void dot(const Vector3* p_Firsts, const Vector3* p_Seconds, float* p_Out, uint32_t p_Number)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	dotAVX512(p_Firsts, p_Seconds, p_Out, p_Number); return;
+				case cpu::LEVEL_AVX2:	dotAVX2(p_Firsts, p_Seconds, p_Out, p_Number); return;
+				case cpu::LEVEL_SSE2:	dotSSE2(p_Firsts, p_Seconds, p_Out, p_Number); return;
+#endif
+				default:				dotScalar(p_Firsts, p_Seconds, p_Out, p_Number); return;
+				}
+			}
+
+			template<Precision P>
+			inline void normalize(const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	normalizeAVX512<P>(p_In, p_Out, p_Number); return;
+				case cpu::LEVEL_AVX2:	normalizeAVX2<P>(p_In, p_Out, p_Number); return;
+				case cpu::LEVEL_SSE2:	normalizeSSE2<P>(p_In, p_Out, p_Number); return;
+#endif
+				default:				normalizeScalar<P>(p_In, p_Out, p_Number); return;
+				}
+			}
+
+			//---------------------------------------------------------------------
+
+			template<TransformMode MODE>
+			inline void transform(const Matrix4x4& p_Mat, const Vector3* p_In, Vector3* p_Out, uint32_t p_Number)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	transformAVX512<MODE>(p_Mat, p_In, p_Out, p_Number); return;
+				case cpu::LEVEL_AVX2:	transformAVX2<MODE>(p_Mat, p_In, p_Out, p_Number); return;
+				case cpu::LEVEL_SSE2:	transformSSE2<MODE>(p_Mat, p_In, p_Out, p_Number); return;
+#endif
+				default:				transformScalar<MODE>(p_Mat, p_In, p_Out, p_Number); return;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,302 @@
+#pragma once
+
+#include "math_types.h"
+#include "aligned.h"
+#include "lanes.h"
+#include "vector3_simd.h"
+#include <stdint.h>
+#include <string.h>
+
+// Vector3Stream keeps x, y and z in separate 64 bytes aligned lanes padded to
+// the widest SIMD width, so batch math runs on full registers with no shuffle.
+// Operations process p_First.count elements and set the output count; the
+// output must have at least that capacity and may be one of the inputs.
+
+namespace alfar
+{
+	namespace vector3stream
+	{
+		inline Vector3Stream create(uint32_t p_Capacity)
+		{
+			Vector3Stream ret;
+			uint32_t padded = aligned::paddedCount(p_Capacity);
+			float* block = (float*)aligned::allocate(padded * 3 * sizeof(float));
+
+			if(block != NULL)
+				memset(block, 0, padded * 3 * sizeof(float));
+
+			ret.x = block;
+			ret.y = block ? block + padded : NULL;
+			ret.z = block ? block + padded * 2 : NULL;
+			ret.count = 0;
+			ret.capacity = block ? padded : 0;
+
+			return ret;
+		}
+
+		inline void destroy(Vector3Stream& p_Stream)
+		{
+			aligned::release(p_Stream.x);
+
+			p_Stream.x = p_Stream.y = p_Stream.z = NULL;
+			p_Stream.count = p_Stream.capacity = 0;
+		}
+
+		//----- AoS <-> SoA
+
+		inline void fromArrayScalar(const Vector3* p_Array, float* x, float* y, float* z, uint32_t p_Start, uint32_t p_Number)
+		{
+			for(uint32_t i = p_Start; i < p_Number; ++i)
+			{
+				x[i] = p_Array[i].x;
+				y[i] = p_Array[i].y;
+				z[i] = p_Array[i].z;
+			}
+		}
+
+		inline void toArrayScalar(const float* x, const float* y, const float* z, Vector3* p_Array, uint32_t p_Start, uint32_t p_Number)
+		{
+			for(uint32_t i = p_Start; i < p_Number; ++i)
+			{
+				p_Array[i].x = x[i];
+				p_Array[i].y = y[i];
+				p_Array[i].z = z[i];
+			}
+		}
+
+#if ALFAR_X86
+
+		ALFAR_TARGET_SSE2 inline void fromArraySSE2(const Vector3* p_Array, float* x, float* y, float* z, uint32_t p_Start, uint32_t p_Number)
+		{
+			uint32_t i = p_Start;
+			for(; i + 4 <= p_Number; i += 4)
+			{
+				const float* a = &p_Array[i].x;
+				__m128 vx, vy, vz;
+				vector3::simd::deinterleave(_mm_loadu_ps(a), _mm_loadu_ps(a + 4), _mm_loadu_ps(a + 8), vx, vy, vz);
+
+				_mm_storeu_ps(x + i, vx);
+				_mm_storeu_ps(y + i, vy);
+				_mm_storeu_ps(z + i, vz);
+			}
+
+			fromArrayScalar(p_Array, x, y, z, i, p_Number);
+		}
+
+		ALFAR_TARGET_SSE2 inline void toArraySSE2(const float* x, const float* y, const float* z, Vector3* p_Array, uint32_t p_Start, uint32_t p_Number)
+		{
+			uint32_t i = p_Start;
+			for(; i + 4 <= p_Number; i += 4)
+			{
+				float* a = &p_Array[i].x;
+				__m128 m0, m1, m2;
+				vector3::simd::interleave(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i), _mm_loadu_ps(z + i), m0, m1, m2);
+
+				_mm_storeu_ps(a, m0);
+				_mm_storeu_ps(a + 4, m1);
+				_mm_storeu_ps(a + 8, m2);
+			}
+
+			toArrayScalar(x, y, z, p_Array, i, p_Number);
+		}
+
+		ALFAR_TARGET_AVX2 inline void fromArrayAVX2(const Vector3* p_Array, float* x, float* y, float* z, uint32_t p_Start, uint32_t p_Number)
+		{
+			uint32_t i = p_Start;
+			for(; i + 8 <= p_Number; i += 8)
+			{
+				__m256 m0, m1, m2, vx, vy, vz;
+				vector3::simd::load8(&p_Array[i].x, m0, m1, m2);
+				vector3::simd::deinterleave(m0, m1, m2, vx, vy, vz);
+
+				_mm256_storeu_ps(x + i, vx);
+				_mm256_storeu_ps(y + i, vy);
+				_mm256_storeu_ps(z + i, vz);
+			}
+
+			fromArraySSE2(p_Array, x, y, z, i, p_Number);
+		}
+
+		ALFAR_TARGET_AVX2 inline void toArrayAVX2(const float* x, const float* y, const float* z, Vector3* p_Array, uint32_t p_Start, uint32_t p_Number)
+		{
+			uint32_t i = p_Start;
+			for(; i + 8 <= p_Number; i += 8)
+			{
+				__m256 m0, m1, m2;
+				vector3::simd::interleave(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), _mm256_loadu_ps(z + i), m0, m1, m2);
+				vector3::simd::store8(&p_Array[i].x, m0, m1, m2);
+			}
+
+			toArraySSE2(x, y, z, p_Array, i, p_Number);
+		}
+
+		ALFAR_TARGET_AVX512 inline void fromArrayAVX512(const Vector3* p_Array, float* x, float* y, float* z, uint32_t p_Start, uint32_t p_Number)
+		{
+			uint32_t i = p_Start;
+			for(; i + 16 <= p_Number; i += 16)
+			{
+				__m512 m0, m1, m2, vx, vy, vz;
+				vector3::simd::load16(&p_Array[i].x, m0, m1, m2);
+				vector3::simd::deinterleave(m0, m1, m2, vx, vy, vz);
+
+				_mm512_storeu_ps(x + i, vx);
+				_mm512_storeu_ps(y + i, vy);
+				_mm512_storeu_ps(z + i, vz);
+			}
+
+			fromArrayAVX2(p_Array, x, y, z, i, p_Number);
+		}
+
+		ALFAR_TARGET_AVX512 inline void toArrayAVX512(const float* x, const float* y, const float* z, Vector3* p_Array, uint32_t p_Start, uint32_t p_Number)
+		{
+			uint32_t i = p_Start;
+			for(; i + 16 <= p_Number; i += 16)
+			{
+				__m512 m0, m1, m2;
+				vector3::simd::interleave(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i), _mm512_loadu_ps(z + i), m0, m1, m2);
+				vector3::simd::store16(&p_Array[i].x, m0, m1, m2);
+			}
+
+			toArrayAVX2(x, y, z, p_Array, i, p_Number);
+		}
+
+#endif
+
+		//---------------------------------------------------------------------
+
+		//p_Number must not exceed p_Out.capacity
+		inline void fromArray(const Vector3* p_Array, uint32_t p_Number, Vector3Stream& p_Out)
+		{
+			p_Out.count = p_Number;
+
+			switch(cpu::level())
+			{
+#if ALFAR_X86
+			case cpu::LEVEL_AVX512:	fromArrayAVX512(p_Array, p_Out.x, p_Out.y, p_Out.z, 0, p_Number); return;
+			case cpu::LEVEL_AVX2:	fromArrayAVX2(p_Array, p_Out.x, p_Out.y, p_Out.z, 0, p_Number); return;
+			case cpu::LEVEL_SSE2:	fromArraySSE2(p_Array, p_Out.x, p_Out.y, p_Out.z, 0, p_Number); return;
+#endif
+			default:				fromArrayScalar(p_Array, p_Out.x, p_Out.y, p_Out.z, 0, p_Number); return;
+			}
+		}
+
+		//writes p_Stream.count vectors
+		inline void toArray(const Vector3Stream& p_Stream, Vector3* p_Array)
+		{
+			switch(cpu::level())
+			{
+#if ALFAR_X86
+			case cpu::LEVEL_AVX512:	toArrayAVX512(p_Stream.x, p_Stream.y, p_Stream.z, p_Array, 0, p_Stream.count); return;
+			case cpu::LEVEL_AVX2:	toArrayAVX2(p_Stream.x, p_Stream.y, p_Stream.z, p_Array, 0, p_Stream.count); return;
+			case cpu::LEVEL_SSE2:	toArraySSE2(p_Stream.x, p_Stream.y, p_Stream.z, p_Array, 0, p_Stream.count); return;
+#endif
+			default:				toArrayScalar(p_Stream.x, p_Stream.y, p_Stream.z, p_Array, 0, p_Stream.count); return;
+			}
+		}
+
+		//----- batch math
+
+		inline void add(const Vector3Stream& p_First, const Vector3Stream& p_Second, Vector3Stream& p_Out)
+		{
+			lanes::binary<lanes::OP_ADD>(p_First.x, p_Second.x, p_Out.x, p_First.count);
+			lanes::binary<lanes::OP_ADD>(p_First.y, p_Second.y, p_Out.y, p_First.count);
+			lanes::binary<lanes::OP_ADD>(p_First.z, p_Second.z, p_Out.z, p_First.count);
+			p_Out.count = p_First.count;
+		}
+
+		//---------------------------------------------------------------------
+
+		inline void sub(const Vector3Stream& p_First, const Vector3Stream& p_Second, Vector3Stream& p_Out)
+		{
+			lanes::binary<lanes::OP_SUB>(p_First.x, p_Second.x, p_Out.x, p_First.count);
+			lanes::binary<lanes::OP_SUB>(p_First.y, p_Second.y, p_Out.y, p_First.count);
+			lanes::binary<lanes::OP_SUB>(p_First.z, p_Second.z, p_Out.z, p_First.count);
+			p_Out.count = p_First.count;
+		}
+
+		//---------------------------------------------------------------------
+
+		//one scalar per element
+		inline void mul(const Vector3Stream& p_First, const float* p_Scalars, Vector3Stream& p_Out)
+		{
+			lanes::binary<lanes::OP_SCALE>(p_First.x, p_Scalars, p_Out.x, p_First.count);
+			lanes::binary<lanes::OP_SCALE>(p_First.y, p_Scalars, p_Out.y, p_First.count);
+			lanes::binary<lanes::OP_SCALE>(p_First.z, p_Scalars, p_Out.z, p_First.count);
+			p_Out.count = p_First.count;
+		}
+
+		//---------------------------------------------------------------------
+
+		inline void scale(const Vector3Stream& p_First, const Vector3Stream& p_Second, Vector3Stream& p_Out)
+		{
+			lanes::binary<lanes::OP_SCALE>(p_First.x, p_Second.x, p_Out.x, p_First.count);
+			lanes::binary<lanes::OP_SCALE>(p_First.y, p_Second.y, p_Out.y, p_First.count);
+			lanes::binary<lanes::OP_SCALE>(p_First.z, p_Second.z, p_Out.z, p_First.count);
+			p_Out.count = p_First.count;
+		}
+
+		//---------------------------------------------------------------------
+
+		inline void cross(const Vector3Stream& p_First, const Vector3Stream& p_Second, Vector3Stream& p_Out)
+		{
+			const float* a[3] = { p_First.x, p_First.y, p_First.z };
+			const float* b[3] = { p_Second.x, p_Second.y, p_Second.z };
+			float* o[3] = { p_Out.x, p_Out.y, p_Out.z };
+
+			lanes::cross(a, b, o, p_First.count);
+			p_Out.count = p_First.count;
+		}
+
+		//---------------------------------------------------------------------
+
+		inline void dot(const Vector3Stream& p_First, const Vector3Stream& p_Second, float* p_Out)
+		{
+			const float* a[3] = { p_First.x, p_First.y, p_First.z };
+			const float* b[3] = { p_Second.x, p_Second.y, p_Second.z };
+
+			lanes::dot<3>(a, b, p_Out, p_First.count);
+		}
+
+		//---------------------------------------------------------------------
+
+		inline void magnitude(const Vector3Stream& p_Stream, float* p_Out)
+		{
+			const float* a[3] = { p_Stream.x, p_Stream.y, p_Stream.z };
+
+			lanes::magnitude<3>(a, p_Out, p_Stream.count);
+		}
+
+		//---------------------------------------------------------------------
+
+		//zero length vectors stay zero
+		inline void normalize(const Vector3Stream& p_Stream, Vector3Stream& p_Out)
+		{
+			const float* a[3] = { p_Stream.x, p_Stream.y, p_Stream.z };
+			float* o[3] = { p_Out.x, p_Out.y, p_Out.z };
+
+			lanes::normalize<3, PRECISION_EXACT>(a, o, p_Stream.count);
+			p_Out.count = p_Stream.count;
+		}
+
+		//normalize through rsqrt, see Precision in functions.h for the error of each tier
+		template<Precision P>
+		inline void fastNormalize(const Vector3Stream& p_Stream, Vector3Stream& p_Out)
+		{
+			const float* a[3] = { p_Stream.x, p_Stream.y, p_Stream.z };
+			float* o[3] = { p_Out.x, p_Out.y, p_Out.z };
+
+			lanes::normalize<3, P>(a, o, p_Stream.count);
+			p_Out.count = p_Stream.count;
+		}
+
+		//---------------------------------------------------------------------
+
+		inline void lerp(const Vector3Stream& p_First, const Vector3Stream& p_Second, float t, Vector3Stream& p_Out)
+		{
+			lanes::lerp(p_First.x, p_Second.x, t, p_Out.x, p_First.count);
+			lanes::lerp(p_First.y, p_Second.y, t, p_Out.y, p_First.count);
+			lanes::lerp(p_First.z, p_Second.z, t, p_Out.z, p_First.count);
+			p_Out.count = p_First.count;
+		}
+	}
+}
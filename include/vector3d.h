@@ -0,0 +1,102 @@
+#pragma once
+
+#include "math_types.h"
+#include "functions.h"
+#include "vector3d_simd.h"
+#include <stdint.h>
+#include <math.h>
+
+// Double precision positions for worlds larger than float precision (a float
+// keeps about 1 mm at 16 km from the origin, 0.5 m at 8000 km). The world
+// stays in doubles and rendering works in floats relative to an origin near
+// the camera: relative subtracts the origin in double and rounds the small
+// difference to float, so positions near the origin keep their precision
+// however far it is from the world's. The array version is the batched
+// rebase pass of a frame (vector3d_simd.h).
+
+namespace alfar
+{
+	namespace vector3d
+	{
+		ALFAR_CONSTEXPR Vector3d create(double x, double y, double z)
+		{
+			Vector3d ret = {};
+			ret.x = x;
+			ret.y = y;
+			ret.z = z;
+
+			return ret;
+		}
+
+		ALFAR_CONSTEXPR Vector3d fromFloat(const Vector3& p_Vec)
+		{
+			return create(p_Vec.x, p_Vec.y, p_Vec.z);
+		}
+
+		ALFAR_CONSTEXPR Vector3 toFloat(const Vector3d& p_Vec)
+		{
+			Vector3 ret = {};
+			ret.x = (float)p_Vec.x;
+			ret.y = (float)p_Vec.y;
+			ret.z = (float)p_Vec.z;
+
+			return ret;
+		}
+
+		//---------------------------------------------------------------------
+
+		ALFAR_CONSTEXPR Vector3d add(const Vector3d& p_First, const Vector3d& p_Second)
+		{
+			return create(p_First.x + p_Second.x, p_First.y + p_Second.y, p_First.z + p_Second.z);
+		}
+
+		ALFAR_CONSTEXPR Vector3d sub(const Vector3d& p_First, const Vector3d& p_Second)
+		{
+			return create(p_First.x - p_Second.x, p_First.y - p_Second.y, p_First.z - p_Second.z);
+		}
+
+		ALFAR_CONSTEXPR Vector3d mul(const Vector3d& p_Vec, double p_Scalar)
+		{
+			return create(p_Vec.x * p_Scalar, p_Vec.y * p_Scalar, p_Vec.z * p_Scalar);
+		}
+
+		ALFAR_CONSTEXPR double dot(const Vector3d& p_First, const Vector3d& p_Second)
+		{
+			return p_First.x * p_Second.x + p_First.y * p_Second.y + p_First.z * p_Second.z;
+		}
+
+		ALFAR_CONSTEXPR Vector3d cross(const Vector3d& p_First, const Vector3d& p_Second)
+		{
+			return create(p_First.y * p_Second.z - p_First.z * p_Second.y,
+						  p_First.z * p_Second.x - p_First.x * p_Second.z,
+						  p_First.x * p_Second.y - p_First.y * p_Second.x);
+		}
+
+		//---------------------------------------------------------------------
+
+		inline double magnitude(const Vector3d& p_Vec)
+		{
+			return sqrt(dot(p_Vec, p_Vec));
+		}
+
+		inline Vector3d normalize(const Vector3d& p_Vec)
+		{
+			return mul(p_Vec, 1.0 / magnitude(p_Vec));
+		}
+
+		//---------------------------------------------------------------------
+
+		//p_Position - p_Origin in float, exact up to the final rounding
+		ALFAR_CONSTEXPR Vector3 relative(const Vector3d& p_Position, const Vector3d& p_Origin)
+		{
+			return toFloat(sub(p_Position, p_Origin));
+		}
+
+		//----- array version
+
+		inline void relative(const Vector3d* p_Positions, const Vector3d& p_Origin, Vector3* p_Out, uint32_t p_Number)
+		{
+			simd::relative(&p_Positions->x, &p_Out->x, (size_t)p_Number * 3, &p_Origin.x, 3);
+		}
+	}
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "vector3d.h"
+#include "parallel.h"
+#include <stdint.h>
+
+// Camera relative rebasing of positions over the pool of a Policy.
+
+namespace alfar
+{
+	namespace vector3d
+	{
+		inline void relative(const parallel::Policy& p_Policy, const Vector3d* p_Positions, const Vector3d& p_Origin, Vector3* p_Out, uint32_t p_Number)
+		{
+			parallel::forRange(p_Policy, p_Number, [=](uint32_t p_Start, uint32_t p_End) { relative(p_Positions + p_Start, p_Origin, p_Out + p_Start, p_End - p_Start); });
+		}
+	}
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "cpu.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// SIMD kernel behind the camera relative rebasing of vector3d.h and mat4x4d.h:
+// a flat stream of doubles minus a periodic origin pattern, rounded to floats.
+// Positions repeat (ox, oy, oz) every 3 doubles, affine matrices
+// (0, 0, 0, ox, 0, 0, 0, oy, 0, 0, 0, oz, 0, 0, 0, 0) every 16. Both periods
+// divide PATTERN, which every register width divides, so the pattern is
+// unrolled once into PATTERN doubles and each register reads its slice of it.
+// SSE2 converts 4 doubles per step, AVX2 8, AVX-512 16, the rest is scalar.
+//
+// The kernel is a subtraction and a conversion per double, which round the
+// same way everywhere: the output is bit identical on every level.
+
+namespace alfar
+{
+	namespace vector3d
+	{
+		namespace simd
+		{
+			const uint32_t PATTERN = 48;
+
+			//p_Origin[p_Period] repeated over PATTERN doubles, p_Period dividing PATTERN
+			inline void repeatOrigin(const double* p_Origin, uint32_t p_Period, double* p_Out)
+			{
+				for(uint32_t k = 0; k < PATTERN; ++k)
+					p_Out[k] = p_Origin[k % p_Period];
+			}
+
+			//----- scalar tails
+
+			//the end of a block, p_Pattern at the position of p_In in it
+			inline void relativeTail(const double* p_In, float* p_Out, size_t p_Count, const double* p_Pattern)
+			{
+				for(size_t i = 0; i < p_Count; ++i)
+					p_Out[i] = (float)(p_In[i] - p_Pattern[i]);
+			}
+
+			inline void relativeScalar(const double* p_In, float* p_Out, size_t p_Count, const double* p_Pattern)
+			{
+				size_t i = 0;
+				for(; i + PATTERN <= p_Count; i += PATTERN)
+				{
+					for(uint32_t k = 0; k < PATTERN; ++k)
+						p_Out[i + k] = (float)(p_In[i + k] - p_Pattern[k]);
+				}
+
+				relativeTail(p_In + i, p_Out + i, p_Count - i, p_Pattern);
+			}
+
+#if ALFAR_X86
+
+			//===================================================================== SSE2
+
+			ALFAR_TARGET_SSE2 inline void relativeSSE2(const double* p_In, float* p_Out, size_t p_Count, const double* p_Pattern)
+			{
+				size_t i = 0;
+				for(; i + PATTERN <= p_Count; i += PATTERN)
+				{
+					for(uint32_t k = 0; k < PATTERN; k += 4)
+					{
+						__m128d a = _mm_sub_pd(_mm_loadu_pd(p_In + i + k), _mm_loadu_pd(p_Pattern + k));
+						__m128d b = _mm_sub_pd(_mm_loadu_pd(p_In + i + k + 2), _mm_loadu_pd(p_Pattern + k + 2));
+						_mm_storeu_ps(p_Out + i + k, _mm_movelh_ps(_mm_cvtpd_ps(a), _mm_cvtpd_ps(b)));
+					}
+				}
+
+				//the last partial block, still in steps of a register pair
+				uint32_t k = 0;
+				for(; i + 4 <= p_Count; i += 4, k += 4)
+				{
+					__m128d a = _mm_sub_pd(_mm_loadu_pd(p_In + i), _mm_loadu_pd(p_Pattern + k));
+					__m128d b = _mm_sub_pd(_mm_loadu_pd(p_In + i + 2), _mm_loadu_pd(p_Pattern + k + 2));
+					_mm_storeu_ps(p_Out + i, _mm_movelh_ps(_mm_cvtpd_ps(a), _mm_cvtpd_ps(b)));
+				}
+
+				relativeTail(p_In + i, p_Out + i, p_Count - i, p_Pattern + k);
+			}
+
+			//===================================================================== AVX2
+
+			ALFAR_TARGET_AVX2 inline void relativeAVX2(const double* p_In, float* p_Out, size_t p_Count, const double* p_Pattern)
+			{
+				size_t i = 0;
+				for(; i + PATTERN <= p_Count; i += PATTERN)
+				{
+					for(uint32_t k = 0; k < PATTERN; k += 8)
+					{
+						__m256d a = _mm256_sub_pd(_mm256_loadu_pd(p_In + i + k), _mm256_loadu_pd(p_Pattern + k));
+						__m256d b = _mm256_sub_pd(_mm256_loadu_pd(p_In + i + k + 4), _mm256_loadu_pd(p_Pattern + k + 4));
+						_mm256_storeu_ps(p_Out + i + k, _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(a)), _mm256_cvtpd_ps(b), 1));
+					}
+				}
+
+				//the last partial block, still in steps of a register pair
+				uint32_t k = 0;
+				for(; i + 8 <= p_Count; i += 8, k += 8)
+				{
+					__m256d a = _mm256_sub_pd(_mm256_loadu_pd(p_In + i), _mm256_loadu_pd(p_Pattern + k));
+					__m256d b = _mm256_sub_pd(_mm256_loadu_pd(p_In + i + 4), _mm256_loadu_pd(p_Pattern + k + 4));
+					_mm256_storeu_ps(p_Out + i, _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(a)), _mm256_cvtpd_ps(b), 1));
+				}
+
+				relativeTail(p_In + i, p_Out + i, p_Count - i, p_Pattern + k);
+			}
+
+			//===================================================================== AVX-512
+
+			ALFAR_TARGET_AVX512 inline void relativeAVX512(const double* p_In, float* p_Out, size_t p_Count, const double* p_Pattern)
+			{
+				size_t i = 0;
+				for(; i + PATTERN <= p_Count; i += PATTERN)
+				{
+					for(uint32_t k = 0; k < PATTERN; k += 16)
+					{
+						__m512d a = _mm512_sub_pd(_mm512_loadu_pd(p_In + i + k), _mm512_loadu_pd(p_Pattern + k));
+						__m512d b = _mm512_sub_pd(_mm512_loadu_pd(p_In + i + k + 8), _mm512_loadu_pd(p_Pattern + k + 8));
+						_mm256_storeu_ps(p_Out + i + k, _mm512_cvtpd_ps(a));
+						_mm256_storeu_ps(p_Out + i + k + 8, _mm512_cvtpd_ps(b));
+					}
+				}
+
+				//the last partial block, still in steps of a register pair
+				uint32_t k = 0;
+				for(; i + 16 <= p_Count; i += 16, k += 16)
+				{
+					__m512d a = _mm512_sub_pd(_mm512_loadu_pd(p_In + i), _mm512_loadu_pd(p_Pattern + k));
+					__m512d b = _mm512_sub_pd(_mm512_loadu_pd(p_In + i + 8), _mm512_loadu_pd(p_Pattern + k + 8));
+					_mm256_storeu_ps(p_Out + i, _mm512_cvtpd_ps(a));
+					_mm256_storeu_ps(p_Out + i + 8, _mm512_cvtpd_ps(b));
+				}
+
+				relativeTail(p_In + i, p_Out + i, p_Count - i, p_Pattern + k);
+			}
+
+#endif
+
+			//===================================================================== dispatch
+
+			//p_Out[i] = (float)(p_In[i] - p_Origin[i % p_Period]), p_Period dividing PATTERN
+			inline void relative(const double* p_In, float* p_Out, size_t p_Count, const double* p_Origin, uint32_t p_Period)
+			{
+				double pattern[PATTERN];
+				repeatOrigin(p_Origin, p_Period, pattern);
+
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	relativeAVX512(p_In, p_Out, p_Count, pattern); return;
+				case cpu::LEVEL_AVX2:	relativeAVX2(p_In, p_Out, p_Count, pattern); return;
+				case cpu::LEVEL_SSE2:	relativeSSE2(p_In, p_Out, p_Count, pattern); return;
+#endif
+				default:				relativeScalar(p_In, p_Out, p_Count, pattern); return;
+				}
+			}
+		}
+	}
+}
@@ -3,18 +3,21 @@
 #include "math_types.h"
 #include "functions.h"
 #include "vector3.h"
+#include "lanes.h"
+#include "vector4_simd.h"
 #include <stdint.h>
 #include <algorithm>
 #include <math.h>
 #include <memory>
+#include <string.h>
 
 namespace alfar
 {
     namespace vector4
     {
-        inline Vector4 create(float x, float y, float z, float w)
+        ALFAR_CONSTEXPR Vector4 create(float x, float y, float z, float w)
         {
-            Vector4 ret;
+            Vector4 ret = {};
             ret.x = x;
             ret.y = y;
             ret.z = z;
@@ -25,23 +28,23 @@ namespace alfar
 
         //-------------------------------------------------------------------
 
-        inline Vector4 create(Vector3 p_Vect, float w = 1.0f)
+        ALFAR_CONSTEXPR Vector4 create(Vector3 p_Vect, float w = 1.0f)
         {
             return create(p_Vect.x, p_Vect.y, p_Vect.z, w);
         }
 
 		//------------------------------------------------------------------
 
-		inline Vector3 toVec3(alfar::Vector4 vec)
+		ALFAR_CONSTEXPR Vector3 toVec3(alfar::Vector4 vec)
 		{
 			return alfar::vector3::create(vec.x, vec.y, vec.z);
 		}
 
         //-------------------------------------------------------------------
 
-        inline Vector4 add(const Vector4& p_First, const Vector4& p_Second)
+        ALFAR_CONSTEXPR Vector4 add(const Vector4& p_First, const Vector4& p_Second)
         {
-            Vector4 ret;
+            Vector4 ret = {};
             ret.x = p_First.x + p_Second.x;
             ret.y = p_First.y + p_Second.y;
             ret.z = p_First.z + p_Second.z;
@@ -52,9 +55,9 @@ namespace alfar
 
         //---------------------------------------------------------------------
 
-        inline Vector4 sub(const Vector4& p_First, const Vector4& p_Second)
+        ALFAR_CONSTEXPR Vector4 sub(const Vector4& p_First, const Vector4& p_Second)
         {
-            Vector4 ret;
+            Vector4 ret = {};
             ret.x = p_First.x - p_Second.x;
             ret.y = p_First.y - p_Second.y;
             ret.z = p_First.z - p_Second.z;
@@ -65,9 +68,9 @@ namespace alfar
 
         //---------------------------------------------------------------------
 
-        inline Vector4 mul(const Vector4& p_Vec, const float p_Scalar)
+        ALFAR_CONSTEXPR Vector4 mul(const Vector4& p_Vec, const float p_Scalar)
         {
-            Vector4 ret;
+            Vector4 ret = {};
             ret.x = p_Vec.x * p_Scalar;
             ret.y = p_Vec.y * p_Scalar;
             ret.z = p_Vec.z * p_Scalar;
@@ -78,9 +81,9 @@ namespace alfar
 
 		//=======================================================================
 
-		inline Vector4 mul(const Matrix4x4& p_Mat, const Vector4& p_Vec)
+		ALFAR_CONSTEXPR Vector4 mul(const Matrix4x4& p_Mat, const Vector4& p_Vec)
 		{
-			Vector4 ret;
+			Vector4 ret = {};
 
 			ret.x = p_Mat.x.x * p_Vec.x + p_Mat.x.y * p_Vec.y + p_Mat.x.z * p_Vec.z + p_Mat.x.w * p_Vec.w;
 			ret.y = p_Mat.y.x * p_Vec.x + p_Mat.y.y * p_Vec.y + p_Mat.y.z * p_Vec.z + p_Mat.y.w * p_Vec.w;
@@ -92,9 +95,9 @@ namespace alfar
 
 		//-----------------------------------------------------------------------
 
-		inline float lengthSqr(const Vector4& p_vec)
+		ALFAR_CONSTEXPR float lengthSqr(const Vector4& p_vec)
 		{
-			return p_vec.x * p_vec.x + p_vec.y * p_vec.y + p_vec.z * p_vec.z + p_vec.w + p_vec.w;
+			return p_vec.x * p_vec.x + p_vec.y * p_vec.y + p_vec.z * p_vec.z + p_vec.w * p_vec.w;
 		}
 
 		inline float length(const Vector4& p_vec)
@@ -102,11 +105,15 @@ namespace alfar
 			return sqrt(lengthSqr(p_vec));
 		}
 
+		//zero vectors stay zero
 		inline Vector4 normalize(const Vector4& p_vec)
 		{
-			Vector4 ret;
+			Vector4 ret = {};
 			float norme = length(p_vec);
 
+			if(norme <= 0)
+				return ret;
+
 			ret.x = p_vec.x / norme;
 			ret.y = p_vec.y / norme;
 			ret.z = p_vec.z / norme;
@@ -115,11 +122,32 @@ namespace alfar
 			return ret;
 		}
 
+		//normalize and length through rsqrt<P>, see Precision for the relative error
+		//of each tier. zero vectors stay zero.
+		template<Precision P = PRECISION_REFINED>
+		inline Vector4 fastNormalize(const Vector4& p_vec)
+		{
+			float f = lanes::normalizeFactorScalar<P>(lengthSqr(p_vec));
+
+			return create(lanes::normalizeApplyScalar<P>(p_vec.x, f),
+						  lanes::normalizeApplyScalar<P>(p_vec.y, f),
+						  lanes::normalizeApplyScalar<P>(p_vec.z, f),
+						  lanes::normalizeApplyScalar<P>(p_vec.w, f));
+		}
+
+		template<Precision P = PRECISION_REFINED>
+		inline float fastLength(const Vector4& p_vec)
+		{
+			float d = lengthSqr(p_vec);
+
+			return P == PRECISION_EXACT ? sqrtf(d) : d * lanes::normalizeFactorScalar<P>(d);
+		}
+
         //-----------------------------------------------------------------------
 
-        inline Vector4 scale(const Vector4& p_First, const Vector4& p_Second)
+        ALFAR_CONSTEXPR Vector4 scale(const Vector4& p_First, const Vector4& p_Second)
         {
-            Vector4 ret;
+            Vector4 ret = {};
             ret.x = p_First.x * p_Second.x;
             ret.y = p_First.y * p_Second.y;
             ret.z = p_First.z * p_Second.z;
@@ -130,14 +158,14 @@ namespace alfar
 
 		//---------------------------------------------------------------------------
 
-		inline Vector4 interpolatedFromBarycentric(const Vector4& v1, const Vector4& v2, const Vector4& v3, const Vector3& barycentric)
+		ALFAR_CONSTEXPR Vector4 interpolatedFromBarycentric(const Vector4& v1, const Vector4& v2, const Vector4& v3, const Vector3& barycentric)
 		{
 			return vector4::add(vector4::add(vector4::mul(v1, barycentric.x), vector4::mul(v2, barycentric.y)), vector4::mul(v3, barycentric.z));
 		}
 
 		//---------------------------------------------------------------------------
 
-		inline Vector4 lerp(const Vector4& p1, const Vector4& p2, float t)
+		ALFAR_CONSTEXPR Vector4 lerp(const Vector4& p1, const Vector4& p2, float t)
 		{
 			return vector4::create(	p1.x * (1.0f - t) + p2.x * t, 
 									p1.y * (1.0f - t) + p2.y * t,
@@ -147,7 +175,7 @@ namespace alfar
 
 		//---------------------------------------------------------------------------
 
-		inline Vector4 clamp(const Vector4& p, const float min, const float max)
+		ALFAR_CONSTEXPR Vector4 clamp(const Vector4& p, const float min, const float max)
 		{
 			return vector4::create(	
 				alfar::clamp(p.x, min, max), 
@@ -158,7 +186,7 @@ namespace alfar
 
         //---------------------------------------------------------------------------
 
-        inline float dot(const Vector4& p_First, const Vector4& p_Second)
+        ALFAR_CONSTEXPR float dot(const Vector4& p_First, const Vector4& p_Second)
         {
             return p_First.x * p_Second.x + p_First.y * p_Second.y + p_First.z * p_Second.z;
         }
@@ -254,5 +282,19 @@ namespace alfar
                 o = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
             }
         }
+
+        //--------------------------------------------------------------------------------------
+
+        //p_Out[i] = normalize(p_In[i]) and fastNormalize<P>(p_In[i]); p_Out may be p_In.
+        inline void normalize(const Vector4* p_In, Vector4* p_Out, uint32_t p_Number)
+        {
+            simd::normalize<PRECISION_EXACT>(&p_In->x, &p_Out->x, p_Number);
+        }
+
+        template<Precision P = PRECISION_REFINED>
+        inline void fastNormalize(const Vector4* p_In, Vector4* p_Out, uint32_t p_Number)
+        {
+            simd::normalize<P>(&p_In->x, &p_Out->x, p_Number);
+        }
     }
 }
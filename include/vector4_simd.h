@@ -0,0 +1,263 @@
+#pragma once
+
+#include "math_types.h"
+#include "cpu.h"
+#include "lanes.h"
+#include <stdint.h>
+
+// SIMD kernels behind the vector4 batch functions. A Vector4 fills one 128
+// bits lane, so a matrix transform is the sum of the matrix columns scaled by
+// the broadcast x, y, z and w of each vector. normalize works on any array of
+// 4 floats records (Vector4, Quaternion): the squared lengths of 4 records are
+// gathered in one lane by a transposing sum and their lanes.h normalize factors
+// broadcast back. p_Out may alias p_In exactly.
+
+namespace alfar
+{
+	namespace vector4
+	{
+		namespace simd
+		{
+			static_assert(sizeof(Vector4) == 4 * sizeof(float), "Vector4 must be 4 packed floats");
+
+			inline void transformScalar(const Matrix4x4& m, const Vector4* p_In, Vector4* p_Out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+				{
+					Vector4 v = p_In[i];
+
+					p_Out[i].x = m.x.x * v.x + m.x.y * v.y + m.x.z * v.z + m.x.w * v.w;
+					p_Out[i].y = m.y.x * v.x + m.y.y * v.y + m.y.z * v.z + m.y.w * v.w;
+					p_Out[i].z = m.z.x * v.x + m.z.y * v.y + m.z.z * v.z + m.z.w * v.w;
+					p_Out[i].w = m.t.x * v.x + m.t.y * v.y + m.t.z * v.z + m.t.w * v.w;
+				}
+			}
+
+			template<Precision P>
+			inline void normalizeScalar(const float* p_In, float* p_Out, uint32_t p_Number)
+			{
+				for(uint32_t i = 0; i < p_Number; ++i)
+				{
+					const float* v = p_In + i * 4;
+					float* o = p_Out + i * 4;
+					float f = lanes::normalizeFactorScalar<P>(v[0] * v[0] + v[1] * v[1] + v[2] * v[2] + v[3] * v[3]);
+
+					for(int c = 0; c < 4; ++c)
+						o[c] = lanes::normalizeApplyScalar<P>(v[c], f);
+				}
+			}
+
+#if ALFAR_X86
+
+			//columns of the matrix, c[k] = (x.k, y.k, z.k, t.k)
+			ALFAR_TARGET_SSE2 inline void columns(const Matrix4x4& m, __m128* c)
+			{
+				c[0] = _mm_loadu_ps(&m.x.x);
+				c[1] = _mm_loadu_ps(&m.y.x);
+				c[2] = _mm_loadu_ps(&m.z.x);
+				c[3] = _mm_loadu_ps(&m.t.x);
+				_MM_TRANSPOSE4_PS(c[0], c[1], c[2], c[3]);
+			}
+
+			ALFAR_TARGET_SSE2 inline void transformSSE2(const Matrix4x4& p_Mat, const Vector4* p_In, Vector4* p_Out, uint32_t p_Number)
+			{
+				__m128 c[4];
+				columns(p_Mat, c);
+
+				for(uint32_t i = 0; i < p_Number; ++i)
+				{
+					__m128 v = _mm_loadu_ps(&p_In[i].x);
+
+					__m128 r = _mm_mul_ps(c[0], _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+					r = _mm_add_ps(r, _mm_mul_ps(c[1], _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+					r = _mm_add_ps(r, _mm_mul_ps(c[2], _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+					r = _mm_add_ps(r, _mm_mul_ps(c[3], _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))));
+
+					_mm_storeu_ps(&p_Out[i].x, r);
+				}
+			}
+
+			//---------------------------------------------------------------------
+
+			//squared lengths of m0..m3, in that order in each 128 bits lane
+			ALFAR_TARGET_SSE2 inline __m128 lengthSqr4(__m128 m0, __m128 m1, __m128 m2, __m128 m3)
+			{
+				__m128 s0 = _mm_mul_ps(m0, m0), s1 = _mm_mul_ps(m1, m1), s2 = _mm_mul_ps(m2, m2), s3 = _mm_mul_ps(m3, m3);
+				__m128 t0 = _mm_add_ps(_mm_unpacklo_ps(s0, s1), _mm_unpackhi_ps(s0, s1));
+				__m128 t1 = _mm_add_ps(_mm_unpacklo_ps(s2, s3), _mm_unpackhi_ps(s2, s3));
+
+				return _mm_add_ps(_mm_movelh_ps(t0, t1), _mm_movehl_ps(t1, t0));
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_SSE2 inline void normalizeSSE2(const float* p_In, float* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 4 <= p_Number; i += 4)
+				{
+					const float* a = p_In + i * 4;
+					float* o = p_Out + i * 4;
+
+					__m128 m0 = _mm_loadu_ps(a), m1 = _mm_loadu_ps(a + 4), m2 = _mm_loadu_ps(a + 8), m3 = _mm_loadu_ps(a + 12);
+					__m128 f = lanes::normalizeFactorSSE2<P>(lengthSqr4(m0, m1, m2, m3));
+
+					_mm_storeu_ps(o, lanes::normalizeApplySSE2<P>(m0, _mm_shuffle_ps(f, f, _MM_SHUFFLE(0, 0, 0, 0))));
+					_mm_storeu_ps(o + 4, lanes::normalizeApplySSE2<P>(m1, _mm_shuffle_ps(f, f, _MM_SHUFFLE(1, 1, 1, 1))));
+					_mm_storeu_ps(o + 8, lanes::normalizeApplySSE2<P>(m2, _mm_shuffle_ps(f, f, _MM_SHUFFLE(2, 2, 2, 2))));
+					_mm_storeu_ps(o + 12, lanes::normalizeApplySSE2<P>(m3, _mm_shuffle_ps(f, f, _MM_SHUFFLE(3, 3, 3, 3))));
+				}
+
+				normalizeScalar<P>(p_In + i * 4, p_Out + i * 4, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX2 inline void transformAVX2(const Matrix4x4& p_Mat, const Vector4* p_In, Vector4* p_Out, uint32_t p_Number)
+			{
+				__m128 c4[4];
+				columns(p_Mat, c4);
+
+				__m256 c[4];
+				for(int k = 0; k < 4; ++k)
+					c[k] = _mm256_insertf128_ps(_mm256_castps128_ps256(c4[k]), c4[k], 1);
+
+				uint32_t i = 0;
+				for(; i + 2 <= p_Number; i += 2)
+				{
+					__m256 v = _mm256_loadu_ps(&p_In[i].x);
+
+					__m256 r = _mm256_mul_ps(c[0], _mm256_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+					r = _mm256_fmadd_ps(c[1], _mm256_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)), r);
+					r = _mm256_fmadd_ps(c[2], _mm256_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)), r);
+					r = _mm256_fmadd_ps(c[3], _mm256_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)), r);
+
+					_mm256_storeu_ps(&p_Out[i].x, r);
+				}
+
+				transformSSE2(p_Mat, p_In + i, p_Out + i, p_Number - i);
+			}
+
+			//m_k holds records 2k, 2k + 1: lane 0 sums records 0, 2, 4, 6 and lane 1 records 1, 3, 5, 7.
+			ALFAR_TARGET_AVX2 inline __m256 lengthSqr4(__m256 m0, __m256 m1, __m256 m2, __m256 m3)
+			{
+				__m256 s0 = _mm256_mul_ps(m0, m0), s1 = _mm256_mul_ps(m1, m1), s2 = _mm256_mul_ps(m2, m2), s3 = _mm256_mul_ps(m3, m3);
+				__m256 t0 = _mm256_add_ps(_mm256_unpacklo_ps(s0, s1), _mm256_unpackhi_ps(s0, s1));
+				__m256 t1 = _mm256_add_ps(_mm256_unpacklo_ps(s2, s3), _mm256_unpackhi_ps(s2, s3));
+
+				return _mm256_add_ps(_mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0)), _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2)));
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_AVX2 inline void normalizeAVX2(const float* p_In, float* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 8 <= p_Number; i += 8)
+				{
+					const float* a = p_In + i * 4;
+					float* o = p_Out + i * 4;
+
+					__m256 m0 = _mm256_loadu_ps(a), m1 = _mm256_loadu_ps(a + 8), m2 = _mm256_loadu_ps(a + 16), m3 = _mm256_loadu_ps(a + 24);
+					__m256 f = lanes::normalizeFactorAVX2<P>(lengthSqr4(m0, m1, m2, m3));
+
+					_mm256_storeu_ps(o, lanes::normalizeApplyAVX2<P>(m0, _mm256_shuffle_ps(f, f, _MM_SHUFFLE(0, 0, 0, 0))));
+					_mm256_storeu_ps(o + 8, lanes::normalizeApplyAVX2<P>(m1, _mm256_shuffle_ps(f, f, _MM_SHUFFLE(1, 1, 1, 1))));
+					_mm256_storeu_ps(o + 16, lanes::normalizeApplyAVX2<P>(m2, _mm256_shuffle_ps(f, f, _MM_SHUFFLE(2, 2, 2, 2))));
+					_mm256_storeu_ps(o + 24, lanes::normalizeApplyAVX2<P>(m3, _mm256_shuffle_ps(f, f, _MM_SHUFFLE(3, 3, 3, 3))));
+				}
+
+				normalizeSSE2<P>(p_In + i * 4, p_Out + i * 4, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX512 inline void transformAVX512(const Matrix4x4& p_Mat, const Vector4* p_In, Vector4* p_Out, uint32_t p_Number)
+			{
+				__m128 c4[4];
+				columns(p_Mat, c4);
+
+				__m512 c[4];
+				for(int k = 0; k < 4; ++k)
+					c[k] = _mm512_broadcast_f32x4(c4[k]);
+
+				uint32_t i = 0;
+				for(; i + 4 <= p_Number; i += 4)
+				{
+					__m512 v = _mm512_loadu_ps(&p_In[i].x);
+
+					__m512 r = _mm512_mul_ps(c[0], _mm512_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+					r = _mm512_fmadd_ps(c[1], _mm512_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)), r);
+					r = _mm512_fmadd_ps(c[2], _mm512_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)), r);
+					r = _mm512_fmadd_ps(c[3], _mm512_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)), r);
+
+					_mm512_storeu_ps(&p_Out[i].x, r);
+				}
+
+				transformAVX2(p_Mat, p_In + i, p_Out + i, p_Number - i);
+			}
+
+			//---------------------------------------------------------------------
+
+			ALFAR_TARGET_AVX512 inline __m512 lengthSqr4(__m512 m0, __m512 m1, __m512 m2, __m512 m3)
+			{
+				__m512 s0 = _mm512_mul_ps(m0, m0), s1 = _mm512_mul_ps(m1, m1), s2 = _mm512_mul_ps(m2, m2), s3 = _mm512_mul_ps(m3, m3);
+				__m512 t0 = _mm512_add_ps(_mm512_unpacklo_ps(s0, s1), _mm512_unpackhi_ps(s0, s1));
+				__m512 t1 = _mm512_add_ps(_mm512_unpacklo_ps(s2, s3), _mm512_unpackhi_ps(s2, s3));
+
+				return _mm512_add_ps(_mm512_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0)), _mm512_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2)));
+			}
+
+			template<Precision P>
+			ALFAR_TARGET_AVX512 inline void normalizeAVX512(const float* p_In, float* p_Out, uint32_t p_Number)
+			{
+				uint32_t i = 0;
+				for(; i + 16 <= p_Number; i += 16)
+				{
+					const float* a = p_In + i * 4;
+					float* o = p_Out + i * 4;
+
+					__m512 m0 = _mm512_loadu_ps(a), m1 = _mm512_loadu_ps(a + 16), m2 = _mm512_loadu_ps(a + 32), m3 = _mm512_loadu_ps(a + 48);
+					__m512 f = lanes::normalizeFactorAVX512<P>(lengthSqr4(m0, m1, m2, m3));
+
+					_mm512_storeu_ps(o, lanes::normalizeApplyAVX512<P>(m0, _mm512_shuffle_ps(f, f, _MM_SHUFFLE(0, 0, 0, 0))));
+					_mm512_storeu_ps(o + 16, lanes::normalizeApplyAVX512<P>(m1, _mm512_shuffle_ps(f, f, _MM_SHUFFLE(1, 1, 1, 1))));
+					_mm512_storeu_ps(o + 32, lanes::normalizeApplyAVX512<P>(m2, _mm512_shuffle_ps(f, f, _MM_SHUFFLE(2, 2, 2, 2))));
+					_mm512_storeu_ps(o + 48, lanes::normalizeApplyAVX512<P>(m3, _mm512_shuffle_ps(f, f, _MM_SHUFFLE(3, 3, 3, 3))));
+				}
+
+				normalizeAVX2<P>(p_In + i * 4, p_Out + i * 4, p_Number - i);
+			}
+
+#endif
+
+			//===================================================================== dispatch
+
+			inline void transform(const Matrix4x4& p_Mat, const Vector4* p_In, Vector4* p_Out, uint32_t p_Number)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	transformAVX512(p_Mat, p_In, p_Out, p_Number); return;
+				case cpu::LEVEL_AVX2:	transformAVX2(p_Mat, p_In, p_Out, p_Number); return;
+				case cpu::LEVEL_SSE2:	transformSSE2(p_Mat, p_In, p_Out, p_Number); return;
+#endif
+				default:				transformScalar(p_Mat, p_In, p_Out, p_Number); return;
+				}
+			}
+
+			//p_Number records of 4 floats
+			template<Precision P>
+			inline void normalize(const float* p_In, float* p_Out, uint32_t p_Number)
+			{
+				switch(cpu::level())
+				{
+#if ALFAR_X86
+				case cpu::LEVEL_AVX512:	normalizeAVX512<P>(p_In, p_Out, p_Number); return;
+				case cpu::LEVEL_AVX2:	normalizeAVX2<P>(p_In, p_Out, p_Number); return;
+				case cpu::LEVEL_SSE2:	normalizeSSE2<P>(p_In, p_Out, p_Number); return;
+#endif
+				default:				normalizeScalar<P>(p_In, p_Out, p_Number); return;
+				}
+			}
+		}
+	}
+}
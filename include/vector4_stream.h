@@ -0,0 +1,252 @@
+#pragma once
+
+#include "math_types.h"
+#include "aligned.h"
+#include "lanes.h"
+#include <stdint.h>
+#include <string.h>
+
+// Vector4Stream is the 4 lanes counterpart of Vector3Stream (vector3_stream.h),
+// with the same capacity, count and aliasing rules. dot, magnitude and
+// normalize use all 4 components.
+
+namespace alfar
+{
+	namespace vector4stream
+	{
+		inline Vector4Stream create(uint32_t p_Capacity)
+		{
+			Vector4Stream ret;
+			uint32_t padded = aligned::paddedCount(p_Capacity);
+			float* block = (float*)aligned::allocate(padded * 4 * sizeof(float));
+
+			if(block != NULL)
+				memset(block, 0, padded * 4 * sizeof(float));
+
+			ret.x = block;
+			ret.y = block ? block + padded : NULL;
+			ret.z = block ? block + padded * 2 : NULL;
+			ret.w = block ? block + padded * 3 : NULL;
+			ret.count = 0;
+			ret.capacity = block ? padded : 0;
+
+			return ret;
+		}
+
+		inline void destroy(Vector4Stream& p_Stream)
+		{
+			aligned::release(p_Stream.x);
+
+			p_Stream.x = p_Stream.y = p_Stream.z = p_Stream.w = NULL;
+			p_Stream.count = p_Stream.capacity = 0;
+		}
+
+		//----- AoS <-> SoA
+
+		inline void fromArrayScalar(const Vector4* p_Array, Vector4Stream& p_Out, uint32_t p_Start, uint32_t p_Number)
+		{
+			for(uint32_t i = p_Start; i < p_Number; ++i)
+			{
+				p_Out.x[i] = p_Array[i].x;
+				p_Out.y[i] = p_Array[i].y;
+				p_Out.z[i] = p_Array[i].z;
+				p_Out.w[i] = p_Array[i].w;
+			}
+		}
+
+		inline void toArrayScalar(const Vector4Stream& p_Stream, Vector4* p_Array, uint32_t p_Start, uint32_t p_Number)
+		{
+			for(uint32_t i = p_Start; i < p_Number; ++i)
+			{
+				p_Array[i].x = p_Stream.x[i];
+				p_Array[i].y = p_Stream.y[i];
+				p_Array[i].z = p_Stream.z[i];
+				p_Array[i].w = p_Stream.w[i];
+			}
+		}
+
+#if ALFAR_X86
+
+		//a 4x4 transpose per 4 vectors; wider registers would only add cross-lane shuffles.
+		ALFAR_TARGET_SSE2 inline void fromArraySSE2(const Vector4* p_Array, Vector4Stream& p_Out, uint32_t p_Number)
+		{
+			uint32_t i = 0;
+			for(; i + 4 <= p_Number; i += 4)
+			{
+				const float* a = &p_Array[i].x;
+				__m128 r0 = _mm_loadu_ps(a), r1 = _mm_loadu_ps(a + 4), r2 = _mm_loadu_ps(a + 8), r3 = _mm_loadu_ps(a + 12);
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+				_mm_storeu_ps(p_Out.x + i, r0);
+				_mm_storeu_ps(p_Out.y + i, r1);
+				_mm_storeu_ps(p_Out.z + i, r2);
+				_mm_storeu_ps(p_Out.w + i, r3);
+			}
+
+			fromArrayScalar(p_Array, p_Out, i, p_Number);
+		}
+
+		ALFAR_TARGET_SSE2 inline void toArraySSE2(const Vector4Stream& p_Stream, Vector4* p_Array, uint32_t p_Number)
+		{
+			uint32_t i = 0;
+			for(; i + 4 <= p_Number; i += 4)
+			{
+				float* a = &p_Array[i].x;
+				__m128 r0 = _mm_loadu_ps(p_Stream.x + i), r1 = _mm_loadu_ps(p_Stream.y + i);
+				__m128 r2 = _mm_loadu_ps(p_Stream.z + i), r3 = _mm_loadu_ps(p_Stream.w + i);
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+				_mm_storeu_ps(a, r0);
+				_mm_storeu_ps(a + 4, r1);
+				_mm_storeu_ps(a + 8, r2);
+				_mm_storeu_ps(a + 12, r3);
+			}
+
+			toArrayScalar(p_Stream, p_Array, i, p_Number);
+		}
+
+#endif
+
+		//---------------------------------------------------------------------
+
+		//p_Number must not exceed p_Out.capacity
+		inline void fromArray(const Vector4* p_Array, uint32_t p_Number, Vector4Stream& p_Out)
+		{
+			p_Out.count = p_Number;
+
+#if ALFAR_X86
+			if(cpu::level() >= cpu::LEVEL_SSE2)
+			{
+				fromArraySSE2(p_Array, p_Out, p_Number);
+				return;
+			}
+#endif
+			fromArrayScalar(p_Array, p_Out, 0, p_Number);
+		}
+
+		//writes p_Stream.count vectors
+		inline void toArray(const Vector4Stream& p_Stream, Vector4* p_Array)
+		{
+#if ALFAR_X86
+			if(cpu::level() >= cpu::LEVEL_SSE2)
+			{
+				toArraySSE2(p_Stream, p_Array, p_Stream.count);
+				return;
+			}
+#endif
+			toArrayScalar(p_Stream, p_Array, 0, p_Stream.count);
+		}
+
+		//----- batch math
+
+		inline void add(const Vector4Stream& p_First, const Vector4Stream& p_Second, Vector4Stream& p_Out)
+		{
+			lanes::binary<lanes::OP_ADD>(p_First.x, p_Second.x, p_Out.x, p_First.count);
+			lanes::binary<lanes::OP_ADD>(p_First.y, p_Second.y, p_Out.y, p_First.count);
+			lanes::binary<lanes::OP_ADD>(p_First.z, p_Second.z, p_Out.z, p_First.count);
+			lanes::binary<lanes::OP_ADD>(p_First.w, p_Second.w, p_Out.w, p_First.count);
+			p_Out.count = p_First.count;
+		}
+
+		//---------------------------------------------------------------------
+
+		inline void sub(const Vector4Stream& p_First, const Vector4Stream& p_Second, Vector4Stream& p_Out)
+		{
+			lanes::binary<lanes::OP_SUB>(p_First.x, p_Second.x, p_Out.x, p_First.count);
+			lanes::binary<lanes::OP_SUB>(p_First.y, p_Second.y, p_Out.y, p_First.count);
+			lanes::binary<lanes::OP_SUB>(p_First.z, p_Second.z, p_Out.z, p_First.count);
+			lanes::binary<lanes::OP_SUB>(p_First.w, p_Second.w, p_Out.w, p_First.count);
+			p_Out.count = p_First.count;
+		}
+
+		//---------------------------------------------------------------------
+
+		//one scalar per element
+		inline void mul(const Vector4Stream& p_First, const float* p_Scalars, Vector4Stream& p_Out)
+		{
+			lanes::binary<lanes::OP_SCALE>(p_First.x, p_Scalars, p_Out.x, p_First.count);
+			lanes::binary<lanes::OP_SCALE>(p_First.y, p_Scalars, p_Out.y, p_First.count);
+			lanes::binary<lanes::OP_SCALE>(p_First.z, p_Scalars, p_Out.z, p_First.count);
+			lanes::binary<lanes::OP_SCALE>(p_First.w, p_Scalars, p_Out.w, p_First.count);
+			p_Out.count = p_First.count;
+		}
+
+		//---------------------------------------------------------------------
+
+		inline void scale(const Vector4Stream& p_First, const Vector4Stream& p_Second, Vector4Stream& p_Out)
+		{
+			lanes::binary<lanes::OP_SCALE>(p_First.x, p_Second.x, p_Out.x, p_First.count);
+			lanes::binary<lanes::OP_SCALE>(p_First.y, p_Second.y, p_Out.y, p_First.count);
+			lanes::binary<lanes::OP_SCALE>(p_First.z, p_Second.z, p_Out.z, p_First.count);
+			lanes::binary<lanes::OP_SCALE>(p_First.w, p_Second.w, p_Out.w, p_First.count);
+			p_Out.count = p_First.count;
+		}
+
+		//---------------------------------------------------------------------
+
+		//cross product of the xyz parts, w is set to 0
+		inline void cross(const Vector4Stream& p_First, const Vector4Stream& p_Second, Vector4Stream& p_Out)
+		{
+			const float* a[3] = { p_First.x, p_First.y, p_First.z };
+			const float* b[3] = { p_Second.x, p_Second.y, p_Second.z };
+			float* o[3] = { p_Out.x, p_Out.y, p_Out.z };
+
+			lanes::cross(a, b, o, p_First.count);
+			memset(p_Out.w, 0, p_First.count * sizeof(float));
+			p_Out.count = p_First.count;
+		}
+
+		//---------------------------------------------------------------------
+
+		inline void dot(const Vector4Stream& p_First, const Vector4Stream& p_Second, float* p_Out)
+		{
+			const float* a[4] = { p_First.x, p_First.y, p_First.z, p_First.w };
+			const float* b[4] = { p_Second.x, p_Second.y, p_Second.z, p_Second.w };
+
+			lanes::dot<4>(a, b, p_Out, p_First.count);
+		}
+
+		//---------------------------------------------------------------------
+
+		inline void magnitude(const Vector4Stream& p_Stream, float* p_Out)
+		{
+			const float* a[4] = { p_Stream.x, p_Stream.y, p_Stream.z, p_Stream.w };
+
+			lanes::magnitude<4>(a, p_Out, p_Stream.count);
+		}
+
+		//---------------------------------------------------------------------
+
+		//zero length vectors stay zero
+		inline void normalize(const Vector4Stream& p_Stream, Vector4Stream& p_Out)
+		{
+			const float* a[4] = { p_Stream.x, p_Stream.y, p_Stream.z, p_Stream.w };
+			float* o[4] = { p_Out.x, p_Out.y, p_Out.z, p_Out.w };
+
+			lanes::normalize<4, PRECISION_EXACT>(a, o, p_Stream.count);
+			p_Out.count = p_Stream.count;
+		}
+
+		//normalize through rsqrt, see Precision in functions.h for the error of each tier
+		template<Precision P>
+		inline void fastNormalize(const Vector4Stream& p_Stream, Vector4Stream& p_Out)
+		{
+			const float* a[4] = { p_Stream.x, p_Stream.y, p_Stream.z, p_Stream.w };
+			float* o[4] = { p_Out.x, p_Out.y, p_Out.z, p_Out.w };
+
+			lanes::normalize<4, P>(a, o, p_Stream.count);
+			p_Out.count = p_Stream.count;
+		}
+
+		//---------------------------------------------------------------------
+
+		inline void lerp(const Vector4Stream& p_First, const Vector4Stream& p_Second, float t, Vector4Stream& p_Out)
+		{
+			lanes::lerp(p_First.x, p_Second.x, t, p_Out.x, p_First.count);
+			lanes::lerp(p_First.y, p_Second.y, t, p_Out.y, p_First.count);
+			lanes::lerp(p_First.z, p_Second.z, t, p_Out.z, p_First.count);
+			lanes::lerp(p_First.w, p_Second.w, t, p_Out.w, p_First.count);
+			p_Out.count = p_First.count;
+		}
+	}
+}
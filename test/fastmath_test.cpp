@@ -0,0 +1,267 @@
+#include "test.h"
+#include "fastmath.h"
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include <random>
+#include <vector>
+
+using namespace alfar;
+
+// Checks the error table of fastmath.h on every dispatch level, against the
+// double precision libm functions. The inputs walk the float bit patterns of
+// each documented domain with a stride, so every exponent is covered; the
+// exhaustive sweeps behind the table take minutes, this takes seconds.
+
+namespace
+{
+	//the table of fastmath.h, APPROXIMATE then REFINED
+	const double SIN_COS[2] = { 1.7e-4, 9.4e-8 };		//abs, |x| < 10^4
+	const double ATAN2[2] = { 1.2e-5, 2.7e-7 };			//rad
+	const double ACOS[2] = { 6.8e-5, 3.1e-7 };			//rad
+	const double EXP[2] = { 1.5e-5, 1.2e-7 };			//relative, normal results
+	const double LOG_ABS[2] = { 8.9e-5, 4.7e-8 };		//abs, results in [-1, 1]
+	const double LOG_REL[2] = { 8.6e-5, 8.2e-8 };		//relative beyond
+
+	const size_t BATCH = 1 << 16;
+
+	float fromBits(uint32_t p_Bits)
+	{
+		float ret;
+		memcpy(&ret, &p_Bits, sizeof(float));
+		return ret;
+	}
+
+	uint32_t toBits(float p_Value)
+	{
+		uint32_t ret;
+		memcpy(&ret, &p_Value, sizeof(float));
+		return ret;
+	}
+
+	//the floats of [p_First, p_Last] (bit patterns) every p_Stride, and their negations when p_Signed
+	std::vector<float> sweep(uint32_t p_First, uint32_t p_Last, uint32_t p_Stride, bool p_Signed)
+	{
+		std::vector<float> ret;
+		for(uint64_t b = p_First; b <= p_Last; b += p_Stride)
+		{
+			ret.push_back(fromBits((uint32_t)b));
+			if(p_Signed)
+				ret.push_back(-fromBits((uint32_t)b));
+		}
+		ret.push_back(fromBits(p_Last));
+
+		return ret;
+	}
+
+	//-------------------------------------------------------------------------
+
+	template<Precision P>
+	void checkSinCos(const std::vector<float>& p_In)
+	{
+		std::vector<float> s(BATCH), c(BATCH), o(BATCH);
+		double error = 0;
+		for(size_t first = 0; first < p_In.size(); first += BATCH)
+		{
+			size_t count = p_In.size() - first < BATCH ? p_In.size() - first : BATCH;
+			const float* in = &p_In[first];
+
+			fastmath::sincos<P>(in, s.data(), c.data(), count);
+			fastmath::sin<P>(in, o.data(), count);
+			for(size_t i = 0; i < count; ++i)
+			{
+				double x = in[i];
+				error = fmax(error, fabs(s[i] - sin(x)));
+				error = fmax(error, fabs(c[i] - cos(x)));
+				error = fmax(error, fabs(o[i] - sin(x)));
+			}
+
+			fastmath::cos<P>(in, o.data(), count);
+			for(size_t i = 0; i < count; ++i)
+				error = fmax(error, fabs(o[i] - cos((double)in[i])));
+
+			//the single value versions on a few of them
+			for(size_t i = 0; i < count; i += 61)
+			{
+				double x = in[i];
+				error = fmax(error, fabs(fastmath::sin<P>(in[i]) - sin(x)));
+				error = fmax(error, fabs(fastmath::cos<P>(in[i]) - cos(x)));
+			}
+		}
+
+		test::checkBound(P == PRECISION_REFINED ? "sin/cos refined" : "sin/cos approximate", error, SIN_COS[P]);
+	}
+
+	template<Precision P>
+	void checkAcos(const std::vector<float>& p_In)
+	{
+		std::vector<float> o(BATCH);
+		double error = 0;
+		for(size_t first = 0; first < p_In.size(); first += BATCH)
+		{
+			size_t count = p_In.size() - first < BATCH ? p_In.size() - first : BATCH;
+			const float* in = &p_In[first];
+
+			fastmath::acos<P>(in, o.data(), count);
+			for(size_t i = 0; i < count; ++i)
+				error = fmax(error, fabs(o[i] - acos((double)in[i])));
+
+			for(size_t i = 0; i < count; i += 61)
+				error = fmax(error, fabs(fastmath::acos<P>(in[i]) - acos((double)in[i])));
+		}
+
+		test::checkBound(P == PRECISION_REFINED ? "acos refined" : "acos approximate", error, ACOS[P]);
+	}
+
+	template<Precision P>
+	void checkExp(const std::vector<float>& p_In)
+	{
+		std::vector<float> o(BATCH);
+		double error = 0;
+		for(size_t first = 0; first < p_In.size(); first += BATCH)
+		{
+			size_t count = p_In.size() - first < BATCH ? p_In.size() - first : BATCH;
+			const float* in = &p_In[first];
+
+			fastmath::exp<P>(in, o.data(), count);
+			for(size_t i = 0; i < count; ++i)
+			{
+				double e = exp((double)in[i]);
+				if(e >= FLT_MIN && e <= FLT_MAX)
+				{
+					error = fmax(error, fabs(o[i] - e) / e);
+					if(i % 61 == 0)
+						error = fmax(error, fabs(fastmath::exp<P>(in[i]) - e) / e);
+				}
+			}
+		}
+
+		test::checkBound(P == PRECISION_REFINED ? "exp refined" : "exp approximate", error, EXP[P]);
+	}
+
+	template<Precision P>
+	void checkLog(const std::vector<float>& p_In)
+	{
+		std::vector<float> o(BATCH);
+		double absolute = 0, relative = 0;
+		for(size_t first = 0; first < p_In.size(); first += BATCH)
+		{
+			size_t count = p_In.size() - first < BATCH ? p_In.size() - first : BATCH;
+			const float* in = &p_In[first];
+
+			fastmath::log<P>(in, o.data(), count);
+			for(size_t i = 0; i < count; ++i)
+			{
+				double l = log((double)in[i]);
+				double error = fabs(o[i] - l);
+				if(i % 61 == 0)
+					error = fmax(error, fabs(fastmath::log<P>(in[i]) - l));
+
+				if(fabs(l) <= 1)
+					absolute = fmax(absolute, error);
+				else
+					relative = fmax(relative, error / fabs(l));
+			}
+		}
+
+		test::checkBound(P == PRECISION_REFINED ? "log refined, abs" : "log approximate, abs", absolute, LOG_ABS[P]);
+		test::checkBound(P == PRECISION_REFINED ? "log refined, relative" : "log approximate, relative", relative, LOG_REL[P]);
+	}
+
+	template<Precision P>
+	void checkAtan2(const std::vector<float>& p_Y, const std::vector<float>& p_X)
+	{
+		std::vector<float> o(BATCH);
+		double error = 0;
+		for(size_t first = 0; first < p_Y.size(); first += BATCH)
+		{
+			size_t count = p_Y.size() - first < BATCH ? p_Y.size() - first : BATCH;
+			const float* y = &p_Y[first];
+			const float* x = &p_X[first];
+
+			fastmath::atan2<P>(y, x, o.data(), count);
+			for(size_t i = 0; i < count; ++i)
+				error = fmax(error, fabs(o[i] - atan2((double)y[i], (double)x[i])));
+
+			for(size_t i = 0; i < count; i += 61)
+				error = fmax(error, fabs(fastmath::atan2<P>(y[i], x[i]) - atan2((double)y[i], (double)x[i])));
+		}
+
+		test::checkBound(P == PRECISION_REFINED ? "atan2 refined" : "atan2 approximate", error, ATAN2[P]);
+	}
+
+	//-------------------------------------------------------------------------
+
+	template<Precision P>
+	void checkSpecialValues()
+	{
+		float out = fastmath::log<P>(0.0f);
+		test::check(isinf(out) && out < 0, "log(0) is %g, not -inf", out);
+		out = fastmath::log<P>(-1.0f);
+		test::check(isnan(out), "log(-1) is %g, not NaN", out);
+		out = fastmath::exp<P>(-200.0f);
+		test::check(out == 0, "exp(-200) is %g, not flushed to 0", out);
+		out = fastmath::exp<P>(INFINITY);
+		test::check(isinf(out) && out > 0, "exp(inf) is %g", out);
+		out = fastmath::acos<P>(1.5f);
+		test::check(isnan(out), "acos(1.5) is %g, not NaN", out);
+		out = fastmath::atan2<P>(0.0f, 0.0f);
+		test::check(out == 0, "atan2(0, 0) is %g, not 0", out);
+	}
+
+	template<Precision P>
+	void checkPrecision(const std::vector<float>& p_Angles, const std::vector<float>& p_Unit, const std::vector<float>& p_ExpIn,
+						const std::vector<float>& p_Positive, const std::vector<float>& p_Y, const std::vector<float>& p_X)
+	{
+		checkSinCos<P>(p_Angles);
+		checkAcos<P>(p_Unit);
+		checkExp<P>(p_ExpIn);
+		checkLog<P>(p_Positive);
+		checkAtan2<P>(p_Y, p_X);
+		checkSpecialValues<P>();
+	}
+}
+
+//=============================================================================
+
+int main()
+{
+	std::vector<float> angles = sweep(0, toBits(1e4f), 257, true);
+	std::vector<float> unit = sweep(0, toBits(1.0f), 127, true);
+	std::vector<float> expIn = sweep(0, toBits(89.0f), 257, true);
+	std::vector<float> positive = sweep(toBits(FLT_MIN), toBits(FLT_MAX), 509, false);
+
+	//atan2: the ratios of every magnitude against +-1 in the four quadrants, then random pairs
+	std::vector<float> y, x;
+	std::vector<float> ratios = sweep(0, toBits(FLT_MAX), 1021, false);
+	for(size_t i = 0; i < ratios.size(); ++i)
+	{
+		for(int q = 0; q < 4; ++q)
+		{
+			float v = (q & 1) != 0 ? -ratios[i] : ratios[i];
+			float w = (q & 2) != 0 ? -1.0f : 1.0f;
+			y.push_back(v);
+			x.push_back(w);
+			y.push_back(w);
+			x.push_back(v);
+		}
+	}
+
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> coordinate(-1000.0f, 1000.0f);
+	for(int i = 0; i < 2000000; ++i)
+	{
+		y.push_back(coordinate(rng));
+		x.push_back(coordinate(rng));
+	}
+
+	for(uint32_t l = 0; l < test::levelCount(); ++l)
+	{
+		printf("%s\n", test::selectLevel(l));
+
+		checkPrecision<PRECISION_APPROXIMATE>(angles, unit, expIn, positive, y, x);
+		checkPrecision<PRECISION_REFINED>(angles, unit, expIn, positive, y, x);
+	}
+
+	return test::result();
+}
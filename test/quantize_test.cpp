@@ -0,0 +1,414 @@
+#include "test.h"
+#include "quantize.h"
+#include "vector3.h"
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include <random>
+#include <vector>
+
+using namespace alfar;
+
+// Checks the round trip table of quantize.h and that encoding stores the same
+// bits on every dispatch level: each level's array versions are compared bit
+// for bit with the single value (scalar) encoders, which are compared with the
+// F16C conversions when the cpu has them. Halves walk the float bit patterns
+// with a stride plus every rounding midpoint, all 65536 halves are decoded;
+// normals, rotations and positions are random plus the special cases of the
+// table. The counts are not multiples of 16 so the tails of the kernels run.
+
+namespace
+{
+	//the table of quantize.h
+	const double HALF_RELATIVE = 1.0 / 2048.0;		//|x| in [2^-14, 65504]
+	const double HALF_ABSOLUTE = 1.0 / 33554432.0;	//below
+	const float HALF_INFINITY = 65520.0f;			//and up
+	const double NORMAL = 6.5e-5;					//rad
+	const double ROTATION_COMPONENT = 6.1e-5;
+	const double ROTATION_ANGLE = 1.5e-4;			//rad
+	const double POSITION_ULPS = 4;					//on top of extent / 131070
+
+	const uint32_t NORMALS = 100003;
+	const uint32_t ROTATIONS = 100003;
+	const uint32_t BOXES = 64;
+	const uint32_t POSITIONS = 1031;				//per box
+
+	float fromBits(uint32_t p_Bits)
+	{
+		float ret;
+		memcpy(&ret, &p_Bits, sizeof(float));
+		return ret;
+	}
+
+	uint32_t toBits(float p_Value)
+	{
+		uint32_t ret;
+		memcpy(&ret, &p_Value, sizeof(float));
+		return ret;
+	}
+
+	bool isHalfNaN(uint16_t p_Half)
+	{
+		return (p_Half & 0x7c00) == 0x7c00 && (p_Half & 0x3ff) != 0;
+	}
+
+#if ALFAR_X86
+	ALFAR_TARGET_AVX2 void toHalfF16C(const float* p_In, uint16_t* p_Out, size_t p_Count)
+	{
+		for(size_t i = 0; i < p_Count; i += 4)
+		{
+			size_t count = p_Count - i < 4 ? p_Count - i : 4;
+			float in[4] = {};
+			uint16_t out[8];
+			memcpy(in, p_In + i, count * sizeof(float));
+			_mm_storeu_si128((__m128i*)out, _mm_cvtps_ph(_mm_loadu_ps(in), _MM_FROUND_TO_NEAREST_INT));
+			memcpy(p_Out + i, out, count * sizeof(uint16_t));
+		}
+	}
+
+	ALFAR_TARGET_AVX2 void fromHalfF16C(const uint16_t* p_In, float* p_Out, size_t p_Count)
+	{
+		for(size_t i = 0; i < p_Count; i += 4)
+		{
+			size_t count = p_Count - i < 4 ? p_Count - i : 4;
+			uint16_t in[8] = {};
+			float out[4];
+			memcpy(in, p_In + i, count * sizeof(uint16_t));
+			_mm_storeu_ps(out, _mm_cvtph_ps(_mm_loadu_si128((const __m128i*)in)));
+			memcpy(p_Out + i, out, count * sizeof(float));
+		}
+	}
+#endif
+
+	//-------------------------------------------------------------------------
+
+	//the floats every p_Stride bit patterns and both neighbours of every midpoint between
+	//two finite halves, with their negations
+	std::vector<float> halfInputs(uint32_t p_Stride)
+	{
+		std::vector<float> ret;
+		for(uint64_t b = 0; b <= 0x7fffffff; b += p_Stride)
+			ret.push_back(fromBits((uint32_t)b));
+
+		for(uint32_t h = 0; h < 0x7bff; ++h)
+		{
+			float middle = (quantize::fromHalf((uint16_t)h) + quantize::fromHalf((uint16_t)(h + 1))) * 0.5f;
+			ret.push_back(quantize::fromHalf((uint16_t)h));
+			ret.push_back(middle);
+			ret.push_back(fromBits(toBits(middle) - 1));
+			ret.push_back(fromBits(toBits(middle) + 1));
+		}
+
+		const float special[] = { 65504.0f, fromBits(toBits(HALF_INFINITY) - 1), HALF_INFINITY, FLT_MAX, INFINITY, NAN };
+		ret.insert(ret.end(), special, special + sizeof(special) / sizeof(special[0]));
+
+		size_t count = ret.size();
+		for(size_t i = 0; i < count; ++i)
+			ret.push_back(-ret[i]);
+
+		return ret;
+	}
+
+	//the scalar encoder against F16C, both ways and on all 65536 halves
+	void checkF16C(const std::vector<float>& p_In, const std::vector<uint16_t>& p_Reference)
+	{
+#if ALFAR_X86
+		if(cpu::detectHardware() < cpu::LEVEL_AVX2)
+		{
+			printf("no F16C, the halves are only compared between levels\n");
+			return;
+		}
+
+		std::vector<uint16_t> h(p_In.size());
+		toHalfF16C(p_In.data(), h.data(), p_In.size());
+
+		uint32_t different = 0;
+		for(size_t i = 0; i < p_In.size(); ++i)
+			different += isnan(p_In[i]) ? !isHalfNaN(h[i]) || !isHalfNaN(p_Reference[i]) : h[i] != p_Reference[i];
+		test::check(different == 0, "toHalf: %u of %u floats encode differently from F16C", different, (uint32_t)p_In.size());
+
+		std::vector<uint16_t> all(65536);
+		std::vector<float> f(65536);
+		for(uint32_t i = 0; i < 65536; ++i)
+			all[i] = (uint16_t)i;
+		fromHalfF16C(all.data(), f.data(), all.size());
+
+		different = 0;
+		for(uint32_t i = 0; i < 65536; ++i)
+		{
+			float v = quantize::fromHalf((uint16_t)i);
+			different += isHalfNaN((uint16_t)i) ? !isnan(v) || !isnan(f[i]) : toBits(v) != toBits(f[i]);
+		}
+		test::check(different == 0, "fromHalf: %u halves decode differently from F16C", different);
+#else
+		(void)p_In;
+		(void)p_Reference;
+#endif
+	}
+
+	void checkHalves(const std::vector<float>& p_In, const std::vector<uint16_t>& p_Reference)
+	{
+		std::vector<uint16_t> h(p_In.size());
+		std::vector<float> f(p_In.size());
+		quantize::toHalf(p_In.data(), h.data(), p_In.size());
+		quantize::fromHalf(h.data(), f.data(), h.size());
+
+		uint32_t different = 0, notInfinity = 0, notNaN = 0;
+		double relative = 0, absolute = 0;
+		for(size_t i = 0; i < p_In.size(); ++i)
+		{
+			double x = p_In[i], a = fabs(x);
+			if(isnan(x))
+			{
+				notNaN += !isHalfNaN(h[i]) || !isnan(f[i]);
+				continue;
+			}
+
+			different += h[i] != p_Reference[i];
+			if(a >= HALF_INFINITY)
+				notInfinity += !isinf(f[i]) || (f[i] < 0) != (x < 0);
+			else if(a >= 1.0 / 16384.0)
+				relative = fmax(relative, fabs(f[i] - x) / a);
+			else
+				absolute = fmax(absolute, fabs(f[i] - x));
+		}
+
+		test::check(different == 0, "toHalf: %u floats encode differently from the scalar level", different);
+		test::check(notInfinity == 0 && notNaN == 0, "toHalf: %u floats from 65520 up not infinity, %u NaN not NaN", notInfinity, notNaN);
+		test::checkBound("half, relative", relative, HALF_RELATIVE);
+		test::checkBound("half, abs", absolute, HALF_ABSOLUTE);
+
+		std::vector<uint16_t> all(65536);
+		std::vector<float> decoded(65536);
+		for(uint32_t i = 0; i < 65536; ++i)
+			all[i] = (uint16_t)i;
+		quantize::fromHalf(all.data(), decoded.data(), all.size());
+
+		different = 0;
+		for(uint32_t i = 0; i < 65536; ++i)
+		{
+			float v = quantize::fromHalf((uint16_t)i);
+			different += isHalfNaN((uint16_t)i) ? !isnan(decoded[i]) : toBits(v) != toBits(decoded[i]);
+		}
+		test::check(different == 0, "fromHalf: %u halves decode differently from the scalar level", different);
+	}
+
+	//-------------------------------------------------------------------------
+
+	void checkNormals(const std::vector<Vector3>& p_In, const std::vector<NormalOct>& p_Reference)
+	{
+		uint32_t number = (uint32_t)p_In.size();
+		std::vector<NormalOct> encoded(number);
+		std::vector<Vector3> decoded(number);
+		quantize::encodeNormal(p_In.data(), encoded.data(), number);
+		quantize::decodeNormal(encoded.data(), decoded.data(), number);
+
+		uint32_t different = 0, notZ = 0;
+		double error = 0;
+		for(uint32_t i = 0; i < number; ++i)
+		{
+			different += memcmp(&encoded[i], &p_Reference[i], sizeof(NormalOct)) != 0;
+
+			double x = p_In[i].x, y = p_In[i].y, z = p_In[i].z;
+			if(x == 0 && y == 0 && z == 0)
+			{
+				notZ += decoded[i].x != 0 || decoded[i].y != 0 || decoded[i].z != 1;
+				continue;
+			}
+
+			double cx = y * decoded[i].z - z * decoded[i].y;
+			double cy = z * decoded[i].x - x * decoded[i].z;
+			double cz = x * decoded[i].y - y * decoded[i].x;
+			double dot = x * decoded[i].x + y * decoded[i].y + z * decoded[i].z;
+			error = fmax(error, atan2(sqrt(cx * cx + cy * cy + cz * cz), dot));
+		}
+
+		test::check(different == 0, "encodeNormal: %u normals encode differently from the scalar level", different);
+		test::check(notZ == 0, "encodeNormal: %u zero normals not decoded as +z", notZ);
+		test::checkBound("normal", error, NORMAL);
+	}
+
+	void checkRotations(const std::vector<Quaternion>& p_In, const std::vector<QuaternionPacked>& p_Reference)
+	{
+		uint32_t number = (uint32_t)p_In.size();
+		std::vector<QuaternionPacked> encoded(number);
+		std::vector<Quaternion> decoded(number);
+		quantize::encodeRotation(p_In.data(), encoded.data(), number);
+		quantize::decodeRotation(encoded.data(), decoded.data(), number);
+
+		uint32_t different = 0;
+		double component = 0, angle = 0;
+		for(uint32_t i = 0; i < number; ++i)
+		{
+			different += memcmp(&encoded[i], &p_Reference[i], sizeof(QuaternionPacked)) != 0;
+
+			const float* q = &p_In[i].x;
+			const float* d = &decoded[i].x;
+			double dot = 0, qq = 0, dd = 0;
+			for(int k = 0; k < 4; ++k)
+			{
+				dot += (double)q[k] * d[k];
+				qq += (double)q[k] * q[k];
+				dd += (double)d[k] * d[k];
+			}
+
+			double sign = dot < 0 ? -1.0 : 1.0;
+			for(int k = 0; k < 4; ++k)
+				component = fmax(component, fabs(d[k] - sign * q[k]));
+
+			double c = fabs(dot) / sqrt(qq * dd);
+			angle = fmax(angle, 2.0 * acos(c < 1 ? c : 1.0));
+		}
+
+		test::check(different == 0, "encodeRotation: %u rotations encode differently from the scalar level", different);
+		test::checkBound("rotation, component", component, ROTATION_COMPONENT);
+		test::checkBound("rotation, angle", angle, ROTATION_ANGLE);
+	}
+
+	//-------------------------------------------------------------------------
+
+	struct PositionSet
+	{
+		AABB bounds;
+		std::vector<Vector3> in;
+		std::vector<Vector3Quantized> reference;
+	};
+
+	void checkPositions(const std::vector<PositionSet>& p_Sets)
+	{
+		uint32_t different = 0, notFlat = 0;
+		double excess = 0;
+		for(size_t s = 0; s < p_Sets.size(); ++s)
+		{
+			const PositionSet& set = p_Sets[s];
+			uint32_t number = (uint32_t)set.in.size();
+			std::vector<Vector3Quantized> encoded(number);
+			std::vector<Vector3> decoded(number);
+			quantize::encodePosition(set.in.data(), encoded.data(), number, set.bounds);
+			quantize::decodePosition(encoded.data(), decoded.data(), number, set.bounds);
+
+			const float* min = &set.bounds.min.x;
+			const float* max = &set.bounds.max.x;
+			for(uint32_t i = 0; i < number; ++i)
+			{
+				different += memcmp(&encoded[i], &set.reference[i], sizeof(Vector3Quantized)) != 0;
+
+				const uint16_t* e = &encoded[i].x;
+				const float* p = &set.in[i].x;
+				const float* d = &decoded[i].x;
+				for(int k = 0; k < 3; ++k)
+				{
+					if(max[k] == min[k])
+					{
+						notFlat += e[k] != 0 || d[k] != min[k];
+						continue;
+					}
+
+					double clamped = p[k] < min[k] ? min[k] : (p[k] > max[k] ? max[k] : p[k]);
+					double magnitude = fmax(fabs(min[k]), fabs(max[k]));
+					double bound = ((double)max[k] - min[k]) / 131070.0 + POSITION_ULPS * ldexp(1.0, ilogb(magnitude) - 23);
+					excess = fmax(excess, fabs(d[k] - clamped) / bound);
+				}
+			}
+		}
+
+		test::check(different == 0, "encodePosition: %u positions encode differently from the scalar level", different);
+		test::check(notFlat == 0, "encodePosition: %u flat axes not stored as 0 and decoded as min", notFlat);
+		test::checkBound("position, error / (extent / 131070 + ulps)", excess, 1.0);
+	}
+}
+
+//=============================================================================
+
+int main()
+{
+	std::mt19937 rng(24);
+	std::normal_distribution<double> gauss;
+
+	std::vector<float> halves = halfInputs(4093);
+	std::vector<uint16_t> halfReference(halves.size());
+	for(size_t i = 0; i < halves.size(); ++i)
+		halfReference[i] = quantize::toHalf(halves[i]);
+
+	//random directions at several lengths, the axes, the octahedron edges and zero
+	std::vector<Vector3> normals;
+	const float lengths[] = { 1.0f, 1e-30f, 3.0f, 1e30f };
+	for(uint32_t i = 0; i < NORMALS; ++i)
+	{
+		double x = gauss(rng), y = gauss(rng), z = gauss(rng);
+		double scale = lengths[i % 4] / sqrt(x * x + y * y + z * z);
+		normals.push_back(vector3::create((float)(x * scale), (float)(y * scale), (float)(z * scale)));
+	}
+	for(int k = 0; k < 27; ++k)
+		normals.push_back(vector3::create((float)(k % 3 - 1), (float)(k / 3 % 3 - 1), (float)(k / 9 - 1)));
+	normals.push_back(vector3::create(0.5f, -0.5f, -1e-7f));
+	normals.push_back(vector3::create(-0.0f, -0.0f, -0.0f));
+
+	std::vector<NormalOct> normalReference(normals.size());
+	for(size_t i = 0; i < normals.size(); ++i)
+		normalReference[i] = quantize::encodeNormal(normals[i]);
+
+	//random unit quaternions, then half turns and ties between the largest components
+	std::vector<Quaternion> rotations;
+	for(uint32_t i = 0; i < ROTATIONS; ++i)
+	{
+		double q[4] = { gauss(rng), gauss(rng), gauss(rng), gauss(rng) };
+		double length = sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+		Quaternion r = { (float)(q[0] / length), (float)(q[1] / length), (float)(q[2] / length), (float)(q[3] / length) };
+		rotations.push_back(r);
+	}
+	const Quaternion special[] = { { 0, 0, 0, 1 }, { 0, 0, 0, -1 }, { 1, 0, 0, 0 }, { 0, -1, 0, 0 }, { 0.5f, 0.5f, 0.5f, 0.5f },
+								   { -0.5f, 0.5f, -0.5f, 0.5f }, { 0.70710678f, -0.70710678f, 0, 0 }, { 0, 0, -0.70710678f, -0.70710678f } };
+	rotations.insert(rotations.end(), special, special + sizeof(special) / sizeof(special[0]));
+
+	std::vector<QuaternionPacked> rotationReference(rotations.size());
+	for(size_t i = 0; i < rotations.size(); ++i)
+		rotationReference[i] = quantize::encodeRotation(rotations[i]);
+
+	//boxes from 10^-3 to 10^4 per axis around centers up to 1000 away, one flat axis in every
+	//eighth, the points 10% past the box on each side and its corners
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<PositionSet> positions(BOXES);
+	for(uint32_t b = 0; b < BOXES; ++b)
+	{
+		PositionSet& set = positions[b];
+		float* min = &set.bounds.min.x;
+		float* max = &set.bounds.max.x;
+		for(int k = 0; k < 3; ++k)
+		{
+			float center = unit(rng) * 2000.0f - 1000.0f;
+			float extent = b % 8 == 0 && k == (int)(b / 8 % 3) ? 0.0f : powf(10.0f, unit(rng) * 7.0f - 3.0f);
+			min[k] = center - extent * 0.5f;
+			max[k] = extent == 0 ? min[k] : center + extent * 0.5f;
+		}
+
+		for(uint32_t i = 0; i < POSITIONS; ++i)
+		{
+			Vector3 p = {};
+			float* out = &p.x;
+			for(int k = 0; k < 3; ++k)
+			{
+				if(i < 8)
+					out[k] = (i >> k & 1) != 0 ? max[k] : min[k];
+				else
+					out[k] = min[k] + (max[k] - min[k]) * (unit(rng) * 1.2f - 0.1f);
+			}
+			set.in.push_back(p);
+			set.reference.push_back(quantize::encodePosition(p, set.bounds));
+		}
+	}
+
+	checkF16C(halves, halfReference);
+
+	for(uint32_t l = 0; l < test::levelCount(); ++l)
+	{
+		printf("%s\n", test::selectLevel(l));
+
+		checkHalves(halves, halfReference);
+		checkNormals(normals, normalReference);
+		checkRotations(rotations, rotationReference);
+		checkPositions(positions);
+	}
+
+	return test::result();
+}
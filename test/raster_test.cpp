@@ -0,0 +1,217 @@
+#include "test.h"
+#include "raster.h"
+#include "mat4x4.h"
+#include <random>
+#include <vector>
+
+using namespace alfar;
+
+// Checks the watertightness of raster.h: the triangles of a mesh sharing its
+// vertices cover each pixel center at most once, and exactly once where the
+// mesh covers the target, on every dispatch level and with FTZ/DAZ on. Each
+// triangle is drawn alone and the pixels it reaches in the depth buffer are
+// counted. The meshes are jittered grids over the whole target (vertices
+// anywhere, and vertices on pixel centers, edges and corners), a fan around a
+// pixel center and a perspective floor crossing the near plane and the guard
+// band.
+
+namespace
+{
+	const uint32_t WIDTH = 128;
+	const uint32_t HEIGHT = 96;
+	const uint32_t SEEDS = 16;
+
+	struct Mesh
+	{
+		Matrix4x4 viewProj;
+		std::vector<Vector3> positions;
+		std::vector<uint32_t> indices;
+		uint32_t fullRows;		//rows [fullRows, HEIGHT) are covered, and [0, emptyRows) are not
+		uint32_t emptyRows;
+	};
+
+	//p_Columns x p_Rows cells over [-p_Extent, p_Extent]^2 of the xy plane, or of the xz plane at y = -1
+	//when p_Floor, interior vertices moved by up to p_Jitter cells and snapped to multiples of
+	//(p_StepX, p_StepY) when they are not 0, each cell cut along a random diagonal with a random winding
+	void addGrid(Mesh& p_Mesh, std::mt19937& p_Rng, uint32_t p_Columns, uint32_t p_Rows, float p_Extent, float p_Jitter,
+				 float p_StepX, float p_StepY, bool p_Floor)
+	{
+		std::uniform_real_distribution<float> jitter(-p_Jitter, p_Jitter);
+		std::uniform_int_distribution<int> coin(0, 1);
+
+		uint32_t first = (uint32_t)p_Mesh.positions.size();
+		float cellX = 2.0f * p_Extent / p_Columns;
+		float cellY = 2.0f * p_Extent / p_Rows;
+
+		for(uint32_t r = 0; r <= p_Rows; ++r)
+		{
+			for(uint32_t c = 0; c <= p_Columns; ++c)
+			{
+				float x = -p_Extent + c * cellX;
+				float y = -p_Extent + r * cellY;
+				if(c > 0 && c < p_Columns && r > 0 && r < p_Rows)
+				{
+					x += jitter(p_Rng) * cellX;
+					y += jitter(p_Rng) * cellY;
+				}
+
+				if(p_StepX != 0)
+				{
+					x = roundf(x / p_StepX) * p_StepX;
+					y = roundf(y / p_StepY) * p_StepY;
+				}
+
+				p_Mesh.positions.push_back(p_Floor ? vector3::create(x, -1.0f, y) : vector3::create(x, y, 0));
+			}
+		}
+
+		for(uint32_t r = 0; r < p_Rows; ++r)
+		{
+			for(uint32_t c = 0; c < p_Columns; ++c)
+			{
+				uint32_t v00 = first + r * (p_Columns + 1) + c;
+				uint32_t v10 = v00 + 1, v01 = v00 + p_Columns + 1, v11 = v01 + 1;
+
+				uint32_t quad[2][3];
+				if(coin(p_Rng))
+				{
+					uint32_t a[3] = { v00, v10, v11 }, b[3] = { v00, v11, v01 };
+					std::copy(a, a + 3, quad[0]);
+					std::copy(b, b + 3, quad[1]);
+				}
+				else
+				{
+					uint32_t a[3] = { v00, v10, v01 }, b[3] = { v10, v11, v01 };
+					std::copy(a, a + 3, quad[0]);
+					std::copy(b, b + 3, quad[1]);
+				}
+
+				for(int t = 0; t < 2; ++t)
+				{
+					if(coin(p_Rng))
+						std::swap(quad[t][1], quad[t][2]);
+					p_Mesh.indices.insert(p_Mesh.indices.end(), quad[t], quad[t] + 3);
+				}
+			}
+		}
+	}
+
+	//a random 8 x 6 grid in normalized device coordinates, past the target edges, with the
+	//vertices on multiples of p_Pixels pixels when it is not 0
+	Mesh grid(std::mt19937& p_Rng, float p_Pixels)
+	{
+		Mesh ret;
+		ret.viewProj = mat4x4::identity();
+		ret.fullRows = 0;
+		ret.emptyRows = 0;
+		addGrid(ret, p_Rng, 8, 6, 1.1f, 0.2f, p_Pixels * 2.0f / WIDTH, p_Pixels * 2.0f / HEIGHT, false);
+		return ret;
+	}
+
+	//triangles around the center of pixel (p_X, p_Y), to past the target edges
+	Mesh fan(uint32_t p_X, uint32_t p_Y, uint32_t p_Count)
+	{
+		Mesh ret;
+		ret.viewProj = mat4x4::identity();
+		ret.fullRows = 0;
+		ret.emptyRows = 0;
+
+		ret.positions.push_back(vector3::create((p_X + 0.5f) * 2.0f / WIDTH - 1.0f, 1.0f - (p_Y + 0.5f) * 2.0f / HEIGHT, 0));
+		for(uint32_t k = 0; k < p_Count; ++k)
+		{
+			float angle = 2.0f * 3.14159265f * k / p_Count;
+			ret.positions.push_back(vector3::create(4.0f * cosf(angle), 4.0f * sinf(angle), 0));
+
+			uint32_t triangle[3] = { 0, 1 + k, 1 + (k + 1) % p_Count };
+			ret.indices.insert(ret.indices.end(), triangle, triangle + 3);
+		}
+
+		return ret;
+	}
+
+	//a floor under the camera, in front of and behind it, so the near plane and the guard band cut it
+	Mesh floorMesh(std::mt19937& p_Rng)
+	{
+		Mesh ret;
+		ret.viewProj = mat4x4::persp(1.2f, (float)WIDTH / HEIGHT, 0.001f, 100.0f);
+		ret.fullRows = HEIGHT / 2 + 8;
+		ret.emptyRows = HEIGHT / 2;
+		addGrid(ret, p_Rng, 16, 16, 40.0f, 0.2f, 0, 0, true);
+		return ret;
+	}
+
+	//-------------------------------------------------------------------------
+
+	void checkMesh(const char* p_Name, const Mesh& p_Mesh, const parallel::Policy& p_Policy)
+	{
+		RasterTarget target = raster::create(WIDTH, HEIGHT, false);
+		std::vector<uint32_t> count(WIDTH * HEIGHT, 0);
+
+		uint32_t triangles = (uint32_t)p_Mesh.indices.size() / 3;
+		for(uint32_t t = 0; t < triangles; ++t)
+		{
+			raster::clear(target);
+			raster::draw(p_Policy, target, p_Mesh.viewProj, p_Mesh.positions.data(), (uint32_t)p_Mesh.positions.size(), NULL, &p_Mesh.indices[t * 3], 1);
+
+			for(uint32_t y = 0; y < HEIGHT; ++y)
+			{
+				for(uint32_t x = 0; x < WIDTH; ++x)
+					count[y * WIDTH + x] += target.depth[y * target.pitch + x] < 1.0f;
+			}
+		}
+
+		uint32_t twice = 0, missed = 0, outside = 0;
+		for(uint32_t y = 0; y < HEIGHT; ++y)
+		{
+			for(uint32_t x = 0; x < WIDTH; ++x)
+			{
+				uint32_t c = count[y * WIDTH + x];
+				twice += c > 1;
+				missed += c == 0 && y >= p_Mesh.fullRows;
+				outside += c != 0 && y < p_Mesh.emptyRows;
+			}
+		}
+
+		test::check(twice == 0 && missed == 0 && outside == 0, "%s: %u pixels covered twice or more, %u missed, %u outside the mesh", p_Name, twice, missed, outside);
+
+		raster::destroy(target);
+	}
+
+	void checkMeshes(const parallel::Policy& p_Policy)
+	{
+		std::mt19937 rng(21);
+		for(uint32_t s = 0; s < SEEDS; ++s)
+		{
+			checkMesh("grid", grid(rng, 0), p_Policy);
+			checkMesh("grid on half pixels", grid(rng, 0.5f), p_Policy);
+			checkMesh("floor", floorMesh(rng), p_Policy);
+		}
+
+		checkMesh("fan", fan(WIDTH / 2, HEIGHT / 3, 12), p_Policy);
+		checkMesh("fan at the origin", fan(0, 0, 7), p_Policy);
+	}
+}
+
+int main()
+{
+	//one participant, so that the MXCSR set here is the one of every step
+	parallel::ThreadPool* single = parallel::create(1);
+
+	for(uint32_t l = 0; l < test::levelCount(); ++l)
+	{
+		printf("%s\n", test::selectLevel(l));
+
+		checkMeshes(parallel::policy());
+
+#if ALFAR_X86
+		unsigned int csr = _mm_getcsr();
+		_mm_setcsr(csr | 0x8040);		//FTZ and DAZ
+		checkMeshes(parallel::policy(single));
+		_mm_setcsr(csr);
+#endif
+	}
+
+	parallel::destroy(single);
+
+	return test::result();
+}
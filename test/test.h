@@ -0,0 +1,74 @@
+#pragma once
+
+#include "cpu.h"
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Minimal harness of the runtime tests: each test is an executable run by
+// ctest, checks print what failed and count it, and main returns
+// test::result(). levels() walks the dispatch levels the cpu supports so that
+// every SIMD path is checked, not just the best one.
+
+namespace test
+{
+	inline uint32_t& failures()
+	{
+		static uint32_t s_Failures = 0;
+		return s_Failures;
+	}
+
+	//false, and the printf style message reported, when p_Ok is false
+	inline bool check(bool p_Ok, const char* p_Format, ...)
+	{
+		if(p_Ok)
+			return true;
+
+		va_list args;
+		va_start(args, p_Format);
+		printf("FAILED [%s] ", alfar::cpu::levelName(alfar::cpu::level()));
+		vprintf(p_Format, args);
+		printf("\n");
+		va_end(args);
+
+		++failures();
+		return false;
+	}
+
+	//p_Value <= p_Bound, both printed on failure
+	inline bool checkBound(const char* p_What, double p_Value, double p_Bound)
+	{
+		return check(p_Value <= p_Bound, "%s: %.4g above the documented %.4g", p_What, p_Value, p_Bound);
+	}
+
+	//levels from scalar up to the best one of the cpu (the only one when the build fixes it)
+	inline uint32_t levelCount()
+	{
+#if ALFAR_MIN_LEVEL == ALFAR_MAX_LEVEL
+		return 1;
+#else
+		return (uint32_t)alfar::cpu::detect() + 1;
+#endif
+	}
+
+	//selects the p_Index-th level of levelCount() and returns its name
+	inline const char* selectLevel(uint32_t p_Index)
+	{
+#if ALFAR_MIN_LEVEL != ALFAR_MAX_LEVEL
+		alfar::cpu::setLevel((alfar::cpu::Level)p_Index);
+#else
+		(void)p_Index;
+#endif
+		return alfar::cpu::levelName(alfar::cpu::level());
+	}
+
+	inline int result()
+	{
+		if(failures() == 0)
+			printf("passed\n");
+		else
+			printf("%u checks failed\n", failures());
+
+		return failures() == 0 ? 0 : 1;
+	}
+}